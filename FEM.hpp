@@ -1,27 +1,40 @@
 #include "Array.hpp"
 #include "BilinearIntegrator.hpp"
 #include "CG.hpp"
+#include "Checkpoint.hpp"
+#include "ConstrainedOperator.hpp"
 #include "Coefficient.hpp"
+#include "Compression.hpp"
 #include "Element.hpp"
 #include "ElTrans.hpp"
+#include "Expression.hpp"
 #include "FEMatrix.hpp"
 #include "FESpace.hpp"
+#include "GeometricFactors.hpp"
 #include "General.hpp"
 #include "GridFunction.hpp"
 #include "L2Space.hpp"
+#include "LagrangeBasis.hpp"
 #include "LagrangeSpace.hpp"
 #include "LHS.hpp"
 #include "LinearIntegrator.hpp"
 #include "Matrix.hpp"
+#include "MatrixView.hpp"
 #include "MeshEl.hpp"
 #include "Mesh.hpp"
+#include "MappedFile.hpp"
 #include "Node.hpp"
 #include "Point.hpp"
 #include "Polynomial.hpp"
 #include "Quadrature.hpp"
+#include "ReferenceElement.hpp"
 #include "RHS.hpp"
+#include "ShapeTable.hpp"
+#include "Snapshot.hpp"
+#include "SpaceCache.hpp"
 #include "SparseMatrix.hpp"
 #include "SquareMesh.hpp"
+#include "StreamingFEMatrix.hpp"
 #include "Vector.hpp"  
 #include "Writer.hpp"
 #include "HWCounter.hpp"
\ No newline at end of file
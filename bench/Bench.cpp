@@ -0,0 +1,229 @@
+#include "Bench.hpp"
+#include <algorithm>
+#include <cstdio>
+
+using namespace std; 
+
+namespace fem 
+{
+
+vector<Benchmark>& BenchRegistry() {
+	static vector<Benchmark> registry; 
+	return registry; 
+}
+
+/// return the name of an element type as used in ids 
+static const char* TypeName(GmshElType type) {
+	if (type == QUAD) return "quad"; 
+	if (type == HEX) return "hex"; 
+	if (type == TRI) return "tri"; 
+	return ""; 
+}
+
+/// return the seconds since start 
+static inline double Seconds(const chrono::steady_clock::time_point& start) {
+	return chrono::duration<double>(chrono::steady_clock::now() - start).count(); 
+}
+
+/// return work/seconds in billions per second ("-" if there is no work) 
+static string Rate(double work, double seconds) {
+	if (work <= 0 || seconds <= 0) return "-"; 
+	char s[32]; 
+	snprintf(s, sizeof(s), "%.3f", work/seconds/1e9); 
+	return s; 
+}
+
+string BenchID(const string& name, const BenchParams& p) {
+	string id = name; 
+	if (p.n) id += "/n=" + to_string(p.n); 
+	if (p.order) id += "/p=" + to_string(p.order); 
+	if (p.type != LINE) id += string("/") + TypeName(p.type); 
+	if (!p.variant.empty()) id += "/" + p.variant; 
+	return id; 
+}
+
+BenchResult BenchRun(const Benchmark& b, const BenchParams& p, const BenchOptions& opt) {
+	BenchKernel k = b.setup(p); 
+	BenchResult r; 
+	r.name = b.name; 
+	r.params = p; 
+	r.id = BenchID(b.name, p); 
+	r.flops = k.flops; 
+	r.bytes = k.bytes; 
+	r.baseline = 0; 
+
+	for (int i=0; i<opt.warmup; i++) {
+		k.run(); 
+	}
+
+	// double the calls per repetition until one lasts min_time 
+	r.inner = 1; 
+	while (r.inner < (1 << 24)) {
+		auto start = chrono::steady_clock::now(); 
+		for (int i=0; i<r.inner; i++) {
+			k.run(); 
+		}
+		if (Seconds(start) >= opt.min_time) break; 
+		r.inner *= 2; 
+	}
+
+	r.reps = std::max(1, opt.reps); 
+	vector<double> secs(r.reps), ticks(r.reps); 
+	HWCounter hwc; 
+	for (int rep=0; rep<r.reps; rep++) {
+		auto start = chrono::steady_clock::now(); 
+		uint64_t t0 = TraceTicks(); 
+		for (int i=0; i<r.inner; i++) {
+			k.run(); 
+		}
+		ticks[rep] = (double)(TraceTicks() - t0)/r.inner; 
+		secs[rep] = Seconds(start)/r.inner; 
+	}
+	hwc.Read(); 
+	double calls = (double)r.reps*r.inner; 
+	r.cycles = HWCounter::Available(HPM::cycles) ? hwc.Cycles()/calls : 0; 
+	r.instructions = HWCounter::Available(HPM::instructions) ? hwc.Instructions()/calls : 0; 
+
+	vector<double> sorted(secs); 
+	sort(sorted.begin(), sorted.end()); 
+	r.min = sorted.front(); 
+	r.max = sorted.back(); 
+	r.median = (r.reps%2) ? sorted[r.reps/2] : .5*(sorted[r.reps/2-1] + sorted[r.reps/2]); 
+	r.mean = 0; 
+	for (int i=0; i<r.reps; i++) {
+		r.mean += secs[i]/r.reps; 
+	}
+	r.stddev = 0; 
+	for (int i=0; i<r.reps; i++) {
+		r.stddev += (secs[i] - r.mean)*(secs[i] - r.mean); 
+	}
+	r.stddev = (r.reps > 1) ? sqrt(r.stddev/(r.reps-1)) : 0; 
+	sort(ticks.begin(), ticks.end()); 
+	r.ticks = ticks[r.reps/2]; 
+	return r; 
+}
+
+int BenchRunAll(const BenchOptions& opt, ostream& out) {
+	map<string, double> base; 
+	if (!opt.baseline.empty()) base = BenchReadBaseline(opt.baseline); 
+
+	char line[512]; 
+	snprintf(line, sizeof(line), "%-48s %12s %12s %7s %9s %9s  %s", "case", "median (us)", 
+		"min (us)", "+/- %", "GFLOP/s", "GB/s", (base.empty()) ? "" : "vs baseline"); 
+	string header = line; 
+	out << header.substr(0, header.find_last_not_of(' ') + 1) << endl; 
+
+	vector<BenchResult> results; 
+	int regressions = 0; 
+	for (const Benchmark& b : BenchRegistry()) {
+		if (b.name.find(opt.filter) == string::npos) continue; 
+		vector<int> sizes = (b.sizes.empty()) ? vector<int>{0} : b.sizes; 
+		vector<int> orders = (b.orders.empty()) ? vector<int>{0} : b.orders; 
+		vector<GmshElType> types = (b.types.empty()) ? vector<GmshElType>{LINE} : b.types; 
+		vector<string> variants = (b.variants.empty()) ? vector<string>{""} : b.variants; 
+		if (opt.quick) {
+			sizes.resize(1); 
+			orders.resize(1); 
+		}
+		for (GmshElType type : types) {
+		for (int order : orders) {
+		for (int n : sizes) {
+		for (const string& variant : variants) {
+			BenchResult r = BenchRun(b, {n, order, type, variant}, opt); 
+			string cmp; 
+			auto it = base.find(r.id); 
+			if (it != base.end() && it->second > 0) {
+				r.baseline = it->second; 
+				double ratio = r.median/r.baseline; 
+				snprintf(line, sizeof(line), "%.3fx", ratio); 
+				cmp = line; 
+				if (ratio > 1 + opt.tolerance) {
+					cmp += " REGRESSION"; 
+					regressions++; 
+				} else if (ratio < 1 - opt.tolerance) {
+					cmp += " improved"; 
+				}
+			}
+			snprintf(line, sizeof(line), "%-48s %12.3f %12.3f %7.2f %9s %9s  %s", 
+				r.id.c_str(), 1e6*r.median, 1e6*r.min, 
+				(r.mean > 0) ? 100*r.stddev/r.mean : 0., 
+				Rate(r.flops, r.median).c_str(), Rate(r.bytes, r.median).c_str(), cmp.c_str()); 
+			string row = line; 
+			out << row.substr(0, row.find_last_not_of(' ') + 1) << endl; 
+			results.push_back(r); 
+		}
+		}
+		}
+		}
+	}
+
+	if (!opt.json.empty()) BenchWriteJSON(opt.json, results); 
+	if (!opt.csv.empty()) BenchWriteCSV(opt.csv, results); 
+	out << results.size() << " cases"; 
+	if (!base.empty()) out << ", " << regressions << " slower than the baseline by more than " 
+		<< 100*opt.tolerance << "%"; 
+	out << endl; 
+	return regressions; 
+}
+
+void BenchWriteJSON(const string& name, const vector<BenchResult>& results) {
+	FILE* out = fopen(name.c_str(), "w"); 
+	if (!out) ERROR("could not open " << name); 
+#ifdef USE_RISCV
+	int riscv = 1; 
+#else
+	int riscv = 0; 
+#endif
+	fprintf(out, "{\"machine\": {\"compiler\": \"%s\", \"riscv\": %d, \"counters\": \"%s\"},\n", 
+		__VERSION__, riscv, HWCounter::Backend().c_str()); 
+	fprintf(out, "\"results\": [\n"); 
+	for (int i=0; i<results.size(); i++) {
+		const BenchResult& r = results[i]; 
+		fprintf(out, "{\"id\": \"%s\", \"name\": \"%s\", \"n\": %d, \"order\": %d, " 
+			"\"type\": \"%s\", \"variant\": \"%s\", \"reps\": %d, \"inner\": %d, " 
+			"\"min\": %.9g, \"median\": %.9g, \"mean\": %.9g, \"stddev\": %.9g, \"max\": %.9g, " 
+			"\"ticks\": %.9g, \"cycles\": %.9g, \"instructions\": %.9g, " 
+			"\"flops\": %.9g, \"bytes\": %.9g}%s\n", 
+			r.id.c_str(), r.name.c_str(), r.params.n, r.params.order, TypeName(r.params.type), 
+			r.params.variant.c_str(), r.reps, r.inner, r.min, r.median, r.mean, r.stddev, r.max, 
+			r.ticks, r.cycles, r.instructions, r.flops, r.bytes, 
+			(i+1 < results.size()) ? "," : ""); 
+	}
+	fprintf(out, "]}\n"); 
+	bool ok = ferror(out) == 0; 
+	if (fclose(out) != 0 || !ok) ERROR("could not write " << name); 
+}
+
+void BenchWriteCSV(const string& name, const vector<BenchResult>& results) {
+	FILE* out = fopen(name.c_str(), "w"); 
+	if (!out) ERROR("could not open " << name); 
+	fprintf(out, "id,name,n,order,type,variant,reps,inner,min,median,mean,stddev,max," 
+		"ticks,cycles,instructions,flops,bytes,baseline\n"); 
+	for (const BenchResult& r : results) {
+		fprintf(out, "\"%s\",\"%s\",%d,%d,%s,\"%s\",%d,%d,%.9g,%.9g,%.9g,%.9g,%.9g," 
+			"%.9g,%.9g,%.9g,%.9g,%.9g,%.9g\n", 
+			r.id.c_str(), r.name.c_str(), r.params.n, r.params.order, TypeName(r.params.type), 
+			r.params.variant.c_str(), r.reps, r.inner, r.min, r.median, r.mean, r.stddev, r.max, 
+			r.ticks, r.cycles, r.instructions, r.flops, r.bytes, r.baseline); 
+	}
+	bool ok = ferror(out) == 0; 
+	if (fclose(out) != 0 || !ok) ERROR("could not write " << name); 
+}
+
+map<string, double> BenchReadBaseline(const string& name) {
+	ifstream in(name); 
+	if (!in) ERROR("could not open baseline " << name); 
+	map<string, double> base; 
+	string line; 
+	const string id_key = "\"id\": \"", median_key = "\"median\": "; 
+	while (getline(in, line)) {
+		size_t id = line.find(id_key); 
+		size_t median = line.find(median_key); 
+		if (id == string::npos || median == string::npos) continue; 
+		id += id_key.size(); 
+		base[line.substr(id, line.find('"', id) - id)] = atof(line.c_str() + median + median_key.size()); 
+	}
+	return base; 
+}
+
+} // end namespace fem 
\ No newline at end of file
@@ -0,0 +1,130 @@
+#pragma once 
+
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+#include "FEM.hpp"
+
+namespace fem 
+{
+
+/// default number of untimed calls before a case is measured 
+#define BENCH_WARMUP 2
+/// default number of timed repetitions of a case 
+#define BENCH_REPS 10
+/// each repetition calls the kernel often enough to run at least this many seconds 
+#define BENCH_MIN_TIME 1e-3
+/// default relative slow down against the baseline reported as a regression 
+#define BENCH_TOLERANCE 0.1
+
+/// one point of a benchmark's sweep 
+struct BenchParams {
+	/// problem size (vector length, matrix size, or elements per side of a 2D mesh) 
+	int n; 
+	/// FEM order (0 if the benchmark has none) 
+	int order; 
+	/// element type (QUAD or HEX, LINE if the benchmark has none) 
+	GmshElType type; 
+	/// kernel variant ("" if the benchmark has one) 
+	std::string variant; 
+}; 
+
+/// the kernel of one case and the work it does per call 
+struct BenchKernel {
+	/// the timed call. Captures whatever state setup built 
+	std::function<void()> run; 
+	/// floating point operations per call (0 if not meaningful) 
+	double flops; 
+	/// bytes moved per call (0 if not meaningful) 
+	double bytes; 
+}; 
+
+/// a parameterized benchmark 
+/** every combination of sizes, orders, types, and variants is one case. setup is
+	called once per case outside the timed region */ 
+struct Benchmark {
+	/// name 
+	std::string name; 
+	/// build the state for a case and return its kernel 
+	std::function<BenchKernel(const BenchParams&)> setup; 
+	/// sizes to sweep 
+	std::vector<int> sizes; 
+	/// orders to sweep 
+	std::vector<int> orders; 
+	/// element types to sweep 
+	std::vector<GmshElType> types; 
+	/// variants to sweep 
+	std::vector<std::string> variants; 
+}; 
+
+/// statistics of one measured case 
+struct BenchResult {
+	/// benchmark name 
+	std::string name; 
+	/// parameters 
+	BenchParams params; 
+	/// unique id of the case: name and parameters 
+	std::string id; 
+	/// timed repetitions 
+	int reps; 
+	/// kernel calls per repetition 
+	int inner; 
+	/// seconds per call: fastest, median, mean, standard deviation, and slowest repetition 
+	double min, median, mean, stddev, max; 
+	/// time stamp ticks (ch_ticks) per call, median repetition 
+	double ticks; 
+	/// hardware cycles and instructions per call (0 if unavailable) 
+	double cycles, instructions; 
+	/// work per call 
+	double flops, bytes; 
+	/// median of the baseline (0 if the case is not in it) 
+	double baseline; 
+}; 
+
+/// return every registered benchmark 
+std::vector<Benchmark>& BenchRegistry(); 
+
+/// adds a benchmark to the registry during static initialization 
+struct BenchRegistrar {
+	/// register b 
+	BenchRegistrar(const Benchmark& b) {BenchRegistry().push_back(b); }
+}; 
+
+/// options of a benchmark run 
+struct BenchOptions {
+	/// only run benchmarks whose name contains this 
+	std::string filter; 
+	/// untimed calls per case 
+	int warmup = BENCH_WARMUP; 
+	/// timed repetitions per case 
+	int reps = BENCH_REPS; 
+	/// minimum seconds per repetition 
+	double min_time = BENCH_MIN_TIME; 
+	/// run only the first size and order of each sweep (for simulators) 
+	bool quick = false; 
+	/// write results as JSON to this file ("" for none) 
+	std::string json; 
+	/// write results as CSV to this file ("" for none) 
+	std::string csv; 
+	/// compare against the JSON results in this file ("" for none) 
+	std::string baseline; 
+	/// relative slow down reported as a regression 
+	double tolerance = BENCH_TOLERANCE; 
+}; 
+
+/// return the id of a case 
+std::string BenchID(const std::string& name, const BenchParams& p); 
+/// measure one case 
+BenchResult BenchRun(const Benchmark& b, const BenchParams& p, const BenchOptions& opt); 
+/// run every selected case, print a table, and write the requested files 
+/** \returns the number of cases slower than the baseline by more than the tolerance */ 
+int BenchRunAll(const BenchOptions& opt, std::ostream& out=std::cout); 
+/// write results as JSON, one result per line 
+void BenchWriteJSON(const std::string& name, const std::vector<BenchResult>& results); 
+/// write results as CSV 
+void BenchWriteCSV(const std::string& name, const std::vector<BenchResult>& results); 
+/// read the median of each case id from results written by BenchWriteJSON 
+std::map<std::string, double> BenchReadBaseline(const std::string& name); 
+
+} // end namespace fem 
\ No newline at end of file
@@ -0,0 +1,131 @@
+#include "Bench.hpp"
+#include <memory>
+
+using namespace std; 
+using namespace fem; 
+
+// sink for reductions so the compiler cannot drop them 
+static volatile double sink; 
+
+// a mesh and order p space on it 
+struct Discretization {
+	// quads: n x n elements. hexes: about n^2 elements in a cube 
+	Discretization(int n, int p, GmshElType type) {
+		if (type == HEX) {
+			int m = std::max(1, (int)round(pow(n, 2./3))); 
+			mesh = make_shared<CubeMesh>(Array<int>{m, m, m}); 
+		} else {
+			mesh = make_shared<SquareMesh>(n, n, Point{0,0}, Point{1,1}); 
+		}
+		space.reset(new LagrangeSpace(*mesh, p)); 
+	}
+	// shared so the derived mesh is destroyed (Mesh has no virtual destructor) 
+	shared_ptr<Mesh> mesh; 
+	unique_ptr<LagrangeSpace> space; 
+}; 
+
+// flops and bytes of one FEMatrix::Mult 
+static void FEMatrixWork(const FEMatrix& A, double& flops, double& bytes) {
+	flops = bytes = 0; 
+	for (int e=0; e<A.GetNumElements(); e++) {
+		int n = A.GetElSize(e); 
+		flops += 2.*n*n; 
+		bytes += 8.*((A.IsPacked()) ? n*(n+1)/2 : n*n) + 4.*n + 16.*n; 
+	}
+}
+
+static BenchRegistrar vector_ops({"vector", [](const BenchParams& p) {
+	auto a = make_shared<Vector>(p.n, 1.), b = make_shared<Vector>(p.n, 2.), c = make_shared<Vector>(p.n); 
+	double n = p.n; 
+	if (p.variant == "add") return BenchKernel{[=]{Add(*a, *b, *c); }, n, 24*n}; 
+	if (p.variant == "dot") return BenchKernel{[=]{sink = a->Dot(*b); }, 2*n, 16*n}; 
+	if (p.variant == "scale") return BenchKernel{[=]{*c *= 1.000001; }, n, 16*n}; 
+	return BenchKernel{[=]{*c = *a; }, 0, 16*n}; 
+}, {1 << 10, 1 << 14, 1 << 18, 1 << 21}, {}, {}, {"add", "dot", "scale", "copy"}}); 
+
+static BenchRegistrar matrix_ops({"matrix", [](const BenchParams& p) {
+	auto A = make_shared<Matrix>(p.n), B = make_shared<Matrix>(p.n), C = make_shared<Matrix>(p.n); 
+	auto x = make_shared<Vector>(p.n, 1.), y = make_shared<Vector>(p.n); 
+	for (int i=0; i<p.n; i++) {
+		for (int j=0; j<p.n; j++) {
+			(*A)(i,j) = 1./(i+j+1); 
+			(*B)(i,j) = i - j; 
+		}
+	}
+	double n = p.n; 
+	if (p.variant == "matvec") return BenchKernel{[=]{A->Mult(*x, *y); }, 2*n*n, 8*n*n + 16*n}; 
+	return BenchKernel{[=]{A->Mult(*B, *C); }, 2*n*n*n, 24*n*n}; 
+}, {4, 9, 16, 32, 64}, {}, {}, {"matvec", "matmult"}}); 
+
+// the only sizes Matrix::Inverse supports 
+static BenchRegistrar matrix_inverse({"matrix inverse", [](const BenchParams& p) {
+	auto A = make_shared<Matrix>(p.n), inv = make_shared<Matrix>(p.n); 
+	*A = 1.; 
+	for (int i=0; i<p.n; i++) (*A)(i,i) = p.n + 1; 
+	return BenchKernel{[=]{A->Inverse(*inv); }, 0, 16.*p.n*p.n}; 
+}, {2, 3}}); 
+
+static BenchRegistrar fematrix_mult({"fematrix mult", [](const BenchParams& p) {
+	auto d = make_shared<Discretization>(p.n, p.order, p.type); 
+	auto A = make_shared<FEMatrix>(d->space.get()); 
+	A->AddIntegrator(new WeakDiffusionIntegrator); 
+	if (p.variant == "dense" && A->IsPacked()) A->Unpack(); 
+	auto x = make_shared<Vector>(d->space->GetVSize(), 1.), b = make_shared<Vector>(d->space->GetVSize()); 
+	BenchKernel k; 
+	FEMatrixWork(*A, k.flops, k.bytes); 
+	k.run = [=]{A->Mult(*x, *b); }; 
+	return k; 
+}, {16, 32, 64}, {1, 2, 3}, {QUAD, HEX}, {"packed", "dense"}}); 
+
+static BenchRegistrar sparse_mult({"sparse mult", [](const BenchParams& p) {
+	auto d = make_shared<Discretization>(p.n, p.order, p.type); 
+	auto A = make_shared<LHS>(d->space.get()); 
+	A->AddIntegrator(new WeakDiffusionIntegrator); 
+	auto x = make_shared<Vector>(d->space->GetVSize(), 1.), b = make_shared<Vector>(d->space->GetVSize()); 
+	double nnz = A->GetNNZ(), n = x->GetSize(); 
+	return BenchKernel{[=]{A->Mult(*x, *b); }, 2*nnz, 12*nnz + 24*n}; 
+}, {16, 32, 64}, {1, 2, 3}, {QUAD, HEX}}); 
+
+static BenchRegistrar calc_shape({"calc shape", [](const BenchParams& p) {
+	auto d = make_shared<Discretization>(1, p.order, p.type); 
+	ElementHandle el = d->space->GetElView(0); 
+	int nb = el->GetNumNodes(); 
+	auto shape = make_shared<Vector>(nb); 
+	auto gshape = make_shared<Matrix>(nb, el->GetDim()); 
+	Point x = {.3, .4, .5}; 
+	if (p.variant == "grad") {
+		return BenchKernel{[d, el, x, gshape]{el->CalcGradShape(x, *gshape); }, 0, 8.*nb*el->GetDim()}; 
+	}
+	return BenchKernel{[d, el, x, shape]{el->CalcShape(x, *shape); }, 0, 8.*nb}; 
+}, {}, {1, 2, 3, 4}, {QUAD, HEX}, {"shape", "grad"}}); 
+
+static BenchRegistrar assembly({"assembly", [](const BenchParams& p) {
+	auto d = make_shared<Discretization>(p.n, p.order, p.type); 
+	return BenchKernel{[=]{
+		FEMatrix A(d->space.get()); 
+		if (p.variant == "mass") A.AddIntegrator(new MassIntegrator); 
+		else A.AddIntegrator(new WeakDiffusionIntegrator); 
+	}, 0, 0}; 
+}, {16, 32}, {1, 2, 3}, {QUAD, HEX}, {"diffusion", "mass"}}); 
+
+static BenchRegistrar cg_solve({"cg solve", [](const BenchParams& p) {
+	auto d = make_shared<Discretization>(p.n, p.order, p.type); 
+	auto source = make_shared<ConstantCoefficient>(1.); 
+	auto rhs = make_shared<RHS>(d->space.get()); 
+	rhs->AddIntegrator(new DomainIntegrator(source.get())); 
+	shared_ptr<Operator> A; 
+	if (p.variant == "sparse") {
+		auto lhs = make_shared<LHS>(d->space.get()); 
+		lhs->AddIntegrator(new WeakDiffusionIntegrator); 
+		lhs->ApplyDirichletBoundary(*rhs, 0.); 
+		A = lhs; 
+	} else {
+		auto lhs = make_shared<FEMatrix>(d->space.get()); 
+		lhs->AddIntegrator(new WeakDiffusionIntegrator); 
+		lhs->ApplyDirichletBoundary(*rhs, 0.); 
+		A = lhs; 
+	}
+	auto cg = make_shared<CG>(A.get(), 1e-8, 10000); 
+	auto x = make_shared<Vector>(d->space->GetVSize()); 
+	return BenchKernel{[d, source, rhs, A, cg, x]{cg->Solve(*rhs, *x); }, 0, 0}; 
+}, {16, 32}, {1, 2}, {QUAD}, {"fematrix", "sparse"}}); 
\ No newline at end of file
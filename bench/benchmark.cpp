@@ -0,0 +1,53 @@
+#include "Bench.hpp"
+
+using namespace std; 
+using namespace fem; 
+
+// print the command line options 
+void Usage(const char* name) {
+	cout << "usage: " << name << " [options]\n"
+		<< "\t--list               print the cases and exit\n"
+		<< "\t--filter <s>         run benchmarks whose name contains s\n"
+		<< "\t--quick              only the first size and order of each sweep\n"
+		<< "\t--warmup <n>         untimed calls per case (" << BENCH_WARMUP << ")\n"
+		<< "\t--reps <n>           timed repetitions per case (" << BENCH_REPS << ")\n"
+		<< "\t--min-time <s>       minimum seconds per repetition (" << BENCH_MIN_TIME << ")\n"
+		<< "\t--json <file>        write the results as JSON\n"
+		<< "\t--csv <file>         write the results as CSV\n"
+		<< "\t--baseline <file>    compare against JSON results from an earlier run\n"
+		<< "\t--tolerance <x>      relative slow down reported as a regression (" 
+			<< BENCH_TOLERANCE << ")\n"; 
+}
+
+int main(int argc, char* argv[]) {
+	BenchOptions opt; 
+	bool list = false; 
+	for (int i=1; i<argc; i++) {
+		string arg = argv[i]; 
+		bool has_value = i+1 < argc; 
+		if (arg == "--list") list = true; 
+		else if (arg == "--quick") opt.quick = true; 
+		else if (arg == "--filter" && has_value) opt.filter = argv[++i]; 
+		else if (arg == "--warmup" && has_value) opt.warmup = atoi(argv[++i]); 
+		else if (arg == "--reps" && has_value) opt.reps = atoi(argv[++i]); 
+		else if (arg == "--min-time" && has_value) opt.min_time = atof(argv[++i]); 
+		else if (arg == "--json" && has_value) opt.json = argv[++i]; 
+		else if (arg == "--csv" && has_value) opt.csv = argv[++i]; 
+		else if (arg == "--baseline" && has_value) opt.baseline = argv[++i]; 
+		else if (arg == "--tolerance" && has_value) opt.tolerance = atof(argv[++i]); 
+		else {
+			Usage(argv[0]); 
+			return 2; 
+		}
+	}
+
+	if (list) {
+		for (const Benchmark& b : BenchRegistry()) {
+			if (b.name.find(opt.filter) != string::npos) cout << b.name << endl; 
+		}
+		return 0; 
+	}
+
+	cout << "counters: " << HWCounter::Backend() << endl; 
+	return (BenchRunAll(opt) > 0) ? 1 : 0; 
+}
\ No newline at end of file
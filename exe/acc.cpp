@@ -36,7 +36,6 @@ void solve(int nref, int order, double& L2, uint64_t& cycles) {
 
 	// apply the boundary conditions
 	lhs.ApplyDirichletBoundary(rhs, 0.);
-	lhs.ConvertToBatch();
 
 	GridFunction x(&h1); 
 	CG cg(&lhs, 1e-10, 1000); 
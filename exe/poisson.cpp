@@ -50,7 +50,6 @@ void solve(int nref, int order) {
 
 	// apply the boundary conditions
 	lhs.ApplyDirichletBoundary(rhs, 0.);
-	lhs.ConvertToBatch();
 	hwc3.Read(); 
 	hwc3.PrintStats("assembly"); 
 
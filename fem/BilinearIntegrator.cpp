@@ -1,60 +1,271 @@
 #include "BilinearIntegrator.hpp"
+#include "LagrangeBasis.hpp"
+#include "FESpace.hpp"
+#include "Opt.hpp"
+#include "Snapshot.hpp"
+#include <typeinfo>
 
 using namespace std; 
 
 namespace fem 
 {
 
+void BatchGramAdd(int N, int B, int D, bool packed, const double* a, 
+	const double* g, double* mats, int bstride, int kstride) {
+	CH_TIMERS("batch gram add"); 
+	int k = 0; 
+	for (int i=0; i<N; i++) {
+		for (int j=(packed ? i : 0); j<N; j++, k++) {
+			double* m = mats + k*kstride; 
+			for (int d=0; d<D; d++) {
+				const double* ai = a + (i*D+d)*B; 
+				const double* gj = g + (j*D+d)*B; 
+				if (bstride == 1) {
+					// unit stride across elements 
+					for (int b=0; b<B; b++) {
+						m[b] += ai[b]*gj[b]; 
+					}
+				} else {
+					for (int b=0; b<B; b++) {
+						m[b*bstride] += ai[b]*gj[b]; 
+					}
+				}
+			}
+		}
+	}
+}
+
+bool BilinearIntegrator::Fingerprint(uint64_t& h, const Coefficient* c) const {
+	const char* type = typeid(*this).name(); 
+	h = HashBytes(type, strlen(type), h); 
+	return !c || c->Fingerprint(h); 
+}
+
+bool BilinearIntegrator::Fingerprint(uint64_t& h, const VectorCoefficient* vc) const {
+	const char* type = typeid(*this).name(); 
+	h = HashBytes(type, strlen(type), h); 
+	return !vc || vc->Fingerprint(h); 
+}
+
+void BilinearIntegrator::GatherBatchGeometry(const FESpace& space, int e0, int B, 
+	const ShapeTable& table, Coefficient* c, bool jinv) {
+	CH_TIMERS("gather batch geometry"); 
+	const Quadrature* quad = table.GetQuadrature(); 
+	int nq = quad->NumPoints(); 
+	ElementHandle view; 
+	int dim = space.GetEl(e0, view).GetDim(); 
+	_bw.Resize(nq*B); 
+	if (jinv) _bJinv.Resize(nq*dim*dim*B); 
+	_cv.Resize(nq); 
+	if (!c) _cv = 1.; 
+	for (int b=0; b<B; b++) {
+		ElTrans& trans = space.GetEl(e0+b, view).GetTrans(); 
+		if (c) c->Eval(trans, table, _cv.GetData()); 
+		for (int q=0; q<nq; q++) {
+			trans.SetX(table, q); 
+			_bw[q*B+b] = quad->Weight(q) * trans.Determinant() * _cv[q]; 
+			if (!jinv) continue; 
+			const double* Jinv = trans.InverseJacobian().GetData(); 
+			for (int k=0; k<dim*dim; k++) {
+				_bJinv[(q*dim*dim+k)*B + b] = Jinv[k]; 
+			}
+		}
+	}
+}
+
+void BilinearIntegrator::ScatterBatch(int S, int B, double* mats) const {
+	for (int b=0; b<B; b++) {
+		for (int k=0; k<S; k++) {
+			mats[b*S+k] += _bacc[k*B+b]; 
+		}
+	}
+}
+
+int BilinearIntegrator::BatchChunk(int S, int B) const {
+	// keep the element fastest accumulator around 2MB 
+	int chunk = (1<<18)/S; 
+	return max(1, min(B, min(chunk, 64))); 
+}
+
 void WeakDiffusionIntegrator::Assemble(Element& el, Matrix& elmat) {
-	CH_TIMERS("weak diffusion assemble"); 
+	CH_TIMERS_FINE("weak diffusion assemble"); 
 	Quadrature* quad = QRules.Get(el.GetType(), el.GetOrder()+1, INTEGRATION_TYPE); 
+	const ShapeTable& table = STables.Get(el, quad); 
 	ElTrans& trans = el.GetTrans();
 	elmat.SetSize(el.GetNumNodes()); 
 	elmat = 0; 
 	_pgshape = 0; 
 	_tmp = 0; 
-	double c = 1.; 
+	_cv.Resize(quad->NumPoints()); 
+	if (_c) _c->Eval(trans, table, _cv.GetData()); 
+	else _cv = 1.; 
+	// order specialized kernel accumulates the upper triangle only 
+	const LagrangeKernels* k = el.GetKernels(); 
+	if (k && k->dim != el.GetMeshDim()) k = NULL; 
 	for (int n=0; n<quad->NumPoints(); n++) {
-		trans.SetX(quad->X(n)); 
+		trans.SetX(table, n); 
 		el.CalcPhysGradShape(trans, _pgshape); 
+		double c = _cv[n]; 
+		if (k) {
+			k->diffusion(quad->Weight(n) * trans.Determinant() * c, 
+				_pgshape.GetData(), elmat.GetData()); 
+			continue; 
+		}
 		_tmp = _pgshape; 
-		if (_c) c = _c->Eval(trans, quad->X(n)); 
 		_tmp *= quad->Weight(n) * trans.Determinant() * c; 
 		_pgshape.AddTransMult(_tmp, elmat); 
 	}
+	if (k) k->symmetrize(elmat.GetData()); 
 	CHECK(elmat.IsSymmetric()); 
 }
 
+bool WeakDiffusionIntegrator::AssembleBatch(const FESpace& space, int e0, int B, 
+	bool packed, double* mats) {
+	CH_TIMERS("weak diffusion assemble batch"); 
+	ElementHandle view; 
+	Element& el = space.GetEl(e0, view); 
+	int D = el.GetDim(); 
+	if (space.GetVDim() != 1 || el.GetMeshDim() != D) return false; 
+	Quadrature* quad = QRules.Get(el.GetType(), el.GetOrder()+1, INTEGRATION_TYPE); 
+	const ShapeTable& table = STables.Get(el, quad); 
+	int N = el.GetNumNodes(); 
+	int S = packed ? N*(N+1)/2 : N*N; 
+	int chunk = BatchChunk(S, B); 
+	for (int c0=0; c0<B; c0+=chunk) {
+		int Bc = min(chunk, B-c0); 
+		GatherBatchGeometry(space, e0+c0, Bc, table, _c, true); 
+		_ba.Resize(N*D*Bc); 
+		_bg.Resize(N*D*Bc); 
+#ifndef RV_ASSEMBLE 
+		_bacc.Resize(S*Bc); 
+		_bacc = 0.; 
+#endif
+		for (int q=0; q<quad->NumPoints(); q++) {
+			const double* g = table.GradShape(q); 
+			const double* Jinv = &_bJinv[q*D*D*Bc]; 
+			const double* w = &_bw[q*Bc]; 
+			// physical gradients of every element: pg(n,d) = sum_k Jinv(d,k) g(k,n) 
+			for (int n=0; n<N; n++) {
+				for (int d=0; d<D; d++) {
+					double* pg = &_bg[(n*D+d)*Bc]; 
+					double* a = &_ba[(n*D+d)*Bc]; 
+					for (int b=0; b<Bc; b++) {
+						pg[b] = 0.; 
+					}
+					for (int k=0; k<D; k++) {
+						double gk = g[k*N+n]; 
+						const double* J = Jinv + (d*D+k)*Bc; 
+						for (int b=0; b<Bc; b++) {
+							pg[b] += J[b]*gk; 
+						}
+					}
+					for (int b=0; b<Bc; b++) {
+						a[b] = w[b]*pg[b]; 
+					}
+				}
+			}
+#ifdef RV_ASSEMBLE 
+			BatchGramAdd_RV(N, Bc, D, packed, _ba.GetData(), _bg.GetData(), mats + c0*S); 
+#else
+			BatchGramAdd(N, Bc, D, packed, _ba.GetData(), _bg.GetData(), 
+				_bacc.GetData(), 1, Bc); 
+#endif
+		}
+#ifndef RV_ASSEMBLE 
+		ScatterBatch(S, Bc, mats + c0*S); 
+#endif
+	}
+	return true; 
+}
+
 void MassIntegrator::Assemble(Element& el, Matrix& elmat) {
-	CH_TIMERS("mass assemble"); 
-	Quadrature* quad = QRules.Get(el.GetType(), INTEGRATION_ORDER, INTEGRATION_TYPE); 
+	CH_TIMERS_FINE("mass assemble"); 
+	Quadrature* quad = QRules.Get(el.GetType(), 
+		std::max(INTEGRATION_ORDER, el.GetOrder()+1), INTEGRATION_TYPE); 
+	const ShapeTable& table = STables.Get(el, quad); 
 	ElTrans& trans = el.GetTrans();
 	elmat.SetSize(el.GetNumNodes()); 
 	elmat = 0; 
-	double c = 1.; 
+	_cv.Resize(quad->NumPoints()); 
+	if (_c) _c->Eval(trans, table, _cv.GetData()); 
+	else _cv = 1.; 
+	const LagrangeKernels* k = el.GetKernels(); 
 	for (int n=0; n<quad->NumPoints(); n++) {
-		trans.SetX(quad->X(n)); 
-		el.CalcShape(quad->X(n), _shape);
-		_shape.OuterProduct(_shape, _op);
-		if (_c) c = _c->Eval(trans, quad->X(n)); 
+		trans.SetX(table, n); 
+		const Vector& shape = trans.Shape(); 
+		double c = _cv[n]; 
+		if (k) {
+			k->mass(c * quad->Weight(n) * trans.Determinant(), 
+				shape.GetData(), elmat.GetData()); 
+			continue; 
+		}
+		shape.OuterProduct(shape, _op); 
 		_op *= c * quad->Weight(n) * trans.Determinant(); 
 		elmat += _op;
 	}
+	if (k) k->symmetrize(elmat.GetData()); 
+}
+
+bool MassIntegrator::AssembleBatch(const FESpace& space, int e0, int B, 
+	bool packed, double* mats) {
+	CH_TIMERS("mass assemble batch"); 
+	ElementHandle view; 
+	Element& el = space.GetEl(e0, view); 
+	if (space.GetVDim() != 1) return false; 
+	Quadrature* quad = QRules.Get(el.GetType(), 
+		std::max(INTEGRATION_ORDER, el.GetOrder()+1), INTEGRATION_TYPE); 
+	const ShapeTable& table = STables.Get(el, quad); 
+	int N = el.GetNumNodes(); 
+	int S = packed ? N*(N+1)/2 : N*N; 
+	int chunk = BatchChunk(S, B); 
+	for (int c0=0; c0<B; c0+=chunk) {
+		int Bc = min(chunk, B-c0); 
+		GatherBatchGeometry(space, e0+c0, Bc, table, _c, false); 
+		_ba.Resize(N*Bc); 
+		_bg.Resize(N*Bc); 
+#ifndef RV_ASSEMBLE 
+		_bacc.Resize(S*Bc); 
+		_bacc = 0.; 
+#endif
+		for (int q=0; q<quad->NumPoints(); q++) {
+			const double* phi = table.Shape(q); 
+			const double* w = &_bw[q*Bc]; 
+			for (int n=0; n<N; n++) {
+				double* a = &_ba[n*Bc]; 
+				double* g = &_bg[n*Bc]; 
+				for (int b=0; b<Bc; b++) {
+					a[b] = w[b]*phi[n]; 
+					g[b] = phi[n]; 
+				}
+			}
+#ifdef RV_ASSEMBLE 
+			BatchGramAdd_RV(N, Bc, 1, packed, _ba.GetData(), _bg.GetData(), mats + c0*S); 
+#else
+			BatchGramAdd(N, Bc, 1, packed, _ba.GetData(), _bg.GetData(), 
+				_bacc.GetData(), 1, Bc); 
+#endif
+		}
+#ifndef RV_ASSEMBLE 
+		ScatterBatch(S, Bc, mats + c0*S); 
+#endif
+	}
+	return true; 
 }
 
 void MassIntegrator::MixedAssemble(Element& trial_fe, Element& test_fe, 
 	Matrix& elmat) {
 	Quadrature* quad = QRules.Get(trial_fe.GetType(), 
 		INTEGRATION_ORDER, INTEGRATION_TYPE); 
+	const ShapeTable& trial_table = STables.Get(trial_fe, quad); 
+	const ShapeTable& test_table = STables.Get(test_fe, quad); 
 	elmat.SetSize(trial_fe.GetNumNodes(), test_fe.GetNumNodes()); 
 	elmat = 0.; 
 	ElTrans& trans = trial_fe.GetTrans(); 
 	double c = 1.; 
 	for (int n=0; n<quad->NumPoints(); n++) {
-		trans.SetX(quad->X(n)); 
-		trial_fe.CalcShape(quad->X(n), _shape);
-		test_fe.CalcShape(quad->X(n), _shape2); 
-		_shape.OuterProduct(_shape2, _op); 
+		trans.SetX(trial_table, n); 
+		test_table.GetShape(n, _shape2); 
+		trans.Shape().OuterProduct(_shape2, _op); 
 		if (_c) c = _c->Eval(trans, quad->X(n)); 
 		_op *= c * quad->Weight(n) * trans.Determinant(); 
 		elmat += _op; 
@@ -63,14 +274,15 @@ void MassIntegrator::MixedAssemble(Element& trial_fe, Element& test_fe,
 
 void MassLumpingIntegrator::Assemble(Element& el, Matrix& elmat) {
 	Quadrature* quad = QRules.Get(el.GetType(), INTEGRATION_ORDER, INTEGRATION_TYPE); 
+	const ShapeTable& table = STables.Get(el, quad); 
 	ElTrans& trans = el.GetTrans(); 
 	elmat.SetSize(el.GetNumNodes()); 
 	elmat = 0; 
 	double c = 1; 
 	for (int n=0; n<quad->NumPoints(); n++) {
-		trans.SetX(quad->X(n)); 
-		el.CalcShape(quad->X(n), _shape);
-		_shape.OuterProduct(_shape, _op);
+		trans.SetX(table, n); 
+		const Vector& shape = trans.Shape(); 
+		shape.OuterProduct(shape, _op); 
 		if (_c) c = _c->Eval(trans, quad->X(n)); 
 		_op *= c * quad->Weight(n) * trans.Determinant(); 
 		elmat += _op;
@@ -88,14 +300,15 @@ void MassLumpingIntegrator::Assemble(Element& el, Matrix& elmat) {
 
 void VectorMassIntegrator::Assemble(Element& el, Matrix& elmat) {
 	Quadrature* quad = QRules.Get(el.GetType(), INTEGRATION_ORDER, INTEGRATION_TYPE); 
+	const ShapeTable& table = STables.Get(el, quad); 
 	elmat.SetSize(el.GetDim() * el.GetNumNodes()); 
 	elmat = 0.; 
 	ElTrans& trans = el.GetTrans(); 
 	double c = 1.; 
 	for (int n=0; n<quad->NumPoints(); n++) {
-		trans.SetX(quad->X(n)); 
-		el.CalcShape(quad->X(n), _shape); 
-		_shape.OuterProduct(_shape, _op); 
+		trans.SetX(table, n); 
+		const Vector& shape = trans.Shape(); 
+		shape.OuterProduct(shape, _op); 
 		if (_c) c = _c->Eval(trans, quad->X(n)); 
 		_op *= c * quad->Weight(n) * trans.Determinant(); 
 		for (int i=0; i<el.GetDim(); i++) {
@@ -106,18 +319,18 @@ void VectorMassIntegrator::Assemble(Element& el, Matrix& elmat) {
 
 void ConvectionIntegrator::Assemble(Element& el, Matrix& elmat) {
 	Quadrature* quad = QRules.Get(el.GetType(), INTEGRATION_ORDER, INTEGRATION_TYPE); 
+	const ShapeTable& table = STables.Get(el, quad); 
 	ElTrans& trans = el.GetTrans(); 
 	elmat.SetSize(el.GetNumNodes()); 
 	_v.SetSize(el.GetMeshDim()); 
 	elmat = 0.; 
 	for (int n=0; n<quad->NumPoints(); n++) {
-		trans.SetX(quad->X(n)); 
-		el.CalcShape(quad->X(n), _shape); 
+		trans.SetX(table, n); 
 		el.CalcPhysGradShape(trans, _pgshape); 
 		_vc->Eval(trans, quad->X(n), _v); 
 		_v.Mult(_pgshape, _tmp); 
 		_tmp *= -quad->Weight(n) * trans.Determinant(); 
-		_tmp.OuterProduct(_shape, _op); 
+		_tmp.OuterProduct(trans.Shape(), _op); 
 		elmat += _op; 
 	}
 }
@@ -125,12 +338,14 @@ void ConvectionIntegrator::Assemble(Element& el, Matrix& elmat) {
 void VectorDivergenceIntegrator::MixedAssemble(Element& trial_fe, Element& test_fe, 
 	Matrix& elmat) {
 	Quadrature* quad = QRules.Get(trial_fe.GetType(), INTEGRATION_ORDER, INTEGRATION_TYPE); 
+	const ShapeTable& trial_table = STables.Get(trial_fe, quad); 
+	const ShapeTable& test_table = STables.Get(test_fe, quad); 
 	elmat.SetSize(test_fe.GetNumNodes(), trial_fe.GetDim()*trial_fe.GetNumNodes()); 
 	elmat = 0.; 
 	ElTrans& trans = trial_fe.GetTrans(); 
 	for (int n=0; n<quad->NumPoints(); n++) {
-		trans.SetX(quad->X(n)); 
-		test_fe.CalcShape(quad->X(n), _shape); 
+		trans.SetX(trial_table, n); 
+		test_table.GetShape(n, _shape); 
 		trial_fe.CalcPhysGradShape(trans, _gshape); 
 		_gshape.GradToDiv(_divshape); 
 		_shape *= trans.Determinant() * quad->Weight(n); 
@@ -5,9 +5,24 @@
 #include "ElTrans.hpp"
 #include "Coefficient.hpp"
 
+#ifdef USE_RISCV 
+// add sum_d a(i,d) g(j,d) to B NxN matrices (packed upper triangles if packed) 
+extern "C" void BatchGramAdd_RV(int N, int B, int D, int packed, 
+	const double* a, const double* g, double* mats); 
+#endif
+
 namespace fem 
 {
 
+class FESpace; 
+
+/// add \f$ \sum_d a_{id} g_{jd} \f$ to each matrix in a batch of B elements 
+/** a and g are element fastest: entry (n,d) of element b is at [(n*D+d)*B + b]. 
+	Entry k of matrix b (row major, upper triangle only if packed) is at 
+	mats[b*bstride + k*kstride] */ 
+void BatchGramAdd(int N, int B, int D, bool packed, const double* a, 
+	const double* g, double* mats, int bstride, int kstride); 
+
 /// represent an integrator for the LHS 
 class BilinearIntegrator {
 public:
@@ -36,7 +51,46 @@ public:
 		FaceTransformations& fts, Matrix& elmat) {
 		ERROR("not implemented"); 
 	}
+	/// true if Assemble always produces symmetric matrices 
+	virtual bool IsSymmetric() const {return false; }
+	/// assemble elements [e0, e0+B) of space directly into contiguous batch storage 
+	/** the elements must share type, order and size. Element e0+b's matrix starts at 
+		mats + b*stride where stride is N*N, or N*(N+1)/2 if packed (upper triangle). 
+		The results are added to the stored values. Returns false if the integrator 
+		has no batched version, in which case the caller uses Assemble instead */ 
+	virtual bool AssembleBatch(const FESpace& space, int e0, int B, bool packed, 
+		double* mats) {return false; }
+	/// fold the integrator type and parameters into the running hash h 
+	/** two integrators with the same fingerprint must assemble the same matrices. Returns 
+		false if the integrator cannot be hashed exactly (the default), which turns caching off */ 
+	virtual bool Fingerprint(uint64_t& h) const {return false; }
 protected:
+	/// fold the integrator type and its coefficient (if any) into h 
+	/** \returns false if the coefficient cannot be hashed exactly */ 
+	bool Fingerprint(uint64_t& h, const Coefficient* c) const; 
+	/// fold the integrator type and its vector coefficient (if any) into h 
+	bool Fingerprint(uint64_t& h, const VectorCoefficient* vc) const; 
+	/// store quadrature weight * determinant * coefficient for B elements at every point of table 
+	/** _bw[q*B+b] holds the weights and if jinv is true 
+		_bJinv[(q*dim*dim + k)*B + b] holds component k of the inverse jacobian */ 
+	void GatherBatchGeometry(const FESpace& space, int e0, int B, 
+		const ShapeTable& table, Coefficient* c, bool jinv); 
+	/// add the chunk's accumulated matrices in _bacc to the batch storage 
+	void ScatterBatch(int S, int B, double* mats) const; 
+	/// number of elements processed together so the scratch space stays bounded 
+	int BatchChunk(int S, int B) const; 
+	/// batched weights 
+	Array<double> _bw; 
+	/// batched inverse jacobians 
+	Array<double> _bJinv; 
+	/// batched left operand of the gram product 
+	Array<double> _ba; 
+	/// batched right operand of the gram product 
+	Array<double> _bg; 
+	/// element fastest accumulator for the host kernel 
+	Array<double> _bacc; 
+	/// coefficient values at the quadrature points of one element 
+	Array<double> _cv; 
 };
 
 /// integrate \f$ \int \nabla B_i \cdot \nabla B_j dV \f$ 
@@ -46,6 +100,12 @@ public:
 	WeakDiffusionIntegrator(Coefficient* c=NULL) {_c = c; }
 	/// assemble 
 	void Assemble(Element& el, Matrix& elmat); 
+	/// assemble a range of elements vectorized across elements 
+	bool AssembleBatch(const FESpace& space, int e0, int B, bool packed, double* mats); 
+	/// produces symmetric matrices 
+	bool IsSymmetric() const {return true; }
+	/// fold the type and coefficient into the running hash h 
+	bool Fingerprint(uint64_t& h) const {return BilinearIntegrator::Fingerprint(h, _c); }
 private:
 	/// store grad shape matrix in physical space 
 	Matrix _pgshape; 
@@ -62,12 +122,16 @@ public:
 	MassIntegrator(Coefficient* c=NULL) {_c = c; }
 	/// assemble 
 	void Assemble(Element& el, Matrix& elmat); 
+	/// assemble a range of elements vectorized across elements 
+	bool AssembleBatch(const FESpace& space, int e0, int B, bool packed, double* mats); 
+	/// produces symmetric matrices 
+	bool IsSymmetric() const {return true; }
 	/// assemble mixed system 
 	void MixedAssemble(Element& trial, Element& test, 
 		Matrix& elmat); 
+	/// fold the type and coefficient into the running hash h 
+	bool Fingerprint(uint64_t& h) const {return BilinearIntegrator::Fingerprint(h, _c); }
 private:
-	/// store shape functions 
-	Vector _shape; 
 	/// store shape function evaluation in mixed case 
 	Vector _shape2; 
 	/// store outer product 
@@ -83,9 +147,11 @@ public:
 	MassLumpingIntegrator(Coefficient* c=NULL) {_c = c; }
 	/// assemble 
 	void Assemble(Element& el, Matrix& elmat); 
+	/// produces symmetric matrices 
+	bool IsSymmetric() const {return true; }
+	/// fold the type and coefficient into the running hash h 
+	bool Fingerprint(uint64_t& h) const {return BilinearIntegrator::Fingerprint(h, _c); }
 private:
-	/// store shape functions 
-	Vector _shape; 
 	/// store outer product 
 	Matrix _op; 
 	/// store the coefficient 
@@ -98,9 +164,11 @@ public:
 	VectorMassIntegrator(Coefficient* c=NULL) {_c = c; }
 	/// assemble 
 	void Assemble(Element& el, Matrix& elmat); 
+	/// produces symmetric matrices 
+	bool IsSymmetric() const {return true; }
+	/// fold the type and coefficient into the running hash h 
+	bool Fingerprint(uint64_t& h) const {return BilinearIntegrator::Fingerprint(h, _c); }
 private:
-	/// store shape functions 
-	Vector _shape; 
 	/// store outer product 
 	Matrix _op; 
 	/// constant multiplier 
@@ -113,13 +181,13 @@ public:
 	ConvectionIntegrator(const VectorCoefficient* vc) {_vc = vc; }
 	/// assemble 
 	void Assemble(Element& el, Matrix& elmat); 
+	/// fold the type and coefficient into the running hash h 
+	bool Fingerprint(uint64_t& h) const {return BilinearIntegrator::Fingerprint(h, _vc); }
 private:
 	/// store coefficient 
 	const VectorCoefficient* _vc; 
 	/// store grad shape matrix 
 	Matrix _pgshape; 
-	/// store shape evaluation 
-	Vector _shape; 
 	/// store function evaluation 
 	Vector _v; 
 	/// intermediate matrix 
@@ -137,6 +205,10 @@ public:
 	// void Assemble(Element& el, Matrix& elmat); 
 	/// assemble mixed system 
 	void MixedAssemble(Element& trial, Element& test, Matrix& elmat); 
+	/// fold the type into the running hash h 
+	bool Fingerprint(uint64_t& h) const {
+		return BilinearIntegrator::Fingerprint(h, (const Coefficient*)NULL); 
+	}
 private:
 	/// store trial shape eval 
 	Vector _shape; 
@@ -163,6 +235,8 @@ public:
 	/// assemble face matrix 
 	void AssembleFaceMatrix(Element* e, Element* ep, 
 		FaceTransformations& fts, Matrix& elmat); 
+	/// fold the type and coefficient into the running hash h 
+	bool Fingerprint(uint64_t& h) const {return BilinearIntegrator::Fingerprint(h, _vc); }
 private:
 	/// velocity vector coefficient 
 	const VectorCoefficient* _vc; 
@@ -0,0 +1,226 @@
+#include "Checkpoint.hpp"
+#include "Snapshot.hpp"
+#include "MappedFile.hpp"
+#include "FESpace.hpp"
+#include <cstdio>
+#include <cstddef>
+#include <chrono>
+#ifndef USE_RISCV 
+#include <unistd.h>
+#endif
+
+using namespace std; 
+
+namespace fem 
+{
+
+/// identifies checkpoint files 
+static const char CHECKPOINT_MAGIC[8] = {'R','V','F','E','M','C','K','P'}; 
+
+/// first bytes of every checkpoint, followed by one CheckpointRecord per array 
+struct CheckpointHeader {
+	/// CHECKPOINT_MAGIC 
+	char magic[8]; 
+	/// CHECKPOINT_VERSION 
+	uint64_t version; 
+	/// Checkpoint::GetKey of the writer 
+	uint64_t key; 
+	/// number of arrays 
+	int64_t count; 
+	/// time step number 
+	int64_t step; 
+	/// iteration 
+	int64_t iter; 
+	/// simulation time 
+	double time; 
+	/// time step size 
+	double dt; 
+	/// checksum of the header block with this field zeroed 
+	uint64_t checksum; 
+}; 
+
+/// location and checksum of one array 
+struct CheckpointRecord {
+	/// array name (NUL padded) 
+	char name[16]; 
+	/// start of the array in the file 
+	int64_t offset; 
+	/// number of doubles 
+	int64_t count; 
+	/// checksum of the array 
+	uint64_t checksum; 
+}; 
+
+/// round bytes up to a multiple of CHECKPOINT_ALIGN 
+static inline size_t Align(size_t bytes) {
+	return (bytes + CHECKPOINT_ALIGN - 1)/CHECKPOINT_ALIGN*CHECKPOINT_ALIGN; 
+}
+
+/// checksum of size bytes 
+/** four interleaved FNV-1a lanes so the multiplies overlap and the checksum keeps up 
+	with memory rather than with the multiplier's latency */ 
+static uint64_t Checksum(const void* data, size_t size) {
+	const char* p = (const char*)data; 
+	uint64_t h[4] = {14695981039346656037ull, 1469598103934665603ull, 
+		9650029242287828579ull, 4928396040233212313ull}; 
+	size_t nblocks = size/32; 
+	for (size_t b=0; b<nblocks; b++) {
+		uint64_t w[4]; 
+		memcpy(w, p + 32*b, 32); 
+		for (int l=0; l<4; l++) {
+			h[l] = (h[l] ^ w[l]) * 1099511628211ull; 
+		}
+	}
+	uint64_t r = HashBytes(p + 32*nblocks, size - 32*nblocks, h[0]); 
+	r = HashBytes(h + 1, 3*sizeof(uint64_t), r); 
+	return HashBytes(&size, sizeof(size), r); 
+}
+
+/// checksum of a header block 
+static uint64_t HeaderChecksum(const char* block, size_t bytes) {
+	vector<char> copy(block, block + bytes); 
+	memset(&copy[offsetof(CheckpointHeader, checksum)], 0, sizeof(uint64_t)); 
+	return Checksum(copy.data(), bytes); 
+}
+
+Checkpoint::Checkpoint(const string& name) : _name(name) {
+	_sync = false; 
+	_bytes = 0; 
+	_write_time = 0; 
+}
+
+void Checkpoint::Add(GridFunction& gf, const string& name) {
+	Register(gf, name, gf.GetSpace()->Hash()); 
+}
+
+void Checkpoint::Add(Vector& v, const string& name) {
+	Register(v, name, 0); 
+}
+
+void Checkpoint::Register(Vector& v, const string& name, uint64_t fp) {
+	CHECKMSG(name.size() < 16, "checkpoint array name " << name << " is too long"); 
+	CHECKMSG(!_names.In(name), "checkpoint already has an array called " << name); 
+	_vecs.Append(&v); 
+	_names.Append(name); 
+	_fps.Append(fp); 
+}
+
+uint64_t Checkpoint::GetKey() const {
+	uint64_t h = HashBytes(CHECKPOINT_MAGIC, 8); 
+	for (int i=0; i<_vecs.GetSize(); i++) {
+		int64_t size = _vecs[i]->GetSize(); 
+		h = HashBytes(_names[i].c_str(), _names[i].size() + 1, h); 
+		h = HashBytes(&size, sizeof(size), h); 
+		h = HashBytes(&_fps[i], sizeof(uint64_t), h); 
+	}
+	return h; 
+}
+
+void Checkpoint::Write(const CheckpointState& state) {
+	CH_TIMERS_COARSE("write checkpoint"); 
+	auto start = chrono::steady_clock::now(); 
+	int n = _vecs.GetSize(); 
+	size_t head = Align(sizeof(CheckpointHeader) + n*sizeof(CheckpointRecord)); 
+
+	// the table needs every checksum so the arrays are hashed before anything is written 
+	vector<CheckpointRecord> table(n); 
+	int64_t offset = head; 
+	for (int i=0; i<n; i++) {
+		CheckpointRecord& rec = table[i]; 
+		memset(rec.name, 0, sizeof(rec.name)); 
+		memcpy(rec.name, _names[i].c_str(), _names[i].size()); 
+		rec.offset = offset; 
+		rec.count = _vecs[i]->GetSize(); 
+		rec.checksum = Checksum(_vecs[i]->GetData(), sizeof(double)*rec.count); 
+		offset += Align(sizeof(double)*rec.count); 
+	}
+	CheckpointHeader header; 
+	memset(&header, 0, sizeof(header)); 
+	memcpy(header.magic, CHECKPOINT_MAGIC, 8); 
+	header.version = CHECKPOINT_VERSION; 
+	header.key = GetKey(); 
+	header.count = n; 
+	header.step = state.step; 
+	header.iter = state.iter; 
+	header.time = state.time; 
+	header.dt = state.dt; 
+	vector<char> block(head, 0); 
+	memcpy(block.data(), &header, sizeof(header)); 
+	if (n) memcpy(&block[sizeof(header)], table.data(), n*sizeof(CheckpointRecord)); 
+	header.checksum = HeaderChecksum(block.data(), head); 
+	memcpy(block.data(), &header, sizeof(header)); 
+
+	// unbuffered: every array goes to the kernel in a single write 
+	string tmp = _name + ".tmp"; 
+	FILE* out = fopen(tmp.c_str(), "wb"); 
+	if (!out) ERROR("could not open checkpoint " << tmp); 
+	setvbuf(out, NULL, _IONBF, 0); 
+	static const char pad[CHECKPOINT_ALIGN] = {0}; 
+	fwrite(block.data(), 1, head, out); 
+	for (int i=0; i<n; i++) {
+		size_t bytes = sizeof(double)*table[i].count; 
+		if (bytes) fwrite(_vecs[i]->GetData(), 1, bytes, out); 
+		if (Align(bytes) > bytes) fwrite(pad, 1, Align(bytes) - bytes, out); 
+	}
+	bool ok = ferror(out) == 0 && fflush(out) == 0; 
+#ifndef USE_RISCV 
+	if (_sync) ok = ok && fsync(fileno(out)) == 0; 
+#endif
+	ok = (fclose(out) == 0) && ok; 
+	if (!ok || rename(tmp.c_str(), _name.c_str()) != 0) {
+		remove(tmp.c_str()); 
+		ERROR("could not write checkpoint " << _name); 
+	}
+	_bytes = offset; 
+	_write_time = chrono::duration<double>(chrono::steady_clock::now() - start).count(); 
+}
+
+bool Checkpoint::Read(CheckpointState& state) {
+	CH_TIMERS_COARSE("read checkpoint"); 
+	MappedFile file(_name); 
+	if (!file.Good() || file.GetSize() < sizeof(CheckpointHeader)) return false; 
+	const char* p = file.GetData(); 
+	size_t size = file.GetSize(); 
+	CheckpointHeader header; 
+	memcpy(&header, p, sizeof(header)); 
+	if (memcmp(header.magic, CHECKPOINT_MAGIC, 8) != 0 || header.version != CHECKPOINT_VERSION) {
+		WARNING(_name << " is not a version " << CHECKPOINT_VERSION << " checkpoint"); 
+		return false; 
+	}
+	if (header.key != GetKey() || header.count != _vecs.GetSize()) {
+		WARNING("checkpoint " << _name << " was written for different variables or spaces"); 
+		return false; 
+	}
+	int n = _vecs.GetSize(); 
+	size_t head = Align(sizeof(CheckpointHeader) + n*sizeof(CheckpointRecord)); 
+	if (size < head || HeaderChecksum(p, head) != header.checksum) {
+		WARNING("checkpoint " << _name << " has a corrupt header"); 
+		return false; 
+	}
+
+	// verify everything before touching the vectors 
+	vector<CheckpointRecord> table(n); 
+	if (n) memcpy(table.data(), p + sizeof(header), n*sizeof(CheckpointRecord)); 
+	for (int i=0; i<n; i++) {
+		const CheckpointRecord& rec = table[i]; 
+		size_t bytes = sizeof(double)*rec.count; 
+		if (strncmp(rec.name, _names[i].c_str(), sizeof(rec.name)) != 0 
+			|| rec.count != _vecs[i]->GetSize() || rec.offset < (int64_t)head 
+			|| rec.offset + bytes > size || Checksum(p + rec.offset, bytes) != rec.checksum) {
+			WARNING("checkpoint " << _name << " array " << _names[i] << " is corrupt"); 
+			return false; 
+		}
+	}
+	for (int i=0; i<n; i++) {
+		if (table[i].count) {
+			memcpy(_vecs[i]->GetData(), p + table[i].offset, sizeof(double)*table[i].count); 
+		}
+	}
+	state.step = header.step; 
+	state.iter = header.iter; 
+	state.time = header.time; 
+	state.dt = header.dt; 
+	return true; 
+}
+
+} // end namespace fem 
\ No newline at end of file
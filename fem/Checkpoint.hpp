@@ -0,0 +1,87 @@
+#pragma once 
+
+#include <cstdint>
+#include <string>
+#include "General.hpp"
+#include "Array.hpp"
+#include "Vector.hpp"
+#include "GridFunction.hpp"
+
+namespace fem 
+{
+
+/// bump when the checkpoint layout changes 
+#define CHECKPOINT_VERSION 1 
+/// the header and every array start on a multiple of this many bytes 
+#define CHECKPOINT_ALIGN 4096 
+
+/// time stepping state saved with a checkpoint 
+struct CheckpointState {
+	/// time step number 
+	int step; 
+	/// iteration within the step (nonlinear or Krylov) 
+	int iter; 
+	/// simulation time 
+	double time; 
+	/// time step size 
+	double dt; 
+}; 
+
+/// write the state of a run to one file and restart from it 
+/** the file is a header block (magic, version, key, the CheckpointState, and a table 
+	with the offset, length, and checksum of every array) followed by the raw arrays, 
+	each starting on a CHECKPOINT_ALIGN boundary and written straight from the 
+	registered vectors with one unbuffered write. The key hashes the name and size of 
+	every array and the FESpace fingerprint of every GridFunction, so a checkpoint only 
+	restarts the run that wrote it. It is written to name.tmp and renamed when 
+	complete so a crash during a write leaves the previous checkpoint intact */ 
+class Checkpoint {
+public:
+	/// constructor 
+	/** \param name checkpoint file name */ 
+	Checkpoint(const std::string& name="checkpoint.ckp"); 
+	/// register a GridFunction (checked against its space's fingerprint on restart) 
+	void Add(GridFunction& gf, const std::string& name); 
+	/// register any other vector of solver state (e.g. Krylov vectors) 
+	void Add(Vector& v, const std::string& name); 
+	/// fsync the file before it replaces the previous checkpoint 
+	/** without it a checkpoint survives a crash of the program but not of the machine */ 
+	void SetSync(bool sync) {_sync = sync; }
+
+	/// write the registered vectors and state 
+	void Write(const CheckpointState& state); 
+	/// restore the registered vectors and state 
+	/** the file is memory mapped and every checksum verified before anything is copied 
+		\returns false, leaving the vectors untouched, if the file does not exist, was 
+			written for different variables or spaces, or is corrupt */ 
+	bool Read(CheckpointState& state); 
+
+	/// return the file name 
+	const std::string& GetName() const {return _name; }
+	/// return the key identifying the registered variables and spaces 
+	uint64_t GetKey() const; 
+	/// return the size of the last checkpoint in bytes 
+	size_t GetBytes() const {return _bytes; }
+	/// return the seconds the last Write took 
+	double GetWriteTime() const {return _write_time; }
+private:
+	/// register v, fp is its space's fingerprint (0 if none) 
+	void Register(Vector& v, const std::string& name, uint64_t fp); 
+
+	/// file name 
+	std::string _name; 
+	/// registered vectors 
+	Array<Vector*> _vecs; 
+	/// their names 
+	Array<std::string> _names; 
+	/// their spaces' fingerprints 
+	Array<uint64_t> _fps; 
+	/// true if writes are fsynced 
+	bool _sync; 
+	/// size of the last checkpoint 
+	size_t _bytes; 
+	/// duration of the last write 
+	double _write_time; 
+}; 
+
+} // end namespace fem 
\ No newline at end of file
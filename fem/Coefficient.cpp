@@ -1,8 +1,177 @@
 #include "Coefficient.hpp"
+#include "FESpace.hpp"
+#include "Snapshot.hpp"
+#include <typeinfo>
+
+using namespace std; 
 
 namespace fem 
 {
 
+/// copy point i of a structure of arrays batch into a Point 
+static inline void GatherPoint(int n, int dim, const double* x, int i, Point& p) {
+	for (int d=0; d<dim; d++) {
+		p[d] = x[d*n+i]; 
+	}
+}
+
+void Coefficient::Eval(int n, int dim, const double* x, double* vals) const {
+	CH_TIMERS_FINE("coefficient batch eval"); 
+	Point p; 
+	for (int i=0; i<n; i++) {
+		GatherPoint(n, dim, x, i, p); 
+		vals[i] = Eval(p); 
+	}
+}
+
+/// fold the dynamic type of obj into the running hash h 
+template<typename T> 
+static inline void HashType(const T& obj, uint64_t& h) {
+	const char* type = typeid(obj).name(); 
+	h = HashBytes(type, strlen(type), h); 
+}
+
+/// fold a user key into the running hash h (false if there is none) 
+template<typename T> 
+static inline bool HashKey(const T& obj, const string& key, uint64_t& h) {
+	if (key.empty()) return false; 
+	HashType(obj, h); 
+	h = HashBytes(key.data(), key.size(), h); 
+	return true; 
+}
+
+bool ConstantCoefficient::Fingerprint(uint64_t& h) const {
+	HashType(*this, h); 
+	h = HashBytes(&_c, sizeof(_c), h); 
+	return true; 
+}
+
+bool FunctionCoefficient::Fingerprint(uint64_t& h) const {
+	return HashKey(*this, _key, h); 
+}
+
+bool ConstantVectorCoefficient::Fingerprint(uint64_t& h) const {
+	HashType(*this, h); 
+	int n = _v.GetSize(); 
+	h = HashBytes(&n, sizeof(n), h); 
+	h = HashBytes(_v.GetData(), n*sizeof(double), h); 
+	return true; 
+}
+
+bool VectorFunctionCoefficient::Fingerprint(uint64_t& h) const {
+	return HashKey(*this, _key, h); 
+}
+
+bool ProductCoefficient::Fingerprint(uint64_t& h) const {
+	HashType(*this, h); 
+	return _c1->Fingerprint(h) && _c2->Fingerprint(h); 
+}
+
+void FunctionCoefficient::Eval(int n, int dim, const double* x, double* vals) const {
+	CH_TIMERS_FINE("function coefficient batch eval"); 
+	if (_fb) {
+		_fb(n, dim, x, vals); 
+		return; 
+	}
+	Point p; 
+	for (int i=0; i<n; i++) {
+		GatherPoint(n, dim, x, i, p); 
+		vals[i] = _f(p); 
+	}
+}
+
+void ProductCoefficient::Eval(int n, int dim, const double* x, double* vals) const {
+	_tmp.Resize(n); 
+	_c1->Eval(n, dim, x, vals); 
+	_c2->Eval(n, dim, x, _tmp.GetData()); 
+	for (int i=0; i<n; i++) {
+		vals[i] *= _tmp[i]; 
+	}
+}
+
+QuadratureFunction::QuadratureFunction(const FESpace& space, Coefficient* c) 
+	: _space(space) {
+	_c = c; 
+	_last = NULL; 
+	_last_values = NULL; 
+}
+
+QuadratureFunction::~QuadratureFunction() {
+	Reset(); 
+}
+
+void QuadratureFunction::Reset() {
+	for (auto it=_values.begin(); it!=_values.end(); ++it) {
+		delete it->second; 
+	}
+	_values.clear(); 
+	_last = NULL; 
+	_last_values = NULL; 
+}
+
+QuadratureFunction::Values& QuadratureFunction::GetRule(const Quadrature* quad) const {
+	if (quad == _last) return *_last_values; 
+	Values*& v = _values[quad]; 
+	if (!v) {
+		v = new Values; 
+		v->nq = quad->NumPoints(); 
+		v->vals.Resize(_space.GetNumElements()*v->nq); 
+		v->done.Resize(_space.GetNumElements()); 
+		v->done = 0; 
+	}
+	_last = quad; 
+	_last_values = v; 
+	return *v; 
+}
+
+int QuadratureFunction::ElementIndex(ElTrans& trans) const {
+	const Element& el = trans.GetEl(); 
+	int e = el.GetID(); 
+	if (e < 0 || e >= _space.GetNumElements()) return -1; 
+	// compact views are rebuilt after eviction so only the id identifies them 
+	if (_space.GetElType(e) != el.GetType() || _space.GetElNumNodes(e) != el.GetNumNodes()) return -1; 
+	return e; 
+}
+
+const double* QuadratureFunction::GetValues(int e, const ShapeTable& table) const {
+	Values& v = GetRule(table.GetQuadrature()); 
+	double* vals = &v.vals[e*v.nq]; 
+	if (!v.done[e]) {
+		CH_TIMERS_FINE("quadrature function fill"); 
+		ElementHandle view; 
+		Element& el = _space.GetEl(e, view); 
+		_c->Eval(el.GetTrans(), table, vals); 
+		v.done[e] = 1; 
+	}
+	return vals; 
+}
+
+double QuadratureFunction::Eval(ElTrans& trans, const Point& ref_x) const {
+	const ShapeTable* table = trans.GetTable(); 
+	int e = (table) ? ElementIndex(trans) : -1; 
+	if (e >= 0) {
+		// only reuse if ref_x is the table point trans was set to 
+		int q = trans.GetTablePoint(); 
+		const Point& xq = table->GetQuadrature()->X(q); 
+		bool same = true; 
+		for (int d=0; d<DIM; d++) {
+			if (xq[d] != ref_x[d]) same = false; 
+		}
+		if (same) return GetValues(e, *table)[q]; 
+	}
+	return _c->Eval(trans, ref_x); 
+}
 
+void QuadratureFunction::Eval(ElTrans& trans, const ShapeTable& table, double* vals) const {
+	int e = ElementIndex(trans); 
+	if (e < 0) {
+		_c->Eval(trans, table, vals); 
+		return; 
+	}
+	const double* cached = GetValues(e, table); 
+	for (int q=0; q<table.NumPoints(); q++) {
+		vals[q] = cached[q]; 
+	}
+}
 
-} // end namespace fem 
\ No newline at end of file
+} // end namespace fem 
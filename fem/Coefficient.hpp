@@ -1,11 +1,16 @@
 #pragma once 
 
+#include <map>
+#include <cstdint>
 #include "General.hpp"
 #include "ElTrans.hpp"
+#include "ShapeTable.hpp"
 
 namespace fem 
 {
 
+class FESpace; 
+
 /// abstract class for evaluating functions
 class Coefficient {
 public:
@@ -13,12 +18,27 @@ public:
 	virtual double Eval(const Point& phys_x) const {
 		ERROR("base class is not callable. Use pointer to call derived class's Eval"); 
 	}
+	/// evaluate at a batch of points in physical space 
+	/** \param[in] n number of points 
+		\param[in] dim number of coordinates per point 
+		\param[in] x coordinates as a structure of arrays: component d of point i is x[d*n+i] 
+		\param[out] vals n values */ 
+	virtual void Eval(int n, int dim, const double* x, double* vals) const; 
 	/// evaluate by first transforming to physical space 
-	double Eval(ElTrans& trans, const Point& ref_x) const {
+	virtual double Eval(ElTrans& trans, const Point& ref_x) const {
 		Point phys; 
 		trans.Transform(ref_x, phys); 
 		return Eval(phys); 
 	}
+	/// evaluate at every point of table's quadrature rule on trans's element 
+	/** \param[out] vals table.NumPoints() values */ 
+	virtual void Eval(ElTrans& trans, const ShapeTable& table, double* vals) const {
+		Eval(table.NumPoints(), trans.GetEl().GetMeshDim(), trans.PhysicalPoints(table), vals); 
+	}
+	/// fold the coefficient's state into the running hash h 
+	/** used to key cached operators, so equal hashes must mean equal coefficients. 
+		Returns false if the state cannot be hashed exactly, which turns caching off */ 
+	virtual bool Fingerprint(uint64_t& h) const {return false; }
 }; 
 
 /// store a constant value 
@@ -28,23 +48,58 @@ public:
 	ConstantCoefficient(double c) {_c = c; }
 	/// evaluate 
 	double Eval(const Point& phys_x) const {return _c; }
+	/// evaluate a batch 
+	void Eval(int n, int dim, const double* x, double* vals) const {
+		for (int i=0; i<n; i++) vals[i] = _c; 
+	}
+	/// evaluate at table points without transforming 
+	void Eval(ElTrans& trans, const ShapeTable& table, double* vals) const {
+		Eval(table.NumPoints(), 0, NULL, vals); 
+	}
+	using Coefficient::Eval; 
+	/// fold the value into the running hash h 
+	bool Fingerprint(uint64_t& h) const; 
 private:
 	/// constant value 
 	double _c; 
 }; 
 
 /// store a function of space 
+/** the function is either called point by point or, if a batch function 
+	is given, once per batch of points */ 
 class FunctionCoefficient : public Coefficient {
 public:
 	/// constructor 
-	FunctionCoefficient(double (*f)(const Point& x)) {_f = f; }
+	FunctionCoefficient(double (*f)(const Point& x)) {_f = f; _fb = NULL; }
+	/// constructor for functions that evaluate a batch (same arguments as Eval) 
+	FunctionCoefficient(void (*fb)(int n, int dim, const double* x, double* vals)) {
+		_f = NULL; 
+		_fb = fb; 
+	}
 	/// evaluate 
 	double Eval(const Point& x) const {
-		return _f(x); 
+		if (_f) return _f(x); 
+		Point y = x; 
+		double val; 
+		_fb(1, DIM, y.GetData(), &val); 
+		return val; 
 	}
+	/// evaluate a batch 
+	void Eval(int n, int dim, const double* x, double* vals) const; 
+	using Coefficient::Eval; 
+	/// name the function for cached operators 
+	/** the function cannot be hashed, so operators assembled with it are only cached 
+		once it has a key. Functions given the same key must be the same function */ 
+	void SetKey(const std::string& key) {_key = key; }
+	/// fold the key into the running hash h (false if there is no key) 
+	bool Fingerprint(uint64_t& h) const; 
 private:
 	/// store the function pointer 
 	double (*_f)(const Point&); 
+	/// store the batch function pointer 
+	void (*_fb)(int, int, const double*, double*); 
+	/// user key ("" if none) 
+	std::string _key; 
 }; 
 
 /// abstract class for evaluating functions that return vectors 
@@ -63,6 +118,9 @@ public:
 		trans.Transform(x_ref, x_phys); 
 		Eval(x_phys, v); 
 	}
+	/// fold the coefficient's state into the running hash h 
+	/** returns false if the state cannot be hashed exactly (see Coefficient::Fingerprint) */ 
+	virtual bool Fingerprint(uint64_t& h) const {return false; }
 }; 
 
 /// constant vector coefficient 
@@ -74,6 +132,8 @@ public:
 	void Eval(const Point& x_phys, Vector& v) const {
 		v = _v; 
 	}
+	/// fold the vector into the running hash h 
+	bool Fingerprint(uint64_t& h) const; 
 private:
 	/// store vector 
 	Vector _v; 
@@ -88,9 +148,15 @@ public:
 	void Eval(const Point& x, Vector& v) const {
 		_f(x, v); 
 	}
+	/// name the function for cached operators (see FunctionCoefficient::SetKey) 
+	void SetKey(const std::string& key) {_key = key; }
+	/// fold the key into the running hash h (false if there is no key) 
+	bool Fingerprint(uint64_t& h) const; 
 private:
 	/// store vector function 
 	void (*_f)(const Point&, Vector&); 
+	/// user key ("" if none) 
+	std::string _key; 
 }; 
 
 /// evaluate the product of two coefficients as one coefficient 
@@ -102,11 +168,77 @@ public:
 	double Eval(const Point& x) const {
 		return _c1->Eval(x) * _c2->Eval(x); 
 	}
+	/// evaluate c1 * c2 over a batch 
+	void Eval(int n, int dim, const double* x, double* vals) const; 
+	using Coefficient::Eval; 
+	/// fold both coefficients into the running hash h 
+	bool Fingerprint(uint64_t& h) const; 
 private:
 	/// store the coefficients 
 	Coefficient* _c1; 
 	/// store the coefficients 
 	Coefficient* _c2; 
+	/// values of _c2 in a batch 
+	mutable Array<double> _tmp; 
+}; 
+
+/// values of a coefficient at the quadrature points of every element of a space 
+/** values for a quadrature rule are computed with one batched evaluation per element the 
+	first time the element is integrated with that rule and then reused by every integrator 
+	and reassembly. Requires elements numbered by their index in the space (GetID). 
+	Points that are not quadrature points of a table fall through to the wrapped coefficient */ 
+class QuadratureFunction : public Coefficient {
+public:
+	/// constructor 
+	/** \param space space whose elements are integrated 
+		\param c coefficient to cache (not owned) */ 
+	QuadratureFunction(const FESpace& space, Coefficient* c); 
+	/// destructor 
+	~QuadratureFunction(); 
+	/// evaluate the wrapped coefficient 
+	double Eval(const Point& x) const {return _c->Eval(x); }
+	/// evaluate the wrapped coefficient over a batch 
+	void Eval(int n, int dim, const double* x, double* vals) const {
+		_c->Eval(n, dim, x, vals); 
+	}
+	/// return the cached value if trans is at a table point 
+	double Eval(ElTrans& trans, const Point& ref_x) const; 
+	/// copy the cached values at the points of table 
+	void Eval(ElTrans& trans, const ShapeTable& table, double* vals) const; 
+	/// return the values of element e at the points of table, computing them on first use 
+	const double* GetValues(int e, const ShapeTable& table) const; 
+	/// discard all values (call when the wrapped coefficient changes) 
+	void Reset(); 
+	/// fold the wrapped coefficient into the running hash h 
+	bool Fingerprint(uint64_t& h) const {return _c->Fingerprint(h); }
+	/// return the number of quadrature rules with stored values 
+	int GetSize() const {return _values.size(); }
+private:
+	/// values of every element at the points of one rule 
+	struct Values {
+		/// number of points in the rule 
+		int nq; 
+		/// value of point q of element e at vals[e*nq+q] 
+		Array<double> vals; 
+		/// true if element e has been evaluated 
+		Array<int> done; 
+	}; 
+	/// return the index of trans's element in the space (-1 if it does not belong to it) 
+	/** elements are matched by id, type, and node count */ 
+	int ElementIndex(ElTrans& trans) const; 
+	/// return the values for quad 
+	Values& GetRule(const Quadrature* quad) const; 
+
+	/// space the values belong to 
+	const FESpace& _space; 
+	/// wrapped coefficient 
+	Coefficient* _c; 
+	/// values for each quadrature rule 
+	mutable std::map<const Quadrature*, Values*> _values; 
+	/// most recently used rule 
+	mutable const Quadrature* _last; 
+	/// values of the most recently used rule 
+	mutable Values* _last_values; 
 }; 
 
 } // end namespace fem 
\ No newline at end of file
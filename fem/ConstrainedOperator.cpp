@@ -0,0 +1,70 @@
+#include "ConstrainedOperator.hpp"
+
+using namespace std; 
+
+namespace fem 
+{
+
+ConstrainedOperator::ConstrainedOperator(const Operator* A, const FESpace* space, 
+	int bc) : Operator(A->Height(), A->Width()) {
+	CHECK(A->Height() == space->GetVSize()); 
+	_A = A; 
+	int vdim = space->GetVDim(); 
+	for (int i=0; i<space->GetNBN(); i++) {
+		int id = space->GetBoundaryNodeID(i); 
+		if (space->GetNodeBC(id) == bc) {
+			for (int d=0; d<vdim; d++) {
+				_cdofs.Append(vdim*id + d); 
+			}
+		}
+	}
+	_cdofs.Unique(); 
+
+	_mask.SetSize(Height()); 
+	_mask = 1.; 
+	for (int i=0; i<_cdofs.GetSize(); i++) {
+		_mask[_cdofs[i]] = 0.; 
+	}
+	_z.SetSize(Height()); 
+	_Az.SetSize(Height()); 
+}
+
+void ConstrainedOperator::Mult(const Vector& x, Vector& b) const {
+	CH_TIMERS("constrained operator mult"); 
+	if (b.GetSize() != Height()) b.SetSize(Height()); 
+
+	// remove the constrained columns 
+	_z = x; 
+	_z *= _mask; 
+	_Az = 0.; 
+	_A->Mult(_z, _Az); 
+
+	// remove the constrained rows and put the identity there instead 
+	_Az *= _mask; 
+	for (int i=0; i<_cdofs.GetSize(); i++) {
+		_Az[_cdofs[i]] = x[_cdofs[i]]; 
+	}
+	b += _Az; 
+}
+
+void ConstrainedOperator::EliminateRHS(const Vector& bvals, Vector& rhs) const {
+	CHECK(bvals.GetSize() == Height() && rhs.GetSize() == Height()); 
+	_z = 0.; 
+	for (int i=0; i<_cdofs.GetSize(); i++) {
+		_z[_cdofs[i]] = bvals[_cdofs[i]]; 
+	}
+	_Az = 0.; 
+	_A->Mult(_z, _Az); 
+	rhs -= _Az; 
+	for (int i=0; i<_cdofs.GetSize(); i++) {
+		rhs[_cdofs[i]] = bvals[_cdofs[i]]; 
+	}
+}
+
+void ConstrainedOperator::SetBoundaryValues(const Vector& bvals, Vector& x) const {
+	for (int i=0; i<_cdofs.GetSize(); i++) {
+		x[_cdofs[i]] = bvals[_cdofs[i]]; 
+	}
+}
+
+} // end namespace fem 
\ No newline at end of file
@@ -0,0 +1,51 @@
+#pragma once 
+
+#include "General.hpp"
+#include "Operator.hpp"
+#include "Vector.hpp"
+#include "Array.hpp"
+#include "FESpace.hpp"
+
+namespace fem 
+{
+
+/// impose essential boundary conditions on an assembled operator without modifying it 
+/** Mult applies \f$ P A P + (I - P) \f$ where \f$ P \f$ masks out the constrained 
+	dofs. The boundary values only enter through EliminateRHS so the same 
+	assembled operator can be reused with different boundary data */ 
+class ConstrainedOperator : public Operator {
+public:
+	/// constructor 
+	/** \param A unconstrained operator 
+		\param space FESpace providing the boundary nodes 
+		\param bc type of boundary node to constrain 
+	*/ 
+	ConstrainedOperator(const Operator* A, const FESpace* space, int bc=DIRICHLET); 
+	/// constrained matrix vector product \f$ b += (P A P + I - P) x \f$ 
+	void Mult(const Vector& x, Vector& b) const; 
+	/// lift the boundary values into the rhs 
+	/** \param bvals full length vector, only the constrained entries are used 
+		\param rhs subtracts \f$ A \f$ applied to the boundary values and sets 
+			the constrained entries to bvals 
+	*/ 
+	void EliminateRHS(const Vector& bvals, Vector& rhs) const; 
+	/// copy the constrained entries of bvals into x 
+	void SetBoundaryValues(const Vector& bvals, Vector& x) const; 
+	/// return the list of constrained vdofs 
+	const Array<int>& GetConstrainedDofs() const {return _cdofs; }
+	/// return the mask (0 on constrained vdofs, 1 elsewhere) 
+	const Vector& GetMask() const {return _mask; }
+private:
+	/// unconstrained operator 
+	const Operator* _A; 
+	/// constrained vdofs 
+	Array<int> _cdofs; 
+	/// zero on constrained vdofs, one otherwise 
+	Vector _mask; 
+	/// masked input 
+	mutable Vector _z; 
+	/// product of _A and _z 
+	mutable Vector _Az; 
+}; 
+
+} // end namespace fem 
\ No newline at end of file
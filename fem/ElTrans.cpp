@@ -1,4 +1,5 @@
 #include "ElTrans.hpp"
+#include "GeometricFactors.hpp"
 
 using namespace std; 
 
@@ -12,13 +13,20 @@ ElTrans::ElTrans() {
 	_bjac = false; 
 	_bJdet = false; 
 	_bJinv = false; 
+	_table = NULL; 
+	_bshape = false; 
+	_bgshape = false; 
+	_gcache = NULL; 
+	_gf = NULL; 
+	_xq_table = NULL; 
 }
 
 ElTrans::ElTrans(Element& el) {
+	_x_set = false; 
+	_gcache = NULL; 
+	_gf = NULL; 
+	_xq_table = NULL; 
 	SetEl(el); 
-	_bjac = false; 
-	_bJdet = false;
-	_bJinv = false;  
 }
 
 void ElTrans::SetEl(Element& el) {
@@ -31,6 +39,12 @@ void ElTrans::SetEl(Element& el) {
 	_bjac = false;
 	_bJdet = false; 
 	_bJinv = false;  
+	_table = NULL; 
+	_bshape = false; 
+	_bgshape = false; 
+	_xq_table = NULL; 
+	// the element may have been moved (Element::Reset) 
+	if (_points.Height() > 0) BuildPoints(); 
 }
 
 void ElTrans::SetX(Point x) {
@@ -39,54 +53,136 @@ void ElTrans::SetX(Point x) {
 	_bjac = false; 
 	_bJdet = false; 
 	_bJinv = false; 
+	_table = NULL; 
+	_bshape = false; 
+	_bgshape = false; 
+}
+
+void ElTrans::SetX(const ShapeTable& table, int q) {
+	CHECK(table.NumNodes() == _el->GetNumNodes()); 
+	SetX(table.GetQuadrature()->X(q)); 
+	_table = &table; 
+	_q = q; 
 }
 
 Point ElTrans::GetPhysX() {
 	ASSERT(_x_set && _el_set); 
 
 	Point ret; 
-	Transform(_x, ret); 
+	if (_table) {
+		const Vector& shape = Shape(); 
+		for (int i=0; i<_el->GetNumNodes(); i++) {
+			const Point& x = _el->GetNode(i).GetX(); 
+			for (int d=0; d<_mdim; d++) {
+				ret[d] += shape[i] * x[d]; 
+			}
+		}
+	} else {
+		Transform(_x, ret); 
+	}
 	return ret; 
 }
 
+const Vector& ElTrans::Shape() {
+	ASSERT(_x_set && _el_set); 
+	if (!_bshape) {
+		if (_table) _table->GetShape(_q, _shape); 
+		else _el->CalcShape(_x, _shape); 
+		_bshape = true; 
+	}
+	return _shape; 
+}
+
+const Matrix& ElTrans::GradShape() {
+	ASSERT(_x_set && _el_set); 
+	if (!_bgshape) {
+		if (_table) _table->GetGradShape(_q, _gshape); 
+		else _el->CalcGradShape(_x, _gshape); 
+		_bgshape = true; 
+	}
+	return _gshape; 
+}
+
+void ElTrans::BuildPoints() {
+	CH_TIMERS_FINE("build points matrix"); 
+	_points.SetSize(_mdim, _el->GetNumNodes()); 
+	for (int i=0; i<_mdim; i++) {
+		for (int j=0; j<_el->GetNumNodes(); j++) {
+			_points(i,j) = _el->GetNode(j).GetX()[i]; 
+		}
+	}
+}
+
 void ElTrans::Transform(const Point& x_ref, Point& x_phys) {
-	CH_TIMERS("transform x"); 
+	CH_TIMERS_FINE("transform x"); 
 	ASSERT(_el_set); 
-	if (_points.Height()==0) {
-		CH_TIMERS("build points matrix"); 
-		_points.SetSize(_mdim, _el->GetNumNodes()); 
-		for (int i=0; i<_mdim; i++) {
-			for (int j=0; j<_el->GetNumNodes(); j++) {
-				_points(i,j) = _el->GetNode(j).GetX()[i]; 
-			}
+	if (_points.Height()==0) BuildPoints(); 
+
+	_el->CalcShape(x_ref, _tshape); 
+	int nn = _el->GetNumNodes(); 
+	const double* p = _points.GetData(); 
+	for (int i=0; i<_mdim; i++) {
+		double sum = 0.; 
+		for (int j=0; j<nn; j++) {
+			sum += p[i*nn+j] * _tshape[j]; 
 		}
+		x_phys[i] = sum; 
 	}
+}
 
-	_el->CalcShape(x_ref, _shape); 
-	Vector v; 
-	_points.Mult(_shape, v); 
-	for (int i=0; i<v.GetSize(); i++) {
-		x_phys[i] = v[i]; 
+const double* ElTrans::PhysicalPoints(const ShapeTable& table) {
+	ASSERT(_el_set); 
+	if (_xq_table == &table) return _xq.GetData(); 
+	CH_TIMERS_FINE("physical points"); 
+	CHECK(table.NumNodes() == _el->GetNumNodes()); 
+	if (_points.Height()==0) BuildPoints(); 
+	int nq = table.NumPoints(); 
+	int nn = table.NumNodes(); 
+	const double* p = _points.GetData(); 
+	_xq.Resize(_mdim*nq); 
+	for (int q=0; q<nq; q++) {
+		const double* shape = table.Shape(q); 
+		for (int i=0; i<_mdim; i++) {
+			double sum = 0.; 
+			for (int j=0; j<nn; j++) {
+				sum += p[i*nn+j] * shape[j]; 
+			}
+			_xq[i*nq+q] = sum; 
+		}
 	}
+	_xq_table = &table; 
+	return _xq.GetData(); 
 }
 
 const Matrix& ElTrans::Jacobian() {
 	ASSERT(_x_set && _el_set); 
 	if (!_bjac) {
-		CH_TIMERS("jacobian"); 
-		_el->CalcGradShape(_x, _gshape); 
-		_gshape.Mult(_el->GetNodeLocationMatrix(), _J); 
+		CH_TIMERS_FINE("jacobian"); 
+		GradShape().Mult(_el->GetNodeLocationMatrix(), _J); 
 		_bjac = true; 
 	}
 	return _J; 
 }
 
+const GeometricFactors* ElTrans::CachedFactors() {
+	if (!_gcache || !_table) return NULL; 
+	if (!_gf || _gf->GetQuadrature() != _table->GetQuadrature()) {
+		_gf = &_gcache->Get(_table->GetQuadrature()); 
+	}
+	return _gf; 
+}
+
 const Matrix& ElTrans::InverseJacobian() {
 	ASSERT(_x_set && _el_set); 
 	if (!_bJinv) {
-		CH_TIMERS("inverse jacobian"); 
-		Jacobian(); 
-		_J.Inverse(_Jinv); 
+		CH_TIMERS_FINE("inverse jacobian"); 
+		const GeometricFactors* gf = CachedFactors(); 
+		if (gf) {
+			gf->GetInverseJacobian(_gcache_id, _q, _Jinv); 
+		} else {
+			Jacobian(); 
+			_J.Inverse(_Jinv); 
+		}
 		_bJinv = true; 		
 	}
 	return _Jinv; 
@@ -94,16 +190,21 @@ const Matrix& ElTrans::InverseJacobian() {
 
 double ElTrans::Determinant() {
 	if (!_bJdet) {
-		CH_TIMERS("jacobian determinant"); 
-		Jacobian(); 
-		_Jdet = _J.Determinant(); 
+		CH_TIMERS_FINE("jacobian determinant"); 
+		const GeometricFactors* gf = CachedFactors(); 
+		if (gf) {
+			_Jdet = gf->Determinant(_gcache_id, _q); 
+		} else {
+			Jacobian(); 
+			_Jdet = _J.Determinant(); 
+		}
 		_bJdet = true; 
 	}
 	return _Jdet; 
 }
 
 double ElTrans::Weight() {
-	CH_TIMERS("jacobian weight"); 
+	CH_TIMERS_FINE("jacobian weight"); 
 	Jacobian(); 
 	return _J.Weight(); 
 }
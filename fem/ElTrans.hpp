@@ -1,14 +1,23 @@
 #pragma once 
 
+#include <memory>
 #include "General.hpp"
 #include "Element.hpp"
 #include "Matrix.hpp"
+#include "ShapeTable.hpp"
 
 namespace fem 
 {
 
 class Element; 
 class ElTrans; 
+class GeometricCache; 
+class GeometricFactors; 
+
+/// holds a compact element view (see FESpace::GetEl) 
+/** keeps the view valid after the space's view cache evicts it. Elements of 
+	non-compact spaces are owned by the space */ 
+typedef std::shared_ptr<Element> ElementHandle; 
 
 /// store all the information and transformations needed for a face integral 
 struct FaceTransformations {
@@ -22,6 +31,10 @@ struct FaceTransformations {
 	ElTrans* ep_iptrans;  
 	/// transformation for the face element 
 	ElTrans* face; 
+	/// main element (keeps face valid) 
+	ElementHandle e_el; 
+	/// neighboring element (empty on a physical boundary) 
+	ElementHandle ep_el; 
 }; 
 
 /// transform from reference to physical space 
@@ -37,6 +50,9 @@ public:
 	Element& GetEl() const {return *_el; }
 	/// set evaluation point 
 	void SetX(Point x); 
+	/// set evaluation point to quadrature point q of table's rule 
+	/** the basis and its gradient are then read from table instead of recomputed */ 
+	void SetX(const ShapeTable& table, int q); 
 	/// return evaluation point 
 	const Point& GetX() const {return _x; }
 	/// return evaluation point in physical space 
@@ -44,6 +60,18 @@ public:
 	Point GetPhysX(); 
 	/// transform to physical space without saving 
 	void Transform(const Point& x_ref, Point& x_phys); 
+	/// physical coordinates of every point of table's rule 
+	/** stored as a structure of arrays: component d of point q is x[d*NumPoints() + q]. 
+		The result is kept until a different table is requested */ 
+	const double* PhysicalPoints(const ShapeTable& table); 
+	/// table the evaluation point was taken from (NULL for general points) 
+	const ShapeTable* GetTable() const {return _table; }
+	/// index of the evaluation point in GetTable() 
+	int GetTablePoint() const {return _q; }
+	/// basis functions at the evaluation point 
+	const Vector& Shape(); 
+	/// reference gradients of the basis functions at the evaluation point 
+	const Matrix& GradShape(); 
 	/// evaluate jacobian 
 	const Matrix& Jacobian(); 
 	/// evaluate inverse jacobian 
@@ -52,7 +80,16 @@ public:
 	double Determinant(); 
 	/// weight of transformation 
 	double Weight(); 
+	/// read inverse jacobians and determinants at table points from cache 
+	/** \param cache geometric cache of the space this element belongs to 
+		\param e index of this element in the space */ 
+	void SetGeometricCache(GeometricCache* cache, int e) {_gcache = cache; _gcache_id = e; _gf = NULL; }
 private:
+	/// build the (mdim x NumNodes) matrix of node locations 
+	void BuildPoints(); 
+	/// return the cached factors for the current table point (NULL if not cached) 
+	const GeometricFactors* CachedFactors(); 
+
 	/// store element (for access to CalcGradShape) 
 	Element* _el; 
 	/// true if element has been set 
@@ -63,6 +100,14 @@ private:
 	bool _x_set; 
 	/// true if jacobian has been computed 
 	bool _bjac; 
+	/// table the evaluation point was taken from (NULL for general points) 
+	const ShapeTable* _table; 
+	/// index of the evaluation point in _table 
+	int _q; 
+	/// true if _shape is current 
+	bool _bshape; 
+	/// true if _gshape is current 
+	bool _bgshape; 
 	/// store grad shape 
 	Matrix _gshape; 
 	/// store shape 
@@ -79,10 +124,22 @@ private:
 	int _mdim; 
 	/// (dim x NumNodes) matrix of point values in physical space 
 	Matrix _points;
+	/// basis functions for Transform 
+	Vector _tshape; 
+	/// physical points of _xq_table (structure of arrays) 
+	Array<double> _xq; 
+	/// table _xq was computed for 
+	const ShapeTable* _xq_table; 
 	/// store the determinant of the jacobian  
 	double _Jdet; 
 	/// true if determinant has been calculated 
 	bool _bJdet; 
+	/// optional geometric cache (NULL if disabled) 
+	GeometricCache* _gcache; 
+	/// index of the element in _gcache 
+	int _gcache_id; 
+	/// factors for the most recently used quadrature rule 
+	const GeometricFactors* _gf; 
 }; 
 
 } // end namespace fem 
\ No newline at end of file
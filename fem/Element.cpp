@@ -12,13 +12,13 @@ Element::Element(Array<MeshNode>& node_list, int order, int geo, int mdim) {
 	_mdim = mdim; 
 	_geo = geo; 
 	_volume = -1; 
+	_id = -1; 
+	_tag = -1; 
+	_ref = NULL; 
 
 	_neighbors.Resize(FacesPerEl(GetType())); 
 	_neighbors = -1; 
 
-	_faceRefTrans.Resize(_neighbors.GetSize()); 
-	_faceRefTrans = NULL; 
-
 	_faceTrans.Resize(_neighbors.GetSize()); 
 	_faceTrans = NULL; 
 
@@ -27,6 +27,37 @@ Element::Element(Array<MeshNode>& node_list, int order, int geo, int mdim) {
 
 Element::~Element() {
 	if (_trans) delete _trans; 
+	for (int f=0; f<_faceTrans.GetSize(); f++) {
+		if (_faceTrans[f]) delete _faceTrans[f]; 
+	}
+}
+
+void Element::Reset(const Array<MeshNode>& node_list) {
+	CHECKMSG(node_list.GetSize() == _geo_nodes.GetSize(), "vertex count changed on reset"); 
+	for (int i=0; i<node_list.GetSize(); i++) {
+		_geo_nodes[i] = node_list[i]; 
+	}
+	Rebuild(); 
+}
+
+void Element::Reset(const Mesh& mesh, int e) {
+	const MeshEl& el = mesh.GetElement(e); 
+	CHECKMSG(el.GetType() == _geo, "element type changed on reset"); 
+	for (int i=0; i<_geo_nodes.GetSize(); i++) {
+		_geo_nodes[i] = mesh.GetNode(el[i]); 
+	}
+	Rebuild(); 
+}
+
+void Element::Rebuild() {
+	_id = -1; 
+	_tag = -1; 
+	_volume = -1; 
+	_neighbors = -1; 
+	PlaceNodes(); 
+	if (_nodeLocMatrix.Height() > 0) FillNodeLocationMatrix(); 
+	_trans->SetEl(*this); 
+	_trans->SetGeometricCache(NULL, -1); 
 }
 
 Node& Element::GetNode(int index) {
@@ -42,26 +73,29 @@ int Element::GetNodeGlobalID(int i) const {
 }
 
 const Matrix& Element::GetNodeLocationMatrix() {
-	if (_nodeLocMatrix.Height() == 0) {
-		_nodeLocMatrix.SetSize(GetNumNodes(), GetDim()); 
-		for (int n=0; n<GetNumNodes(); n++) {
-			for (int d=0; d<GetDim(); d++) {
-				_nodeLocMatrix(n,d) = GetNode(n).GetX()[d]; 
-			}
+	if (_nodeLocMatrix.Height() == 0) FillNodeLocationMatrix(); 
+	return _nodeLocMatrix; 
+}
+
+void Element::FillNodeLocationMatrix() {
+	_nodeLocMatrix.SetSize(GetNumNodes(), GetDim()); 
+	for (int n=0; n<GetNumNodes(); n++) {
+		for (int d=0; d<GetDim(); d++) {
+			_nodeLocMatrix(n,d) = GetNode(n).GetX()[d]; 
 		}
 	}
-	return _nodeLocMatrix; 
 }
 
 ElTrans& Element::GetFaceRefTrans(int e) {
 	int ind = FindNeighbor(e); 
 	CHECKMSG(ind >= 0, "neighbor not found"); 
-	CHECKMSG(_faceRefTrans[ind], "reference face transformation not initialized"); 
-	return _faceRefTrans[ind]->GetTrans(); 
+	CHECKMSG(_ref, "reference element not set"); 
+	return _ref->GetFace(ind).GetTrans(); 
 }
 
 ElTrans& Element::GetFaceRefTransFromFace(int f) {
-	return _faceRefTrans[f]->GetTrans(); 
+	CHECKMSG(_ref, "reference element not set"); 
+	return _ref->GetFace(f).GetTrans(); 
 }
 
 ElTrans& Element::GetFaceTrans(int e) {
@@ -84,6 +118,11 @@ int Element::FindNeighbor(int e) const {
 }
 
 void Element::CalcPhysGradShape(ElTrans& trans, Matrix& pgshape) const {
+	if (&trans.GetEl() == this) {
+		// reuse the reference gradient the jacobian was built from 
+		trans.InverseJacobian().Mult(trans.GradShape(), pgshape); 
+		return; 
+	}
 	Matrix gshape; 
 	CalcGradShape(trans.GetX(), gshape); 
 	trans.InverseJacobian().Mult(gshape, pgshape); 
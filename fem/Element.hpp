@@ -7,17 +7,19 @@
 #include "Matrix.hpp"
 #include "ElTrans.hpp"
 #include "Quadrature.hpp"
+#include "ReferenceElement.hpp"
 
 namespace fem 
 {
 
 class ElTrans; 
+struct LagrangeKernels; 
 
 /// base class for finite elements 
 class Element {
 public:
 	/// default constructor
-	Element() {_trans = NULL; } 
+	Element() {_trans = NULL; _ref = NULL; } 
 	/// construct an element from the Mesh 
 	/** \param node_list list of MeshNodes to build FEM nodes on 
 		\param order polynomial order for this element 
@@ -26,6 +28,12 @@ public:
 	Element(Array<MeshNode>& node_list, int order, int geo, int mdim); 
 	/// deconstructor 
 	~Element(); 
+	/// move the element onto new vertices of the same geometry type 
+	/** rebuilds the nodes and transformation in the existing storage instead of 
+		constructing a new element. The id, tag, neighbors, and geometric cache are cleared */ 
+	void Reset(const Array<MeshNode>& node_list); 
+	/// Reset onto the vertices of mesh element e 
+	void Reset(const Mesh& mesh, int e); 
 	/// set tags for material properties etc 
 	void SetTag(int tag) {_tag = tag; }
 	/// return the tag for this element 
@@ -115,12 +123,24 @@ public:
 	}
 	/// evaluate gradient of basis functions in physical space using ElTrans 
 	virtual void CalcPhysGradShape(ElTrans& trans, Matrix& pgshape) const; 
+	/// return compile time specialized basis kernels (NULL if not available) 
+	const LagrangeKernels* GetKernels() const {return (_ref) ? _ref->kernels : NULL; }
+	/// return the shared reference element (NULL if not set) 
+	const ReferenceElement* GetReference() const {return _ref; }
 
 	/// print Element information 
 	void Print(std::ostream& out=std::cout) const; 
 protected: 
+	/// place the FEM nodes on _geo_nodes (called by the constructors and Reset) 
+	virtual void PlaceNodes() {
+		ERROR("PlaceNodes not defined"); 
+	}
 	/// find the index into _neighbors that matches element e 
 	int FindNeighbor(int e) const; 
+	/// clear the per element state and place the nodes on the new _geo_nodes 
+	void Rebuild(); 
+	/// copy the node locations into _nodeLocMatrix 
+	void FillNodeLocationMatrix(); 
 
 	/// id number for this element 
 	int _id; 
@@ -144,8 +164,8 @@ protected:
 	double _volume; 
 	/// store the ElTrans transformation object 
 	ElTrans* _trans; 
-	/// store reference space face transformations for each face 
-	Array<Element*> _faceRefTrans; 
+	/// shared basis data and reference face transformations 
+	const ReferenceElement* _ref; 
 	/// physical space face transformations 
 	Array<Element*> _faceTrans; 
 	/// store the node locations in a matrix (Nnodes x dim) 
@@ -0,0 +1,307 @@
+#include "Expression.hpp"
+#include "Snapshot.hpp"
+#include <cstdlib>
+#include <cctype>
+
+using namespace std; 
+
+namespace fem 
+{
+
+/// points processed per pass over the bytecode 
+#define EXPRESSION_CHUNK 64
+
+/// bytecode operations 
+enum ExpressionOp {
+	EX_ADD, EX_SUB, EX_MUL, EX_DIV, EX_POW, EX_ATAN2, EX_MIN, EX_MAX,
+	EX_NEG, EX_SIN, EX_COS, EX_TAN, EX_ASIN, EX_ACOS, EX_ATAN,
+	EX_SINH, EX_COSH, EX_TANH, EX_EXP, EX_LOG, EX_SQRT, EX_ABS,
+	EX_FLOOR, EX_CEIL,
+	EX_NUM_OPS
+}; 
+
+/// names of the operations (functions are called by these names) 
+static const char* ExpressionOpNames[EX_NUM_OPS] = {
+	"add", "sub", "mul", "div", "pow", "atan2", "min", "max",
+	"neg", "sin", "cos", "tan", "asin", "acos", "atan",
+	"sinh", "cosh", "tanh", "exp", "log", "sqrt", "abs",
+	"floor", "ceil"
+}; 
+
+/// true if op takes two operands 
+static inline bool IsBinary(int op) {return op <= EX_MAX; }
+
+/// r = f(a, b) over m points. NULL operands are the constants ka and kb 
+template<class F>
+static inline void Apply2(F f, int m, const double* a, double ka,
+	const double* b, double kb, double* r) {
+	if (a && b) {
+		for (int i=0; i<m; i++) r[i] = f(a[i], b[i]); 
+	} else if (a) {
+		for (int i=0; i<m; i++) r[i] = f(a[i], kb); 
+	} else if (b) {
+		for (int i=0; i<m; i++) r[i] = f(ka, b[i]); 
+	} else {
+		double v = f(ka, kb); 
+		for (int i=0; i<m; i++) r[i] = v; 
+	}
+}
+
+/// r = f(a) over m points. A NULL operand is the constant ka 
+template<class F>
+static inline void Apply1(F f, int m, const double* a, double ka, double* r) {
+	if (a) {
+		for (int i=0; i<m; i++) r[i] = f(a[i]); 
+	} else {
+		double v = f(ka); 
+		for (int i=0; i<m; i++) r[i] = v; 
+	}
+}
+
+/// apply op to m points (also used with m = 1 to fold constants) 
+static void Execute(int op, int m, const double* a, double ka,
+	const double* b, double kb, double* r) {
+	switch (op) {
+		case EX_ADD: Apply2([](double u, double v) {return u + v; }, m, a, ka, b, kb, r); break; 
+		case EX_SUB: Apply2([](double u, double v) {return u - v; }, m, a, ka, b, kb, r); break; 
+		case EX_MUL: Apply2([](double u, double v) {return u * v; }, m, a, ka, b, kb, r); break; 
+		case EX_DIV: Apply2([](double u, double v) {return u / v; }, m, a, ka, b, kb, r); break; 
+		case EX_POW: Apply2([](double u, double v) {return pow(u, v); }, m, a, ka, b, kb, r); break; 
+		case EX_ATAN2: Apply2([](double u, double v) {return atan2(u, v); }, m, a, ka, b, kb, r); break; 
+		case EX_MIN: Apply2([](double u, double v) {return (u < v) ? u : v; }, m, a, ka, b, kb, r); break; 
+		case EX_MAX: Apply2([](double u, double v) {return (u > v) ? u : v; }, m, a, ka, b, kb, r); break; 
+		case EX_NEG: Apply1([](double u) {return -u; }, m, a, ka, r); break; 
+		case EX_SIN: Apply1([](double u) {return sin(u); }, m, a, ka, r); break; 
+		case EX_COS: Apply1([](double u) {return cos(u); }, m, a, ka, r); break; 
+		case EX_TAN: Apply1([](double u) {return tan(u); }, m, a, ka, r); break; 
+		case EX_ASIN: Apply1([](double u) {return asin(u); }, m, a, ka, r); break; 
+		case EX_ACOS: Apply1([](double u) {return acos(u); }, m, a, ka, r); break; 
+		case EX_ATAN: Apply1([](double u) {return atan(u); }, m, a, ka, r); break; 
+		case EX_SINH: Apply1([](double u) {return sinh(u); }, m, a, ka, r); break; 
+		case EX_COSH: Apply1([](double u) {return cosh(u); }, m, a, ka, r); break; 
+		case EX_TANH: Apply1([](double u) {return tanh(u); }, m, a, ka, r); break; 
+		case EX_EXP: Apply1([](double u) {return exp(u); }, m, a, ka, r); break; 
+		case EX_LOG: Apply1([](double u) {return log(u); }, m, a, ka, r); break; 
+		case EX_SQRT: Apply1([](double u) {return sqrt(u); }, m, a, ka, r); break; 
+		case EX_ABS: Apply1([](double u) {return fabs(u); }, m, a, ka, r); break; 
+		case EX_FLOOR: Apply1([](double u) {return floor(u); }, m, a, ka, r); break; 
+		case EX_CEIL: Apply1([](double u) {return ceil(u); }, m, a, ka, r); break; 
+		default: ERROR("unknown expression operation " << op); 
+	}
+}
+
+Expression::Expression(const string& expr) {
+	_expr = expr; 
+	_pos = 0; 
+	_nreg = 0; 
+	_t = 0.; 
+	_result = ParseSum(0); 
+	if (Peek() != 0) SyntaxError("unexpected character"); 
+}
+
+char Expression::Peek() {
+	while (_pos < (int)_expr.size() && isspace(_expr[_pos])) _pos++; 
+	return (_pos < (int)_expr.size()) ? _expr[_pos] : 0; 
+}
+
+bool Expression::Accept(char c) {
+	if (Peek() != c) return false; 
+	_pos++; 
+	return true; 
+}
+
+void Expression::Expect(char c) {
+	if (!Accept(c)) SyntaxError(string("expected '") + c + "'"); 
+}
+
+void Expression::SyntaxError(const string& msg) const {
+	ERROR("expression \"" << _expr << "\": " << msg << " at position " << _pos); 
+}
+
+Expression::Arg Expression::ParseSum(int r) {
+	Arg left = ParseProduct(r); 
+	while (true) {
+		if (Accept('+')) left = Emit(EX_ADD, r, left, ParseProduct(r+1)); 
+		else if (Accept('-')) left = Emit(EX_SUB, r, left, ParseProduct(r+1)); 
+		else return left; 
+	}
+}
+
+Expression::Arg Expression::ParseProduct(int r) {
+	Arg left = ParseUnary(r); 
+	while (true) {
+		char c = Peek(); 
+		// ** is a power and is handled by ParsePower 
+		if (c == '*' && _pos+1 < (int)_expr.size() && _expr[_pos+1] == '*') return left; 
+		if (Accept('*')) left = Emit(EX_MUL, r, left, ParseUnary(r+1)); 
+		else if (Accept('/')) left = Emit(EX_DIV, r, left, ParseUnary(r+1)); 
+		else return left; 
+	}
+}
+
+Expression::Arg Expression::ParseUnary(int r) {
+	if (Accept('-')) {
+		Arg none = {CONST, 0, 0.}; 
+		return Emit(EX_NEG, r, ParseUnary(r), none); 
+	}
+	if (Accept('+')) return ParseUnary(r); 
+	return ParsePower(r); 
+}
+
+Expression::Arg Expression::ParsePower(int r) {
+	Arg base = ParsePrimary(r); 
+	bool power = Accept('^'); 
+	if (!power && Peek() == '*' && _pos+1 < (int)_expr.size() && _expr[_pos+1] == '*') {
+		_pos += 2; 
+		power = true; 
+	}
+	if (!power) return base; 
+	// right associative: a^b^c = a^(b^c) 
+	Arg ex = ParseUnary(r+1); 
+	if (ex.kind == CONST && base.kind != CONST) {
+		// avoid pow for the common exponents 
+		Arg none = {CONST, 0, 0.}; 
+		if (ex.val == 1.) return base; 
+		if (ex.val == 2.) return Emit(EX_MUL, r, base, base); 
+		if (ex.val == .5) return Emit(EX_SQRT, r, base, none); 
+	}
+	return Emit(EX_POW, r, base, ex); 
+}
+
+Expression::Arg Expression::ParsePrimary(int r) {
+	char c = Peek(); 
+	if (c == 0) SyntaxError("unexpected end of expression"); 
+	if (Accept('(')) {
+		Arg a = ParseSum(r); 
+		Expect(')'); 
+		return a; 
+	}
+	if (isdigit(c) || c == '.') {
+		const char* start = _expr.c_str() + _pos; 
+		char* end; 
+		double val = strtod(start, &end); 
+		if (end == start) SyntaxError("invalid number"); 
+		_pos += end - start; 
+		Arg a = {CONST, 0, val}; 
+		return a; 
+	}
+	if (!isalpha(c) && c != '_') SyntaxError(string("unexpected '") + c + "'"); 
+	int start = _pos; 
+	while (_pos < (int)_expr.size() && (isalnum(_expr[_pos]) || _expr[_pos] == '_')) _pos++; 
+	string name = _expr.substr(start, _pos - start); 
+
+	if (Peek() != '(') {
+		Arg a = {CONST, 0, 0.}; 
+		if (name == "x") {a.kind = VAR; a.index = 0; }
+		else if (name == "y") {a.kind = VAR; a.index = 1; }
+		else if (name == "z") {a.kind = VAR; a.index = 2; }
+		else if (name == "t") a.kind = TIME; 
+		else if (name == "pi") a.val = M_PI; 
+		else if (name == "e") a.val = M_E; 
+		else {
+			_pos = start; 
+			SyntaxError("unknown variable '" + name + "'"); 
+		}
+		return a; 
+	}
+
+	// function call: neg and the operators are not callable by name 
+	int op = -1; 
+	for (int i=EX_POW; i<EX_NUM_OPS; i++) {
+		if (i != EX_NEG && name == ExpressionOpNames[i]) op = i; 
+	}
+	if (op < 0) {
+		_pos = start; 
+		SyntaxError("unknown function '" + name + "'"); 
+	}
+	Expect('('); 
+	Arg a = ParseSum(r); 
+	Arg b = {CONST, 0, 0.}; 
+	if (IsBinary(op)) {
+		Expect(','); 
+		b = ParseSum(r+1); 
+	}
+	Expect(')'); 
+	return Emit(op, r, a, b); 
+}
+
+Expression::Arg Expression::Emit(int op, int r, const Arg& a, const Arg& b) {
+	Arg ret = {REG, r, 0.}; 
+	if (a.kind == CONST && (!IsBinary(op) || b.kind == CONST)) {
+		ret.kind = CONST; 
+		Execute(op, 1, NULL, a.val, NULL, b.val, &ret.val); 
+		return ret; 
+	}
+	Instr ins = {op, r, a, b}; 
+	_code.Append(ins); 
+	if (r+1 > _nreg) _nreg = r+1; 
+	return ret; 
+}
+
+void Expression::Eval(int n, int dim, const double* x, double* vals) const {
+	CH_TIMERS_FINE("expression eval"); 
+	const int C = EXPRESSION_CHUNK; 
+	_regs.Resize(_nreg*C); 
+	double* regs = _regs.GetData(); 
+
+	// pointer to the values of arg for points i0.. or NULL with k set for scalars 
+	auto Resolve = [&](const Arg& arg, int i0, double& k) -> const double* {
+		k = arg.val; 
+		if (arg.kind == REG) return regs + arg.index*C; 
+		if (arg.kind == TIME) k = _t; 
+		if (arg.kind == VAR) {
+			if (arg.index < dim) return x + arg.index*n + i0; 
+			k = 0.; 
+		}
+		return NULL; 
+	}; 
+
+	for (int i0=0; i0<n; i0+=C) {
+		int m = min(C, n-i0); 
+		for (int i=0; i<_code.GetSize(); i++) {
+			const Instr& ins = _code[i]; 
+			double ka, kb; 
+			const double* a = Resolve(ins.a, i0, ka); 
+			const double* b = Resolve(ins.b, i0, kb); 
+			Execute(ins.op, m, a, ka, b, kb, regs + ins.dst*C); 
+		}
+		double k; 
+		const double* res = Resolve(_result, i0, k); 
+		for (int i=0; i<m; i++) {
+			vals[i0+i] = (res) ? res[i] : k; 
+		}
+	}
+}
+
+double Expression::Eval(const Point& x) const {
+	Point p = x; 
+	double val; 
+	Eval(1, DIM, p.GetData(), &val); 
+	return val; 
+}
+
+void Expression::Print(ostream& out) const {
+	auto Name = [](const Arg& a) {
+		if (a.kind == REG) return "r" + to_string(a.index); 
+		if (a.kind == VAR) return string(1, "xyz"[a.index]); 
+		if (a.kind == TIME) return string("t"); 
+		return to_string(a.val); 
+	}; 
+	for (int i=0; i<_code.GetSize(); i++) {
+		const Instr& ins = _code[i]; 
+		out << "r" << ins.dst << " = " << ExpressionOpNames[ins.op] << " " << Name(ins.a); 
+		if (IsBinary(ins.op)) out << " " << Name(ins.b); 
+		out << endl; 
+	}
+	out << "result = " << Name(_result) << endl; 
+}
+
+bool ExpressionCoefficient::Fingerprint(uint64_t& h) const {
+	const string& src = _expr.GetString(); 
+	h = HashBytes(src.data(), src.size(), h); 
+	double t = _expr.GetTime(); 
+	h = HashBytes(&t, sizeof(t), h); 
+	return true; 
+}
+
+} // end namespace fem 
\ No newline at end of file
@@ -0,0 +1,134 @@
+#pragma once 
+
+#include <string>
+#include "General.hpp"
+#include "Array.hpp"
+#include "Coefficient.hpp"
+
+namespace fem 
+{
+
+/// arithmetic expression of space and time compiled to register bytecode 
+/** supports numbers, the variables x, y, z, and t, the constants pi and e,
+	the operators + - * / and ^ (or **), and the functions
+	sin, cos, tan, asin, acos, atan, sinh, cosh, tanh, exp, log, sqrt, abs,
+	floor, ceil, pow, atan2, min, and max. Subexpressions that do not depend on
+	the variables are folded when the string is compiled. Each instruction is
+	applied to a whole batch of points before the next one runs */ 
+class Expression {
+public:
+	/// compile expr 
+	Expression(const std::string& expr); 
+	/// evaluate at a batch of points in physical space 
+	/** \param[in] n number of points
+		\param[in] dim number of coordinates per point (missing coordinates are zero)
+		\param[in] x coordinates, component d of point i is x[d*n+i]
+		\param[out] vals n values */ 
+	void Eval(int n, int dim, const double* x, double* vals) const; 
+	/// evaluate at a single point 
+	double Eval(const Point& x) const; 
+	/// set the value of t 
+	void SetTime(double t) {_t = t; }
+	/// return the value of t 
+	double GetTime() const {return _t; }
+	/// return true if the expression folded to a constant 
+	bool IsConstant() const {return _result.kind == CONST; }
+	/// return the number of instructions 
+	int NumInstructions() const {return _code.GetSize(); }
+	/// return the number of registers 
+	int NumRegisters() const {return _nreg; }
+	/// return the source string 
+	const std::string& GetString() const {return _expr; }
+	/// print the bytecode 
+	void Print(std::ostream& out=std::cout) const; 
+private:
+	/// where an operand lives 
+	enum ArgKind {
+		CONST,
+		VAR,
+		TIME,
+		REG
+	}; 
+	/// instruction operand 
+	struct Arg {
+		/// one of ArgKind 
+		int kind; 
+		/// coordinate (VAR) or register (REG) index 
+		int index; 
+		/// value of CONST operands 
+		double val; 
+	}; 
+	/// one instruction: dst = op(a, b) 
+	struct Instr {
+		/// operation 
+		int op; 
+		/// destination register 
+		int dst; 
+		/// first operand 
+		Arg a; 
+		/// second operand (binary operations only) 
+		Arg b; 
+	}; 
+
+	/// sum := product (('+' | '-') product)* 
+	Arg ParseSum(int r); 
+	/// product := unary (('*' | '/') unary)* 
+	Arg ParseProduct(int r); 
+	/// unary := ('-' | '+') unary | power 
+	Arg ParseUnary(int r); 
+	/// power := primary (('^' | '**') unary)? 
+	Arg ParsePower(int r); 
+	/// primary := number | name | name '(' sum (',' sum)? ')' | '(' sum ')' 
+	Arg ParsePrimary(int r); 
+	/// fold constant operands or emit an instruction writing register r 
+	Arg Emit(int op, int r, const Arg& a, const Arg& b); 
+	/// skip white space and return the next character (0 at the end) 
+	char Peek(); 
+	/// consume c if it is next 
+	bool Accept(char c); 
+	/// consume c or report an error 
+	void Expect(char c); 
+	/// report a syntax error at the current position 
+	void SyntaxError(const std::string& msg) const; 
+
+	/// source string 
+	std::string _expr; 
+	/// parse position 
+	int _pos; 
+	/// bytecode 
+	Array<Instr> _code; 
+	/// operand holding the result 
+	Arg _result; 
+	/// number of registers 
+	int _nreg; 
+	/// value of t 
+	double _t; 
+	/// register file for one chunk of points 
+	mutable Array<double> _regs; 
+}; 
+
+/// coefficient given by an Expression of the physical coordinates 
+class ExpressionCoefficient : public Coefficient {
+public:
+	/// constructor 
+	/** \param expr expression in x, y, z, and t (e.g. "sin(pi*x)*sin(pi*y)") */ 
+	ExpressionCoefficient(const std::string& expr) : _expr(expr) { }
+	/// evaluate 
+	double Eval(const Point& x) const {return _expr.Eval(x); }
+	/// evaluate a batch 
+	void Eval(int n, int dim, const double* x, double* vals) const {
+		_expr.Eval(n, dim, x, vals); 
+	}
+	using Coefficient::Eval; 
+	/// set the value of t 
+	void SetTime(double t) {_expr.SetTime(t); }
+	/// fold the source string and t into the running hash h 
+	bool Fingerprint(uint64_t& h) const; 
+	/// return the compiled expression 
+	const Expression& GetExpression() const {return _expr; }
+private:
+	/// compiled expression 
+	Expression _expr; 
+}; 
+
+} // end namespace fem 
\ No newline at end of file
@@ -7,84 +7,277 @@ namespace fem
 
 FEMatrix::FEMatrix(const FESpace* space) : Operator(space->GetVSize()) {
 	_space = space; 
+	_packed = true; 
+	_fingerprint = 0; 
+	_exact = true; 
+	_mapped = NULL; 
 	int Ne = _space->GetNumElements(); 
-	_data.Resize(Ne); 
-	for (int i=0; i<Ne; i++) {
-		Element& el = _space->GetEl(i); 
-		_data[i] = new Matrix(el.GetNumNodes()); 
+	_doffsets.Resize(Ne+1); 
+	_N = (Ne > 0) ? _space->GetVDim()*_space->GetElNumNodes(0) : 0; 
+	_Nmax = 0; 
+	for (int e=0; e<Ne; e++) {
+		int n = _space->GetVDim()*_space->GetElNumNodes(e); 
+		if (n != _N) _N = -1; 
+		_Nmax = std::max(_Nmax, n); 
+		_doffsets[e+1] = _doffsets[e] + n; 
+	}
+
+	SetOffsets(); 
+	_mats.Resize(_offsets[Ne]); 
+	_vdofs.Resize(_doffsets[Ne]); 
+	Array<int> vdofs; 
+	for (int e=0; e<Ne; e++) {
+		_space->GetVDofs(e, vdofs); 
+		for (int i=0; i<vdofs.GetSize(); i++) {
+			_vdofs[_doffsets[e]+i] = vdofs[i]; 
+		}
 	}
 }
 
-FEMatrix::~FEMatrix() {
-	for (int i=0; i<_data.GetSize(); i++) {
-		if (_data[i]) delete _data[i]; 
+/// packed matvec of Ne small NxN elements stored back to back 
+/** each triangle is expanded into a dense block on the stack first. At these sizes 
+	the row dot products vectorize while the triangle loop's updates of both 
+	(i,j) and (j,i) do not, so the expansion pays for itself. Larger 
+	elements use the triangle loop in BatchMult */ 
+template <int N> 
+void PackedMult(int Ne, const double* mats, const int* dofs, const double* x, double* b) {
+	constexpr int S = N*(N+1)/2; 
+	for (int e=0; e<Ne; e++, mats += S, dofs += N) {
+		double xe[N], A[N*N]; 
+		for (int i=0, k=0; i<N; i++) {
+			xe[i] = x[dofs[i]]; 
+			for (int j=i; j<N; j++, k++) {
+				A[i*N+j] = A[j*N+i] = mats[k]; 
+			}
+		}
+		for (int i=0; i<N; i++) {
+			double sum = 0.; 
+			for (int j=0; j<N; j++) {
+				sum += A[i*N+j] * xe[j]; 
+			}
+			b[dofs[i]] += sum; 
+		}
 	}
 }
 
-void FEMatrix::Mult(const Vector& x, Vector& b) const {
-	CH_TIMERS("FEMatrix mat vec"); 
-	if (b.GetSize() != Height()) b.SetSize(Height()); 
-	int Ne = _space->GetNumElements(); 
-#ifdef RV_MVOUTERC
-	if (_mats.GetSize()==0) ERROR("must call ConvertToBatch first"); 
-	int height = _data[0]->Height(); 
-	Vector ball(height*Ne); 
-	MVOuterC_RV(height, Ne, _mats.GetData(), 
-		_vdofs.GetData(), x.GetData(), ball.GetData()); 
-	BatchAdd_RV(height, Ne, _vdofs.GetData(), ball.GetData(), b.GetData()); 
-#elif defined RV_MVOUTER 
-	if (_mats.GetSize()==0) ERROR("must call ConvertToBatch first"); 
-	int height = _data[0]->Height(); 
-#ifdef RV_UNROLL 
-	if (height==4) {
-		MVOuter4_RV(height, Ne, _mats.GetData(), 
-			_vdofs.GetData(), x.GetData(), b.GetData()); 
-	} else if (height==9) {
-		MVOuter9_RV(height, Ne, _mats.GetData(), 
-			_vdofs.GetData(), x.GetData(), b.GetData()); 
-	} else if (height==16) {
-		MVOuter16_RV(height, Ne, _mats.GetData(), 
-			_vdofs.GetData(), x.GetData(), b.GetData()); 
-	}
-	else {
-		ERROR("height = " << height << " not unrolled"); 
+void BatchMult(int e0, int e1, int N, int Nmax, bool packed, const double* mats, 
+	const int* offsets, const int* doffsets, const int* vdofs, const double* x, double* b) {
+	int Ne = e1 - e0; 
+	int base = offsets[e0]; 
+#if defined RV_MVOUTERC || defined RV_MVOUTER 
+	const double* m0 = mats; 
+	const int* d0 = vdofs + doffsets[e0]; 
+	if (N > 0 && packed) {
+		MVOuterSym_RV(N, Ne, m0, d0, x, b); 
+		return; 
 	}
+	if (N > 0) {
+		int height = N; 
+#ifdef RV_MVOUTERC
+		Vector ball(height*Ne); 
+		MVOuterC_RV(height, Ne, m0, d0, x, ball.GetData()); 
+		BatchAdd_RV(height, Ne, d0, ball.GetData(), b); 
+#elif defined RV_UNROLL 
+		if (height==4) {
+			MVOuter4_RV(height, Ne, m0, d0, x, b); 
+		} else if (height==9) {
+			MVOuter9_RV(height, Ne, m0, d0, x, b); 
+		} else if (height==16) {
+			MVOuter16_RV(height, Ne, m0, d0, x, b); 
+		}
+		else {
+			ERROR("height = " << height << " not unrolled"); 
+		}
 #else
-	MVOuter_RV(height, Ne, _mats.GetData(), 
-		_vdofs.GetData(), x.GetData(), b.GetData()); 
+		MVOuter_RV(height, Ne, m0, d0, x, b); 
 #endif
-#else
-	Array<int> vdofs; 
-	Vector elvec; 
-	Vector prod; 
-	for (int e=0; e<Ne; e++) {
-		vdofs = _space->GetVDofs(e);  
-		x.GetFromDofs(vdofs, elvec); 
-		_data[e]->Mult(elvec, prod); 
-		b.AddFromDofs(vdofs, prod); 
+		return; 
 	}
 #endif
+	// gather, multiply, and scatter straight out of the batch 
+	if (packed) {
+		// low order elements (quad p1, hex p1, quad p2) 
+		if (N == 4) {PackedMult<4>(e1-e0, mats, vdofs + doffsets[e0], x, b); return; }
+		if (N == 8) {PackedMult<8>(e1-e0, mats, vdofs + doffsets[e0], x, b); return; }
+		if (N == 9) {PackedMult<9>(e1-e0, mats, vdofs + doffsets[e0], x, b); return; }
+		// each stored off diagonal entry is used for both (i,j) and (j,i) 
+		static thread_local Array<double> work; 
+		if (work.GetSize() < 2*Nmax) work.Resize(2*Nmax); 
+		double* xe = work.GetData(); 
+		double* ye = xe + Nmax; 
+		for (int e=e0; e<e1; e++) {
+			int n = doffsets[e+1] - doffsets[e]; 
+			const double* A = mats + offsets[e] - base; 
+			const int* dofs = vdofs + doffsets[e]; 
+			for (int i=0; i<n; i++) {
+				xe[i] = x[dofs[i]]; 
+				ye[i] = 0.; 
+			}
+			for (int i=0; i<n; i++) {
+				double xi = xe[i]; 
+				double sum = A[0] * xi; 
+				for (int j=i+1; j<n; j++) {
+					sum += A[j-i] * xe[j]; 
+					ye[j] += A[j-i] * xi; 
+				}
+				ye[i] += sum; 
+				A += n-i; 
+			}
+			for (int i=0; i<n; i++) {
+				b[dofs[i]] += ye[i]; 
+			}
+		}
+		return; 
+	}
+	for (int e=e0; e<e1; e++) {
+		int n = doffsets[e+1] - doffsets[e]; 
+		const double* A = mats + offsets[e] - base; 
+		const int* dofs = vdofs + doffsets[e]; 
+		for (int i=0; i<n; i++) {
+			double sum = 0.; 
+			for (int j=0; j<n; j++) {
+				sum += A[i*n+j] * x[dofs[j]]; 
+			}
+			b[dofs[i]] += sum; 
+		}
+	}
+}
+
+void FEMatrix::Mult(const Vector& x, Vector& b) const {
+	CH_TIMERS("FEMatrix mat vec"); 
+	if (b.GetSize() != Height()) b.SetSize(Height()); 
+	BatchMult(0, GetNumElements(), _N, _Nmax, _packed, Mats(), _offsets.GetData(), 
+		_doffsets.GetData(), _vdofs.GetData(), x.GetData(), b.GetData()); 
 }
 
 void FEMatrix::AddIntegrator(BilinearIntegrator* integ) {
-	Array<int> vdofs; 
-	for (int n=0; n<_space->GetNumElements(); n++) {
-		Element& el = _space->GetEl(n); 
-		Matrix elmat(el.GetNumNodes()); 
-		integ->Assemble(el, elmat);
-		(*this)[n] += elmat;  
+	Own(); 
+	_exact = integ->Fingerprint(_fingerprint) && _exact; 
+	if (_packed && !integ->IsSymmetric()) Unpack(); 
+	int Ne = _space->GetNumElements(); 
+	int e0 = 0; 
+	while (e0 < Ne) {
+		// extend the range over elements with the same type and size 
+		// (a space builds one element class of one order per type) 
+		int e1 = e0 + 1; 
+		while (e1 < Ne) {
+			if (_space->GetElType(e1) != _space->GetElType(e0) 
+				|| GetElSize(e1) != GetElSize(e0)) break; 
+			e1++; 
+		}
+
+		// fall back to element by element assembly 
+		if (!integ->AssembleBatch(*_space, e0, e1-e0, _packed, &_mats[_offsets[e0]])) {
+			for (int n=e0; n<e1; n++) {
+				ElementHandle view; 
+				Element& el = _space->GetEl(n, view); 
+				Matrix elmat; 
+				integ->Assemble(el, elmat); 
+				El(n) += elmat;  
+			}
+		}
+		e0 = e1; 
 	}
 	delete integ; 
 }
 
+uint64_t FEMatrix::CacheKey(uint64_t fingerprint) const {
+	uint64_t state[3] = {_space->Hash(), fingerprint, SNAPSHOT_VERSION}; 
+	return HashBytes(state, sizeof(state)); 
+}
+
+bool FEMatrix::AddIntegrators(const Array<BilinearIntegrator*>& integs, const string& dir) {
+	CH_TIMERS_COARSE("cached fematrix assembly"); 
+	uint64_t fingerprint = _fingerprint; 
+	bool exact = _exact; 
+	for (int i=0; i<integs.GetSize(); i++) {
+		exact = exact && integs[i]->Fingerprint(fingerprint); 
+	}
+	// a key that does not identify the operator could map a stale one 
+	if (!exact) {
+		for (int i=0; i<integs.GetSize(); i++) {
+			AddIntegrator(integs[i]); 
+		}
+		return false; 
+	}
+	uint64_t key = CacheKey(fingerprint); 
+	string name = SnapshotName(dir, "fematrix", key); 
+	if (Map(name, key)) {
+		for (int i=0; i<integs.GetSize(); i++) {
+			delete integs[i]; 
+		}
+		_fingerprint = fingerprint; 
+		return true; 
+	}
+
+	for (int i=0; i<integs.GetSize(); i++) {
+		AddIntegrator(integs[i]); 
+	}
+	SnapshotWriter snap(name, key); 
+	Save(snap); 
+	snap.Close(); 
+	return false; 
+}
+
+void FEMatrix::Save(SnapshotWriter& snap) const {
+	CH_TIMERS_COARSE("save fematrix snapshot"); 
+	snap.Add("fem_packed", (int)_packed); 
+	snap.Add("fem_doff", _doffsets); 
+	snap.Add("fem_vdofs", _vdofs); 
+	snap.Add("fem_mats", sizeof(double), _offsets[GetNumElements()], Mats()); 
+}
+
+bool FEMatrix::Map(const string& name, uint64_t key) {
+	CH_TIMERS_COARSE("map fematrix snapshot"); 
+	shared_ptr<SnapshotReader> snap = make_shared<SnapshotReader>(name, key); 
+	if (!snap->Good() || !snap->Has("fem_mats")) return false; 
+
+	// the element sizes and vdofs must match this space 
+	int64_t ndoff, nvdofs, nmats; 
+	const void* doffsets = snap->GetData("fem_doff", sizeof(int), ndoff); 
+	const void* vdofs = snap->GetData("fem_vdofs", sizeof(int), nvdofs); 
+	if (ndoff != _doffsets.GetSize() || nvdofs != _vdofs.GetSize() 
+		|| memcmp(doffsets, _doffsets.GetData(), ndoff*sizeof(int)) != 0 
+		|| memcmp(vdofs, _vdofs.GetData(), nvdofs*sizeof(int)) != 0) return false; 
+
+	bool packed = _packed; 
+	_packed = snap->GetInt("fem_packed"); 
+	SetOffsets(); 
+	const double* mats = (const double*)snap->GetData("fem_mats", sizeof(double), nmats); 
+	if (nmats != _offsets[GetNumElements()]) {
+		_packed = packed; 
+		SetOffsets(); 
+		return false; 
+	}
+
+	// release the assembled batch, pages of the mapped one are read on first touch 
+	_mats = Array<double>(); 
+	_mapped = mats; 
+	_map = snap; 
+	return true; 
+}
+
+void FEMatrix::CopyMapped() {
+	CH_TIMERS_COARSE("copy mapped fematrix"); 
+	_mats.Resize(_offsets[GetNumElements()]); 
+	if (_mats.GetSize()) memcpy(_mats.GetData(), _mapped, _mats.GetSize()*sizeof(double)); 
+	_mapped = NULL; 
+	_map.reset(); 
+}
+
 void FEMatrix::ApplyDirichletBoundary(RHS& rhs, double val) {
+	Own(); 
+	const char tag[] = "dirichlet"; 
+	_fingerprint = HashBytes(tag, sizeof(tag), _fingerprint); 
+	_fingerprint = HashBytes(&val, sizeof(val), _fingerprint); 
 
 	// eliminate into rhs 
 	for (int e=0; e<_space->GetNumElements(); e++) {
-		Element& bel = _space->GetEl(e); 
+		ElementHandle bel_view; 
+		Element& bel = _space->GetEl(e, bel_view); 
 		for (int n=0; n<bel.GetNumNodes(); n++) {
 			if (bel[n].GetBC()==DIRICHLET) {
-				Matrix& elmat = (*this)[e]; 
+				MatrixView elmat = El(e); 
 				for (int i=0; i<elmat.Width(); i++) {
 					rhs[bel[i].GetGlobalID()] -= val * elmat(i,n); 
 				}
@@ -94,10 +287,11 @@ void FEMatrix::ApplyDirichletBoundary(RHS& rhs, double val) {
 
 	// overwrite boundaries to 0 
 	for (int e=0; e<_space->GetNumElements(); e++) {
-		Element& bel = _space->GetEl(e); 
+		ElementHandle bel_view; 
+		Element& bel = _space->GetEl(e, bel_view); 
 		for (int n=0; n<bel.GetNumNodes(); n++) {
 			if (bel[n].GetBC()==DIRICHLET) {
-				Matrix& elmat = (*this)[e]; 
+				MatrixView elmat = El(e); 
 				for (int i=0; i<bel.GetNumNodes(); i++) {
 					elmat(i,n) = 0.; 
 					elmat(n,i) = 0.; 
@@ -110,10 +304,11 @@ void FEMatrix::ApplyDirichletBoundary(RHS& rhs, double val) {
 	Array<int> bins(_space->GetNumNodes()); 
 	bins = -1;
 	for (int e=0; e<_space->GetNumElements(); e++) {
-		Element& bel = _space->GetEl(e); 
+		ElementHandle bel_view; 
+		Element& bel = _space->GetEl(e, bel_view); 
 		for (int n=0; n<bel.GetNumNodes(); n++) {
 			if (bel[n].GetBC()==DIRICHLET) {
-				Matrix& elmat = (*this)[e]; 
+				MatrixView elmat = El(e); 
 				if (bins[bel[n].GetGlobalID()]<0) {
 					elmat(n,n) = 1.; 
 					bins[bel[n].GetGlobalID()] = 1;
@@ -124,7 +319,8 @@ void FEMatrix::ApplyDirichletBoundary(RHS& rhs, double val) {
 
 	// set rhs to bc value 
 	for (int e=0; e<_space->GetNumElements(); e++) {
-		Element& bel = _space->GetEl(e); 
+		ElementHandle bel_view; 
+		Element& bel = _space->GetEl(e, bel_view); 
 		for (int n=0; n<bel.GetNumNodes(); n++) {
 			if (bel[n].GetBC()==DIRICHLET) {
 				rhs[bel[n].GetGlobalID()] = val; 
@@ -135,11 +331,13 @@ void FEMatrix::ApplyDirichletBoundary(RHS& rhs, double val) {
 
 void FEMatrix::ConvertToSparseMatrix(SparseMatrix& spmat) const {
 	spmat.Resize(_space->GetVSize()); 
-	for (int e=0; e<_space->GetNumElements(); e++) {
-		Element& el = _space->GetEl(e); 
-		for (int i=0; i<el.GetNumNodes(); i++) {
-			for (int j=0; j<el.GetNumNodes(); j++) {
-				spmat(el[i].GetGlobalID(), el[j].GetGlobalID()) += (*this)[e](i,j); 
+	for (int e=0; e<GetNumElements(); e++) {
+		int n = GetElSize(e); 
+		const MatrixView A = (*this)[e]; 
+		const int* dofs = &_vdofs[_doffsets[e]]; 
+		for (int i=0; i<n; i++) {
+			for (int j=0; j<n; j++) {
+				spmat(dofs[i], dofs[j]) += A(i,j); 
 			}
 		}
 	}
@@ -147,24 +345,29 @@ void FEMatrix::ConvertToSparseMatrix(SparseMatrix& spmat) const {
 
 void FEMatrix::GetDiagonal(Vector& diag) const {
 	diag.SetSize(Height()); 
-
-	for (int e=0; e<_space->GetNumElements(); e++) {
-		Element& el = _space->GetEl(e); 
-		const Matrix& elmat = (*this)[e]; 
-		for (int i=0; i<elmat.Height(); i++) {
-			diag[el[i].GetGlobalID()] += elmat(i,i); 
+	diag = 0.; 
+	for (int e=0; e<GetNumElements(); e++) {
+		int n = GetElSize(e); 
+		const MatrixView A = (*this)[e]; 
+		const int* dofs = &_vdofs[_doffsets[e]]; 
+		for (int i=0; i<n; i++) {
+			diag[dofs[i]] += A(i,i); 
 		}
 	}
 }
 
 void FEMatrix::DiagonalPrecondition(const Vector& diag) {
 	CHECK(diag.GetSize() == Height()); 
-	for (int e=0; e<_space->GetNumElements(); e++) {
-		Element& el = _space->GetEl(e); 
-		Matrix& elmat = (*this)[e]; 
-		for (int i=0; i<elmat.Height(); i++) {
-			for (int j=0; j<elmat.Width(); j++) {
-				elmat(i,j) /= (diag[el.GetNodeGlobalID(i)]*diag[el.GetNodeGlobalID(j)]); 
+	Own(); 
+	_fingerprint = HashBytes(diag.GetData(), diag.GetSize()*sizeof(double), _fingerprint); 
+	for (int e=0; e<GetNumElements(); e++) {
+		int n = GetElSize(e); 
+		MatrixView A = El(e); 
+		const int* dofs = &_vdofs[_doffsets[e]]; 
+		for (int i=0; i<n; i++) {
+			// packed entries are shared between (i,j) and (j,i) so only scale once 
+			for (int j=(_packed ? i : 0); j<n; j++) {
+				A(i,j) /= diag[dofs[i]]*diag[dofs[j]]; 
 			}
 		}
 	}
@@ -172,29 +375,61 @@ void FEMatrix::DiagonalPrecondition(const Vector& diag) {
 
 void FEMatrix::operator-=(const FEMatrix& A) {
 	CHECK(Height() == A.Height()); 
-	for (int e=0; e<_space->GetNumElements(); e++) {
-		(*this)[e] -= A[e]; 
+	Own(); 
+	const char tag[] = "subtract"; 
+	_fingerprint = HashBytes(tag, sizeof(tag), _fingerprint); 
+	_fingerprint = HashBytes(&A._fingerprint, sizeof(A._fingerprint), _fingerprint); 
+	_exact = _exact && A._exact; 
+	if (_packed && !A.IsPacked()) Unpack(); 
+	if (_packed != A.IsPacked()) {
+		for (int e=0; e<GetNumElements(); e++) {
+			MatrixView me = El(e); 
+			const MatrixView ae = A[e]; 
+			for (int i=0; i<me.Height(); i++) {
+				for (int j=0; j<me.Width(); j++) {
+					me(i,j) -= ae(i,j); 
+				}
+			}
+		}
+		return; 
+	}
+	CHECK(_offsets[GetNumElements()] == A._offsets[A.GetNumElements()]); 
+#ifdef RV_VECSUB
+	VectorSub_RV(_mats.GetSize(), _mats.GetData(), A.GetBatch()); 
+#else
+	const double* adata = A.GetBatch(); 
+	for (int i=0; i<_mats.GetSize(); i++) {
+		_mats[i] -= adata[i]; 
 	}
+#endif
 }
 
-void FEMatrix::ConvertToBatch() {
-#if defined RV_MVOUTER || defined RV_MVOUTERC 
-	int Ne = _space->GetNumElements(); 
-	int N = _data[0]->Height(); 
-	_mats.Resize(N*N*Ne); 
-	_vdofs.Resize(N*Ne); 
-	Array<int> vdofs; 
-
-	for (int e=0; e<Ne; e++) {
-		vdofs = _space->GetVDofs(e); 
-		for (int i=0; i<N; i++) {
-			for (int j=0; j<N; j++) {
-				_mats[N*N*e + N*i + j] = _data[e]->operator()(i,j); 
+void FEMatrix::Unpack() {
+	if (!_packed) return; 
+	Own(); 
+	Array<double> packed = _mats; 
+	Array<int> poffsets = _offsets; 
+	_packed = false; 
+	SetOffsets(); 
+	_mats.Resize(_offsets[GetNumElements()]); 
+	for (int e=0; e<GetNumElements(); e++) {
+		int n = GetElSize(e); 
+		const MatrixView src(&packed[poffsets[e]], n, n, MatrixView::SYMMETRIC_PACKED); 
+		MatrixView dst = El(e); 
+		for (int i=0; i<n; i++) {
+			for (int j=0; j<n; j++) {
+				dst(i,j) = src(i,j); 
 			}
-			_vdofs[N*e+i] = vdofs[i]; 
 		}
 	}
-#endif
+}
+
+void FEMatrix::SetOffsets() {
+	int Ne = GetNumElements(); 
+	_offsets.Resize(Ne+1); 
+	for (int e=0; e<Ne; e++) {
+		_offsets[e+1] = _offsets[e] + StoredSize(GetElSize(e)); 
+	}
 }
 
 } // end namespace fem 
\ No newline at end of file
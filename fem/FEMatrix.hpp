@@ -3,6 +3,7 @@
 #include "General.hpp"
 #include "Operator.hpp"
 #include "Vector.hpp"
+#include "MatrixView.hpp"
 #include "FESpace.hpp"
 #include "Array.hpp"
 #include "Quadrature.hpp"
@@ -10,6 +11,8 @@
 #include "BilinearIntegrator.hpp"
 #include "RHS.hpp"
 #include "SparseMatrix.hpp"
+#include "Snapshot.hpp"
+#include <memory>
 
 #ifdef USE_RISCV
 // b batches of NxN scattered matvecs 
@@ -29,31 +32,82 @@ extern "C" void MVOuterC_RV(int N, int B, const double* mats,
 	const int* dofs, const double* x, double* b); 
 // scatter add with reduced vl to avoid aliasing 
 extern "C" void BatchAdd_RV(int N, int B, const int* dofs, double* ball, double* b); 
+// b batches of NxN symmetric matvecs stored as packed upper triangles 
+extern "C" void MVOuterSym_RV(int N, int B, const double* mats, 
+	const int* dofs, const double* x, double* b); 
 #endif
 
 namespace fem 
 {
 
+/// add the products of a range of elemental matrices with x to b 
+/** multiplies the matrices of elements [e0, e1), stored back to back starting at mats 
+	(element e's at mats + offsets[e] - offsets[e0]), with the entries of x at their 
+	vdofs (element e's at vdofs + doffsets[e]). N is the common matrix size 
+	(-1 if the sizes differ) and Nmax the largest */ 
+void BatchMult(int e0, int e1, int N, int Nmax, bool packed, const double* mats, 
+	const int* offsets, const int* doffsets, const int* vdofs, const double* x, double* b); 
+
 /// store an element by element finite element matrix 
-class FEMatrix : public Operator {
+/** the elemental matrices are assembled directly into one contiguous batch 
+	(row major, element after element) along with their vdofs. 
+	While every added integrator is symmetric only the upper triangles 
+	are stored (symmetric packed). 
+	The batch can be cached on disk keyed by the space and the integrators that built it 
+	(see AddIntegrators). A cached batch is mapped read-only and the matvec streams it 
+	straight from the page cache. It is copied into memory the first time it is modified */ 
+class FEMatrix : public Operator, private MatrixViewOwner {
 public:
 	/// default constructor 
-	FEMatrix() { }
-	/// deconstructor 
-	~FEMatrix(); 
+	FEMatrix() {_space = NULL; _N = 0; _Nmax = 0; _packed = false; _fingerprint = 0; _exact = true; _mapped = NULL; }
 	/// construct and set size 
 	FEMatrix(const FESpace* space); 
 	/// matrix vector product 
 	void Mult(const Vector& x, Vector& b) const; 
 	/// access elemental matrices 
-	Matrix& operator[](int el) {return *_data[el]; }
+	/** symmetric updates (scaling, adding a symmetric Matrix) keep packed storage. 
+		A non-symmetric one, including a write to an off diagonal entry, unpacks the 
+		whole batch first, which invalidates views taken before it. Writes through 
+		the view are not fingerprinted, so the matrix is no longer cached */ 
+	MatrixView operator[](int el) {
+		MatrixView view = El(el); 
+		view.SetOwner(this, el); 
+		return view; 
+	}
 	/// const access to elemental matrices 
-	const Matrix& operator[](int el) const {
-		CH_TIMERS("get el matrix"); 
-		return *_data[el]; 
+	const MatrixView operator[](int el) const {
+		return MatrixView(const_cast<double*>(Mats() + _offsets[el]), 
+			GetElSize(el), GetElSize(el), 
+			_packed ? MatrixView::SYMMETRIC_PACKED : MatrixView::DENSE); 
 	}
 	/// add a bilinear integrator 
 	void AddIntegrator(BilinearIntegrator* integ); 
+	/// add several integrators, reusing the batch cached by an earlier run if there is one 
+	/** the cache file in dir is keyed by the space's Hash, the fingerprints of everything 
+		already applied to this matrix, and the integrators' fingerprints. On a miss the 
+		integrators are added one by one and the result is saved. If anything applied so far 
+		cannot be fingerprinted exactly (see IsCacheable) the cache is not used at all. 
+		Takes ownership of integs 
+		\returns true if the batch was mapped from the cache */ 
+	bool AddIntegrators(const Array<BilinearIntegrator*>& integs, const std::string& dir=""); 
+	/// add the batch, its vdofs, and the storage format to a snapshot 
+	void Save(SnapshotWriter& snap) const; 
+	/// map the batch saved in snapshot name read-only instead of assembling it 
+	/** returns false (leaving the matrix unchanged) if the file is missing, 
+		does not match key, or was saved for different vdofs */ 
+	bool Map(const std::string& name, uint64_t key); 
+	/// return true if the batch is still read from a mapped snapshot 
+	bool IsMapped() const {return _mapped != NULL; }
+	/// return the fingerprint of the integrators and modifications applied so far 
+	uint64_t GetFingerprint() const {return _fingerprint; }
+	/// return true if the fingerprint identifies the matrix exactly 
+	/** false once an integrator or coefficient without an exact fingerprint (e.g. a 
+		FunctionCoefficient without a key) or a write through operator[] was applied */ 
+	bool IsCacheable() const {return _exact; }
+	/// return the name of the cache file in dir holding the matrix in its current state 
+	std::string GetCacheName(const std::string& dir="") const {
+		return SnapshotName(dir, "fematrix", CacheKey(_fingerprint)); 
+	}
 	/// apply dirichlet boundary conditions 
 	void ApplyDirichletBoundary(RHS& rhs, double val=0); 
 	/// convert from element by element to a general SparseMatrix 
@@ -62,20 +116,74 @@ public:
 	void GetDiagonal(Vector& diag) const; 
 	/// diagonal preconditioning on this matrix 
 	void DiagonalPrecondition(const Vector& diag); 
-	/// convert to batch storage format 
-	void ConvertToBatch(); 
 
 	/// subtract two FEMatrix's 
 	void operator-=(const FEMatrix& A); 
+	/// expand symmetric packed storage to full matrices 
+	void Unpack(); 
+	/// return true if the batch stores packed upper triangles 
+	bool IsPacked() const {return _packed; }
+
+	/// return the number of elemental matrices 
+	int GetNumElements() const {return _doffsets.GetSize()-1; }
+	/// return the size of element el's matrix 
+	int GetElSize(int el) const {return _doffsets[el+1] - _doffsets[el]; }
+	/// return the common elemental matrix size (-1 if elements differ) 
+	int GetBatchSize() const {return _N; }
+	/// access the contiguous matrix storage (GetNumElements()+1 offsets worth of entries) 
+	const double* GetBatch() const {return Mats(); }
+	/// access the contiguous vdof storage 
+	const Array<int>& GetBatchVDofs() const {return _vdofs; }
 protected:
-	/// store the elemental matrices 
-	Array<Matrix*> _data; 
 	/// store the fespace 
 	const FESpace* _space; 
 	/// store data for all matrices contiguously 
 	Array<double> _mats; 
 	/// store the vdofs for each element contiguously 
 	Array<int> _vdofs; 
+	/// start of each element's matrix in _mats 
+	Array<int> _offsets; 
+	/// start of each element's vdofs in _vdofs 
+	Array<int> _doffsets; 
+	/// size of the elemental matrices if they all match, -1 otherwise 
+	int _N; 
+	/// largest elemental matrix size 
+	int _Nmax; 
+	/// true if only the upper triangles are stored 
+	bool _packed; 
+	/// number of stored entries for an n x n elemental matrix 
+	int StoredSize(int n) const {return _packed ? n*(n+1)/2 : n*n; }
+	/// set _offsets from the current storage format 
+	void SetOffsets(); 
+	/// key of the cache file for the matrix with the given fingerprint 
+	uint64_t CacheKey(uint64_t fingerprint) const; 
+	/// fingerprint of everything applied to the matrix 
+	uint64_t _fingerprint; 
+	/// true while _fingerprint identifies the matrix exactly 
+	bool _exact; 
+	/// access elemental matrices without giving up the fingerprint 
+	MatrixView El(int el) {
+		Own(); 
+		return MatrixView(&_mats[_offsets[el]], GetElSize(el), GetElSize(el), 
+			_packed ? MatrixView::SYMMETRIC_PACKED : MatrixView::DENSE); 
+	}
+	/// a write through operator[] leaves the fingerprint behind 
+	void ViewModified(int el) {_exact = false; }
+	/// unpack for a non-symmetric write through operator[] 
+	MatrixView ViewUnpacked(int el) {
+		Unpack(); 
+		return El(el); 
+	}
+	/// snapshot the batch is mapped from (NULL once the batch is owned) 
+	std::shared_ptr<SnapshotReader> _map; 
+	/// mapped batch (NULL if _mats holds it) 
+	const double* _mapped; 
+	/// return the batch wherever it lives 
+	const double* Mats() const {return (_mapped) ? _mapped : _mats.GetData(); }
+	/// copy a mapped batch into _mats before it is modified 
+	void Own() {if (_mapped) CopyMapped(); }
+	/// copy the mapped batch into _mats and release the mapping 
+	void CopyMapped(); 
 }; 
 
 } // end namespace fem 
\ No newline at end of file
@@ -1,5 +1,7 @@
 #include "FESpace.hpp"
 #include "Quadrature.hpp"
+#include "GeometricFactors.hpp"
+#include "Snapshot.hpp"
 #ifdef USE_MPI 
 #include <mpi.h> 
 #endif
@@ -11,42 +13,298 @@ namespace fem
 
 FESpace::~FESpace() {
 	// clean up elements
-	for (int i=0; i<GetNumElements(); i++) {
+	for (int i=0; i<_el.GetSize(); i++) {
 		delete _el[i]; 
 	}
+	if (_gcache) delete _gcache; 
 }
 
 void FESpace::GetVDofs(int e, Array<int>& vdofs) const {
-	vdofs = _vdofs[e]; 
+	if (!_compact) {
+		vdofs = _vdofs[e]; 
+		return; 
+	}
+	int off = _el_offsets[e]; 
+	int nn = _el_offsets[e+1] - off; 
+	vdofs.Resize(_vdim*nn); 
+	for (int d=0; d<_vdim; d++) {
+		for (int i=0; i<nn; i++) {
+			vdofs[nn*d+i] = _vdim*_el_dofs[off+i] + d; 
+		}
+	}
 }
 
 const Array<int>& FESpace::GetVDofs(int e) const {
+	if (_compact) ERROR("compact spaces do not store vdofs, use GetVDofs(e, vdofs)"); 
 	return _vdofs[e]; 
 }
 
 FESpace::FESpace(const Mesh& mesh, int order, int vdim) : _mesh(mesh), _order(order) {
 	_dim = _mesh.GetDim(); 
 	_vdim = vdim; 
+	_gcache = NULL; 
+	_compact = false; 
+	_view_clock = 0; 
+}
+
+void FESpace::EnableGeometricCache() {
+	if (_gcache) return; 
+	_gcache = new GeometricCache(*this); 
+	for (int e=0; e<_el.GetSize(); e++) {
+		_el[e]->GetTrans().SetGeometricCache(_gcache, e); 
+	}
+	for (int i=0; i<_views.GetSize(); i++) {
+		if (_views[i]) _views[i]->GetTrans().SetGeometricCache(_gcache, _view_ids[i]); 
+	}
+}
+
+void FESpace::Compact() {
+	if (_compact) return; 
+	CH_TIMERS_COARSE("compact fespace"); 
+	int Ne = _el.GetSize(); 
+	for (int e=0; e<Ne; e++) {
+		AppendCompact(*_el[e]); 
+	}
+	_bel_ids.Resize(_bel.GetSize()); 
+	for (int i=0; i<_bel.GetSize(); i++) {
+		_bel_ids[i] = _bel[i]->GetID(); 
+	}
+
+	// release the per element objects 
+	for (int e=0; e<Ne; e++) {
+		delete _el[e]; 
+	}
+	Array<Element*>().Swap(_el); 
+	Array<Element*>().Swap(_bel); 
+	Array<Array<int>>().Swap(_vdofs); 
+
+	// keep only the location and boundary condition of the nodes 
+	Array<Node> nodes; 
+	nodes.Swap(_nodes); 
+	Array<Node>().Swap(_bnodes); 
+	_compact = true; 
+	ResizeNodes(nodes.GetSize()); 
+	for (int i=0; i<nodes.GetSize(); i++) {
+		CHECKMSG(nodes[i].GetGlobalID() == i, "compact storage requires nodes numbered by index"); 
+		SetNode(i, nodes[i]); 
+	}
+	FindBoundaryNodes(); 
+	InitViews(); 
+}
+
+void FESpace::ResizeNodes(int N) {
+	if (!_compact) {
+		_nodes.Resize(N); 
+		return; 
+	}
+	// Resize zeroes numeric arrays, so grow by appending 
+	CHECK(N >= GetNumNodes()); 
+	for (int i=GetNumNodes(); i<N; i++) {
+		for (int d=0; d<DIM; d++) {
+			_node_x.Append(0.); 
+		}
+		_node_bc.Append(INTERIOR); 
+	}
+}
+
+void FESpace::SetNode(int ind, const Node& node) {
+	if (!_compact) {
+		_nodes[ind] = node; 
+		return; 
+	}
+	for (int d=0; d<DIM; d++) {
+		_node_x[DIM*ind+d] = node.GetX()[d]; 
+	}
+	_node_bc[ind] = node.GetBC(); 
+}
+
+void FESpace::FindBoundaryNodes() {
+	for (int i=0; i<GetNumNodes(); i++) {
+		if (GetNodeBC(i) == INTERIOR) continue; 
+		if (_compact) _bnode_ids.Append(i); 
+		else _bnodes.Append(_nodes[i]); 
+	}
+}
+
+void FESpace::AppendCompact(const Element& el) {
+	CHECKMSG(el.GetID() == _el_type.GetSize(), "compact storage requires elements numbered by index"); 
+	if (_el_offsets.GetSize() == 0) _el_offsets.Append(0); 
+	if (_el_noffsets.GetSize() == 0) _el_noffsets.Append(0); 
+	for (int i=0; i<el.GetNumNodes(); i++) {
+		_el_dofs.Append(el.GetNodeGlobalID(i)); 
+	}
+	_el_offsets.Append(_el_dofs.GetSize()); 
+	_el_type.Append(el.GetType()); 
+	_el_tag.Append(el.GetTag()); 
+	for (int f=0; f<FacesPerEl(el.GetType()); f++) {
+		_el_neighbors.Append(el.GetNeighbor(f)); 
+	}
+	_el_noffsets.Append(_el_neighbors.GetSize()); 
+}
+
+void FESpace::InitViews() {
+	int nslots = FESPACE_VIEW_SETS*FESPACE_VIEW_WAYS; 
+	_views.Resize(nslots); 
+	_views = ElementHandle(); 
+	_view_ids.Resize(nslots); 
+	_view_ids = -1; 
+	_view_age.Resize(nslots); 
+	_view_age = 0; 
+}
+
+void FESpace::Save(SnapshotWriter& snap) {
+	CH_TIMERS_COARSE("save fespace snapshot"); 
+	Compact(); 
+	snap.Add("sp_order", _order); 
+	snap.Add("sp_vdim", _vdim); 
+	snap.Add("sp_dim", _dim); 
+	snap.Add("sp_tags", _unique_tags); 
+	snap.Add("sp_node_x", _node_x); 
+	snap.Add("sp_node_bc", _node_bc); 
+	snap.Add("sp_bnode_ids", _bnode_ids); 
+	snap.Add("sp_el_off", _el_offsets); 
+	snap.Add("sp_el_dofs", _el_dofs); 
+	snap.Add("sp_el_type", _el_type); 
+	snap.Add("sp_el_tag", _el_tag); 
+	snap.Add("sp_el_noff", _el_noffsets); 
+	snap.Add("sp_el_nbr", _el_neighbors); 
+	snap.Add("sp_bel_ids", _bel_ids); 
+}
+
+uint64_t FESpace::Hash() const {
+	int params[4] = {_order, _vdim, GetNumNodes(), GetNumElements()}; 
+	uint64_t h = HashBytes(params, sizeof(params)); 
+	Array<double> x(DIM*GetNumNodes()); 
+	Array<int> bc(GetNumNodes()); 
+	for (int i=0; i<GetNumNodes(); i++) {
+		Point p = GetNodeX(i); 
+		for (int d=0; d<DIM; d++) {
+			x[DIM*i+d] = p[d]; 
+		}
+		bc[i] = GetNodeBC(i); 
+	}
+	if (GetNumNodes()) {
+		h = HashBytes(&x[0], x.GetSize()*sizeof(double), h); 
+		h = HashBytes(&bc[0], bc.GetSize()*sizeof(int), h); 
+	}
+	Array<int> vdofs; 
+	for (int e=0; e<GetNumElements(); e++) {
+		GetVDofs(e, vdofs); 
+		int type = GetElType(e); 
+		h = HashBytes(&type, sizeof(type), h); 
+		if (vdofs.GetSize()) h = HashBytes(&vdofs[0], vdofs.GetSize()*sizeof(int), h); 
+	}
+	return h; 
+}
+
+void FESpace::Load(const SnapshotReader& snap) {
+	CH_TIMERS_COARSE("load fespace snapshot"); 
+	CHECKMSG(snap.GetInt("sp_order") == _order && snap.GetInt("sp_vdim") == _vdim, 
+		"snapshot does not match the order and vector dimension of the space"); 
+	_dim = snap.GetInt("sp_dim"); 
+	snap.Get("sp_tags", _unique_tags); 
+	snap.Get("sp_node_x", _node_x); 
+	snap.Get("sp_node_bc", _node_bc); 
+	snap.Get("sp_bnode_ids", _bnode_ids); 
+	snap.Get("sp_el_off", _el_offsets); 
+	snap.Get("sp_el_dofs", _el_dofs); 
+	snap.Get("sp_el_type", _el_type); 
+	snap.Get("sp_el_tag", _el_tag); 
+	snap.Get("sp_el_noff", _el_noffsets); 
+	snap.Get("sp_el_nbr", _el_neighbors); 
+	snap.Get("sp_bel_ids", _bel_ids); 
+	CHECKMSG(_el_type.GetSize() == _mesh.GetNumElements(), "snapshot does not match the mesh"); 
+	InitViews(); 
+	_compact = true; 
+}
+
+int FESpace::ViewSlot(int e) const {
+	int set = (e % FESPACE_VIEW_SETS) * FESPACE_VIEW_WAYS; 
+	int slot = set; 
+	for (int w=0; w<FESPACE_VIEW_WAYS; w++) {
+		if (_view_ids[set+w] == e) {
+			_view_age[set+w] = ++_view_clock; 
+			return set+w; 
+		}
+		if (_view_age[set+w] < _view_age[slot]) slot = set+w; 
+	}
+
+	// replace the least recently used view of the set. Unless a caller still holds 
+	// it, its element is moved onto e in place instead of building a new one 
+	CH_TIMERS_FINE("build element view"); 
+	ElementHandle& view = _views[slot]; 
+	if (view && view.use_count() == 1 && view->GetType() == GetElType(e)) {
+		view->Reset(_mesh, e); 
+	} else {
+		view.reset(CreateElement(e)); 
+	}
+	Element* el = view.get(); 
+	CHECK(el->GetNumNodes() == GetElNumNodes(e)); 
+	int off = _el_offsets[e]; 
+	for (int i=0; i<el->GetNumNodes(); i++) {
+		el->GetNode(i).SetGlobalID(_el_dofs[off+i]); 
+	}
+	el->SetID(e); 
+	el->SetTag(_el_tag[e]); 
+	for (int f=_el_noffsets[e]; f<_el_noffsets[e+1]; f++) {
+		el->SetNeighbor(f - _el_noffsets[e], _el_neighbors[f]); 
+	}
+	el->GetTrans().SetGeometricCache(_gcache, e); 
+	_view_ids[slot] = e; 
+	_view_age[slot] = ++_view_clock; 
+	return slot; 
 }
 
 Element& FESpace::GetEl(int ind) const {
+	if (_compact) ERROR("compact spaces hand out element views, use GetEl(ind, view)"); 
 	return *_el[ind]; 
 }
 
+Element& FESpace::GetEl(int ind, ElementHandle& view) const {
+	if (!_compact) return *_el[ind]; 
+	// let go of the previous view first so the cache can move it in place 
+	view.reset(); 
+	view = _views[ViewSlot(ind)]; 
+	return *view; 
+}
+
+ElementHandle FESpace::GetElView(int ind) const {
+	if (_compact) return _views[ViewSlot(ind)]; 
+	// the space owns its elements, so the handle does not share ownership 
+	return ElementHandle(ElementHandle(), _el[ind]); 
+}
+
 Element& FESpace::GetBoundaryEl(int ind) const {
+	if (_compact) ERROR("compact spaces hand out element views, use GetBoundaryEl(ind, view)"); 
 	return *_bel[ind]; 
 }
 
+Element& FESpace::GetBoundaryEl(int ind, ElementHandle& view) const {
+	if (!_compact) return *_bel[ind]; 
+	return GetEl(_bel_ids[ind], view); 
+}
+
 const Node& FESpace::GetNode(int ind) const {
+	if (_compact) ERROR("compact spaces do not store Nodes, use GetNodeX and GetNodeBC"); 
 	return _nodes[ind]; 
 }
 
 const Node& FESpace::GetBoundaryNode(int ind) const {
+	if (_compact) ERROR("compact spaces do not store Nodes, use GetBoundaryNodeID"); 
 	return _bnodes[ind]; 
 }
 
+Point FESpace::GetNodeX(int ind) const {
+	if (!_compact) return _nodes[ind].GetX(); 
+	Point x; 
+	for (int d=0; d<DIM; d++) {
+		x[d] = _node_x[DIM*ind+d]; 
+	}
+	return x; 
+}
+
 void FESpace::GetFaceTransformations(int e, int f, FaceTransformations& fts) const {
-	Element& el = GetEl(e); 
+	Element& el = GetEl(e, fts.e_el); 
 	fts.e_id = el.GetID(); 
 	fts.ep_id = el.GetNeighbor(f); 
 
@@ -56,10 +314,11 @@ void FESpace::GetFaceTransformations(int e, int f, FaceTransformations& fts) con
 
 	// if ep exists (ie not a physical boundary) 
 	if (fts.ep_id >= 0) {
-		Element& neighb = GetEl(fts.ep_id); 
+		Element& neighb = GetEl(fts.ep_id, fts.ep_el); 
 		fts.ep_iptrans = &neighb.GetFaceRefTrans(e); 
 	} else {
 		fts.ep_iptrans = NULL; 
+		fts.ep_el.reset(); 
 	}
 }
 
@@ -67,11 +326,12 @@ void FESpace::PrintMeshInfo(ostream& out) const {
 	double max = -1.; 
 	double min = numeric_limits<double>::max(); 
 	double avg = 0; 
-	for (int i=0; i<_el.GetSize(); i++) {
-		Quadrature* quad = QRules.Get(_el[i]->GetType(), 
+	for (int i=0; i<GetNumElements(); i++) {
+		Quadrature* quad = QRules.Get(GetElType(i), 
 			INTEGRATION_ORDER, INTEGRATION_TYPE); 
 
-		ElTrans& trans = _el[i]->GetTrans(); 
+		ElementHandle view; 
+		ElTrans& trans = GetEl(i, view).GetTrans(); 
 
 		double a = 0; 
 		for (int j=0; j<quad->NumPoints(); j++) {
@@ -83,7 +343,7 @@ void FESpace::PrintMeshInfo(ostream& out) const {
 		if (a < min) min = a; 
 		avg += a; 
 	}
-	avg /= _el.GetSize(); 
+	avg /= GetNumElements(); 
 
 	out << "Mesh Info:" << endl; 
 	out << "\tNumber of Elements = " << GetNumElements() << endl; 
@@ -1,5 +1,6 @@
 #pragma once 
 
+#include <cstdint>
 #include "General.hpp" 
 #include "Mesh.hpp" 
 #include "Node.hpp"
@@ -9,6 +10,15 @@
 namespace fem 
 {
 
+class GeometricCache; 
+class SnapshotWriter; 
+class SnapshotReader; 
+
+/// number of sets in the compact element view cache 
+#define FESPACE_VIEW_SETS 64 
+/// views per set 
+#define FESPACE_VIEW_WAYS 2 
+
 /// represent a finite element grid 
 class FESpace {
 public:
@@ -21,30 +31,55 @@ public:
 	/// destructor 
 	~FESpace(); 
 	/// return the number of unknowns 
-	int GetNumNodes() const {return _nodes.GetSize(); }
-	/// return the total number of unknowns = _vdim * _nodes.size() 
-	int GetVSize() const {return _vdim * _nodes.GetSize(); }
+	int GetNumNodes() const {return (_compact) ? _node_bc.GetSize() : _nodes.GetSize(); }
+	/// return the total number of unknowns = _vdim * GetNumNodes() 
+	int GetVSize() const {return _vdim * GetNumNodes(); }
 	/// get the global ids correspond to an element 
 	/** \param[in] el element index 
 		\param[out] vdofs Array of global indices (includes vector unknowns)
 	*/ 
 	void GetVDofs(int el, Array<int>& vdofs) const; 
-	/// get vdofs as reference to the array (hopefully faster?) 
+	/// get vdofs as reference to the stored array 
+	/** only spaces with Element storage keep per element vdofs. Compact spaces 
+		(see Compact) fill a caller owned array with GetVDofs(el, vdofs) */ 
 	const Array<int>& GetVDofs(int el) const; 
 	/// return the number of boundary nodes 
-	int GetNBN() const {return _bnodes.GetSize(); }
+	int GetNBN() const {return (_compact) ? _bnode_ids.GetSize() : _bnodes.GetSize(); }
 	/// return the number of elements 
-	int GetNumElements() const {return _el.GetSize(); }
+	int GetNumElements() const {return (_compact) ? _el_type.GetSize() : _el.GetSize(); }
 	/// return the number of boundary elements 
-	int GetNBE() const {return _bel.GetSize(); }
-	/// const access to elements 
+	int GetNBE() const {return (_compact) ? _bel_ids.GetSize() : _bel.GetSize(); }
+	/// access to element ind 
+	/** only for spaces that own their Elements. Code that also runs on compact 
+		spaces uses GetEl(ind, view) */ 
 	Element& GetEl(int ind) const; 
-	/// const access to boundary element ind 
+	/// access to element ind with either storage 
+	/** a compact space builds a view of the element and puts it in view, which keeps 
+		it alive until view is released or reused. Owned elements are returned 
+		without touching view */ 
+	Element& GetEl(int ind, ElementHandle& view) const; 
+	/// shared handle to element ind, built on demand by a compact space 
+	/** the view lives while a handle to it exists, even once the space's cache has 
+		evicted it. For owned elements the handle does not share ownership */ 
+	ElementHandle GetElView(int ind) const; 
+	/// access to boundary element ind (spaces that own their Elements) 
 	Element& GetBoundaryEl(int ind) const; 
-	/// const access to nodes 
+	/// access to boundary element ind with either storage (see GetEl) 
+	Element& GetBoundaryEl(int ind, ElementHandle& view) const; 
+	/// const access to nodes (spaces that own their Elements) 
+	/** compact spaces keep only node coordinates and boundary conditions, 
+		see GetNodeX and GetNodeBC */ 
 	const Node& GetNode(int ind) const; 
-	/// const access to boundary nodes 
+	/// const access to boundary nodes (spaces that own their Elements) 
 	const Node& GetBoundaryNode(int ind) const;
+	/// return the location of node ind with either storage 
+	Point GetNodeX(int ind) const; 
+	/// return the boundary condition of node ind with either storage 
+	int GetNodeBC(int ind) const {return (_compact) ? _node_bc[ind] : _nodes[ind].GetBC(); }
+	/// return the node index of boundary node ind with either storage 
+	int GetBoundaryNodeID(int ind) const {
+		return (_compact) ? _bnode_ids[ind] : _bnodes[ind].GetGlobalID(); 
+	}
 	/// returns all transformations needed for face integration 
 	/** \param[in] e element id 
 		\param[in] ep element id for neighboring element 
@@ -63,7 +98,55 @@ public:
 	}
 	/// return the vector dimension 
 	int GetVDim() const {return _vdim; }
+	/// cache inverse jacobians and determinants for all elements 
+	/** the factors for a quadrature rule are computed in one pass over the space the 
+		first time an element is integrated with it. Call after the nodes are final */ 
+	void EnableGeometricCache(); 
+	/// return the geometric cache (NULL if not enabled) 
+	GeometricCache* GetGeometricCache() const {return _gcache; }
+	/// return the geometry type of element e 
+	int GetElType(int e) const {return (_compact) ? _el_type[e] : _el[e]->GetType(); }
+	/// return the number of nodes of element e 
+	int GetElNumNodes(int e) const {
+		return (_compact) ? _el_offsets[e+1] - _el_offsets[e] : _el[e]->GetNumNodes(); 
+	}
+	/// switch to compact storage 
+	/** replaces the Element objects with flat connectivity, type, tag, and neighbor arrays 
+		and the Node objects with flat coordinate and boundary condition arrays. 
+		GetEl then builds element views on demand from the mesh geometry. A small 
+		set associative cache keeps the most recently used views. Evicting a view 
+		only drops the cache's share of it, so views held by callers stay valid. 
+		Spaces that can should build this storage directly instead (see LagrangeSpace) */ 
+	void Compact(); 
+	/// return true if the space uses compact storage 
+	bool IsCompact() const {return _compact; }
+	/// add the nodes, boundary nodes, and compact connectivity to a snapshot 
+	/** switches the space to compact storage. Geometric factors are not stored, 
+		they are recomputed in one pass the first time they are needed */ 
+	void Save(SnapshotWriter& snap); 
+	/// hash of the nodes, boundary conditions, element types, and vdofs 
+	/** two spaces with the same hash number their unknowns the same way on the same 
+		geometry, so operators assembled on one can be reused on the other */ 
+	uint64_t Hash() const; 
 protected: 
+	/// fill a compact space from a snapshot written by Save 
+	void Load(const SnapshotReader& snap); 
+	/// allocate the empty compact element view cache 
+	void InitViews(); 
+	/// append element el to the compact connectivity, type, tag, and neighbor arrays 
+	void AppendCompact(const Element& el); 
+	/// grow the node storage to N nodes, keeping the stored ones 
+	void ResizeNodes(int N); 
+	/// store node as node ind (only its location and boundary condition on compact spaces) 
+	void SetNode(int ind, const Node& node); 
+	/// list the nodes with a boundary condition as boundary nodes 
+	void FindBoundaryNodes(); 
+	/// build the element for mesh element e (used for compact views) 
+	virtual Element* CreateElement(int e) const {
+		ERROR("element views not supported by this space"); 
+	}
+	/// return the cache slot holding the view of element e, building it if needed 
+	int ViewSlot(int e) const; 
 	/// store reference to mesh 
 	const Mesh& _mesh; 
 	/// fem order 
@@ -84,6 +167,39 @@ protected:
 	Array<int> _unique_tags; 
 	/// store the degrees of freedom corresponding to each element 
 	Array<Array<int>> _vdofs; 
+	/// optional cache of geometric factors 
+	GeometricCache* _gcache; 
+
+	/// true if the elements are stored in the flat arrays below 
+	bool _compact; 
+	/// start of each element's nodes in _el_dofs 
+	Array<int> _el_offsets; 
+	/// global node ids of every element 
+	Array<int> _el_dofs; 
+	/// geometry type of every element 
+	Array<int> _el_type; 
+	/// material tag of every element 
+	Array<int> _el_tag; 
+	/// start of each element's neighbors in _el_neighbors 
+	Array<int> _el_noffsets; 
+	/// neighbor of every element face 
+	Array<int> _el_neighbors; 
+	/// element indices of the boundary elements 
+	Array<int> _bel_ids; 
+	/// location of every node (DIM entries per node) 
+	Array<double> _node_x; 
+	/// boundary condition of every node 
+	Array<int> _node_bc; 
+	/// node indices of the boundary nodes 
+	Array<int> _bnode_ids; 
+	/// cached element views (FESPACE_VIEW_SETS x FESPACE_VIEW_WAYS) 
+	mutable Array<ElementHandle> _views; 
+	/// element held by each view (-1 if empty) 
+	mutable Array<int> _view_ids; 
+	/// access counter of each view for least recently used replacement 
+	mutable Array<int> _view_age; 
+	/// counter for _view_age 
+	mutable int _view_clock; 
 }; 
 
 } // end namespace fem 
\ No newline at end of file
@@ -0,0 +1,186 @@
+#include "GeometricFactors.hpp"
+#include "FESpace.hpp"
+#include "ShapeTable.hpp"
+#include "LagrangeBasis.hpp"
+
+using namespace std; 
+
+namespace fem 
+{
+
+GeometricFactors::GeometricFactors(const FESpace& space, const Quadrature* quad) {
+	CH_TIMERS_COARSE("compute geometric factors"); 
+	_quad = quad; 
+	int Ne = space.GetNumElements(); 
+	int nq = quad->NumPoints(); 
+	ElementHandle view; 
+	_dim = (Ne > 0) ? space.GetEl(0, view).GetDim() : 0; 
+	_affine.Resize(Ne); 
+	_offsets.Resize(Ne+1); 
+	_naffine = 0; 
+
+	// one slot for affine elements, one per point otherwise 
+	int nslots = 0; 
+	for (int e=0; e<Ne; e++) {
+		const Element& el = space.GetEl(e, view); 
+		CHECKMSG(el.GetDim() == _dim && el.GetMeshDim() == _dim,
+			"geometric factors require square jacobians"); 
+		_affine[e] = CheckAffine(el); 
+		if (_affine[e]) _naffine++; 
+		_offsets[e] = nslots; 
+		nslots += (_affine[e]) ? 1 : nq; 
+	}
+	_offsets[Ne] = nslots; 
+	_detJ.Resize(nslots); 
+	_Jinv.Resize(_dim*_dim*nslots); 
+
+	// gather the jacobians J(i,j) = dx_j/dxi_i 
+	for (int e=0; e<Ne; e++) {
+		Element& el = space.GetEl(e, view); 
+		if (_affine[e]) {
+			SetAffineJacobian(el, _offsets[e]); 
+			continue; 
+		}
+		const ShapeTable& table = STables.Get(el, quad); 
+		const Matrix& X = el.GetNodeLocationMatrix(); 
+		int nn = el.GetNumNodes(); 
+		for (int q=0; q<nq; q++) {
+			const double* g = table.GradShape(q); 
+			int s = _offsets[e] + q; 
+			for (int i=0; i<_dim; i++) {
+				for (int j=0; j<_dim; j++) {
+					double sum = 0.; 
+					for (int n=0; n<nn; n++) {
+						sum += g[i*nn+n] * X(n,j); 
+					}
+					_Jinv[(i*_dim+j)*nslots + s] = sum; 
+				}
+			}
+		}
+	}
+
+	InvertAll(); 
+}
+
+bool GeometricFactors::CheckAffine(const Element& el) const {
+	// tensor lagrange nodes lie on the multilinear image of the vertices 
+	if (!el.GetKernels()) return false; 
+	if (el.GetType() != QUAD && el.GetType() != HEX) return false; 
+	const Point& x0 = el.GetNode(0).GetX(); 
+	const Point& x1 = el.GetNode(1).GetX(); 
+	const Point& x3 = el.GetNode(3).GetX(); 
+	double h = 0.; 
+	for (int d=0; d<DIM; d++) {
+		h = max(h, fabs(x1[d]-x0[d]) + fabs(x3[d]-x0[d])); 
+	}
+	double tol = 1e-12*h; 
+
+	// predicted position of vertex v from the edges leaving vertex 0 
+	auto Match = [&](int v, const Point& x) {
+		for (int d=0; d<DIM; d++) {
+			if (fabs(el.GetNode(v).GetX()[d] - x[d]) > tol) return false; 
+		}
+		return true; 
+	}; 
+	Point x2; 
+	for (int d=0; d<DIM; d++) x2[d] = x1[d] + x3[d] - x0[d]; 
+	if (!Match(2, x2)) return false; 
+	if (el.GetType() == QUAD) return true; 
+
+	const Point& x4 = el.GetNode(4).GetX(); 
+	Point x5, x6, x7; 
+	for (int d=0; d<DIM; d++) {
+		x5[d] = x1[d] + x4[d] - x0[d]; 
+		x7[d] = x3[d] + x4[d] - x0[d]; 
+		x6[d] = x2[d] + x4[d] - x0[d]; 
+	}
+	return Match(5, x5) && Match(6, x6) && Match(7, x7); 
+}
+
+void GeometricFactors::SetAffineJacobian(const Element& el, int s) {
+	// reference element is [-1,1]^dim so each edge vector is scaled by 1/2 
+	static const int edge[3] = {1, 3, 4}; 
+	int nslots = _detJ.GetSize(); 
+	const Point& x0 = el.GetNode(0).GetX(); 
+	for (int i=0; i<_dim; i++) {
+		const Point& xi = el.GetNode(edge[i]).GetX(); 
+		for (int j=0; j<_dim; j++) {
+			_Jinv[(i*_dim+j)*nslots + s] = .5*(xi[j] - x0[j]); 
+		}
+	}
+}
+
+void GeometricFactors::InvertAll() {
+	CH_TIMERS_COARSE("invert geometric factors"); 
+	int ns = _detJ.GetSize(); 
+	double* J = _Jinv.GetData(); 
+	double* det = _detJ.GetData(); 
+	// closed form inverses over contiguous component arrays 
+	if (_dim == 1) {
+		for (int s=0; s<ns; s++) {
+			det[s] = J[s]; 
+			J[s] = 1./J[s]; 
+		}
+	} else if (_dim == 2) {
+		double* a = J; double* b = J+ns; double* c = J+2*ns; double* d = J+3*ns; 
+		for (int s=0; s<ns; s++) {
+			double dt = a[s]*d[s] - b[s]*c[s]; 
+			double id = 1./dt; 
+			double a0 = a[s]; 
+			a[s] = d[s]*id; 
+			b[s] = -b[s]*id; 
+			c[s] = -c[s]*id; 
+			d[s] = a0*id; 
+			det[s] = dt; 
+		}
+	} else if (_dim == 3) {
+		double* m[9]; 
+		for (int k=0; k<9; k++) m[k] = J + k*ns; 
+		for (int s=0; s<ns; s++) {
+			double a = m[0][s], b = m[1][s], c = m[2][s]; 
+			double d = m[3][s], e = m[4][s], f = m[5][s]; 
+			double g = m[6][s], h = m[7][s], i = m[8][s]; 
+			double c00 = e*i - f*h, c01 = f*g - d*i, c02 = d*h - e*g; 
+			double dt = a*c00 + b*c01 + c*c02; 
+			double id = 1./dt; 
+			m[0][s] = c00*id; 
+			m[1][s] = (c*h - b*i)*id; 
+			m[2][s] = (b*f - c*e)*id; 
+			m[3][s] = c01*id; 
+			m[4][s] = (a*i - c*g)*id; 
+			m[5][s] = (c*d - a*f)*id; 
+			m[6][s] = c02*id; 
+			m[7][s] = (b*g - a*h)*id; 
+			m[8][s] = (a*e - b*d)*id; 
+			det[s] = dt; 
+		}
+	} else if (ns > 0) {
+		ERROR("geometric factors not defined for dim = " << _dim); 
+	}
+}
+
+void GeometricFactors::GetInverseJacobian(int e, int q, Matrix& Jinv) const {
+	int s = Slot(e,q); 
+	int ns = _detJ.GetSize(); 
+	Jinv.SetSize(_dim); 
+	double* data = Jinv.GetData(); 
+	for (int k=0; k<_dim*_dim; k++) {
+		data[k] = _Jinv[k*ns + s]; 
+	}
+}
+
+GeometricCache::~GeometricCache() {
+	for (auto it=_factors.begin(); it!=_factors.end(); ++it) {
+		delete it->second; 
+	}
+}
+
+const GeometricFactors& GeometricCache::Get(const Quadrature* quad) {
+	auto it = _factors.find(quad); 
+	if (it != _factors.end()) return *it->second; 
+	GeometricFactors* gf = new GeometricFactors(_space, quad); 
+	_factors[quad] = gf; 
+	return *gf; 
+}
+
+} // end namespace fem 
\ No newline at end of file
@@ -0,0 +1,80 @@
+#pragma once 
+
+#include <map>
+#include "General.hpp"
+#include "Array.hpp"
+#include "Matrix.hpp"
+#include "Quadrature.hpp"
+
+namespace fem 
+{
+
+class FESpace; 
+class Element; 
+
+/// inverse jacobians and determinants of every element of a space at the points of one quadrature rule 
+/** stored as a structure of arrays: component (i,j) of \f$ J^{-1} \f$ in slot s is
+	_Jinv[(i*dim+j)*NumSlots() + s]. Elements with a constant jacobian
+	(parallelogram quads and parallelepiped hexes) use a single slot, all other
+	elements use one slot per quadrature point */ 
+class GeometricFactors {
+public:
+	/// compute the factors for all elements of space at the points of quad 
+	GeometricFactors(const FESpace& space, const Quadrature* quad); 
+	/// return the quadrature rule the factors were computed at 
+	const Quadrature* GetQuadrature() const {return _quad; }
+	/// return true if element e has a constant jacobian 
+	bool IsAffine(int e) const {return _affine[e]; }
+	/// return the number of affine elements 
+	int NumAffine() const {return _naffine; }
+	/// return the total number of stored jacobians 
+	int NumSlots() const {return _detJ.GetSize(); }
+	/// location of the factors of element e at quadrature point q 
+	int Slot(int e, int q) const {return _offsets[e] + (_affine[e] ? 0 : q); }
+	/// determinant of the jacobian of element e at quadrature point q 
+	double Determinant(int e, int q) const {return _detJ[Slot(e,q)]; }
+	/// copy the inverse jacobian of element e at quadrature point q into Jinv 
+	void GetInverseJacobian(int e, int q, Matrix& Jinv) const; 
+private:
+	/// return true if el is a parallelogram quad or parallelepiped hex 
+	bool CheckAffine(const Element& el) const; 
+	/// store the constant jacobian of an affine element at slot s 
+	void SetAffineJacobian(const Element& el, int s); 
+	/// invert all stored jacobians in place and compute the determinants 
+	void InvertAll(); 
+
+	/// quadrature rule 
+	const Quadrature* _quad; 
+	/// dimension of the elements 
+	int _dim; 
+	/// true if element e is affine 
+	Array<int> _affine; 
+	/// first slot of each element 
+	Array<int> _offsets; 
+	/// determinants (one per slot) 
+	Array<double> _detJ; 
+	/// jacobian components on input, inverse jacobian components after InvertAll 
+	Array<double> _Jinv; 
+	/// number of affine elements 
+	int _naffine; 
+}; 
+
+/// lazily built GeometricFactors of one space for each quadrature rule it is integrated with 
+class GeometricCache {
+public:
+	/// constructor 
+	GeometricCache(const FESpace& space) : _space(space) { }
+	/// destructor 
+	~GeometricCache(); 
+	/// return the factors for quad, computing them for every element on first use 
+	const GeometricFactors& Get(const Quadrature* quad); 
+	/// return the number of quadrature rules cached 
+	int GetSize() const {return _factors.size(); }
+private:
+	/// space the factors belong to 
+	const FESpace& _space; 
+	/// factors for each quadrature rule 
+	std::map<const Quadrature*, GeometricFactors*> _factors; 
+}; 
+
+} // end namespace fem 
\ No newline at end of file
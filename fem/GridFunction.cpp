@@ -22,7 +22,8 @@ void GridFunction::Project(double (*f)(const Point&)) {
 	for (int i=0; i<_space->GetNumElements(); i++) {
 		Array<int> vdofs; 
 		_space->GetVDofs(i, vdofs); 
-		Element& el = _space->GetEl(i); 
+		ElementHandle view; 
+		Element& el = _space->GetEl(i, view); 
 		for (int j=0; j<vdofs.GetSize(); j++) {
 			(*this)[vdofs[j]] = f(el.GetNode(j).GetX()); 
 		}
@@ -32,7 +33,8 @@ void GridFunction::Project(double (*f)(const Point&)) {
 double GridFunction::EnergyNorm(Quadrature* quad) const {
 	double e = 0; 
 	for (int i=0; i<_space->GetNumElements(); i++) {
-		const Element& el = _space->GetEl(i); 
+		ElementHandle view; 
+		const Element& el = _space->GetEl(i, view); 
 		quad = QRules.Get(el.GetType(), INTEGRATION_ORDER, INTEGRATION_TYPE); 
 		e += el.EnergyNorm(*this, quad); 
 	}
@@ -48,9 +50,10 @@ double GridFunction::L2Error(Coefficient* c) const {
 	Vector vals; 
 	double error = 0.; 
 	for (int n=0; n<_space->GetNumElements(); n++) {
-		Element& el = _space->GetEl(n); 
+		ElementHandle view; 
+		Element& el = _space->GetEl(n, view); 
 		Quadrature* quad = QRules.Get(el.GetType(), 
-			INTEGRATION_ORDER, INTEGRATION_TYPE); 
+			std::max(INTEGRATION_ORDER, el.GetOrder()+1), INTEGRATION_TYPE); 
 		ElTrans& trans = el.GetTrans(); 
 		_space->GetVDofs(n, vdofs); 
 		for (int i=0; i<quad->NumPoints(); i++) {
@@ -5,18 +5,23 @@ using namespace std;
 namespace fem 
 {
 
+Element* L2Space::CreateElement(int e) const {
+	const MeshEl& el = _mesh.GetElement(e); 
+	ASSERT(el.GetType()==QUAD); 
+
+	Array<MeshNode> node_list(4); 
+	for (int j=0; j<4; j++) {
+		node_list[j] = _mesh.GetNode(el[j]); 
+	}
+	return new L2Quad(node_list, _order); 
+}
+
 L2Space::L2Space(const Mesh& mesh, int order) : FESpace(mesh, order) {
 
 	// assign FEM nodes by mesh elements 
 	for (int i=0; i<mesh.GetNumElements(); i++) {
 		const MeshEl& el = mesh.GetElement(i); 
-		ASSERT(el.GetType()==QUAD); 
-
-		Array<MeshNode> node_list(4); 
-		for (int j=0; j<4; j++) {
-			node_list[j] = mesh.GetNode(el[j]); 
-		}
-		_el.Append(new L2Quad(node_list, _order)); 
+		_el.Append(CreateElement(i)); 
 		_el[i]->SetID(i); 
 
 		const Array<int>& neighb = el.GetNeighbors(); 
@@ -43,6 +48,13 @@ L2Space::L2Space(const Mesh& mesh, int order) : FESpace(mesh, order) {
 
 L2Segment::L2Segment(Array<MeshNode> list, int order, int mdim) 
 	: Element(list, order, LINE, mdim) {
+	PlaceNodes(); 
+	_ref = &RefElements.Get(L2_BASIS, LINE, _order, _mdim, BuildReference); 
+}
+
+void L2Segment::PlaceNodes() {
+	const Array<MeshNode>& list = _geo_nodes; 
+	_nodes.Resize(0); 
 	if (_order == 0) {
 		Point avg; 
 		for (int i=0; i<list.GetSize(); i++) {
@@ -67,28 +79,20 @@ L2Segment::L2Segment(Array<MeshNode> list, int order, int mdim)
 	} else {
 		ERROR("order " << _order << " not implemented for L2Segment"); 
 	}
+}
 
-	GenLagrangePolynomials(_order, -1, 1, _p); 
-	// if (_order == 0) {
-	// 	_p.Append(Poly1D({1})); 
-	// } else if (_order == 1) {
-	// 	_p.Append(Poly1D({1, -1})); 
-	// 	_p.Append(Poly1D({0, 1})); 
-	// } else if (_order == 2) {
-	// 	_p.Append(Poly1D({1,-3,2})); 
-	// 	_p.Append(Poly1D({0,-1,2})); 
-	// 	_p.Append(Poly1D({0,4,-4}));
-	// }
-
-	for (int i=0; i<_p.GetSize(); i++) {
-		_dp.Append(_p[i].Derivative()); 
+void L2Segment::BuildReference(ReferenceElement& ref) {
+	GenLagrangePolynomials(ref.order, -1, 1, ref.p); 
+	for (int i=0; i<ref.p.GetSize(); i++) {
+		ref.dp.Append(ref.p[i].Derivative()); 
 	}
 }
 
 void L2Segment::CalcShape(Point x, Vector& shape) const {
 	shape.SetSize(GetNumNodes()); 
-	for (int i=0; i<_p.GetSize(); i++) {
-		shape[i] = _p[i](x[0]); 
+	const Array<Poly1D>& p = _ref->p; 
+	for (int i=0; i<p.GetSize(); i++) {
+		shape[i] = p[i](x[0]); 
 	}
 }
 
@@ -96,13 +100,20 @@ void L2Segment::CalcGradShape(Point x, Matrix& gradshape) const {
 	gradshape.SetSize(_mdim, GetNumNodes()); 
 	for (int d=0; d<_mdim; d++) {
 		for (int i=0; i<GetNumNodes(); i++) {
-			gradshape(d,i) = _dp[i](x[d]); 
+			gradshape(d,i) = _ref->dp[i](x[d]); 
 		}
 	}
 }
 
 L2Quad::L2Quad(Array<MeshNode> node_list, int order, int mdim) 
 	: Element(node_list, order, QUAD, mdim) {
+	PlaceNodes(); 
+	_ref = &RefElements.Get(L2_BASIS, QUAD, _order, _mdim, BuildReference); 
+}
+
+void L2Quad::PlaceNodes() {
+	const Array<MeshNode>& node_list = _geo_nodes; 
+	_nodes.Resize(0); 
 	if (_order == 0) {
 		Point avg; 
 		for (int i=0; i<node_list.GetSize(); i++) {
@@ -155,87 +166,93 @@ L2Quad::L2Quad(Array<MeshNode> node_list, int order, int mdim)
 		ERROR("order " << _order << " not implemented for L2"); 
 	}
 
-	if (_order == 0) {
-		_p.Append(Poly1D({1})); 
-		_pp.Append(PolyProduct(_p[0])); 
+	// setup reference to physical space face transformations 
+	for (int i=0; i<_faceTrans.GetSize(); i++) {
+		int next = (i+1)%_faceTrans.GetSize(); 
+		if (_faceTrans[i]) _faceTrans[i]->Reset({_geo_nodes[i], _geo_nodes[next]}); 
+		else _faceTrans[i] = new L2Segment({_geo_nodes[i], _geo_nodes[next]}, _order, _mdim); 
 	}
-	else if (_order == 1) {
-		_p.Append(Poly1D({1, -1})); 
-		_p.Append(Poly1D({0, 1})); 
-		_pp.Append(PolyProduct(_p[0], _p[0])); 
-		_pp.Append(PolyProduct(_p[1], _p[0])); 
-		_pp.Append(PolyProduct(_p[1], _p[1])); 
-		_pp.Append(PolyProduct(_p[0], _p[1])); 
-	} else if (_order == 2) {
-		_p.Append(Poly1D({1,-3,2})); 
-		_p.Append(Poly1D({0,-1,2})); 
-		_p.Append(Poly1D({0,4,-4}));
+}
 
-		_pp.Append(PolyProduct(_p[0], _p[0])); 
-		_pp.Append(PolyProduct(_p[1], _p[0]));
-		_pp.Append(PolyProduct(_p[1], _p[1]));
-		_pp.Append(PolyProduct(_p[0], _p[1]));
+void L2Quad::BuildReference(ReferenceElement& ref) {
+	if (ref.order == 0) {
+		ref.p.Append(Poly1D({1})); 
+		ref.pp.Append(PolyProduct(ref.p[0])); 
+	}
+	else if (ref.order == 1) {
+		ref.p.Append(Poly1D({1, -1})); 
+		ref.p.Append(Poly1D({0, 1})); 
+		ref.pp.Append(PolyProduct(ref.p[0], ref.p[0])); 
+		ref.pp.Append(PolyProduct(ref.p[1], ref.p[0])); 
+		ref.pp.Append(PolyProduct(ref.p[1], ref.p[1])); 
+		ref.pp.Append(PolyProduct(ref.p[0], ref.p[1])); 
+	} else if (ref.order == 2) {
+		ref.p.Append(Poly1D({1,-3,2})); 
+		ref.p.Append(Poly1D({0,-1,2})); 
+		ref.p.Append(Poly1D({0,4,-4})); 
+
+		ref.pp.Append(PolyProduct(ref.p[0], ref.p[0])); 
+		ref.pp.Append(PolyProduct(ref.p[1], ref.p[0])); 
+		ref.pp.Append(PolyProduct(ref.p[1], ref.p[1])); 
+		ref.pp.Append(PolyProduct(ref.p[0], ref.p[1])); 
 
-		_pp.Append(PolyProduct(_p[2], _p[0]));
-		_pp.Append(PolyProduct(_p[1], _p[2]));
-		_pp.Append(PolyProduct(_p[2], _p[1]));
-		_pp.Append(PolyProduct(_p[0], _p[2]));
-		_pp.Append(PolyProduct(_p[2], _p[2]));
+		ref.pp.Append(PolyProduct(ref.p[2], ref.p[0])); 
+		ref.pp.Append(PolyProduct(ref.p[1], ref.p[2])); 
+		ref.pp.Append(PolyProduct(ref.p[2], ref.p[1])); 
+		ref.pp.Append(PolyProduct(ref.p[0], ref.p[2])); 
+		ref.pp.Append(PolyProduct(ref.p[2], ref.p[2])); 
 	}
 
-	// get derivatives of _p 
-	for (int i=0; i<_p.GetSize(); i++) {
-		_dp.Append(_p[i].Derivative()); 
+	// get derivatives of p 
+	for (int i=0; i<ref.p.GetSize(); i++) {
+		ref.dp.Append(ref.p[i].Derivative()); 
 	}
 
-	_dpp.Resize(_pp.GetSize()); 
-	for (int i=0; i<_pp.GetSize(); i++) {
-		_pp[i].Gradient(_dpp[i]); 		
+	ref.dpp.Resize(ref.pp.GetSize()); 
+	for (int i=0; i<ref.pp.GetSize(); i++) {
+		ref.pp[i].Gradient(ref.dpp[i]); 		 
 	}
 
-	// setup face transformations 
+	// reference face transformations are shared by all elements 
+	ref.faces.Resize(4); 
 	{
 		MeshNode n0 = {0, {0,0}, INTERIOR}; 
 		MeshNode n1 = {0, {1,0}, INTERIOR}; 
-		_faceRefTrans[0] = new L2Segment({n0, n1}, _order, _mdim); 
+		ref.faces[0] = new L2Segment({n0, n1}, ref.order, ref.mdim); 
 	}
 	{
 		MeshNode n0 = {0, {1,0}, INTERIOR}; 
 		MeshNode n1 = {0, {1,1}, INTERIOR}; 
-		_faceRefTrans[1] = new L2Segment({n0, n1}, _order, _mdim); 
+		ref.faces[1] = new L2Segment({n0, n1}, ref.order, ref.mdim); 
 	}
 	{
 		MeshNode n0 = {0, {1,1}, INTERIOR}; 
 		MeshNode n1 = {0, {0,1}, INTERIOR}; 
-		_faceRefTrans[2] = new L2Segment({n0, n1}, _order, _mdim); 
+		ref.faces[2] = new L2Segment({n0, n1}, ref.order, ref.mdim); 
 	}
 	{
 		MeshNode n0 = {0, {0,1}, INTERIOR}; 
 		MeshNode n1 = {0, {0,0}, INTERIOR}; 
-		_faceRefTrans[3] = new L2Segment({n0, n1}, _order, _mdim); 
-	}
-	// setup reference to physical space face transformations 
-	for (int i=0; i<_faceTrans.GetSize(); i++) {
-		int next = (i+1)%_faceTrans.GetSize(); 
-		_faceTrans[i] = new L2Segment({_geo_nodes[i], _geo_nodes[next]}, 
-			_order, _mdim); 
+		ref.faces[3] = new L2Segment({n0, n1}, ref.order, ref.mdim); 
 	}
 }
 
 void L2Quad::CalcShape(Point x, Vector& shape) const {
 	shape.SetSize(GetNumNodes()); 
 
-	for (int i=0; i<_pp.GetSize(); i++) {
-		shape[i] = _pp[i](x); 
+	const Array<PolyProduct>& pp = _ref->pp; 
+	for (int i=0; i<pp.GetSize(); i++) {
+		shape[i] = pp[i](x); 
 	}
 }
 
 void L2Quad::CalcGradShape(Point x, Matrix& gradshape) const {
 	gradshape.SetSize(_mdim, GetNumNodes()); 
 
-	for (int i=0; i<_dpp.GetSize(); i++) {
+	const Array<Array<PolyProduct>>& dpp = _ref->dpp; 
+	for (int i=0; i<dpp.GetSize(); i++) {
 		for (int j=0; j<_mdim; j++) {
-			gradshape(j, i) = _dpp[i][j](x); 
+			gradshape(j, i) = dpp[i][j](x); 
 		}
 	}
 }
@@ -14,6 +14,9 @@ class L2Space : public FESpace {
 public:
 	/// constructor 
 	L2Space(const Mesh& mesh, int order); 
+protected:
+	/// build the L2 element for mesh element e 
+	Element* CreateElement(int e) const; 
 }; 
 
 /// represent an L2 segment finite element 
@@ -26,11 +29,11 @@ public:
 	void CalcShape(Point x, Vector& shape) const; 
 	/// evaluate derivative of basis functions 
 	void CalcGradShape(Point x, Matrix& gradshape) const; 
-private:
-	/// 1d polynomials for basis function evaluation 
-	Array<Poly1D> _p; 
-	/// derivative of 1d polynomials 
-	Array<Poly1D> _dp; 
+	/// fill the shared 1d polynomials 
+	static void BuildReference(ReferenceElement& ref); 
+protected:
+	/// place the nodes for the element order 
+	void PlaceNodes(); 
 }; 
 
 /// represent an L2 quadrilaterial finite element 
@@ -43,13 +46,11 @@ public:
 	void CalcShape(Point x, Vector& shape) const; 
 	/// evaluate gradient of basis functions 
 	void CalcGradShape(Point x, Matrix& gradshape) const;
-private:
-	/// 1d polynomials for basis function evaluation 
-	Array<Poly1D> _p; 
-	/// derivative of 1D polynomials 
-	Array<Poly1D> _dp; 
-	Array<PolyProduct> _pp; 
-	Array<Array<PolyProduct>> _dpp; 
+	/// fill the shared tensor product polynomials and reference faces 
+	static void BuildReference(ReferenceElement& ref); 
+protected:
+	/// place the nodes for the element order and the physical face elements 
+	void PlaceNodes(); 
 }; 
 
 } // end namespace fem 
\ No newline at end of file
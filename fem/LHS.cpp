@@ -1,4 +1,5 @@
 #include "LHS.hpp"
+#include "Snapshot.hpp"
 
 using namespace std; 
 
@@ -12,12 +13,16 @@ LHS::LHS(const FESpace* space, Quadrature* gq)
 	_gq = gq; 
 	_nel = _space->GetNumElements(); 
 	_nnodes = _space->GetNumNodes(); 
+	_fingerprint = 0; 
+	_exact = true; 
 }
 
 void LHS::AddIntegrator(BilinearIntegrator* integ) {
+	_exact = integ->Fingerprint(_fingerprint) && _exact; 
 	Array<int> vdofs; 
 	for (int n=0; n<_nel; n++) {
-		Element& el = _space->GetEl(n); 
+		ElementHandle view; 
+		Element& el = _space->GetEl(n, view); 
 		Matrix local(el.GetNumNodes()); 
 		integ->Assemble(el, local); 
 		_space->GetVDofs(n, vdofs); 
@@ -30,15 +35,62 @@ void LHS::AddIntegrator(BilinearIntegrator* integ) {
 	delete integ; 
 }
 
+uint64_t LHS::CacheKey(uint64_t fingerprint) const {
+	uint64_t state[3] = {_space->Hash(), fingerprint, SNAPSHOT_VERSION}; 
+	return HashBytes(state, sizeof(state)); 
+}
+
+bool LHS::AddIntegrators(const Array<BilinearIntegrator*>& integs, const string& dir) {
+	CH_TIMERS_COARSE("cached lhs assembly"); 
+	uint64_t fingerprint = _fingerprint; 
+	bool exact = _exact; 
+	for (int i=0; i<integs.GetSize(); i++) {
+		exact = exact && integs[i]->Fingerprint(fingerprint); 
+	}
+	// a key that does not identify the operator could load a stale one 
+	if (!exact) {
+		for (int i=0; i<integs.GetSize(); i++) {
+			AddIntegrator(integs[i]); 
+		}
+		return false; 
+	}
+	uint64_t key = CacheKey(fingerprint); 
+	string name = SnapshotName(dir, "lhs", key); 
+	{
+		SnapshotReader snap(name, key); 
+		if (snap.Good()) {
+			Load(snap); 
+			for (int i=0; i<integs.GetSize(); i++) {
+				delete integs[i]; 
+			}
+			_fingerprint = fingerprint; 
+			return true; 
+		}
+	}
+
+	for (int i=0; i<integs.GetSize(); i++) {
+		AddIntegrator(integs[i]); 
+	}
+	SnapshotWriter snap(name, key); 
+	Save(snap); 
+	snap.Close(); 
+	return false; 
+}
+
 void LHS::AddFaceIntegrator(BilinearIntegrator* integ) {
+	const char tag[] = "face"; 
+	_fingerprint = HashBytes(tag, sizeof(tag), _fingerprint); 
+	_exact = integ->Fingerprint(_fingerprint) && _exact; 
 	Matrix elmat; 
 	for (int n=0; n<_nel; n++) {
-		Element& el = _space->GetEl(n); 
+		ElementHandle view; 
+		Element& el = _space->GetEl(n, view); 
 		for (int f=0; f<FacesPerEl(el.GetType()); f++) {
 			FaceTransformations fts; 
 			_space->GetFaceTransformations(n, f, fts); 
 			if (el.GetNeighbor(f) >= 0) {
-				Element& neighb = _space->GetEl(el.GetNeighbor(f)); 
+				ElementHandle neighb_view; 
+				Element& neighb = _space->GetEl(el.GetNeighbor(f), neighb_view); 
 				integ->AssembleFaceMatrix(&el, &neighb, fts, elmat); 
 				Array<int> vdofs_e, vdofs_ep; 
 				_space->GetVDofs(n, vdofs_e); 
@@ -69,21 +121,19 @@ void LHS::AddFaceIntegrator(BilinearIntegrator* integ) {
 }
 
 void LHS::ApplyDirichletBoundary(RHS& rhs, double val) {
-
+	const char tag[] = "dirichlet"; 
+	_fingerprint = HashBytes(tag, sizeof(tag), _fingerprint); 
+	_fingerprint = HashBytes(&val, sizeof(val), _fingerprint); 
+	Array<int> rcs; 
 	for (int i=0; i<_space->GetNBN(); i++) {
-		const Node& node = _space->GetBoundaryNode(i); 
-		if (node.GetBC() == DIRICHLET) {
-			EliminateRowIntoRHS(node.GetGlobalID(), rhs, val); 
+		int id = _space->GetBoundaryNodeID(i); 
+		if (_space->GetNodeBC(id) == DIRICHLET) {
+			for (int d=0; d<_space->GetVDim(); d++) {
+				rcs.Append(_space->GetVDim()*id + d); 
+			}
 		}
 	}
-
-	// for (int i=0; i<_space->GetNumNodes(); i++) {
-	// 	const Node& node = _space->GetNode(i); 
-	// 	if (node.GetBC() == DIRICHLET) {
-	// 		EliminateRowIntoRHS(node.GetGlobalID(), rhs, val); 
-	// 	}
-	// }
-	ClearNonZeros(); 
+	EliminateRowsIntoRHS(rcs, rhs, val); 
 }
 
 MixedLHS::MixedLHS(const FESpace* trial, const FESpace* test, 
@@ -99,8 +149,10 @@ MixedLHS::MixedLHS(const FESpace* trial, const FESpace* test,
 void MixedLHS::AddIntegrator(BilinearIntegrator* integ) {
 	Array<int> vdofs_test, vdofs_trial; 
 	for (int n=0; n<_nel; n++) {
-		Element& test_fe = _test->GetEl(n); 
-		Element& trial_fe = _trial->GetEl(n); 
+		ElementHandle test_fe_view; 
+		Element& test_fe = _test->GetEl(n, test_fe_view); 
+		ElementHandle trial_fe_view; 
+		Element& trial_fe = _trial->GetEl(n, trial_fe_view); 
 		Matrix local; 
 		integ->MixedAssemble(trial_fe, test_fe, local); 
 		_test->GetVDofs(n, vdofs_test); 
@@ -7,6 +7,7 @@
 #include "BilinearIntegrator.hpp"
 #include "SparseMatrix.hpp"
 #include "RHS.hpp"
+#include "Snapshot.hpp"
 
 namespace fem 
 {
@@ -18,6 +19,10 @@ public:
 	LHS(const FESpace* space, Quadrature* gq=NULL); 
 	/// add an integrator 
 	void AddIntegrator(BilinearIntegrator* integ); 
+	/// add several integrators, loading the matrix cached by an earlier run if there is one 
+	/** keyed like FEMatrix::AddIntegrators. Takes ownership of integs 
+		\returns true if the matrix was read from the cache in dir */ 
+	bool AddIntegrators(const Array<BilinearIntegrator*>& integs, const std::string& dir=""); 
 	/// assemble a local face integrator 
 	void AddFaceIntegrator(BilinearIntegrator* integ); 
 	/// apply dirichlet boundary conditions by 
@@ -25,7 +30,17 @@ public:
 	void ApplyDirichletBoundary(RHS& rhs, double val=0); 
 	/// return the FESpace pointer 
 	const FESpace* GetSpace() const {return _space; }
+	/// return the fingerprint of the integrators and modifications applied so far 
+	uint64_t GetFingerprint() const {return _fingerprint; }
+	/// return true if the fingerprint identifies the matrix exactly (see FEMatrix::IsCacheable) 
+	bool IsCacheable() const {return _exact; }
+	/// return the name of the cache file in dir holding the matrix in its current state 
+	std::string GetCacheName(const std::string& dir="") const {
+		return SnapshotName(dir, "lhs", CacheKey(_fingerprint)); 
+	}
 private:
+	/// key of the cache file for the matrix with the given fingerprint 
+	uint64_t CacheKey(uint64_t fingerprint) const; 
 	/// FESpace 
 	const FESpace* _space; 
 	/// number of elements in FESpace 
@@ -34,6 +49,10 @@ private:
 	int _nnodes; 
 	/// quadrature class 
 	Quadrature* _gq; 
+	/// fingerprint of everything applied to the matrix 
+	uint64_t _fingerprint; 
+	/// true while _fingerprint identifies the matrix exactly 
+	bool _exact; 
 }; 
 
 /// build the left hand side sparse matrix for a mixed FEM system 
@@ -0,0 +1,36 @@
+#include "LagrangeBasis.hpp"
+
+using namespace std; 
+
+namespace fem 
+{
+
+/// wrap the TensorLagrange<G,P> kernels in a runtime handle 
+template<int G, int P>
+LagrangeKernels MakeKernels() {
+	typedef TensorLagrange<G,P> T; 
+	return {G, P, T::D, T::N, &T::ord[0][0],
+		T::CalcShape, T::CalcGradShape, T::AddMass, T::AddDiffusion, T::Symmetrize,
+		T::shapex.data(), T::shapey.data(), T::dshapex.data(), T::dshapey.data()}; 
+}
+
+/// instantiate orders 1 through LAGRANGE_MAX_ORDER for geometry G 
+template<int G>
+array<LagrangeKernels,LAGRANGE_MAX_ORDER> MakeKernelTable() {
+	return {MakeKernels<G,1>(), MakeKernels<G,2>(), MakeKernels<G,3>(),
+		MakeKernels<G,4>(), MakeKernels<G,5>(), MakeKernels<G,6>(),
+		MakeKernels<G,7>(), MakeKernels<G,8>()}; 
+}
+
+const LagrangeKernels* GetLagrangeKernels(int geo, int order) {
+	static const array<LagrangeKernels,LAGRANGE_MAX_ORDER> line = MakeKernelTable<LINE>(); 
+	static const array<LagrangeKernels,LAGRANGE_MAX_ORDER> quad = MakeKernelTable<QUAD>(); 
+	static const array<LagrangeKernels,LAGRANGE_MAX_ORDER> hex = MakeKernelTable<HEX>(); 
+	if (order < 1 || order > LAGRANGE_MAX_ORDER) return NULL; 
+	if (geo == LINE) return &line[order-1]; 
+	else if (geo == QUAD) return &quad[order-1]; 
+	else if (geo == HEX) return &hex[order-1]; 
+	return NULL; 
+}
+
+} // end namespace fem 
\ No newline at end of file
@@ -0,0 +1,304 @@
+#pragma once 
+
+#include <array>
+#include "General.hpp"
+#include "Mesh.hpp"
+
+/// highest order with compile time generated lagrange tables 
+#define LAGRANGE_MAX_ORDER 8
+
+namespace fem 
+{
+
+/// monomial coefficients of the P+1 equispaced lagrange polynomials on [-1,1] 
+/** c[i][k] multiplies x^k in the polynomial that is one at node i.
+	Built by expanding \f$ \prod_{j \neq i} (x - x_j)/(x_i - x_j) \f$ */ 
+template<int P>
+constexpr std::array<std::array<double,P+1>,P+1> LagrangeCoefs() {
+	std::array<std::array<double,P+1>,P+1> c{}; 
+	for (int i=0; i<=P; i++) {
+		double xi = -1. + 2.*i/P; 
+		double denom = 1.; 
+		c[i][0] = 1.; 
+		int deg = 0; 
+		for (int j=0; j<=P; j++) {
+			if (j==i) continue; 
+			double xj = -1. + 2.*j/P; 
+			// multiply by (x - xj) 
+			for (int k=deg+1; k>0; k--) {
+				c[i][k] = c[i][k-1] - xj*c[i][k]; 
+			}
+			c[i][0] *= -xj; 
+			deg++; 
+			denom *= xi - xj; 
+		}
+		for (int k=0; k<=P; k++) {
+			c[i][k] /= denom; 
+		}
+	}
+	return c; 
+}
+
+/// monomial coefficients of the derivatives of LagrangeCoefs<P> (degree P-1, last entry zero) 
+template<int P>
+constexpr std::array<std::array<double,P+1>,P+1> LagrangeDerivCoefs() {
+	std::array<std::array<double,P+1>,P+1> c = LagrangeCoefs<P>(); 
+	std::array<std::array<double,P+1>,P+1> dc{}; 
+	for (int i=0; i<=P; i++) {
+		for (int k=1; k<=P; k++) {
+			dc[i][k-1] = k*c[i][k]; 
+		}
+	}
+	return dc; 
+}
+
+/// compile time 1D lagrange basis of order P 
+template<int P>
+struct Lagrange1D {
+	/// basis coefficients 
+	static constexpr std::array<std::array<double,P+1>,P+1> c = LagrangeCoefs<P>(); 
+	/// derivative coefficients 
+	static constexpr std::array<std::array<double,P+1>,P+1> dc = LagrangeDerivCoefs<P>(); 
+
+	/// evaluate all P+1 polynomials at x (Horner's rule) 
+	static inline void Eval(double x, double* phi) {
+		for (int i=0; i<=P; i++) {
+			double v = c[i][P]; 
+			for (int k=P-1; k>=0; k--) {
+				v = v*x + c[i][k]; 
+			}
+			phi[i] = v; 
+		}
+	}
+	/// evaluate all P+1 derivatives at x 
+	static inline void EvalDeriv(double x, double* dphi) {
+		for (int i=0; i<=P; i++) {
+			double v = dc[i][P]; 
+			for (int k=P-1; k>=0; k--) {
+				v = v*x + dc[i][k]; 
+			}
+			dphi[i] = v; 
+		}
+	}
+}; 
+
+/// 1D lattice indices of the nodes of an order P line: end points then interior 
+template<int P>
+constexpr std::array<std::array<int,1>,P+1> LineOrdering() {
+	std::array<std::array<int,1>,P+1> o{}; 
+	o[0][0] = 0; 
+	o[1][0] = P; 
+	for (int i=1; i<P; i++) {
+		o[i+1][0] = i; 
+	}
+	return o; 
+}
+
+/// 2D lattice indices of the nodes of an order P quad 
+/** corners counter clockwise, then the edge nodes walking counter clockwise
+	around the boundary, then the interior nodes in lexicographic (x fastest) order */ 
+template<int P>
+constexpr std::array<std::array<int,2>,(P+1)*(P+1)> QuadOrdering() {
+	std::array<std::array<int,2>,(P+1)*(P+1)> o{}; 
+	int n = 0; 
+	o[n++] = {0,0}; 
+	o[n++] = {P,0}; 
+	o[n++] = {P,P}; 
+	o[n++] = {0,P}; 
+	for (int i=1; i<P; i++) o[n++] = {i,0}; 
+	for (int i=1; i<P; i++) o[n++] = {P,i}; 
+	for (int i=1; i<P; i++) o[n++] = {P-i,P}; 
+	for (int i=1; i<P; i++) o[n++] = {0,P-i}; 
+	for (int j=1; j<P; j++) {
+		for (int i=1; i<P; i++) {
+			o[n++] = {i,j}; 
+		}
+	}
+	return o; 
+}
+
+/// 3D lattice indices of the nodes of an order P hex 
+/** the 8 corners (bottom then top), the non-corner nodes of the bottom face
+	in QuadOrdering, every interior layer in full QuadOrdering and finally
+	the non-corner nodes of the top face */ 
+template<int P>
+constexpr std::array<std::array<int,3>,(P+1)*(P+1)*(P+1)> HexOrdering() {
+	constexpr int NQ = (P+1)*(P+1); 
+	std::array<std::array<int,2>,NQ> q = QuadOrdering<P>(); 
+	std::array<std::array<int,3>,(P+1)*(P+1)*(P+1)> o{}; 
+	int n = 0; 
+	for (int k=0; k<2; k++) {
+		for (int i=0; i<4; i++) {
+			o[n++] = {q[i][0], q[i][1], k*P}; 
+		}
+	}
+	for (int i=4; i<NQ; i++) o[n++] = {q[i][0], q[i][1], 0}; 
+	for (int k=1; k<P; k++) {
+		for (int i=0; i<NQ; i++) {
+			o[n++] = {q[i][0], q[i][1], k}; 
+		}
+	}
+	for (int i=4; i<NQ; i++) o[n++] = {q[i][0], q[i][1], P}; 
+	return o; 
+}
+
+/// return the lattice ordering for geometry G (LINE, QUAD or HEX) 
+template<int G, int P>
+constexpr auto TensorOrdering() {
+	if constexpr (G == LINE) return LineOrdering<P>(); 
+	else if constexpr (G == QUAD) return QuadOrdering<P>(); 
+	else return HexOrdering<P>(); 
+}
+
+/// batched monomial coefficients of the dir factor of each basis function 
+/** layout [n*(P+1)+k] as used by CalcShape_RV */ 
+template<int G, int P>
+constexpr auto LagrangeBatched(int dir) {
+	constexpr auto ord = TensorOrdering<G,P>(); 
+	constexpr int N = ord.size(); 
+	std::array<double,N*(P+1)> b{}; 
+	std::array<std::array<double,P+1>,P+1> c = LagrangeCoefs<P>(); 
+	for (int n=0; n<N; n++) {
+		for (int k=0; k<=P; k++) {
+			b[n*(P+1)+k] = c[ord[n][dir]][k]; 
+		}
+	}
+	return b; 
+}
+
+/// batched coefficients for the D x N gradient rows: the dir factor of row g is differentiated if g == dir 
+/** layout [(g*N+n)*(P+1)+k] as used by CalcShape_RV for gradients */ 
+template<int G, int P>
+constexpr auto LagrangeBatchedGrad(int dir) {
+	constexpr auto ord = TensorOrdering<G,P>(); 
+	constexpr int N = ord.size(); 
+	constexpr int D = ord[0].size(); 
+	std::array<double,D*N*(P+1)> b{}; 
+	std::array<std::array<double,P+1>,P+1> c = LagrangeCoefs<P>(); 
+	std::array<std::array<double,P+1>,P+1> dc = LagrangeDerivCoefs<P>(); 
+	for (int g=0; g<D; g++) {
+		for (int n=0; n<N; n++) {
+			for (int k=0; k<=P; k++) {
+				b[(g*N+n)*(P+1)+k] = (g==dir) ? dc[ord[n][dir]][k] : c[ord[n][dir]][k]; 
+			}
+		}
+	}
+	return b; 
+}
+
+/// compile time tensor product lagrange element of geometry G and order P 
+template<int G, int P>
+struct TensorLagrange {
+	/// dimension of the reference element 
+	static constexpr int D = (G == LINE) ? 1 : ((G == QUAD) ? 2 : 3); 
+	/// number of basis functions 
+	static constexpr int N = (D == 1) ? P+1 : ((D == 2) ? (P+1)*(P+1) : (P+1)*(P+1)*(P+1)); 
+	/// lattice index of every node 
+	static constexpr std::array<std::array<int,D>,N> ord = TensorOrdering<G,P>(); 
+
+	/// evaluate the N basis functions at reference point x 
+	static void CalcShape(const double* x, double* shape) {
+		double phi[D][P+1]; 
+		for (int d=0; d<D; d++) Lagrange1D<P>::Eval(x[d], phi[d]); 
+		for (int n=0; n<N; n++) {
+			double s = phi[0][ord[n][0]]; 
+			for (int d=1; d<D; d++) s *= phi[d][ord[n][d]]; 
+			shape[n] = s; 
+		}
+	}
+	/// evaluate the D x N (row major) reference gradients at x 
+	static void CalcGradShape(const double* x, double* gshape) {
+		double phi[D][P+1]; 
+		double dphi[D][P+1]; 
+		for (int d=0; d<D; d++) {
+			Lagrange1D<P>::Eval(x[d], phi[d]); 
+			Lagrange1D<P>::EvalDeriv(x[d], dphi[d]); 
+		}
+		for (int g=0; g<D; g++) {
+			for (int n=0; n<N; n++) {
+				double s = 1.; 
+				for (int d=0; d<D; d++) {
+					s *= (d==g) ? dphi[d][ord[n][d]] : phi[d][ord[n][d]]; 
+				}
+				gshape[g*N+n] = s; 
+			}
+		}
+	}
+	/// elmat += w shape shape^T (upper triangle of the row major N x N elmat) 
+	static void AddMass(double w, const double* shape, double* elmat) {
+		for (int i=0; i<N; i++) {
+			double wi = w*shape[i]; 
+			double* row = elmat + i*N; 
+			for (int j=i; j<N; j++) {
+				row[j] += wi*shape[j]; 
+			}
+		}
+	}
+	/// elmat += w G^T G for a D x N physical gradient G (upper triangle only) 
+	static void AddDiffusion(double w, const double* g, double* elmat) {
+		for (int i=0; i<N; i++) {
+			double* row = elmat + i*N; 
+			for (int d=0; d<D; d++) {
+				double wi = w*g[d*N+i]; 
+				const double* gd = g + d*N; 
+				for (int j=i; j<N; j++) {
+					row[j] += wi*gd[j]; 
+				}
+			}
+		}
+	}
+	/// copy the upper triangle of elmat into the lower triangle 
+	static void Symmetrize(double* elmat) {
+		for (int i=0; i<N; i++) {
+			for (int j=i+1; j<N; j++) {
+				elmat[j*N+i] = elmat[i*N+j]; 
+			}
+		}
+	}
+	/// batched x coefficients 
+	static constexpr std::array<double,N*(P+1)> shapex = LagrangeBatched<G,P>(0); 
+	/// batched y coefficients 
+	static constexpr std::array<double,N*(P+1)> shapey = LagrangeBatched<G,P>(D > 1 ? 1 : 0); 
+	/// batched x coefficients of the gradient 
+	static constexpr std::array<double,D*N*(P+1)> dshapex = LagrangeBatchedGrad<G,P>(0); 
+	/// batched y coefficients of the gradient 
+	static constexpr std::array<double,D*N*(P+1)> dshapey = LagrangeBatchedGrad<G,P>(D > 1 ? 1 : 0); 
+}; 
+
+/// runtime handle to the compile time kernels of one (geometry, order) pair 
+struct LagrangeKernels {
+	/// element geometry 
+	int geo; 
+	/// polynomial order 
+	int order; 
+	/// reference dimension 
+	int dim; 
+	/// number of basis functions 
+	int nn; 
+	/// lattice index of node n in direction d is lattice[n*dim+d] 
+	const int* lattice; 
+	/// evaluate basis functions 
+	void (*shape)(const double* x, double* shape); 
+	/// evaluate dim x nn reference gradients 
+	void (*gshape)(const double* x, double* gshape); 
+	/// add weighted mass outer product (upper triangle) 
+	void (*mass)(double w, const double* shape, double* elmat); 
+	/// add weighted stiffness product (upper triangle) 
+	void (*diffusion)(double w, const double* gshape, double* elmat); 
+	/// mirror upper triangle to lower 
+	void (*symmetrize)(double* elmat); 
+	/// batched x coefficients (nn x (order+1)) 
+	const double* shapex; 
+	/// batched y coefficients (nn x (order+1)) 
+	const double* shapey; 
+	/// batched x coefficients of the gradient (dim*nn x (order+1)) 
+	const double* dshapex; 
+	/// batched y coefficients of the gradient (dim*nn x (order+1)) 
+	const double* dshapey; 
+}; 
+
+/// return the kernels for geometry geo (LINE, QUAD or HEX) and order 1 <= order <= LAGRANGE_MAX_ORDER 
+/** returns NULL if the pair is not available */ 
+const LagrangeKernels* GetLagrangeKernels(int geo, int order); 
+
+} // end namespace fem 
\ No newline at end of file
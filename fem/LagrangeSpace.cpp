@@ -1,80 +1,188 @@
 #include "LagrangeSpace.hpp"
+#include "Snapshot.hpp"
 #ifdef USE_MPI 
 #include <mpi.h>
 #endif
 #include "Opt.hpp"
+#include <unordered_map>
+#include <algorithm>
 
 using namespace std; 
 
 namespace fem 
 {
 
-int FindMatch(const Node& node, const Array<Node>& list) {
-	for (int i=0; i<list.GetSize(); i++) {
-		if (list[i].CheckEqual(node)) {
-			return i; 
-		}
+bool InVector(const Array<int>& unique, int tag) {
+	for (int i=0; i<unique.GetSize(); i++) {
+		if (unique[i] == tag) return true; 
 	}
-	return -1; 
+	return false; 
 }
 
-int FindMatch(const Node& node, const Array<int>& neighb, 
-	Array<Element*> els) {
-	for (int e=0; e<neighb.GetSize(); e++) {
-		if (neighb[e] >= 0) {
-			Element* el = els[neighb[e]]; 
-			for (int n=0; n<el->GetNumNodes(); n++) {
-				if (el->GetNode(n).CheckEqual(node)) {
-					if (el->GetNodeGlobalID(n)>=0)
-						return el->GetNodeGlobalID(n); 
-				}
-			}			
+/// key of a mesh entity: its sorted vertex ids (unused entries are -1) 
+typedef array<int,4> EntityKey; 
+
+/// hash of an EntityKey 
+struct EntityKeyHash {
+	size_t operator()(const EntityKey& k) const {
+		size_t h = 14695981039346656037ull; 
+		for (int i=0; i<4; i++) {
+			h = (h ^ (size_t)(unsigned int)k[i]) * 1099511628211ull; 
+		}
+		return h; 
+	}
+}; 
+
+/// numbering state carried from one element to the next by NumberEntityNodes 
+struct EntityNumbering {
+	/// start from the nv vertex nodes for a mesh of Ne elements 
+	EntityNumbering(int nv, int Ne) : count(nv), stored(nv, 1) {
+		base.reserve(3*Ne); 
+	}
+	/// first node of each shared edge or face 
+	unordered_map<EntityKey, int, EntityKeyHash> base; 
+	/// number of global nodes so far 
+	int count; 
+	/// true once the node with that global id has been stored in the space 
+	vector<char> stored; 
+}; 
+
+void LagrangeSpace::NumberEntityNodes(Element& el, EntityNumbering& num) {
+	unordered_map<EntityKey, int, EntityKeyHash>& base = num.base; 
+	vector<char>& stored = num.stored; 
+	int& count = num.count; 
+	const LagrangeKernels* k = el.GetKernels(); 
+	if (!k) {
+		// only vertex nodes 
+		for (int n=0; n<el.GetNumNodes(); n++) {
+			CHECKMSG(el.GetNodeGlobalID(n) >= 0, "no entity numbering for element type " 
+				<< el.GetType()); 
 		}
+		return; 
+	}
+	int P = k->order; 
+	int dim = k->dim; 
+
+	// vertex at each corner: bit d of the corner is set if lattice coordinate d is P 
+	int corner[8]; 
+	for (int v=0; v<(1<<dim); v++) {
+		const int* l = k->lattice + v*dim; 
+		int c = 0; 
+		for (int d=0; d<dim; d++) {
+			if (l[d] == P) c |= 1 << d; 
+		}
+		corner[c] = el.GetNodeGlobalID(v); 
 	}
-	return -2; 
-}
 
-int Search(Element* nel, Node& node, int max) {
-	CH_TIMERS("search through neighbors"); 
-	for (int i=0; i<nel->GetNumNodes(); i++) {
-		if (nel->GetNodeGlobalID(i) >= max) {
-			if (nel->GetNode(i).CheckEqual(node)) {
-				int id = nel->GetNodeGlobalID(i); 
-				if (id>=0) return id; 
+	int cell = -1; 
+	for (int n=(1<<dim); n<k->nn; n++) {
+		const int* l = k->lattice + n*dim; 
+		// free dimensions (interior lattice coordinates) and the fixed corner bits 
+		int free[3], nfree = 0, fixed = 0; 
+		for (int d=0; d<dim; d++) {
+			if (l[d] == P) fixed |= 1 << d; 
+			else if (l[d] > 0) free[nfree++] = d; 
+		}
+		int id; 
+		if (nfree == dim) {
+			// cell interior nodes belong to this element only 
+			if (cell < 0) {
+				cell = count; 
+				int ncell = 1; 
+				for (int d=0; d<dim; d++) ncell *= P-1; 
+				count += ncell; 
+			}
+			int idx = 0; 
+			for (int d=dim-1; d>=0; d--) {
+				idx = idx*(P-1) + l[d] - 1; 
+			}
+			id = cell + idx; 
+		} else if (nfree == 1) {
+			// edge: count from the endpoint with the smaller global id 
+			int d = free[0]; 
+			int a = corner[fixed], b = corner[fixed | 1 << d]; 
+			int t = (a < b) ? l[d] : P - l[d]; 
+			EntityKey key = {min(a,b), max(a,b), -1, -1}; 
+			auto it = base.find(key); 
+			if (it == base.end()) {
+				it = base.emplace(key, count).first; 
+				count += P-1; 
+			}
+			id = it->second + t - 1; 
+		} else {
+			// face: origin at the smallest global id, first axis toward 
+			// the smaller of its two face neighbors 
+			int d1 = free[0], d2 = free[1]; 
+			int g[2][2]; 
+			for (int i=0; i<2; i++) {
+				for (int j=0; j<2; j++) {
+					g[i][j] = corner[fixed | i << d1 | j << d2]; 
+				}
+			}
+			int i0 = 0, j0 = 0; 
+			for (int i=0; i<2; i++) {
+				for (int j=0; j<2; j++) {
+					if (g[i][j] < g[i0][j0]) {i0 = i; j0 = j; }
+				}
 			}
+			int du = (i0) ? P - l[d1] : l[d1]; 
+			int dv = (j0) ? P - l[d2] : l[d2]; 
+			bool first = g[1-i0][j0] < g[i0][1-j0]; 
+			int s = (first) ? du : dv; 
+			int t = (first) ? dv : du; 
+			EntityKey key = {g[0][0], g[0][1], g[1][0], g[1][1]}; 
+			sort(key.begin(), key.end()); 
+			auto it = base.find(key); 
+			if (it == base.end()) {
+				it = base.emplace(key, count).first; 
+				count += (P-1)*(P-1); 
+			}
+			id = it->second + (t-1)*(P-1) + s - 1; 
+		}
+		Node& node = el.GetNode(n); 
+		node.SetGlobalID(id); 
+		if (id >= GetNumNodes()) {
+			ResizeNodes(count); 
+			stored.resize(count, 0); 
+		}
+		if (!stored[id]) {
+			SetNode(id, node); 
+			stored[id] = 1; 
 		}
 	}
-	return -1; 
 }
 
-bool InVector(const Array<int>& unique, int tag) {
-	for (int i=0; i<unique.GetSize(); i++) {
-		if (unique[i] == tag) return true; 
+Element* LagrangeSpace::CreateElement(int e) const {
+	const MeshEl& el = _mesh.GetElement(e); 
+
+	// setup FEM nodes 
+	Array<MeshNode> node_list; 
+	_mesh.GetNodes(e, node_list); 
+
+	if (el.GetType() == QUAD) {
+		return new LagrangeQuad(node_list, _order); 
+	} else if (el.GetType() == TRI) {
+		return new LagrangeTri(node_list, _order); 
+	} else if (el.GetType() == HEX) {
+		return new LagrangeHex(node_list, _order); 
+	} else {
+		ERROR("element type " << el.GetType() << " not supported"); 
 	}
-	return false; 
 }
 
-LagrangeSpace::LagrangeSpace(const Mesh& mesh, int order, int vdim) 
+LagrangeSpace::LagrangeSpace(const Mesh& mesh, int order, int vdim, bool compact) 
 	: FESpace(mesh, order, vdim) {
-	CH_TIMERS("setup lagrange space"); 
+	CH_TIMERS_COARSE("setup lagrange space"); 
+	if (compact) {
+		BuildCompact(); 
+		return; 
+	}
 
 	// create Elements for every mesh element 
 	for (int i=0; i<mesh.GetNumElements(); i++) {
 		const MeshEl& el = mesh.GetElement(i); 
-
-		// setup FEM nodes 
-		Array<MeshNode> node_list; 
-		_mesh.GetNodes(i, node_list); 
-
-		if (el.GetType() == QUAD) {
-			_el.Append(new LagrangeQuad(node_list, order)); 						
-		} else if (el.GetType() == TRI) {
-			_el.Append(new LagrangeTri(node_list, order)); 
-		} else if (el.GetType() == HEX) {
-			_el.Append(new LagrangeHex(node_list, order)); 
-		} else {
-			ERROR("element type " << el.GetType() << " not supported"); 
-		}
+		_el.Append(CreateElement(i)); 
+		_el[i]->SetID(i); 
 
 		bool boundary = false; 
 		for (int j=0; j<_el[i]->GetNumNodes(); j++) {
@@ -99,70 +207,28 @@ LagrangeSpace::LagrangeSpace(const Mesh& mesh, int order, int vdim)
 	}
 
 	// add linear nodes in 
-	{ CH_TIMERS("relabel nodes"); 
-	_nodes.Resize(mesh.GetNumNodes()); 
+	{ CH_TIMERS_COARSE("relabel nodes"); 
+	ResizeNodes(mesh.GetNumNodes()); 
 	for (int n=0; n<mesh.GetNumNodes(); n++) {
 		const MeshNode& node = mesh.GetNode(n); 
-		_nodes[n] = Node(node.x, -1, node.id, node.bc); 
+		SetNode(n, Node(node.x, -1, node.id, node.bc)); 
 	}
 
-	// add the rest in
-	int count = _nodes.GetSize(); 
+	// add the rest in by topological entity 
+	{ CH_TIMERS_COARSE("number entity nodes"); 
+	EntityNumbering num(GetNumNodes(), _el.GetSize()); 
 	for (int e=0; e<_el.GetSize(); e++) {
-		Element* el = _el[e]; 
-		const MeshEl& mel = mesh.GetElement(e); 
-		for (int n=0; n<el->GetNumNodes(); n++) {
-			if (el->GetNodeGlobalID(n)<0) {
-				Node& node = el->GetNode(n); 
-				const Array<int>& nei = mel.GetNeighbors(); 
-				int id = -1; 
-				for (int ne=0; ne<nei.GetSize(); ne++) {
-					if (nei[ne] >= 0 and nei[ne] < e) {
-						id = Search(_el[nei[ne]], node, mesh.GetNumNodes()); 
-						if (id >= 0) break; 
-					}
-				}
-
-				if (id>=0) {
-					node.SetGlobalID(id); 
-				} else {
-					node.SetGlobalID(count++); 
-					_nodes.Append(node); 
-				}
-			}
-		}
+		NumberEntityNodes(*_el[e], num); 
 	}
+	CHECK(GetNumNodes() == num.count); 
 	}
-
-	// assign global id 
-	// {
-	// 	CH_TIMERS("relabel nodes"); 
-	// 	Array<Node> nodes; 
-	// 	int count = 0; 
-	// 	for (int i=0; i<_el.GetSize(); i++) {
-	// 		for (int j=0; j<_el[i]->GetNumNodes(); j++) {
-	// 			int match = FindMatch(_el[i]->GetNode(j), nodes); 
-	// 			// int match = FindMatch(_el[i]->GetNode(j), 
-	// 				// mesh.GetElement(i).GetNeighbors(), _el); 
-	// 			if (match >= 0) {
-	// 				_el[i]->GetNode(j).SetGlobalID(match); 
-	// 			} else {
-	// 				_el[i]->GetNode(j).SetGlobalID(count++); 
-	// 				nodes.Append(_el[i]->GetNode(j)); 
-	// 			}
-	// 		}
-	// 	}
-	// 	_nodes = nodes; 
-	// }
-
-	for (int i=0; i<_nodes.GetSize(); i++) {
-		if (_nodes[i].GetBC() != INTERIOR) {
-			_bnodes.Append(_nodes[i]); 
-		}
 	}
+
+	FindBoundaryNodes(); 
 	_vdofs.Resize(GetNumElements()); 
 	for (int e=0; e<GetNumElements(); e++) {
-		Element& el = GetEl(e); 
+		ElementHandle view; 
+		Element& el = GetEl(e, view); 
 		_vdofs[e].Resize(GetVDim() * el.GetNumNodes()); 
 		for (int d=0; d<GetVDim(); d++) {
 			for (int i=0; i<el.GetNumNodes(); i++) {
@@ -172,279 +238,199 @@ LagrangeSpace::LagrangeSpace(const Mesh& mesh, int order, int vdim)
 	}
 }
 
-LagrangeLine::LagrangeLine(Array<MeshNode> node_list, int order, int mdim) 
-	: Element(node_list, order, LINE, mdim) {
+void LagrangeSpace::BuildCompact() {
+	CH_TIMERS_COARSE("build compact lagrange space"); 
+	// nodes go straight into the flat coordinate and boundary condition arrays 
+	_compact = true; 
+	ResizeNodes(_mesh.GetNumNodes()); 
+	for (int n=0; n<_mesh.GetNumNodes(); n++) {
+		const MeshNode& node = _mesh.GetNode(n); 
+		SetNode(n, Node(node.x, -1, node.id, node.bc)); 
+	}
+
+	// number each element with one scratch element, keeping only its connectivity 
+	EntityNumbering num(GetNumNodes(), _mesh.GetNumElements()); 
+	Element* el = NULL; 
+	for (int e=0; e<_mesh.GetNumElements(); e++) {
+		const MeshEl& mel = _mesh.GetElement(e); 
+		if (el && el->GetType() == mel.GetType()) {
+			el->Reset(_mesh, e); 
+		} else {
+			delete el; 
+			el = CreateElement(e); 
+		}
+		el->SetID(e); 
+		if (mel.GetNumTags()>0) {
+			el->SetTag(mel.GetTag(0)); 
+			if (!InVector(_unique_tags, mel.GetTag(0))) {
+				_unique_tags.Append(mel.GetTag(0)); 
+			}
+		}
+		NumberEntityNodes(*el, num); 
+		AppendCompact(*el); 
 
-	// store the nodes 
-	for (int n=0; n<_geo_nodes.GetSize(); n++) {
-		_nodes.Append(Node(_geo_nodes[n].x, _nodes.GetSize(), 
-			_geo_nodes[n].id, _geo_nodes[n].bc)); 
-		_nodes[n].SetProcs(node_list[n].procs); 
+		for (int j=0; j<el->GetNumNodes(); j++) {
+			if (el->GetNode(j).GetBC() != INTERIOR) {
+				_bel_ids.Append(e); 
+				break; 
+			}
+		}
 	}
+	delete el; 
+	CHECK(GetNumNodes() == num.count); 
 
-	GenLagrangePolynomials(_order, -1, 1, _p); 
-	for (int i=0; i<_p.GetSize(); i++) {
-		_dp.Append(_p[i].Derivative()); 
-	}
+	FindBoundaryNodes(); 
+	InitViews(); 
 }
 
-void LagrangeLine::CalcShape(Point x, Vector& shape) const {
-	shape.SetSize(GetNumNodes()); 
-	for (int i=0; i<_p.GetSize(); i++) {
-		shape[i] = _p[i](x[0]); 
-	}
-}
-
-void LagrangeLine::CalcGradShape(Point x, Matrix& gradshape) const {
-	gradshape.SetSize(_mdim, GetNumNodes()); 
-	for (int d=0; d<_mdim; d++) {
-		for (int i=0; i<GetNumNodes(); i++) {
-			gradshape(d,i) = _dp[i](x[d]); 
-		}
-	}
+LagrangeSpace::LagrangeSpace(const Mesh& mesh, const SnapshotReader& snap) 
+	: FESpace(mesh, snap.GetInt("sp_order"), snap.GetInt("sp_vdim")) {
+	Load(snap); 
 }
 
-LagrangeQuad::LagrangeQuad(Array<MeshNode> node_list, int order, int mdim) 
-	: Element(node_list, order, QUAD, mdim) {
-	CH_TIMERS("build lagrange quad element"); 
-
-	for (int i=0; i<_geo_nodes.GetSize(); i++) {
-		_nodes.Append(Node(_geo_nodes[i].x, _nodes.GetSize(), 
-			_geo_nodes[i].id, _geo_nodes[i].bc)); 
-		// _nodes.Append(Node(_geo_nodes[i].x, _nodes.GetSize(), 
-			// -1, _geo_nodes[i].bc)); 
-		_nodes[i].SetProcs(node_list[i].procs); 
-	}
-
-	if (_order == 2) {
-		CH_TIMERS("setup quadratic"); 
-		Array<Node> nodes = _nodes; 
-		for (int i=0; i<_nodes.GetSize(); i++) {
-			int next = (i+1)%_nodes.GetSize(); 
-			Point x; 
-			for (int d=0; d<DIM; d++) {
-				x[d] = .5*(_nodes[i].GetX()[d] + _nodes[next].GetX()[d]); 
-			}
-
-			int bc; 
-			if (_nodes[i].GetBC() == _nodes[next].GetBC()) {
-				bc = _nodes[i].GetBC(); 
-			} else {
-				bc = INTERIOR; 
-			}
-			nodes.Append(Node(x, _nodes.GetSize()+i, -1, bc)); 
-			Array<int> procs; 
-			_nodes[i].GetProcs().Intersection(_nodes[next].GetProcs(), procs); 
-			procs.Sort(); 
-			nodes[nodes.GetSize()-1].SetProcs(procs); 
-		}
-		// add center point 
+/// build the FEM nodes of a tensor product lagrange element from its vertices 
+/** nodes are placed at the multilinear image of the equispaced reference lattice. 
+	Edge and face nodes take the boundary condition of their vertices if they all 
+	agree and are INTERIOR otherwise. Cell interior nodes are always INTERIOR */ 
+void BuildTensorNodes(const LagrangeKernels& k, const Array<MeshNode>& geo_nodes, 
+	Array<Node>& nodes) {
+	CH_TIMERS_FINE("build tensor nodes"); 
+	int nv = 1 << k.dim; 
+	CHECKMSG(geo_nodes.GetSize() >= nv, "need " << nv << " vertices"); 
+	nodes.Resize(0); 
+	for (int v=0; v<nv; v++) {
+		nodes.Append(Node(geo_nodes[v].x, v, geo_nodes[v].id, geo_nodes[v].bc)); 
+		Array<int> procs = geo_nodes[v].procs; 
+		nodes[v].SetProcs(procs); 
+	}
+
+	for (int n=nv; n<k.nn; n++) {
+		const int* l = k.lattice + n*k.dim; 
 		Point x; 
-		for (int d=0; d<DIM; d++) {
-			for (int i=0; i<_nodes.GetSize(); i++) {
-				x[d] += _nodes[i].GetX()[d]; 
+		Array<int> verts; 
+		for (int v=0; v<nv; v++) {
+			const int* lv = k.lattice + v*k.dim; 
+			double w = 1.; 
+			bool on = true; 
+			for (int d=0; d<k.dim; d++) {
+				double xi = (double)l[d]/k.order; 
+				w *= (lv[d]) ? xi : 1. - xi; 
+				if ((l[d]==0 || l[d]==k.order) && l[d]!=lv[d]) on = false; 
 			}
-			x[d] /= _nodes.GetSize(); 
-		}
-		nodes.Append(Node(x, nodes.GetSize(), -1, INTERIOR)); 
-		_nodes = nodes; 
-	} 
-
-	else if (_order == 3) {
-		CH_TIMERS("setup cubic"); 
-		Array<Node> nodes = _nodes; 
-		for (int i=0; i<_nodes.GetSize(); i++) {
-			int next = (i+1)%_nodes.GetSize(); 
-			Point x1; 
-			Point x2; 
 			for (int d=0; d<DIM; d++) {
-				x1[d] = 1./3*(_nodes[next].GetX()[d] - 
-					_nodes[i].GetX()[d]) + _nodes[i].GetX()[d]; 
-				x2[d] = 2./3*(_nodes[next].GetX()[d] - 
-					_nodes[i].GetX()[d]) + _nodes[i].GetX()[d]; 
+				x[d] += w*geo_nodes[v].x[d]; 
 			}
+			if (on) verts.Append(v); 
+		}
 
-			int bc; 
-			if (_nodes[i].GetBC() == nodes[next].GetBC()) {
-				bc = _nodes[i].GetBC(); 
-			} else {
-				bc = INTERIOR; 
+		int bc = INTERIOR; 
+		Array<int> procs; 
+		if (verts.GetSize() < nv) {
+			bc = geo_nodes[verts[0]].bc; 
+			procs = geo_nodes[verts[0]].procs; 
+			for (int i=1; i<verts.GetSize(); i++) {
+				if (geo_nodes[verts[i]].bc != bc) bc = INTERIOR; 
+				Array<int> tmp; 
+				procs.Intersection(geo_nodes[verts[i]].procs, tmp); 
+				procs = tmp; 
 			}
-			Array<int> procs; 
-			_nodes[i].GetProcs().Intersection(_nodes[next].GetProcs(), procs); 
 			procs.Sort(); 
-			nodes.Append(Node(x1, nodes.GetSize(), -1, bc)); 
-			nodes.Append(Node(x2, nodes.GetSize(), -1, bc)); 
-			nodes[nodes.GetSize()-1].SetProcs(procs); 
-			nodes[nodes.GetSize()-2].SetProcs(procs); 
 		}
-
-		nodes.Append(Node(
-			{nodes[4].GetX()[0], nodes[11].GetX()[1]}, 
-			nodes.GetSize(), -1, INTERIOR)); 
-		nodes.Append(Node(
-			{nodes[5].GetX()[0], nodes[11].GetX()[1]}, 
-			nodes.GetSize(), -1, INTERIOR)); 
-		nodes.Append(Node(
-			{nodes[4].GetX()[0], nodes[10].GetX()[1]}, 
-			nodes.GetSize(), -1, INTERIOR)); 
-		nodes.Append(Node(
-			{nodes[5].GetX()[0], nodes[10].GetX()[1]}, 
-			nodes.GetSize(), -1, INTERIOR)); 
-		_nodes = nodes; 
+		nodes.Append(Node(x, n, -1, bc)); 
+		nodes[n].SetProcs(procs); 
 	}
+}
 
-	GenLagrangePolynomials(_order, -1, 1, _p); 
-	if (_order == 1) {
-		CH_TIMERS("setup linear shape"); 
-		_pp.Append(PolyProduct(_p[0], _p[0])); 
-		_pp.Append(PolyProduct(_p[1], _p[0])); 
-		_pp.Append(PolyProduct(_p[1], _p[1])); 
-		_pp.Append(PolyProduct(_p[0], _p[1])); 
-	} else if (_order == 2) {
-		CH_TIMERS("setup quadratic shape"); 
-		_pp.Append(PolyProduct(_p[0], _p[0])); 
-		_pp.Append(PolyProduct(_p[2], _p[0]));
-		_pp.Append(PolyProduct(_p[2], _p[2]));
-		_pp.Append(PolyProduct(_p[0], _p[2]));
-
-		_pp.Append(PolyProduct(_p[1], _p[0]));
-		_pp.Append(PolyProduct(_p[2], _p[1]));
-		_pp.Append(PolyProduct(_p[1], _p[2]));
-		_pp.Append(PolyProduct(_p[0], _p[1]));
-		_pp.Append(PolyProduct(_p[1], _p[1]));
-	} else if (_order == 3) {
-		CH_TIMERS("setup cubic shape"); 
-		// 0-3
-		_pp.Append(PolyProduct(_p[0], _p[0])); 
-		_pp.Append(PolyProduct(_p[3], _p[0])); 
-		_pp.Append(PolyProduct(_p[3], _p[3])); 
-		_pp.Append(PolyProduct(_p[0], _p[3])); 
-
-		// 4 - 11 
-		_pp.Append(PolyProduct(_p[1], _p[0])); // 4 
-		_pp.Append(PolyProduct(_p[2], _p[0])); // 5 
-		_pp.Append(PolyProduct(_p[3], _p[1])); // 6 
-		_pp.Append(PolyProduct(_p[3], _p[2])); // 7 
-		_pp.Append(PolyProduct(_p[2], _p[3])); // 8 
-		_pp.Append(PolyProduct(_p[1], _p[3])); // 9 
-		_pp.Append(PolyProduct(_p[0], _p[2])); // 10 
-		_pp.Append(PolyProduct(_p[0], _p[1])); // 11 
-
-		// 12 - 15
-		_pp.Append(PolyProduct(_p[1], _p[1])); // 12
-		_pp.Append(PolyProduct(_p[2], _p[1])); // 13 
-		_pp.Append(PolyProduct(_p[1], _p[2])); // 14 
-		_pp.Append(PolyProduct(_p[2], _p[2])); // 15
-	} else {
-		ERROR("order " << _order << " not defined"); 
-	}
+/// return the kernels for geo and order or exit if they are not available 
+const LagrangeKernels* GetKernelsOrError(int geo, int order) {
+	const LagrangeKernels* k = GetLagrangeKernels(geo, order); 
+	if (!k) ERROR("order " << order << " not defined (max order is " 
+		<< LAGRANGE_MAX_ORDER << ")"); 
+	return k; 
+}
+
+void BuildLagrangeReference(ReferenceElement& ref) {
+	if (ref.geo == TRI) return; 
+	ref.kernels = GetKernelsOrError(ref.geo, ref.order); 
+}
 
-	{CH_TIMERS("gradients"); 
-	// for (int i=0; i<_p.GetSize(); i++) {
-	// 	_dp.Append(_p[i].Derivative()); 
-	// }
+LagrangeLine::LagrangeLine(Array<MeshNode> node_list, int order, int mdim) 
+	: Element(node_list, order, LINE, mdim) {
+	_ref = &RefElements.Get(LAGRANGE_BASIS, LINE, _order, _mdim, BuildLagrangeReference); 
+	PlaceNodes(); 
+}
 
-	_dpp.Resize(_pp.GetSize()); 
-	for (int i=0; i<_pp.GetSize(); i++) {
-		_pp[i].Gradient(_dpp[i]); 
-	}
-	}
+void LagrangeLine::PlaceNodes() {
+	BuildTensorNodes(*_ref->kernels, _geo_nodes, _nodes); 
+}
 
-	{CH_TIMERS("setup batched"); 
-	_shapex.Resize(_pp.GetSize()*(_order+1)); 
-	_shapey.Resize(_pp.GetSize()*(_order+1)); 
+void LagrangeLine::CalcShape(Point x, Vector& shape) const {
+	shape.SetSize(GetNumNodes()); 
+	_ref->kernels->shape(x.GetData(), shape.GetData()); 
+}
 
-	for (int i=0; i<_pp.GetSize(); i++) {
-		for (int j=0; j<_order+1; j++) {
-			_shapex[i*(_order+1)+j] = _pp[i].Get1D(0).GetCoefs()[j];
-			_shapey[i*(_order+1)+j] = _pp[i].Get1D(1).GetCoefs()[j];  
-		}
+void LagrangeLine::CalcGradShape(Point x, Matrix& gradshape) const {
+	gradshape.SetSize(_mdim, GetNumNodes()); 
+	for (int d=0; d<_mdim; d++) {
+		_ref->kernels->gshape(x.GetData()+d, gradshape.GetData()+d*GetNumNodes()); 
 	}
+}
 
-	_dshapex.Resize(_mdim*GetNumNodes()*(_order+1));
-	_dshapey.Resize(_mdim*GetNumNodes()*(_order+1));  
-	for (int i=0; i<GetNumNodes(); i++) {
-		for (int j=0; j<_order; j++) {
-			_dshapex[i*(_order+1)+j] = _dpp[i][0].Get1D(0).GetCoefs()[j]; 
-		} 
-		for (int j=0; j<_order+1; j++) {
-			_dshapey[i*(_order+1)+j] = _dpp[i][0].Get1D(1).GetCoefs()[j]; 
-		}
-	}
-	for (int i=0; i<GetNumNodes(); i++) {
-		for (int j=0; j<_order+1; j++) {
-			_dshapex[i*(_order+1)+j+GetNumNodes()*(_order+1)] = 
-				_dpp[i][1].Get1D(0).GetCoefs()[j]; 
-		} 
-		for (int j=0; j<_order; j++) {
-			_dshapey[i*(_order+1)+j+GetNumNodes()*(_order+1)] = 
-				_dpp[i][1].Get1D(1).GetCoefs()[j]; 
-		}
-	}
-	}
+LagrangeQuad::LagrangeQuad(Array<MeshNode> node_list, int order, int mdim) 
+	: Element(node_list, order, QUAD, mdim) {
+	CH_TIMERS_FINE("build lagrange quad element"); 
+	_ref = &RefElements.Get(LAGRANGE_BASIS, QUAD, _order, _mdim, BuildLagrangeReference); 
+	PlaceNodes(); 
+}
+
+void LagrangeQuad::PlaceNodes() {
+	BuildTensorNodes(*_ref->kernels, _geo_nodes, _nodes); 
 }
 
 void LagrangeQuad::CalcShape(Point x, 
 	Vector& shape) const {
-	CH_TIMERS("lagrange quad calc shape"); 
+	CH_TIMERS_FINE("lagrange quad calc shape"); 
 	shape.SetSize(GetNumNodes()); 
 #ifdef RV_SHAPE 
 	shape = 1.; 
-	CalcShape_RV(GetNumNodes(), _order+1, _shapex.GetData(), 
-		_shapey.GetData(), shape.GetData(), x.GetData()); 
+	CalcShape_RV(GetNumNodes(), _order+1, _ref->kernels->shapex, 
+		_ref->kernels->shapey, shape.GetData(), x.GetData()); 
 #else
-	for (int i=0; i<_pp.GetSize(); i++) {
-		shape[i] = _pp[i](x); 
-	}
+	_ref->kernels->shape(x.GetData(), shape.GetData()); 
 #endif
 }
 
 void LagrangeQuad::CalcGradShape(Point x, 
 	Matrix& gradshape) const {
-	CH_TIMERS("lagrange quad calc grad shape"); 
+	CH_TIMERS_FINE("lagrange quad calc grad shape"); 
 	gradshape.SetSize(_mdim, GetNumNodes()); 
 #ifdef RV_GSHAPE 
 	gradshape = 1.; 
-	CalcShape_RV(GetNumNodes()*2, _order+1, _dshapex.GetData(), 
-		_dshapey.GetData(), gradshape.GetData(), x.GetData()); 
+	CalcShape_RV(GetNumNodes()*2, _order+1, _ref->kernels->dshapex, 
+		_ref->kernels->dshapey, gradshape.GetData(), x.GetData()); 
 #else
-	for (int i=0; i<_dpp.GetSize(); i++) {
-		for (int j=0; j<_mdim; j++) {
-			gradshape(j, i) = _dpp[i][j](x); 
-		}
-	}
+	if (_mdim > 2) gradshape = 0.; 
+	_ref->kernels->gshape(x.GetData(), gradshape.GetData()); 
 #endif
 }
 
-void LagrangeQuad::CalcPhysGradShape(ElTrans& trans, 
-	Matrix& pgshape) const {
-	Matrix gshape; 
-	CalcGradShape(trans.GetX(), gshape); 
-	trans.InverseJacobian().Mult(gshape, pgshape); 
-}
-
 LagrangeTri::LagrangeTri(Array<MeshNode> node_list, int order, int mdim) 
 	: Element(node_list, order, TRI, mdim) {
+	PlaceNodes(); 
+	if (_order != 1) {
+		ERROR("order " << _order << " not defined"); 
+	}
+	// closed form basis: the reference element only records the type 
+	_ref = &RefElements.Get(LAGRANGE_BASIS, TRI, _order, _mdim, BuildLagrangeReference); 
+}
 
+void LagrangeTri::PlaceNodes() {
+	_nodes.Resize(0); 
 	for (int i=0; i<_geo_nodes.GetSize(); i++) {
 		_nodes.Append(Node(_geo_nodes[i].x, _nodes.GetSize(), 
 			_geo_nodes[i].id, _geo_nodes[i].bc)); 
 		_nodes[i].SetProcs(_geo_nodes[i].procs); 
 	}
-
-	if (_order == 1) {
-		_p.Append(Poly1D({1,-1})); 
-		_p.Append(Poly1D({0,1})); 
-	}
-
-	else {
-		ERROR("order " << _order << " not defined"); 
-	}
-
-	for (int i=0; i<_p.GetSize(); i++) {
-		_dp.Append(_p[i].Derivative()); 
-	}
 }
 
 void LagrangeTri::CalcShape(Point x, Vector& shape) const {
@@ -468,199 +454,23 @@ void LagrangeTri::CalcGradShape(Point x, Matrix& gradshape) const {
 	gradshape(1,2) = 1.; 
 }
 
-void LagrangeTri::CalcPhysGradShape(ElTrans& trans, Matrix& pgshape) const {
-	Matrix gshape; 
-	CalcGradShape(trans.GetX(), gshape); 
-	trans.InverseJacobian().Mult(gshape, pgshape); 
-}
-
 LagrangeHex::LagrangeHex(Array<MeshNode> node_list, int order, int mdim) : Element(node_list, order, HEX, mdim) {
+	_ref = &RefElements.Get(LAGRANGE_BASIS, HEX, _order, _mdim, BuildLagrangeReference); 
+	PlaceNodes(); 
+}
 
-	// append nodes 
-	for (int i=0; i<_geo_nodes.GetSize(); i++) {
-		_nodes.Append(Node(_geo_nodes[i].x, _nodes.GetSize(), _geo_nodes[i].id, _geo_nodes[i].bc)); 
-		_nodes[i].SetProcs(node_list[i].procs); 
-	}
-
-	if (_order == 2) {
-		Array<Node> nodes = _nodes; 
-
-		// bottom layer 
-		for (int i=0; i<4; i++) {
-			int next = (i+1)%4; 
-			Point x; 
-			for (int d=0; d<DIM; d++) {
-				x[d] = .5*(_nodes[i].GetX()[d] + _nodes[next].GetX()[d]); 
-			}
-
-			int bc; 
-			if (_nodes[i].GetBC()==_nodes[next].GetBC()) {
-				bc = _nodes[i].GetBC(); 
-			} else bc = INTERIOR; 
-			nodes.Append(Node(x, _nodes.GetSize()+i, -1, bc)); 
-			Array<int> procs; 
-			_nodes[i].GetProcs().Intersection(_nodes[next].GetProcs(), procs); 
-			procs.Sort(); 
-			nodes[nodes.GetSize()-1].SetProcs(procs); 
-		}
-
-		// add the center point 
-		Point x; 
-		for (int d=0; d<DIM; d++) {
-			for (int i=0; i<4; i++) {
-				x[d] += _nodes[i].GetX()[d]; 				
-			}
-			x[d] /= 4; 
-		}
-		nodes.Append(Node(x, nodes.GetSize(), -1, INTERIOR)); 
-
-		// middle layer 
-		Array<Node> corners; 
-		for (int i=0; i<4; i++) {
-			int next = i+4; 
-			x = {0,0,0}; 
-			for (int d=0; d<DIM; d++) {
-				x[d] = .5*(_nodes[i].GetX()[d] + _nodes[next].GetX()[d]); 
-			}
-			int bc; 
-			if (_nodes[i].GetBC() == _nodes[next].GetBC()) bc = _nodes[i].GetBC(); 
-			else bc = INTERIOR; 
-			nodes.Append(Node(x, nodes.GetSize(), -1, bc)); 
-			corners.Append(nodes[nodes.GetSize()-1]); 
-		}
-
-		for (int i=0; i<4; i++) {
-			int next = (i+1)%4; 
-			x = {0,0,0}; 
-			for (int d=0; d<DIM; d++) {
-				x[d] = .5*(corners[i].GetX()[d] + corners[next].GetX()[d]); 
-			}
-			int bc; 
-			if (corners[i].GetBC() == corners[next].GetBC()) bc = corners[i].GetBC(); 
-			else bc = INTERIOR; 
-			nodes.Append(Node(x, nodes.GetSize(), -1, bc)); 
-		}
-		// add center point 
-		x = {0,0,0}; 
-		for (int d=0; d<DIM; d++) {
-			for (int i=0; i<4; i++) {
-				x[d] += corners[i].GetX()[d]; 
-			}
-			x[d] /= 4; 
-		}
-		nodes.Append(Node(x, nodes.GetSize(), -1, INTERIOR)); 
-
-		// top layer 
-		for (int i=4; i<8; i++) {
-			int next = (i+1)%4 + 4; 
-			Point x; 
-			for (int d=0; d<DIM; d++) {
-				x[d] = .5*(_nodes[i].GetX()[d] + _nodes[next].GetX()[d]); 
-			}
-
-			int bc; 
-			if (_nodes[i].GetBC()==_nodes[next].GetBC()) {
-				bc = _nodes[i].GetBC(); 
-			} else bc = INTERIOR; 
-			nodes.Append(Node(x, nodes.GetSize(), -1, bc)); 
-			Array<int> procs; 
-			_nodes[i].GetProcs().Intersection(_nodes[next].GetProcs(), procs); 
-			procs.Sort(); 
-			nodes[nodes.GetSize()-1].SetProcs(procs); 
-		}
-		// add center point 
-		x = {0,0,0}; 
-		for (int d=0; d<DIM; d++) {
-			for (int i=4; i<8; i++) {
-				x[d] += _nodes[i].GetX()[d]; 
-			}
-			x[d] /= 4; 
-		}
-		nodes.Append(Node(x, nodes.GetSize(), -1, INTERIOR)); 
-
-		_nodes = nodes; 
-	} else if (_order > 2) ERROR("order " << _order << " not implemented"); 
-
-	GenLagrangePolynomials(_order, -1, 1, _p); 
-	if (_order == 1) {
-		// bottom quad 
-		_pp.Append(PolyProduct(_p[0], _p[0], _p[0])); 
-		_pp.Append(PolyProduct(_p[1], _p[0], _p[0])); 
-		_pp.Append(PolyProduct(_p[1], _p[1], _p[0])); 
-		_pp.Append(PolyProduct(_p[0], _p[1], _p[0])); 
-
-		// top quad 
-		_pp.Append(PolyProduct(_p[0], _p[0], _p[1])); 
-		_pp.Append(PolyProduct(_p[1], _p[0], _p[1])); 
-		_pp.Append(PolyProduct(_p[1], _p[1], _p[1])); 
-		_pp.Append(PolyProduct(_p[0], _p[1], _p[1])); 
-	} else if (_order == 2) {
-		// bottom four 
-		_pp.Append(PolyProduct(_p[0], _p[0], _p[0])); 
-		_pp.Append(PolyProduct(_p[2], _p[0], _p[0]));
-		_pp.Append(PolyProduct(_p[2], _p[2], _p[0]));
-		_pp.Append(PolyProduct(_p[0], _p[2], _p[0]));
-		// top four 
-		_pp.Append(PolyProduct(_p[0], _p[0], _p[2])); 
-		_pp.Append(PolyProduct(_p[2], _p[0], _p[2]));
-		_pp.Append(PolyProduct(_p[2], _p[2], _p[2]));
-		_pp.Append(PolyProduct(_p[0], _p[2], _p[2]));
-		
-		// bottom ho nodes 
-		_pp.Append(PolyProduct(_p[1], _p[0], _p[0]));
-		_pp.Append(PolyProduct(_p[2], _p[1], _p[0]));
-		_pp.Append(PolyProduct(_p[1], _p[2], _p[0]));
-		_pp.Append(PolyProduct(_p[0], _p[1], _p[0]));
-		_pp.Append(PolyProduct(_p[1], _p[1], _p[0]));
-
-		// middle ho nodes
-		_pp.Append(PolyProduct(_p[0], _p[0], _p[1])); 
-		_pp.Append(PolyProduct(_p[2], _p[0], _p[1]));
-		_pp.Append(PolyProduct(_p[2], _p[2], _p[1]));
-		_pp.Append(PolyProduct(_p[0], _p[2], _p[1]));
-
-		_pp.Append(PolyProduct(_p[1], _p[0], _p[1]));
-		_pp.Append(PolyProduct(_p[2], _p[1], _p[1]));
-		_pp.Append(PolyProduct(_p[1], _p[2], _p[1]));
-		_pp.Append(PolyProduct(_p[0], _p[1], _p[1]));
-		_pp.Append(PolyProduct(_p[1], _p[1], _p[1]));
-		
-		// top ho nodes 
-		_pp.Append(PolyProduct(_p[1], _p[0], _p[2]));
-		_pp.Append(PolyProduct(_p[2], _p[1], _p[2]));
-		_pp.Append(PolyProduct(_p[1], _p[2], _p[2]));
-		_pp.Append(PolyProduct(_p[0], _p[1], _p[2]));
-		_pp.Append(PolyProduct(_p[1], _p[1], _p[2]));
-	}
-	CHECK(_pp.GetSize() == _nodes.GetSize()); 
-
-	// get gradients 
-	_dpp.Resize(_pp.GetSize()); 
-	for (int i=0; i<_pp.GetSize(); i++) {
-		_pp[i].Gradient(_dpp[i]); 
-	}
+void LagrangeHex::PlaceNodes() {
+	BuildTensorNodes(*_ref->kernels, _geo_nodes, _nodes); 
 }
 
 void LagrangeHex::CalcShape(Point x, Vector& shape) const {
 	shape.Resize(GetNumNodes()); 
-	for (int i=0; i<GetNumNodes(); i++) {
-		shape[i] = _pp[i](x); 
-	}
+	_ref->kernels->shape(x.GetData(), shape.GetData()); 
 }
 
 void LagrangeHex::CalcGradShape(Point x, Matrix& gradshape) const {
 	gradshape.SetSize(_mdim, GetNumNodes()); 
-	for (int i=0; i<_dpp.GetSize(); i++) {
-		for (int j=0; j<_mdim; j++) {
-			gradshape(j, i) = _dpp[i][j](x); 
-		}
-	}
-}
-
-void LagrangeHex::CalcPhysGradShape(ElTrans& trans, Matrix& pgshape) const {
-	Matrix gshape; 
-	CalcGradShape(trans.GetX(), gshape); 
-	trans.InverseJacobian().Mult(gshape, pgshape); 
+	_ref->kernels->gshape(x.GetData(), gradshape.GetData()); 
 }
 
 } // end namespace fem 
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include "FESpace.hpp"
 #include "Element.hpp"
 #include "Polynomial.hpp"
+#include "LagrangeBasis.hpp"
 
 #ifdef USE_RISCV 
 extern "C" void CalcShape_RV(int Nn, int Nc, 
@@ -13,12 +14,31 @@ extern "C" void CalcShape_RV(int Nn, int Nc,
 namespace fem 
 {
 
+struct EntityNumbering; 
+
+/// point a reference element at the compile time kernels of its geometry and order 
+void BuildLagrangeReference(ReferenceElement& ref); 
+
 /// collection of lagrange finite elements 
 class LagrangeSpace : public FESpace {
 public:
 	/// constructor 
-	LagrangeSpace(const Mesh& mesh, int order, int vdim=1); 
+	/** if compact is true the flat storage of FESpace::Compact is filled one element 
+		at a time with a single scratch element, so the Element objects of the whole 
+		space never exist at once */ 
+	LagrangeSpace(const Mesh& mesh, int order, int vdim=1, bool compact=false); 
+	/// reopen a compact space from a snapshot written by FESpace::Save 
+	LagrangeSpace(const Mesh& mesh, const SnapshotReader& snap); 
+protected:
+	/// build the lagrange element for mesh element e 
+	Element* CreateElement(int e) const; 
 private:
+	/// number the edge, face, and cell nodes of el, storing new ones in the space 
+	/** edges and faces are identified by their sorted vertex ids so 
+		neighboring elements agree on their numbering regardless of orientation */ 
+	void NumberEntityNodes(Element& el, EntityNumbering& num); 
+	/// build the space directly in compact storage 
+	void BuildCompact(); 
 }; 
 
 /// represent a lagrange line element 
@@ -31,11 +51,9 @@ public:
 	void CalcShape(Point x, Vector& shape) const; 
 	/// evaluate gradient of basis functions 
 	void CalcGradShape(Point x, Matrix& gradshape) const; 
-private:
-	/// 1D polynomials 
-	Array<Poly1D> _p; 
-	/// gradients of 1D polynomials 
-	Array<Poly1D> _dp; 
+protected:
+	/// place the nodes on the tensor product lattice 
+	void PlaceNodes(); 
 }; 
 
 /// represent a lagrange quadrilateral finite element 
@@ -50,25 +68,9 @@ public:
 	/// evaluate gradient of basis functions 
 	void CalcGradShape(Point x, 
 		Matrix& gradshape) const; 
-	/// evaluate gradient of basis functions in physical space 
-	void CalcPhysGradShape(ElTrans& trans, Matrix& pgshape) const; 
-private:
-	/// 1D polynomials for x direction 
-	Array<Poly1D> _p;
-	/// 1D polynomials for gradient of basis function 
-	Array<Poly1D> _dp; 
-	/// products of 1D polynomials 
-	Array<PolyProduct> _pp; 
-	/// gradients 
-	Array<Array<PolyProduct>> _dpp; 
-	/// batched version of 1d x shape functions 
-	Array<double> _shapex; 
-	/// batched version of 1d y shape functions 
-	Array<double> _shapey; 
-	/// batched derivative of x shape functions 
-	Array<double> _dshapex; 
-	/// batched derivative of y shape functions 
-	Array<double> _dshapey; 
+protected:
+	/// place the nodes on the tensor product lattice 
+	void PlaceNodes(); 
 }; 
 
 /// represent a lagrange triangle finite element 
@@ -81,13 +83,9 @@ public:
 	void CalcShape(Point x, Vector& shape) const; 
 	/// evaluate gradient of basis functions (in reference space) 
 	void CalcGradShape(Point x, Matrix& gradshape) const; 
-	/// evaluate gradients in physical space 
-	void CalcPhysGradShape(ElTrans& trans, Matrix& pgshape) const; 
-private:
-	/// 1d polynomials for basis functions 
-	Array<Poly1D> _p; 
-	/// 1d polynomials for gradient of basis functions 
-	Array<Poly1D> _dp; 
+protected:
+	/// place one node on each vertex 
+	void PlaceNodes(); 
 }; 
 
 /// represent a 3D hexahedral element (cube) 
@@ -100,17 +98,9 @@ public:
 	void CalcShape(Point x, Vector& shape) const; 
 	/// evaluate gradient of basis functions 
 	void CalcGradShape(Point x, Matrix& gradshape) const; 
-	/// evaluate gradient in physical space 
-	void CalcPhysGradShape(ElTrans& trans, Matrix& pgshape) const; 
-private:
-	/// array of 1D shape functions 
-	Array<Poly1D> _p; 
-	/// array of derivatives of 1D shape functions 
-	Array<Poly1D> _dp; 
-	/// polynomial products to create 3D shape functions 
-	Array<PolyProduct> _pp; 
-	/// polynomial products for 3D gradients 
-	Array<Array<PolyProduct>> _dpp; 
+protected:
+	/// place the nodes on the tensor product lattice 
+	void PlaceNodes(); 
 }; 
 
 }
\ No newline at end of file
@@ -6,18 +6,20 @@ namespace fem
 {
 
 void DomainIntegrator::Assemble(Element& el, Vector& elvec) {
-	CH_TIMERS("domain integrator"); 
+	CH_TIMERS_FINE("domain integrator"); 
 	Quadrature* quad = QRules.Get(el.GetType(), 
 		_oa*el.GetOrder()+_ob, INTEGRATION_TYPE); 
+	const ShapeTable& table = STables.Get(el, quad); 
 	elvec.SetSize(el.GetNumNodes()); 
 	elvec = 0; 
 	ElTrans& trans = el.GetTrans(); 
-	double c = 1.; 
+	_cv.Resize(quad->NumPoints()); 
+	if (_c) _c->Eval(trans, table, _cv.GetData()); 
+	else _cv = 1.; 
 	for (int n=0; n<quad->NumPoints(); n++) {
-		trans.SetX(quad->X(n)); 
-		el.CalcShape(quad->X(n), _shape); 
-		if (_c) c = _c->Eval(trans, quad->X(n)); 
-		_shape *= quad->Weight(n) * trans.Determinant() * c; 
+		trans.SetX(table, n); 
+		_shape = trans.Shape(); 
+		_shape *= quad->Weight(n) * trans.Determinant() * _cv[n]; 
 		elvec += _shape; 
 	}
 }
@@ -37,6 +37,8 @@ private:
 	Vector _shape; 
 	/// store function for Q 
 	Coefficient* _c; 
+	/// values of Q at the quadrature points 
+	Array<double> _cv; 
 	/// quadrature order function coefficient 
 	int _oa; 
 	int _ob; 
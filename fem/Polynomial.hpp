@@ -26,12 +26,12 @@ public:
 	/** evaluates in ascending powers \f[ f(x) = \sum_i c_i x^i \f] */ 
 	void SetCoef(std::vector<double> c) {_c = c; }	
 
-	/// evaluate polynomial 
+	/// evaluate polynomial (Horner's rule) 
 	inline double Eval(double x) const {
 		CHECK(_c.size() > 0); 
 		double ret = 0; 
-		for (int i=0; i<_c.size(); i++) {
-			ret += _c[i] * pow(x, i); 
+		for (int i=_c.size()-1; i>=0; i--) {
+			ret = ret*x + _c[i]; 
 		}
 		return ret; 
 	}
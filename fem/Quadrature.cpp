@@ -83,8 +83,31 @@ QuadLegendre::QuadLegendre(int p) : Quadrature(p) {
 		}
 
 		default : {
-			ERROR("legendre integration of order " << _p 
+			// compute the roots of P_p with Newton's method on [-1,1] 
+			if (_p < 1) ERROR("legendre integration of order " << _p 
 				<< " not implemented"); 
+			x.Resize(_p); 
+			_w.Resize(_p); 
+			for (int i=0; i<_p; i++) {
+				double z = -cos(M_PI*(i+.75)/(_p+.5)); 
+				double dp = 1.; 
+				for (int it=0; it<100; it++) {
+					// three term recurrence for P_p(z) and its derivative 
+					double p0 = 1., p1 = z; 
+					for (int k=2; k<=_p; k++) {
+						double p2 = ((2*k-1)*z*p1 - (k-1)*p0)/k; 
+						p0 = p1; 
+						p1 = p2; 
+					}
+					dp = _p*(z*p1 - p0)/(z*z - 1.); 
+					double dz = p1/dp; 
+					z -= dz; 
+					if (fabs(dz) < 1e-15) break; 
+				}
+				x[i] = .5*(z + 1.); 
+				_w[i] = 1./((1. - z*z)*dp*dp); 
+			}
+			break; 
 		}
 	}
 
@@ -16,7 +16,8 @@ RHS::RHS(const FESpace* space, Quadrature* gq) {
 
 void RHS::AddIntegrator(LinearIntegrator* integ) {
 	for (int n=0; n<_space->GetNumElements(); n++) {
-		Element& el = _space->GetEl(n); 
+		ElementHandle view; 
+		Element& el = _space->GetEl(n, view); 
 		Vector local(el.GetNumNodes()); 
 		integ->Assemble(el, local); 
 		for (int i=0; i<el.GetNumNodes(); i++) {
@@ -30,7 +31,8 @@ void RHS::AddIntegrator(LinearIntegrator* integ) {
 void RHS::AddBoundaryIntegrator(LinearIntegrator* integ) {
 	Vector local;
 	for (int n=0; n<_space->GetNumElements(); n++) {
-		Element& el = _space->GetEl(n); 
+		ElementHandle view; 
+		Element& el = _space->GetEl(n, view); 
 		for (int f=0; f<FacesPerEl(el.GetType()); f++) {
 			if (el.GetNeighbor(f) < 0) {
 				ElTrans& face = el.GetFaceTransFromFace(f);
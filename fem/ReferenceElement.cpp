@@ -0,0 +1,49 @@
+#include "ReferenceElement.hpp"
+#include "Element.hpp"
+
+using namespace std; 
+
+namespace fem 
+{
+
+ReferenceElements RefElements; 
+
+ReferenceElement::ReferenceElement(int family, int geo, int order, int mdim) {
+	this->family = family; 
+	this->geo = geo; 
+	this->order = order; 
+	this->mdim = mdim; 
+	kernels = NULL; 
+}
+
+ReferenceElement::~ReferenceElement() {
+	for (int f=0; f<faces.GetSize(); f++) {
+		delete faces[f]; 
+	}
+}
+
+Element& ReferenceElement::GetFace(int f) const {
+	CHECKMSG(f < faces.GetSize(), "reference face transformation not initialized"); 
+	return *faces[f]; 
+}
+
+ReferenceElements::~ReferenceElements() {
+	for (auto it=_refs.begin(); it!=_refs.end(); ++it) {
+		delete it->second; 
+	}
+}
+
+const ReferenceElement& ReferenceElements::Get(int family, int geo, int order, int mdim, 
+	void (*build)(ReferenceElement&)) {
+	Key key(family, geo, order, mdim); 
+	auto it = _refs.find(key); 
+	if (it != _refs.end()) return *it->second; 
+	CH_TIMERS("build reference element"); 
+	// store before building: face builders add their own entries 
+	ReferenceElement* ref = new ReferenceElement(family, geo, order, mdim); 
+	_refs[key] = ref; 
+	build(*ref); 
+	return *ref; 
+}
+
+} // end namespace fem 
\ No newline at end of file
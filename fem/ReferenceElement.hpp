@@ -0,0 +1,74 @@
+#pragma once 
+
+#include "General.hpp"
+#include "Array.hpp"
+#include "Polynomial.hpp"
+#include <map>
+#include <tuple>
+
+namespace fem 
+{
+
+class Element; 
+struct LagrangeKernels; 
+
+/// basis families that share reference data 
+enum BasisFamily {
+	LAGRANGE_BASIS, 
+	L2_BASIS 
+}; 
+
+/// data shared by every element of one family, geometry, order, and mesh dimension 
+/** filled once by the element class's builder and owned by RefElements. 
+	Physical elements only store their nodes and geometry plus a pointer to this */ 
+struct ReferenceElement {
+	/// constructor 
+	ReferenceElement(int family, int geo, int order, int mdim); 
+	/// destructor (deletes the face elements) 
+	~ReferenceElement(); 
+	/// return the reference transformation of face f 
+	Element& GetFace(int f) const; 
+
+	/// basis family 
+	int family; 
+	/// gmsh geometry type 
+	int geo; 
+	/// polynomial order 
+	int order; 
+	/// mesh dimension 
+	int mdim; 
+	/// compile time basis kernels (NULL if the family has none) 
+	const LagrangeKernels* kernels; 
+	/// 1d polynomials 
+	Array<Poly1D> p; 
+	/// derivatives of the 1d polynomials 
+	Array<Poly1D> dp; 
+	/// tensor product basis functions 
+	Array<PolyProduct> pp; 
+	/// gradients of the tensor product basis functions 
+	Array<Array<PolyProduct>> dpp; 
+	/// elements mapping the reference face to reference space, one per face (owned) 
+	Array<Element*> faces; 
+}; 
+
+/// registry of ReferenceElements keyed by (family, geometry, order, mesh dimension) 
+class ReferenceElements {
+public:
+	/// destructor 
+	~ReferenceElements(); 
+	/// return the reference element, calling build to fill it on first use 
+	const ReferenceElement& Get(int family, int geo, int order, int mdim, 
+		void (*build)(ReferenceElement&)); 
+	/// number of reference elements 
+	int GetSize() const {return _refs.size(); }
+private:
+	/// (family, geometry, order, mesh dimension) 
+	typedef std::tuple<int, int, int, int> Key; 
+	/// stored reference elements 
+	std::map<Key, ReferenceElement*> _refs; 
+}; 
+
+/// global ReferenceElements 
+extern ReferenceElements RefElements; 
+
+} // end namespace fem 
\ No newline at end of file
@@ -0,0 +1,70 @@
+#include "ShapeTable.hpp"
+#include "Element.hpp"
+
+using namespace std; 
+
+namespace fem 
+{
+
+ShapeTables STables; 
+
+ShapeTable::ShapeTable(const Element& el, const Quadrature* quad) {
+	CH_TIMERS("build shape table"); 
+	_quad = quad; 
+	_nq = quad->NumPoints(); 
+	_nn = el.GetNumNodes(); 
+
+	Vector shape; 
+	Matrix gshape; 
+	el.CalcGradShape(quad->X(0), gshape); 
+	_gdim = gshape.Height(); 
+	_shape.Resize(_nq*_nn); 
+	_gshape.Resize(_nq*_gdim*_nn); 
+	for (int q=0; q<_nq; q++) {
+		el.CalcShape(quad->X(q), shape); 
+		el.CalcGradShape(quad->X(q), gshape); 
+		CHECK(shape.GetSize() == _nn && gshape.Width() == _nn); 
+		for (int i=0; i<_nn; i++) {
+			_shape[q*_nn+i] = shape[i]; 
+		}
+		for (int i=0; i<_gdim*_nn; i++) {
+			_gshape[q*_gdim*_nn+i] = gshape.GetData()[i]; 
+		}
+	}
+}
+
+void ShapeTable::GetShape(int q, Vector& shape) const {
+	CHECK(q < _nq); 
+	shape.SetSize(_nn); 
+	const double* s = Shape(q); 
+	for (int i=0; i<_nn; i++) {
+		shape[i] = s[i]; 
+	}
+}
+
+void ShapeTable::GetGradShape(int q, Matrix& gshape) const {
+	CHECK(q < _nq); 
+	if (gshape.Height() != _gdim || gshape.Width() != _nn) gshape.SetSize(_gdim, _nn); 
+	const double* g = GradShape(q); 
+	double* data = gshape.GetData(); 
+	for (int i=0; i<_gdim*_nn; i++) {
+		data[i] = g[i]; 
+	}
+}
+
+ShapeTables::~ShapeTables() {
+	for (auto it=_tables.begin(); it!=_tables.end(); ++it) {
+		delete it->second; 
+	}
+}
+
+const ShapeTable& ShapeTables::Get(const Element& el, const Quadrature* quad) {
+	Key key(type_index(typeid(el)), el.GetType(), el.GetOrder(), el.GetMeshDim(), quad); 
+	auto it = _tables.find(key); 
+	if (it != _tables.end()) return *it->second; 
+	ShapeTable* table = new ShapeTable(el, quad); 
+	_tables[key] = table; 
+	return *table; 
+}
+
+} // end namespace fem 
\ No newline at end of file
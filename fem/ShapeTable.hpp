@@ -0,0 +1,74 @@
+#pragma once 
+
+#include "General.hpp"
+#include "Array.hpp"
+#include "Vector.hpp"
+#include "Matrix.hpp"
+#include "Quadrature.hpp"
+#include <map>
+#include <tuple>
+#include <typeindex>
+
+namespace fem 
+{
+
+class Element; 
+
+/// basis functions and reference gradients at every point of a quadrature rule 
+/** values are stored point by point: shape (NumNodes) and 
+	gradient (GradDim x NumNodes, row major) blocks are contiguous */ 
+class ShapeTable {
+public:
+	/// evaluate the basis of el at all points of quad 
+	ShapeTable(const Element& el, const Quadrature* quad); 
+	/// return the quadrature rule the table was built for 
+	const Quadrature* GetQuadrature() const {return _quad; }
+	/// number of quadrature points 
+	int NumPoints() const {return _nq; }
+	/// number of basis functions 
+	int NumNodes() const {return _nn; }
+	/// number of rows of the gradient blocks 
+	int GradDim() const {return _gdim; }
+	/// basis functions at point q 
+	const double* Shape(int q) const {return &_shape[q*_nn]; }
+	/// reference gradients at point q 
+	const double* GradShape(int q) const {return &_gshape[q*_gdim*_nn]; }
+	/// copy the basis functions at point q 
+	void GetShape(int q, Vector& shape) const; 
+	/// copy the reference gradients at point q 
+	void GetGradShape(int q, Matrix& gshape) const; 
+private:
+	/// quadrature rule 
+	const Quadrature* _quad; 
+	/// number of points 
+	int _nq; 
+	/// number of basis functions 
+	int _nn; 
+	/// rows in the gradient 
+	int _gdim; 
+	/// basis functions (NumPoints x NumNodes) 
+	Array<double> _shape; 
+	/// gradients (NumPoints x GradDim x NumNodes) 
+	Array<double> _gshape; 
+}; 
+
+/// cache of ShapeTables keyed by element type, order, and quadrature rule 
+class ShapeTables {
+public:
+	/// destructor 
+	~ShapeTables(); 
+	/// get the table for el's basis at quad, building it on first use 
+	const ShapeTable& Get(const Element& el, const Quadrature* quad); 
+	/// number of cached tables 
+	int GetSize() const {return _tables.size(); }
+private:
+	/// (element class, geometry, order, mesh dimension, rule) 
+	typedef std::tuple<std::type_index, int, int, int, const Quadrature*> Key; 
+	/// stored tables 
+	std::map<Key, ShapeTable*> _tables; 
+}; 
+
+/// global ShapeTables 
+extern ShapeTables STables; 
+
+} // end namespace fem 
\ No newline at end of file
@@ -0,0 +1,47 @@
+#include "SpaceCache.hpp"
+#include "Snapshot.hpp"
+
+using namespace std; 
+
+namespace fem 
+{
+
+uint64_t SpaceCache::Key(const string& mesh_file, int order, int vdim, int nref) {
+	MappedFile file(MESH_DIR + mesh_file); 
+	if (!file.Good()) ERROR("meshfile " << mesh_file << " not read"); 
+	uint64_t h = HashBytes(file.GetData(), file.GetSize()); 
+	int params[4] = {order, vdim, nref, SNAPSHOT_VERSION}; 
+	return HashBytes(params, sizeof(params), h); 
+}
+
+SpaceCache::SpaceCache(const string& mesh_file, int order, int vdim, int nref, 
+	const string& dir) {
+	CH_TIMERS_COARSE("open space cache"); 
+	uint64_t key = Key(mesh_file, order, vdim, nref); 
+	_name = SnapshotName(dir, "space", key); 
+
+	{
+		SnapshotReader snap(_name, key); 
+		_hit = snap.Good(); 
+		if (_hit) {
+			_mesh = new Mesh; 
+			_mesh->Load(snap); 
+			_space = new LagrangeSpace(*_mesh, snap); 
+			return; 
+		}
+	}
+
+	_mesh = new Mesh(mesh_file, nref); 
+	_space = new LagrangeSpace(*_mesh, order, vdim, true); 
+	SnapshotWriter snap(_name, key); 
+	_mesh->Save(snap); 
+	_space->Save(snap); 
+	snap.Close(); 
+}
+
+SpaceCache::~SpaceCache() {
+	delete _space; 
+	delete _mesh; 
+}
+
+} // end namespace fem 
\ No newline at end of file
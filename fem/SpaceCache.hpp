@@ -0,0 +1,53 @@
+#pragma once 
+
+#include <cstdint>
+#include "General.hpp"
+#include "Mesh.hpp"
+#include "LagrangeSpace.hpp"
+
+namespace fem 
+{
+
+/// mesh and lagrange space reopened from a snapshot when their inputs have not changed 
+/** snapshots are keyed by a hash of the contents of the mesh file, the order, the 
+	vector dimension, the number of refinements, and SNAPSHOT_VERSION. On a match the 
+	mesh and a compact space are copied out of the mapped snapshot without parsing 
+	the mesh file, finding neighbors, or numbering nodes. Otherwise they are built 
+	and the snapshot is written for the next run */ 
+class SpaceCache {
+public:
+	/// load or build the mesh and space 
+	/** \param mesh_file gmsh file (relative to the mesh directory) 
+		\param order FEM order 
+		\param vdim vector dimension 
+		\param nref number of uniform refinements 
+		\param dir directory snapshots are kept in */ 
+	SpaceCache(const std::string& mesh_file, int order, int vdim=1, int nref=0, 
+		const std::string& dir=""); 
+	/// destructor 
+	~SpaceCache(); 
+	/// return the mesh 
+	Mesh& GetMesh() {return *_mesh; }
+	/// return the space 
+	LagrangeSpace& GetSpace() {return *_space; }
+	/// return true if the mesh and space were read from a snapshot 
+	bool FromSnapshot() const {return _hit; }
+	/// return the snapshot file name 
+	const std::string& GetSnapshotName() const {return _name; }
+	/// return the snapshot key for a set of inputs 
+	static uint64_t Key(const std::string& mesh_file, int order, int vdim, int nref); 
+private:
+	/// no copies 
+	SpaceCache(const SpaceCache&) = delete; 
+
+	/// mesh 
+	Mesh* _mesh; 
+	/// space on _mesh 
+	LagrangeSpace* _space; 
+	/// snapshot file name 
+	std::string _name; 
+	/// true if read from the snapshot 
+	bool _hit; 
+}; 
+
+} // end namespace fem 
\ No newline at end of file
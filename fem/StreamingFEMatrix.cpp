@@ -0,0 +1,269 @@
+#include "StreamingFEMatrix.hpp"
+#include "FEMatrix.hpp"
+#include "MatrixView.hpp"
+#ifndef USE_RISCV
+#include <future>
+#include <fcntl.h>
+#endif
+
+using namespace std; 
+
+namespace fem 
+{
+
+/// seconds since start 
+static inline double Seconds(const chrono::steady_clock::time_point& start) {
+	return chrono::duration<double>(chrono::steady_clock::now() - start).count(); 
+}
+
+void StreamStats::Print(ostream& out) const {
+	out << "streamed " << bytes/1e9 << " GB in " << mults << " matvecs" << endl; 
+	out << "read " << read << " s (" << Bandwidth()/1e9 << " GB/s), compute "
+		<< compute << " s, waited " << wait << " s" << endl; 
+	out << (DiskBound() ? "disk bound" : "compute bound") << endl; 
+}
+
+StreamingFEMatrix::StreamingFEMatrix(const FESpace* space, const string& file,
+	size_t chunk_bytes) : Operator(space->GetVSize()) {
+	_space = space; 
+	_name = file; 
+	_chunk_bytes = chunk_bytes; 
+	_written = false; 
+	_packed = true; 
+	int Ne = _space->GetNumElements(); 
+	_doffsets.Resize(Ne+1); 
+	_N = (Ne > 0) ? _space->GetVDim()*_space->GetElNumNodes(0) : 0; 
+	_Nmax = 0; 
+	for (int e=0; e<Ne; e++) {
+		int n = _space->GetVDim()*_space->GetElNumNodes(e); 
+		if (n != _N) _N = -1; 
+		_Nmax = std::max(_Nmax, n); 
+		_doffsets[e+1] = _doffsets[e] + n; 
+	}
+	_vdofs.Resize(_doffsets[Ne]); 
+	Array<int> vdofs; 
+	for (int e=0; e<Ne; e++) {
+		_space->GetVDofs(e, vdofs); 
+		for (int i=0; i<vdofs.GetSize(); i++) {
+			_vdofs[_doffsets[e]+i] = vdofs[i]; 
+		}
+	}
+	Layout(chunk_bytes); 
+
+	_file = fopen(_name.c_str(), "w+b"); 
+	if (!_file) ERROR("could not open " << _name); 
+#ifndef USE_RISCV
+	// matvecs read the file front to back 
+	posix_fadvise(fileno(_file), 0, 0, POSIX_FADV_SEQUENTIAL); 
+#endif
+	ResetStats(); 
+}
+
+StreamingFEMatrix::~StreamingFEMatrix() {
+	fclose(_file); 
+	remove(_name.c_str()); 
+}
+
+void StreamingFEMatrix::Mult(const Vector& x, Vector& b) const {
+	CH_TIMERS_COARSE("streaming FEMatrix mat vec"); 
+	CHECKMSG(_written, "no integrators added"); 
+	if (b.GetSize() != Height()) b.SetSize(Height()); 
+	int nc = GetNumChunks(); 
+	if (nc == 0) return; 
+	auto start = chrono::steady_clock::now(); 
+	double compute = 0.; 
+
+	// chunk c is multiplied from _buf[c%2] while chunk c+1 is read into the other 
+#ifdef USE_RISCV
+	auto Read = [this](int c) {return ReadChunk(c, _buf[c%2].GetData()); }; 
+	auto Finish = [](double t) {return t; }; 
+	double pending = Read(0); 
+#else
+	auto Read = [this](int c) {
+		return async(launch::async, &StreamingFEMatrix::ReadChunk, this, c,
+			_buf[c%2].GetData()); 
+	}; 
+	auto Finish = [](future<double>& f) {return f.get(); }; 
+	future<double> pending = Read(0); 
+#endif
+	for (int c=0; c<nc; c++) {
+		_stats.read += Finish(pending); 
+		if (c+1 < nc) pending = Read(c+1); 
+		auto cstart = chrono::steady_clock::now(); 
+		BatchMult(_chunks[c], _chunks[c+1], _N, _Nmax, _packed, _buf[c%2].GetData(),
+			_local.GetData(), _doffsets.GetData(), _vdofs.GetData(),
+			x.GetData(), b.GetData()); 
+		compute += Seconds(cstart); 
+	}
+	_stats.mults++; 
+	_stats.bytes += GetFileSize(); 
+	_stats.compute += compute; 
+	_stats.wait += Seconds(start) - compute; 
+}
+
+void StreamingFEMatrix::AddIntegrator(BilinearIntegrator* integ) {
+	Array<BilinearIntegrator*> integs(1); 
+	integs[0] = integ; 
+	AddIntegrators(integs); 
+}
+
+void StreamingFEMatrix::AddIntegrators(const Array<BilinearIntegrator*>& integs) {
+	CH_TIMERS_COARSE("streaming FEMatrix assembly"); 
+	bool symmetric = true; 
+	for (int i=0; i<integs.GetSize(); i++) {
+		symmetric = symmetric && integs[i]->IsSymmetric(); 
+	}
+	if (!symmetric) Unpack(); 
+
+	double* buf = _buf[0].GetData(); 
+	for (int c=0; c<GetNumChunks(); c++) {
+		if (_written) ReadChunk(c, buf); 
+		else {
+			for (size_t i=0; i<ChunkSize(c); i++) buf[i] = 0.; 
+		}
+		for (int i=0; i<integs.GetSize(); i++) {
+			AssembleChunk(integs[i], c, buf); 
+		}
+		WriteChunk(c, buf); 
+	}
+	if (fflush(_file) != 0) ERROR("could not write " << _name); 
+	_written = true; 
+	for (int i=0; i<integs.GetSize(); i++) {
+		delete integs[i]; 
+	}
+}
+
+void StreamingFEMatrix::GetDiagonal(Vector& diag) const {
+	CHECKMSG(_written, "no integrators added"); 
+	diag.SetSize(Height()); 
+	diag = 0.; 
+	double* buf = _buf[0].GetData(); 
+	for (int c=0; c<GetNumChunks(); c++) {
+		ReadChunk(c, buf); 
+		for (int e=_chunks[c]; e<_chunks[c+1]; e++) {
+			int n = _doffsets[e+1] - _doffsets[e]; 
+			const MatrixView A(buf + _local[e], n, n,
+				_packed ? MatrixView::SYMMETRIC_PACKED : MatrixView::DENSE); 
+			for (int i=0; i<n; i++) {
+				diag[_vdofs[_doffsets[e]+i]] += A(i,i); 
+			}
+		}
+	}
+}
+
+void StreamingFEMatrix::Unpack() {
+	if (!_packed) return; 
+	CH_TIMERS_COARSE("unpack streaming FEMatrix"); 
+	Array<int64_t> poffsets = _offsets; 
+	Array<int> pchunks = _chunks; 
+	_packed = false; 
+	Layout(_chunk_bytes); 
+	if (!_written) return; 
+
+	// an element's full matrix never starts before its packed one, so going from the 
+	// last chunk to the first only overwrites packed data that was already read 
+	Array<double> packed, full; 
+	for (int c=pchunks.GetSize()-2; c>=0; c--) {
+		int e0 = pchunks[c]; 
+		int e1 = pchunks[c+1]; 
+		packed.Resize(poffsets[e1] - poffsets[e0]); 
+		full.Resize(_offsets[e1] - _offsets[e0]); 
+		Read(poffsets[e0], packed.GetSize(), packed.GetData()); 
+		for (int e=e0; e<e1; e++) {
+			int n = _doffsets[e+1] - _doffsets[e]; 
+			const MatrixView src(&packed[poffsets[e] - poffsets[e0]], n, n,
+				MatrixView::SYMMETRIC_PACKED); 
+			MatrixView dst(&full[_offsets[e] - _offsets[e0]], n, n); 
+			for (int i=0; i<n; i++) {
+				for (int j=0; j<n; j++) {
+					dst(i,j) = src(i,j); 
+				}
+			}
+		}
+		Write(_offsets[e0], full.GetSize(), full.GetData()); 
+	}
+	if (fflush(_file) != 0) ERROR("could not write " << _name); 
+}
+
+void StreamingFEMatrix::ResetStats() {
+	_stats.mults = 0; 
+	_stats.bytes = 0.; 
+	_stats.read = 0.; 
+	_stats.compute = 0.; 
+	_stats.wait = 0.; 
+}
+
+void StreamingFEMatrix::Layout(size_t chunk_bytes) {
+	int Ne = GetNumElements(); 
+	_offsets.Resize(Ne+1); 
+	for (int e=0; e<Ne; e++) {
+		int n = _doffsets[e+1] - _doffsets[e]; 
+		_offsets[e+1] = _offsets[e] + ((_packed) ? n*(n+1)/2 : n*n); 
+	}
+
+	// whole elements per chunk, at least one 
+	_chunks.Clear(); 
+	_chunks.Append(0); 
+	_local.Resize(Ne+1); 
+	int first = 0; 
+	int64_t largest = 0; 
+	for (int e=0; e<Ne; e++) {
+		if (e != first && sizeof(double)*(_offsets[e+1] - _offsets[first]) > chunk_bytes) {
+			largest = std::max(largest, _offsets[e] - _offsets[first]); 
+			_chunks.Append(e); 
+			first = e; 
+		}
+		_local[e] = _offsets[e] - _offsets[first]; 
+	}
+	if (Ne > 0) {
+		largest = std::max(largest, _offsets[Ne] - _offsets[first]); 
+		_chunks.Append(Ne); 
+	}
+	_buf[0].Resize(largest); 
+	_buf[1].Resize(largest); 
+}
+
+void StreamingFEMatrix::AssembleChunk(BilinearIntegrator* integ, int c, double* buf) {
+	int e0 = _chunks[c]; 
+	while (e0 < _chunks[c+1]) {
+		// extend the range over elements with the same type and size like FEMatrix 
+		int e1 = e0 + 1; 
+		while (e1 < _chunks[c+1]) {
+			if (_space->GetElType(e1) != _space->GetElType(e0)
+				|| _doffsets[e1+1] - _doffsets[e1] != _doffsets[e0+1] - _doffsets[e0]) break; 
+			e1++; 
+		}
+
+		if (!integ->AssembleBatch(*_space, e0, e1-e0, _packed, buf + _local[e0])) {
+			for (int n=e0; n<e1; n++) {
+				ElementHandle el_view; 
+				Element& el = _space->GetEl(n, el_view); 
+				Matrix elmat; 
+				integ->Assemble(el, elmat); 
+				int size = _doffsets[n+1] - _doffsets[n]; 
+				MatrixView view(buf + _local[n], size, size,
+					_packed ? MatrixView::SYMMETRIC_PACKED : MatrixView::DENSE); 
+				view += elmat; 
+			}
+		}
+		e0 = e1; 
+	}
+}
+
+double StreamingFEMatrix::Read(int64_t offset, size_t n, double* buf) const {
+	auto start = chrono::steady_clock::now(); 
+	if (fseek(_file, sizeof(double)*offset, SEEK_SET) != 0
+		|| fread(buf, sizeof(double), n, _file) != n) {
+		ERROR("could not read " << n << " doubles at " << offset << " of " << _name); 
+	}
+	return Seconds(start); 
+}
+
+void StreamingFEMatrix::Write(int64_t offset, size_t n, const double* buf) {
+	if (fseek(_file, sizeof(double)*offset, SEEK_SET) != 0
+		|| fwrite(buf, sizeof(double), n, _file) != n) {
+		ERROR("could not write " << n << " doubles at " << offset << " of " << _name); 
+	}
+}
+
+} // end namespace fem 
\ No newline at end of file
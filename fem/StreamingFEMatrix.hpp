@@ -0,0 +1,132 @@
+#pragma once 
+
+#include <cstdio>
+#include <cstdint>
+#include <string>
+#include "General.hpp"
+#include "Operator.hpp"
+#include "Vector.hpp"
+#include "FESpace.hpp"
+#include "Array.hpp"
+#include "BilinearIntegrator.hpp"
+
+namespace fem 
+{
+
+/// default size of the chunks a StreamingFEMatrix is read in 
+#define STREAM_CHUNK_BYTES (64 << 20)
+
+/// bytes and time spent by the matvecs of a StreamingFEMatrix 
+struct StreamStats {
+	/// number of matvecs 
+	int mults; 
+	/// bytes read from the file 
+	double bytes; 
+	/// seconds spent reading (overlapped with compute when reads are asynchronous) 
+	double read; 
+	/// seconds spent multiplying 
+	double compute; 
+	/// seconds the matvecs waited for reads to finish 
+	double wait; 
+	/// achieved read bandwidth in bytes per second 
+	double Bandwidth() const {return (read > 0) ? bytes/read : 0; }
+	/// true if the matvecs spent more time waiting for the disk than computing 
+	bool DiskBound() const {return wait > compute; }
+	/// print a summary 
+	void Print(std::ostream& out=std::cout) const; 
+}; 
+
+/// element by element matrix whose elemental matrices live in a file 
+/** for operators that do not fit in memory. The batch has the same layout as
+	FEMatrix's and is assembled and written one chunk of elements at a time. Mult
+	streams it back in chunks of about chunk_bytes through two buffers: the read of the
+	next chunk runs in the background while the current one is multiplied
+	(under USE_RISCV there are no threads and reads are synchronous).
+	The file is scratch space and is removed by the destructor */ 
+class StreamingFEMatrix : public Operator {
+public:
+	/// constructor 
+	/** \param space space to assemble on
+		\param file scratch file holding the batch
+		\param chunk_bytes approximate size of the chunks read at once */ 
+	StreamingFEMatrix(const FESpace* space, const std::string& file,
+		size_t chunk_bytes=STREAM_CHUNK_BYTES); 
+	/// close and remove the file 
+	~StreamingFEMatrix(); 
+	/// matrix vector product streamed from the file 
+	void Mult(const Vector& x, Vector& b) const; 
+	/// add a bilinear integrator (one read-modify-write pass over the file) 
+	void AddIntegrator(BilinearIntegrator* integ); 
+	/// add several integrators in a single pass over the file 
+	/** the batch is stored as packed upper triangles until a non-symmetric integrator is
+		added, which first rewrites the file with full matrices (like FEMatrix).
+		Takes ownership of integs */ 
+	void AddIntegrators(const Array<BilinearIntegrator*>& integs); 
+	/// extract the diagonal of the assembled matrix 
+	void GetDiagonal(Vector& diag) const; 
+	/// expand the stored packed upper triangles to full matrices in place 
+	void Unpack(); 
+
+	/// return the number of elemental matrices 
+	int GetNumElements() const {return _doffsets.GetSize()-1; }
+	/// return the number of chunks the file is read in 
+	int GetNumChunks() const {return _chunks.GetSize()-1; }
+	/// return the size of the file in bytes 
+	size_t GetFileSize() const {return sizeof(double)*_offsets[GetNumElements()]; }
+	/// return true if the file stores packed upper triangles 
+	bool IsPacked() const {return _packed; }
+	/// return the statistics of the matvecs so far 
+	const StreamStats& GetStats() const {return _stats; }
+	/// zero the statistics 
+	void ResetStats(); 
+private:
+	/// set _offsets and _chunks for the storage format 
+	void Layout(size_t chunk_bytes); 
+	/// add integ's matrices of chunk c to buf 
+	void AssembleChunk(BilinearIntegrator* integ, int c, double* buf); 
+	/// read chunk c into buf and return the seconds it took 
+	double ReadChunk(int c, double* buf) const {
+		return Read(_offsets[_chunks[c]], ChunkSize(c), buf); 
+	}
+	/// write chunk c from buf 
+	void WriteChunk(int c, const double* buf) {Write(_offsets[_chunks[c]], ChunkSize(c), buf); }
+	/// read n doubles starting offset doubles into the file and return the seconds it took 
+	double Read(int64_t offset, size_t n, double* buf) const; 
+	/// write n doubles starting offset doubles into the file 
+	void Write(int64_t offset, size_t n, const double* buf); 
+	/// return the number of entries in chunk c 
+	size_t ChunkSize(int c) const {return _offsets[_chunks[c+1]] - _offsets[_chunks[c]]; }
+
+	/// store the fespace 
+	const FESpace* _space; 
+	/// file name 
+	std::string _name; 
+	/// open file 
+	FILE* _file; 
+	/// requested chunk size 
+	size_t _chunk_bytes; 
+	/// true once the file has been written 
+	bool _written; 
+	/// true if only the upper triangles are stored 
+	bool _packed; 
+	/// size of the elemental matrices if they all match, -1 otherwise 
+	int _N; 
+	/// largest elemental matrix size 
+	int _Nmax; 
+	/// start of each element's matrix in the file (in doubles) 
+	Array<int64_t> _offsets; 
+	/// start of each element's matrix in its chunk 
+	Array<int> _local; 
+	/// start of each element's vdofs in _vdofs 
+	Array<int> _doffsets; 
+	/// the vdofs for each element contiguously 
+	Array<int> _vdofs; 
+	/// first element of each chunk 
+	Array<int> _chunks; 
+	/// the two chunk buffers 
+	mutable Array<double> _buf[2]; 
+	/// matvec statistics 
+	mutable StreamStats _stats; 
+}; 
+
+} // end namespace fem 
\ No newline at end of file
@@ -1,5 +1,15 @@
 #include "HWCounter.hpp"
 #include "General.hpp"
+#if !defined(__riscv) && defined(__linux__) 
+#define HWCOUNTER_PERF 
+#include <fstream>
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
 
 using namespace std; 
 
@@ -19,33 +29,164 @@ using namespace std;
 	READ_CSR(hpmcounter6); \
 	READ_CSR(hpmcounter7); \
 	READ_CSR(hpmcounter8); \
-	READ_CSR(hpmcounter9); 
+	READ_CSR(hpmcounter9); \
+	READ_CSR(instret); 
 
 namespace fem
 {
 
-void HWCounter::Reset() {
+#ifdef HWCOUNTER_PERF 
+/// one perf_event_open group holding every host counter 
+/** opened on first use and shared by all HWCounters. The group is read with a single 
+	read so all counters are sampled at the same instant */ 
+struct PerfGroup {
+	/// open the group 
+	PerfGroup(); 
+	/// close the events 
+	~PerfGroup(); 
+	/// open one event in the group and return true on success 
+	bool Open(HPM slot, uint32_t type, uint64_t config); 
+	/// read the current values into ctrs (zero for unavailable counters) 
+	void Read(array<uint64_t,NUMCOUNTERS>& ctrs) const; 
+
+	/// group leader (-1 if the group could not be opened) 
+	int leader; 
+	/// event descriptors in the order the group reports them 
+	vector<int> fds; 
+	/// counter each event fills 
+	vector<HPM> slots; 
+	/// description of the backend 
+	string backend; 
+}; 
+
+PerfGroup::PerfGroup() : leader(-1) {
+	// cycles lead the group; without them nothing is counted 
+	if (!Open(HPM::cycles, PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES)) {
+		backend = string("perf_event_open unavailable (") + strerror(errno); 
+		if (errno == EACCES || errno == EPERM) {
+			backend += "; check /proc/sys/kernel/perf_event_paranoid"; 
+		} else if (errno == ENOENT || errno == ENODEV) {
+			backend += "; no hardware PMU, e.g. in a virtual machine"; 
+		}
+		backend += ")"; 
+		return; 
+	}
+	Open(HPM::instructions, PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS); 
+	Open(HPM::accesses, PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_REFERENCES); 
+	Open(HPM::misses, PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES); 
+
+	// FP arithmetic has no generic event 
+	ifstream cpuinfo("/proc/cpuinfo"); 
+	string line; 
+	while (getline(cpuinfo, line) && line.find("vendor_id") == string::npos); 
+	if (line.find("GenuineIntel") != string::npos) {
+		// FP_ARITH_INST_RETIRED, all scalar and packed widths (instructions, not lanes) 
+		Open(HPM::flops, PERF_TYPE_RAW, 0xffc7); 
+	} else if (line.find("AuthenticAMD") != string::npos) {
+		// retired SSE/AVX FLOPs 
+		Open(HPM::flops, PERF_TYPE_RAW, 0xff03); 
+	}
+	ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP); 
+	ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP); 
+	backend = "perf_event_open"; 
+}
+
+PerfGroup::~PerfGroup() {
+	for (int i=0; i<fds.size(); i++) {
+		close(fds[i]); 
+	}
+}
+
+bool PerfGroup::Open(HPM slot, uint32_t type, uint64_t config) {
+	struct perf_event_attr attr; 
+	memset(&attr, 0, sizeof(attr)); 
+	attr.size = sizeof(attr); 
+	attr.type = type; 
+	attr.config = config; 
+	attr.disabled = (leader < 0); 
+	attr.exclude_kernel = 1; 
+	attr.exclude_hv = 1; 
+	attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED 
+		| PERF_FORMAT_TOTAL_TIME_RUNNING; 
+	int fd = syscall(__NR_perf_event_open, &attr, 0, -1, leader, 0); 
+	if (fd < 0) return false; 
+	if (leader < 0) leader = fd; 
+	fds.push_back(fd); 
+	slots.push_back(slot); 
+	return true; 
+}
+
+void PerfGroup::Read(array<uint64_t,NUMCOUNTERS>& ctrs) const {
+	ctrs.fill(0); 
+	if (leader < 0) return; 
+	// nr, time enabled, time running, then one value per event 
+	vector<uint64_t> buf(3 + fds.size()); 
+	if (read(leader, buf.data(), sizeof(uint64_t)*buf.size()) <= 0) return; 
+	// scale up if the group had to share the PMU with other events 
+	double scale = (buf[2] > 0 && buf[2] < buf[1]) ? (double)buf[1]/buf[2] : 1.; 
+	for (int i=0; i<slots.size() && i<buf[0]; i++) {
+		ctrs[slots[i]] = buf[3+i]*scale; 
+	}
+}
+
+/// return the group, opening it on first use 
+static const PerfGroup& Group() {
+	static PerfGroup group; 
+	return group; 
+}
+#endif
+
+/// sample every counter 
+static void ReadCounters(array<uint64_t,NUMCOUNTERS>& ctrs) {
+#ifdef HWCOUNTER_PERF 
+	Group().Read(ctrs); 
+#else 
 	int i=0; 
 	#define READ_CSR(name) {\
 		uint64_t val = read_csr(name); \
-		_ctrs[i] = val; \
+		ctrs[i] = val; \
 		i++; \
 	}
 
 	READ_ALL(); 
 	#undef READ_CSR
+#endif
+}
+
+void HWCounter::Reset() {
+	ReadCounters(_ctrs); 
 }
 
 void HWCounter::Read() {
-	int i=0; 
-	#define READ_CSR(name) {\
-		uint64_t val = read_csr(name); \
-		_ctrs[i] = val - _ctrs[i]; \
-		i++; \
+	array<uint64_t,NUMCOUNTERS> now; 
+	ReadCounters(now); 
+	for (int i=0; i<NUMCOUNTERS; i++) {
+		_ctrs[i] = now[i] - _ctrs[i]; 
 	}
+}
 
-	READ_ALL(); 
-	#undef READ_CSR
+bool HWCounter::Available(HPM c) {
+#ifdef HWCOUNTER_PERF 
+	const PerfGroup& group = Group(); 
+	for (int i=0; i<group.slots.size(); i++) {
+		if (group.slots[i] == c) return true; 
+	}
+	return false; 
+#elif defined(__riscv)
+	return true; 
+#else 
+	return false; 
+#endif
+}
+
+string HWCounter::Backend() {
+#ifdef HWCOUNTER_PERF 
+	return Group().backend; 
+#elif defined(__riscv)
+	return "hpmcounter CSRs"; 
+#else 
+	return "none"; 
+#endif
 }
 
 double HWCounter::AvgVecLen() const {
@@ -82,6 +223,14 @@ uint64_t HWCounter::CacheBytesRead() const {
 	return _ctrs[HPM::bytes_read]; 
 }
 
+uint64_t HWCounter::Instructions() const {
+	return _ctrs[HPM::instructions]; 
+}
+
+double HWCounter::IPC() const {
+	return (double)Instructions()/Cycles(); 
+}
+
 double HWCounter::GetFOM(int tf, int lm, int lh) const {
 	double m = CacheMissRate()/100; 
 	return Cycles() + (lm*m + lh*(1-m))*CacheAccesses(); // + tf*_ctrs[HPM::flops]; 
@@ -89,15 +238,27 @@ double HWCounter::GetFOM(int tf, int lm, int lh) const {
 
 void HWCounter::PrintStats(string name) const {
 	cout << name << " stats:" << endl; 
-	cout << "\taverage vl = " << AvgVecLen() << endl; 
-	cout << "\tq = " << GetQ() << endl; 
-	cout << "\tflops = " << _ctrs[HPM::flops] << endl; 
-	cout << "\tflops / cycle = " << FlopsPerCycle() << endl; 
+	if (!Available(HPM::cycles)) {
+		cout << "\thardware counters: " << Backend() << endl; 
+		return; 
+	}
+	if (Available(HPM::v_instr)) cout << "\taverage vl = " << AvgVecLen() << endl; 
+	if (Available(HPM::fmem)) cout << "\tq = " << GetQ() << endl; 
+	if (Available(HPM::flops)) {
+		cout << "\tflops = " << _ctrs[HPM::flops] << endl; 
+		cout << "\tflops / cycle = " << FlopsPerCycle() << endl; 
+	}
 	cout << "\tcycles = " << Cycles() << endl; 
-	cout << "\tCache: " << CacheMisses() << "/" << CacheAccesses() << ", "
-		<< (double)CacheMisses()/CacheAccesses() << "%, "
-		<< CacheBytesRead()/1024 << "kB read" << endl; 
-	cout << "\tFOM = " << GetFOM() << " cycles" << endl; 
+	if (Available(HPM::instructions)) {
+		cout << "\tinstructions = " << Instructions() << ", IPC = " << IPC() << endl; 
+	}
+	if (Available(HPM::accesses) && Available(HPM::misses)) {
+		cout << "\tCache: " << CacheMisses() << "/" << CacheAccesses() << ", "
+			<< CacheMissRate() << "%"; 
+		if (Available(HPM::bytes_read)) cout << ", " << CacheBytesRead()/1024 << "kB read"; 
+		cout << endl; 
+		cout << "\tFOM = " << GetFOM() << " cycles" << endl; 
+	}
 }
 
-} // end namespace fem 
\ No newline at end of file
+} // end namespace fem 
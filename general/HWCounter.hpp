@@ -1,8 +1,10 @@
 #pragma once 
 
 #include <array>
+#include <cstdint>
+#include <string>
 
-#define NUMCOUNTERS 8
+#define NUMCOUNTERS 9
 
 namespace fem 
 {
@@ -16,10 +18,18 @@ enum HPM {
 	flops,
 	accesses, 
 	misses, 
-	bytes_read
+	bytes_read, 
+	instructions
 }; 
 
 /// class for reading hardware counters 
+/** on RISC-V the counters are the hpmcounter CSRs. On Linux hosts they come from one 
+	perf_event_open group shared by every HWCounter and read atomically: cycles, 
+	instructions, last level cache references and misses, and where the CPU has an 
+	event for it FP arithmetic. The vector, fmem, and bytes_read counters have no host 
+	event. Counters that could not be opened (e.g. restricted by perf_event_paranoid) 
+	read zero and are left out of PrintStats. Host counters measure the thread that 
+	first used an HWCounter */ 
 class HWCounter {
 public:
 	/// initialize for a given CSR 
@@ -45,6 +55,14 @@ public:
 	uint64_t CacheBytesRead() const; 
 	/// return the cache miss rate (percentage) 
 	double CacheMissRate() const; 
+	/// return instructions retired 
+	uint64_t Instructions() const; 
+	/// return instructions per cycle 
+	double IPC() const; 
+	/// return true if counter c is measured on this machine 
+	static bool Available(HPM c); 
+	/// return where the counters come from (and why not, if they are unavailable) 
+	static std::string Backend(); 
 
 	/// return an estimate of execution time 
 	/** \param tf number of cycles per flop 
@@ -53,8 +71,10 @@ public:
 	*/ 
 	double GetFOM(int tf=3, int lm=20, int lh=1) const; 
 
+	/// print the available counters and the statistics derived from them 
 	void PrintStats(std::string name="main") const; 
 private:
+	/// counter values at Reset, differences after Read 
 	std::array<uint64_t,NUMCOUNTERS> _ctrs; 
 }; 
 
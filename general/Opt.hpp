@@ -24,6 +24,7 @@
 
 // fematrix optimizations 
 #define RV_MVOUTER
+#define RV_ASSEMBLE 
 // #define RV_MVOUTERC 
 #define RV_UNROLL 
 
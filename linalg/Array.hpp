@@ -38,6 +38,8 @@ public:
 	int GetSize() const {return _vector.size(); }
 	/// resize the array 
 	void Resize(int N) {_vector.resize(N); }
+	/// allocate space for N entries without changing the size 
+	void Reserve(int N) {_vector.reserve(N); }
 	/// access to the array 
 	T& operator[](int ind) {
 		CHECKMSG(ind < _vector.size() && ind >= 0, 
@@ -68,6 +70,8 @@ public:
 	}
 	/// clear contents of vector 
 	void Clear() {_vector.clear(); }
+	/// exchange contents with a (releases memory when a is empty) 
+	void Swap(Array<T>& a) {_vector.swap(a._vector); }
 	/// return the intersection of two arrays 
 	void Intersection(const Array<T>& x, Array<T>& r) const {
 		for (int i=0; i<x.GetSize(); i++) {
@@ -43,7 +43,7 @@ Matrix& Matrix::operator=(const Matrix& m) {
 }
 
 void Matrix::operator=(double val) {
-	CH_TIMERS("matrix = double"); 
+	CH_TIMERS_FINE("matrix = double"); 
 #ifdef RV_SETEQ 
 	SetEqual_RV(Height()*Width(), &val, GetData()); 
 #else
@@ -74,7 +74,7 @@ void Matrix::SetSize(int m, int n) {
 }
 
 void Matrix::operator*=(double val) {
-	CH_TIMERS("matrix scale"); 
+	CH_TIMERS_FINE("matrix scale"); 
 #ifdef RV_VECSCALE
 	VectorScale_RV(Height()*Width(), GetData(), &val); 
 #else
@@ -85,7 +85,7 @@ void Matrix::operator*=(double val) {
 }
 
 void Matrix::operator+=(const Matrix& a) {
-	CH_TIMERS("matrix +="); 
+	CH_TIMERS_FINE("matrix +="); 
 	CHECK(a.Height()==Height() && a.Width()==Width()); 
 #ifdef RV_VECADD
 	VectorAdd_RV(Height()*Width(), GetData(), a.GetData()); 
@@ -97,7 +97,7 @@ void Matrix::operator+=(const Matrix& a) {
 }
 
 void Matrix::operator-=(const Matrix& a) {
-	CH_TIMERS("matrix -="); 
+	CH_TIMERS_FINE("matrix -="); 
 	CHECK(a.Height()==Height() && a.Width()==Width()); 
 #ifdef RV_VECSUB
 	VectorSub_RV(Height()*Width(), GetData(), a.GetData()); 
@@ -117,7 +117,7 @@ void Matrix::AddMatrix(double a, const Matrix& mat, int row, int col) {
 }
 
 void Matrix::Inverse(Matrix& inv) const {
-	CH_TIMERS("matrix dense inverse"); 
+	CH_TIMERS_FINE("matrix dense inverse"); 
 	if (Height()==2 && Width()==2) {
 		Inverse_2x2(inv); 
 	} else if (Height()==3 && Width() == 3) {
@@ -128,7 +128,7 @@ void Matrix::Inverse(Matrix& inv) const {
 }
 
 double Matrix::Determinant() const {
-	CH_TIMERS("matrix determinant"); 
+	CH_TIMERS_FINE("matrix determinant"); 
 	if (Height()==2 && Width()==2) {
 		return (*this)(0,0)*(*this)(1,1) - (*this)(1,0)*(*this)(0,1); 
 	} else if (Height()==3 && Width()==3) {
@@ -159,7 +159,7 @@ double Matrix::Weight() const {
 void Matrix::Mult(const Matrix& a, Matrix& b) const {
 	CHECK(Width()==a.Height()); 
 	b.SetSize(Height(), a.Width()); 
-	CH_TIMERS("matmult"); 
+	CH_TIMERS_FINE("matmult"); 
 #ifdef RV_MATMULT
 	MatMult_RV(Height(), Width(), a.Width(), GetData(), a.GetData(), b.GetData()); 
 #else
@@ -168,7 +168,7 @@ void Matrix::Mult(const Matrix& a, Matrix& b) const {
 }
 
 void Matrix::Mult(double alpha, const Matrix& B, double beta, Matrix& C) const {
-	CH_TIMERS("dgemm"); 
+	CH_TIMERS_FINE("dgemm"); 
 	CHECK(Width() == B.Height()); 
 	CHECK(C.Height() == Height()); 
 	CHECK(C.Width() == B.Width()); 
@@ -197,7 +197,7 @@ void Matrix::Mult(double alpha, const Matrix& B, double beta, Matrix& C) const {
 }
 
 void Matrix::AddTransMult(const Matrix& a, Matrix& b) const {
-	CH_TIMERS("add trans mult"); 
+	CH_TIMERS_FINE("add trans mult"); 
 	CHECK(Height()==a.Height()); 
 	CHECK(b.Width()==Width() && b.Height()==a.Width()); 
 #ifdef RV_ATM 
@@ -217,7 +217,7 @@ void Matrix::AddTransMult(const Matrix& a, Matrix& b) const {
 void Matrix::Mult(const Vector& x, Vector& b) const {
 	CHECK(Width()==x.GetSize()); 
 	if (b.GetSize()!=Height()) b.SetSize(Height()); 
-	CH_TIMERS("matvec"); 
+	CH_TIMERS_FINE("matvec"); 
 #ifdef RV_MATVEC
 	MatVec_RV(Height(), Width(), GetData(), x.GetData(), b.GetData()); 
 #elif defined RV_SMATVEC
@@ -228,7 +228,7 @@ void Matrix::Mult(const Vector& x, Vector& b) const {
 }
 
 void Matrix::Mult(double alpha, const Vector& x, double beta, Vector& b) const {
-	CH_TIMERS("matvec with coeffs"); 
+	CH_TIMERS_FINE("matvec with coeffs"); 
 	CHECKMSG(x.GetSize() == Width(), "size mismatch"); 
 	CHECKMSG(b.GetSize() == Height(), "size mismatch"); 
 	for (int i=0; i<Height(); i++) {
@@ -270,7 +270,7 @@ void Matrix::GradToDiv(Vector& divshape) const {
 }
 
 void Matrix::Solve(const Vector& b, Vector& x) const {
-	CH_TIMERS("dense gauss elim"); 
+	CH_TIMERS_FINE("dense gauss elim"); 
 #ifdef USE_LAPACK
 	x = b; 
 
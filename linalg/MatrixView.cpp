@@ -0,0 +1,191 @@
+#include "MatrixView.hpp"
+#include "Opt.hpp"
+
+using namespace std; 
+
+namespace fem 
+{
+
+MatrixView::MatrixView(double* data, int m, int n, Storage storage) {
+	CHECKMSG(m > 0, "m = " << m); CHECKMSG(n > 0 || n == -1, "n = " << n); 
+	_data = data; 
+	_m = m; 
+	_n = n; 
+	if (_n == -1) _n = _m; 
+	_storage = storage; 
+	_owner = NULL; 
+	_id = -1; 
+	CHECKMSG(_storage == DENSE || _m == _n, "packed storage must be square"); 
+}
+
+void MatrixView::Modify(bool symmetric) {
+	if (!_owner) {
+		if (IsPacked() && !symmetric) ERROR("non-symmetric matrix written to symmetric packed storage"); 
+		return; 
+	}
+	_owner->ViewModified(_id); 
+	if (IsPacked() && !symmetric) {
+		MatrixView dense = _owner->ViewUnpacked(_id); 
+		CHECK(!dense.IsPacked() && dense.Height() == _m && dense.Width() == _n); 
+		_data = dense._data; 
+		_storage = DENSE; 
+	}
+}
+
+void MatrixView::operator=(double val) {
+	if (_owner) Modify(true); 
+#ifdef RV_SETEQ
+	SetEqual_RV(GetStoredSize(), &val, _data); 
+#else
+	for (int i=0; i<GetStoredSize(); i++) {
+		_data[i] = val; 
+	}
+#endif
+}
+
+void MatrixView::operator=(const Matrix& a) {
+	CHECK(a.Height()==Height() && a.Width()==Width()); 
+	if (_owner || IsPacked()) Modify(!IsPacked() || a.IsSymmetric()); 
+	if (IsPacked()) {
+		for (int i=0, k=0; i<_m; i++) {
+			for (int j=i; j<_n; j++, k++) {
+				_data[k] = a(i,j); 
+			}
+		}
+		return; 
+	}
+	const double* adata = a.GetData(); 
+	for (int i=0; i<_m*_n; i++) {
+		_data[i] = adata[i]; 
+	}
+}
+
+void MatrixView::operator*=(double val) {
+	if (_owner) Modify(true); 
+#ifdef RV_VECSCALE
+	VectorScale_RV(GetStoredSize(), _data, &val); 
+#else
+	for (int i=0; i<GetStoredSize(); i++) {
+		_data[i] *= val; 
+	}
+#endif
+}
+
+void MatrixView::operator+=(const Matrix& a) {
+	CHECK(a.Height()==Height() && a.Width()==Width()); 
+	if (_owner || IsPacked()) Modify(!IsPacked() || a.IsSymmetric()); 
+	if (IsPacked()) {
+		for (int i=0, k=0; i<_m; i++) {
+			for (int j=i; j<_n; j++, k++) {
+				_data[k] += a(i,j); 
+			}
+		}
+		return; 
+	}
+#ifdef RV_VECADD
+	VectorAdd_RV(_m*_n, _data, a.GetData()); 
+#else
+	const double* adata = a.GetData(); 
+	for (int i=0; i<_m*_n; i++) {
+		_data[i] += adata[i]; 
+	}
+#endif
+}
+
+void MatrixView::operator-=(const Matrix& a) {
+	CHECK(a.Height()==Height() && a.Width()==Width()); 
+	if (_owner || IsPacked()) Modify(!IsPacked() || a.IsSymmetric()); 
+	if (IsPacked()) {
+		for (int i=0, k=0; i<_m; i++) {
+			for (int j=i; j<_n; j++, k++) {
+				_data[k] -= a(i,j); 
+			}
+		}
+		return; 
+	}
+#ifdef RV_VECSUB
+	VectorSub_RV(_m*_n, _data, a.GetData()); 
+#else
+	const double* adata = a.GetData(); 
+	for (int i=0; i<_m*_n; i++) {
+		_data[i] -= adata[i]; 
+	}
+#endif
+}
+
+void MatrixView::operator-=(const MatrixView& a) {
+	CHECK(a.Height()==Height() && a.Width()==Width()); 
+	if (_owner) Modify(true); 
+	CHECK(a.IsPacked() == IsPacked()); 
+#ifdef RV_VECSUB
+	VectorSub_RV(GetStoredSize(), _data, a.GetData()); 
+#else
+	const double* adata = a.GetData(); 
+	for (int i=0; i<GetStoredSize(); i++) {
+		_data[i] -= adata[i]; 
+	}
+#endif
+}
+
+void MatrixView::Mult(const Vector& x, Vector& b) const {
+	CHECK(Width()==x.GetSize()); 
+	if (b.GetSize()!=Height()) b.SetSize(Height()); 
+	const double* xdata = x.GetData(); 
+	double* bdata = b.GetData(); 
+	if (IsPacked()) {
+		// each off diagonal entry contributes to rows i and j 
+		for (int i=0; i<_m; i++) bdata[i] = 0.; 
+		for (int i=0, k=0; i<_m; i++) {
+			double xi = xdata[i]; 
+			double sum = _data[k++] * xi; 
+			for (int j=i+1; j<_n; j++, k++) {
+				sum += _data[k] * xdata[j]; 
+				bdata[j] += _data[k] * xi; 
+			}
+			bdata[i] += sum; 
+		}
+		return; 
+	}
+#ifdef RV_MATVEC
+	MatVec_RV(_m, _n, _data, x.GetData(), b.GetData()); 
+#else
+	for (int i=0; i<_m; i++) {
+		double sum = 0.; 
+		for (int j=0; j<_n; j++) {
+			sum += _data[i*_n+j] * xdata[j]; 
+		}
+		bdata[i] = sum; 
+	}
+#endif
+}
+
+void MatrixView::Copy(Matrix& a) const {
+	a.SetSize(_m, _n); 
+	for (int i=0; i<_m; i++) {
+		for (int j=0; j<_n; j++) {
+			a(i,j) = (*this)(i,j); 
+		}
+	}
+}
+
+bool MatrixView::IsSymmetric() const {
+	if (IsPacked()) return true; 
+	if (_m != _n) return false; 
+	for (int i=0; i<_m; i++) {
+		for (int j=i+1; j<_n; j++) {
+			if (!EQUAL((*this)(i,j), (*this)(j,i))) return false; 
+		}
+	}
+	return true; 
+}
+
+void MatrixView::Print(std::ostream& out) const {
+	for (int i=0; i<_m; i++) {
+		for (int j=0; j<_n; j++) {
+			out << (*this)(i,j) << " "; 
+		}
+		out << std::endl; 
+	}
+}
+
+} // end namespace fem 
\ No newline at end of file
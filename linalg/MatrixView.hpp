@@ -0,0 +1,116 @@
+#pragma once 
+
+#include "General.hpp"
+#include "Matrix.hpp"
+#include "Vector.hpp"
+
+namespace fem 
+{
+
+class MatrixView; 
+
+/// storage that is told about writes through the views it hands out 
+/** lets a packed view switch its owner to full storage on a non-symmetric write 
+	instead of failing */ 
+class MatrixViewOwner {
+public:
+	virtual ~MatrixViewOwner() {}
+	/// called before matrix id is written through a view 
+	virtual void ViewModified(int id) = 0; 
+	/// switch to full storage and return the new dense view of matrix id 
+	virtual MatrixView ViewUnpacked(int id) = 0; 
+}; 
+
+/// non-owning dense matrix that points into externally managed storage 
+/** the data is either row major or the row major upper triangle of a symmetric 
+	matrix (\f$ N(N+1)/2 \f$ entries). In packed storage (i,j) and (j,i) 
+	refer to the same entry */ 
+class MatrixView {
+public:
+	/// layout of the viewed data 
+	enum Storage {DENSE, SYMMETRIC_PACKED}; 
+	/// default constructor 
+	MatrixView() {_data = NULL; _m = 0; _n = 0; _storage = DENSE; _owner = NULL; _id = -1; }
+	/// wrap row major data 
+	/** \param data pointer to the first entry \param m number of rows \param n number of columns 
+		\param storage layout of data */ 
+	MatrixView(double* data, int m, int n=-1, Storage storage=DENSE); 
+
+	/// access to data 
+	/** an owned packed view switches to full storage for an off diagonal entry 
+		since the write would also change (j,i) */ 
+	double& operator()(int i, int j) {
+		CHECKMSG(i < _m && j < _n,
+			"index = (" << i << ", " << j << "), size = " << _m << " x " << _n); 
+		if (_owner) Modify(i == j); 
+		return _data[Index(i,j)]; 
+	}
+	/// const access to data 
+	double operator()(int i, int j) const {
+		CHECKMSG(i < _m && j < _n,
+			"index = (" << i << ", " << j << "), size = " << _m << " x " << _n); 
+		return _data[Index(i,j)]; 
+	}
+	/// return the number of rows 
+	int Height() const {return _m; }
+	/// return the number of columns 
+	int Width() const {return _n; }
+	/// return true if the data is symmetric packed 
+	bool IsPacked() const {return _storage == SYMMETRIC_PACKED; }
+	/// number of stored entries 
+	int GetStoredSize() const {return IsPacked() ? _n*(_n+1)/2 : _m*_n; }
+	/// location of entry (i,j) in the data 
+	int Index(int i, int j) const {
+		if (!IsPacked()) return i*_n+j; 
+		if (i > j) std::swap(i,j); 
+		return PackedIndex(_n, i, j); 
+	}
+	/// location of (i,j), i <= j, in the packed upper triangle of an NxN matrix 
+	static int PackedIndex(int N, int i, int j) {return i*N - i*(i-1)/2 + j - i; }
+	/// access to the underlying data 
+	double* GetData() {return _data; }
+	/// const access to the underlying data 
+	const double* GetData() const {return _data; }
+	/// report writes to owner, which stores this view as matrix id 
+	/** non-symmetric writes to a packed view then unpack the owner's storage 
+		(invalidating its other views) instead of failing */ 
+	void SetOwner(MatrixViewOwner* owner, int id) {_owner = owner; _id = id; }
+
+	/// set all values to val 
+	void operator=(double val); 
+	/// copy values from a matrix of the same size (a must be symmetric if packed and not owned) 
+	void operator=(const Matrix& a); 
+	/// scale all entries by val 
+	void operator*=(double val); 
+	/// add a matrix to this (a must be symmetric if packed and not owned) 
+	void operator+=(const Matrix& a); 
+	/// subtract a matrix from this (a must be symmetric if packed and not owned) 
+	void operator-=(const Matrix& a); 
+	/// subtract another view of the same layout from this 
+	void operator-=(const MatrixView& a); 
+	/// matrix vector product (does not accumulate into b) 
+	void Mult(const Vector& x, Vector& b) const; 
+	/// copy into an owning matrix 
+	void Copy(Matrix& a) const; 
+	/// check if the viewed matrix is symmetric 
+	bool IsSymmetric() const; 
+	/// print matrix 
+	void Print(std::ostream& out=std::cout) const; 
+private:
+	/// pointer to the first entry 
+	double* _data; 
+	/// number of rows 
+	int _m; 
+	/// number of columns 
+	int _n; 
+	/// layout of _data 
+	Storage _storage; 
+	/// told about writes (NULL if none) 
+	MatrixViewOwner* _owner; 
+	/// index of this view in _owner 
+	int _id; 
+	/// prepare for a write that keeps the matrix symmetric or not 
+	void Modify(bool symmetric); 
+}; 
+
+} // end namespace fem 
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "SparseMatrix.hpp"
+#include "Snapshot.hpp"
 #ifdef USE_OMP
 #include <omp.h>
 #endif
@@ -123,26 +124,59 @@ void SparseMatrix::ClearNonZeros(double tol) {
 
 void SparseMatrix::EliminateRowIntoRHS(int rc, Vector& rhs, double val) {
 	CHECK(rc < Height()); 
+	Array<int> rcs(1); 
+	rcs[0] = rc; 
+	EliminateRowsIntoRHS(rcs, rhs, val); 
+}
 
-	// subtract column rc from rhs 
-	{
-		for (int i=0; i<Height(); i++) {
-			if (val != 0) {
-				rhs[i] -= At(i,rc)*val; 			
-			}
-			Get(i,rc) = 0.; 
-		}
-	}
+void SparseMatrix::EliminateRowsIntoRHS(const Array<int>& rcs, Vector& rhs, double val) {
+	Vector vals(Height()); 
+	vals = val; 
+	EliminateRowsIntoRHS(rcs, rhs, vals); 
+}
 
-	rhs[rc] = val; 
+void SparseMatrix::EliminateRowsIntoRHS(const Array<int>& rcs, Vector& rhs, 
+	const Vector& vals) {
+	CHECK(_m == _n); 
+	CHECK(rhs.GetSize() == Height() && vals.GetSize() == Height()); 
 
-	// set row rc to only one on the diagonal 
-	{
-		for (int i=0; i<_rowIndex[rc].size(); i++) {
-			if (_rowIndex[rc][i] == rc) _data[rc][i] = 1.; 
-			else _data[rc][i] = 0.; 
+	// mark the eliminated rows/columns 
+	Array<int> marked(_m); 
+	for (int i=0; i<rcs.GetSize(); i++) {
+		CHECK(rcs[i] < Height()); 
+		marked[rcs[i]] = 1; 
+	}
+
+	// one pass over the non-zeros: move marked columns into rhs and drop them 
+	int removed = 0; 
+	#pragma omp parallel for reduction(+:removed) 
+	for (int i=0; i<_m; i++) {
+		vector<int>& cols = _rowIndex[i]; 
+		vector<double>& data = _data[i]; 
+		int nnz_row = cols.size(); 
+		if (marked[i]) {
+			cols.assign(1, i); 
+			data.assign(1, 1.); 
+			rhs[i] = vals[i]; 
+			removed += nnz_row - 1; 
+			continue; 
 		}
+		int count = 0; 
+		for (int j=0; j<nnz_row; j++) {
+			int col = cols[j]; 
+			if (marked[col]) {
+				rhs[i] -= data[j]*vals[col]; 
+			} else {
+				cols[count] = col; 
+				data[count] = data[j]; 
+				count++; 
+			}
+		}
+		cols.resize(count); 
+		data.resize(count); 
+		removed += nnz_row - count; 
 	}
+	_nnz -= removed; 
 }
 
 void SparseMatrix::Print(ostream& stream) const {
@@ -198,6 +232,45 @@ void SparseMatrix::GetSLUFormat(double* val, int* row, int* colptr) const {
 	}
 }
 
+void SparseMatrix::Save(SnapshotWriter& snap) const {
+	CH_TIMERS_COARSE("save sparse matrix snapshot"); 
+	Array<int> rowptr(_m+1); 
+	for (int i=0; i<_m; i++) {
+		rowptr[i+1] = rowptr[i] + _rowIndex[i].size(); 
+	}
+	Array<int> cols(rowptr[_m]); 
+	Array<double> vals(rowptr[_m]); 
+	for (int i=0; i<_m; i++) {
+		for (int j=0; j<_rowIndex[i].size(); j++) {
+			cols[rowptr[i]+j] = _rowIndex[i][j]; 
+			vals[rowptr[i]+j] = _data[i][j]; 
+		}
+	}
+	snap.Add("csr_m", _m); 
+	snap.Add("csr_n", _n); 
+	snap.Add("csr_rowptr", rowptr); 
+	snap.Add("csr_cols", cols); 
+	snap.Add("csr_vals", vals); 
+}
+
+void SparseMatrix::Load(const SnapshotReader& snap) {
+	CH_TIMERS_COARSE("load sparse matrix snapshot"); 
+	CHECKMSG(snap.GetInt("csr_m") == _m && snap.GetInt("csr_n") == _n, 
+		"snapshot does not match the size of the matrix"); 
+	Array<int> rowptr, cols; 
+	Array<double> vals; 
+	snap.Get("csr_rowptr", rowptr); 
+	snap.Get("csr_cols", cols); 
+	snap.Get("csr_vals", vals); 
+	CHECKMSG(rowptr.GetSize() == _m+1 && cols.GetSize() == rowptr[_m] 
+		&& vals.GetSize() == rowptr[_m], "corrupt sparse matrix snapshot"); 
+	for (int i=0; i<_m; i++) {
+		_rowIndex[i].assign(cols.GetData() + rowptr[i], cols.GetData() + rowptr[i+1]); 
+		_data[i].assign(vals.GetData() + rowptr[i], vals.GetData() + rowptr[i+1]); 
+	}
+	_nnz = rowptr[_m]; 
+}
+
 #ifdef USE_EIGEN
 void SparseMatrix::GetEigenFormat(Eigen::SparseMatrix<double>& eigen) const {
 	eigen.resize(_m, _n); 
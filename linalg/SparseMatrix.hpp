@@ -10,6 +10,9 @@
 namespace fem 
 {
 
+class SnapshotWriter; 
+class SnapshotReader; 
+
 /// store a matrix in compressed column format 
 class SparseMatrix : public Operator {
 public:
@@ -45,6 +48,14 @@ public:
 	void ClearNonZeros(double tol=1e-12); 
 	/// subtract column rc from rhs and set row rc to zero except for one on the diagonal
 	void EliminateRowIntoRHS(int rc, Vector& rhs, double val); 
+	/// eliminate all rows/columns in rcs at once with the same value 
+	void EliminateRowsIntoRHS(const Array<int>& rcs, Vector& rhs, double val); 
+	/// eliminate all rows/columns in rcs at once 
+	/** \param rcs rows (and columns) to eliminate 
+		\param rhs right hand side, rhs[rcs[i]] is set to vals[rcs[i]] 
+		\param vals full length vector holding the values at the eliminated rows 
+	*/ 
+	void EliminateRowsIntoRHS(const Array<int>& rcs, Vector& rhs, const Vector& vals); 
 
 	/// print a dense matrix 
 	void Print(std::ostream& stream = std::cout) const; 
@@ -59,6 +70,11 @@ public:
 	/// get transpose of matrix 
 	void Transpose(SparseMatrix& transpose) const; 
 
+	/// add the matrix to a snapshot in compressed row format 
+	void Save(SnapshotWriter& snap) const; 
+	/// replace the matrix with one saved by Save 
+	void Load(const SnapshotReader& snap); 
+
 	/// return val, row, colptr format for superlu format 
 	void GetSLUFormat(double* val, int* row, int* colptr) const; 
 	/// get Eigen matrix 
@@ -13,7 +13,7 @@ Vector::Vector(int size, double val) : Array<double>(size, val) {
 }
 
 void Vector::operator=(double val) {
-	CH_TIMERS("vector = double"); 
+	CH_TIMERS_FINE("vector = double"); 
 #ifdef RV_SETEQ
 	SetEqual_RV(GetSize(), &val, GetData()); 
 #else
@@ -24,7 +24,7 @@ void Vector::operator=(double val) {
 }
 
 void Vector::operator=(const Vector& v) {
-	CH_TIMERS("vector = vector"); 
+	CH_TIMERS_FINE("vector = vector"); 
 	SetSize(v.GetSize()); 
 	for (int i=0; i<GetSize(); i++) {
 		(*this)[i] = v[i]; 
@@ -32,7 +32,7 @@ void Vector::operator=(const Vector& v) {
 }
 
 void Vector::GetFromDofs(const Array<int>& dofs, Vector& v) const {
-	CH_TIMERS("get from dofs"); 
+	CH_TIMERS_FINE("get from dofs"); 
 	v.Resize(dofs.GetSize()); 
 #ifdef RV_GETDOFS
 	GetFromDofs_RV(dofs.GetSize(), dofs.GetData(), v.GetData(), GetData()); 
@@ -44,7 +44,7 @@ void Vector::GetFromDofs(const Array<int>& dofs, Vector& v) const {
 }
 
 void Vector::AddFromDofs(const Array<int>& dofs, Vector& v) {
-	CH_TIMERS("add from dofs"); 
+	CH_TIMERS_FINE("add from dofs"); 
 	CHECKMSG(dofs.GetSize()==v.GetSize() && v.GetSize()>0, "dofs and v sizes must agree"); 
 #ifdef RV_ADDDOFS
 	AddFromDofs_RV(dofs.GetSize(), dofs.GetData(), v.GetData(), GetData()); 
@@ -56,7 +56,7 @@ void Vector::AddFromDofs(const Array<int>& dofs, Vector& v) {
 }
 
 void Vector::operator*=(double val) {
-	CH_TIMERS("vector operation *="); 
+	CH_TIMERS_FINE("vector operation *="); 
 	CHECKMSG(GetSize() > 0, "vector not initialized"); 
 #ifdef RV_VECSCALE
 	VectorScale_RV(GetSize(), GetData(), &val); 
@@ -69,7 +69,7 @@ void Vector::operator*=(double val) {
 }
 
 void Vector::operator+=(const Vector& a) {
-	CH_TIMERS("vector +="); 
+	CH_TIMERS_FINE("vector +="); 
 	CHECK(a.GetSize() == GetSize()); 
 #ifdef RV_VECADD
 	VectorAdd_RV(GetSize(), GetData(), a.GetData()); 
@@ -82,7 +82,7 @@ void Vector::operator+=(const Vector& a) {
 }
 
 void Vector::operator-=(const Vector& a) {
-	CH_TIMERS("vector -="); 
+	CH_TIMERS_FINE("vector -="); 
 	CHECK(a.GetSize() == GetSize()); 
 #ifdef RV_VECSUB
 	VectorSub_RV(GetSize(), GetData(), a.GetData()); 
@@ -96,7 +96,7 @@ void Vector::operator-=(const Vector& a) {
 }
 
 void Vector::operator/=(const Vector& a) {
-	CH_TIMERS("vector /="); 
+	CH_TIMERS_FINE("vector /="); 
 	CHECK(a.GetSize() == GetSize()); 
 #ifdef RV_VECDIV
 	VectorDiv_RV(GetSize(), GetData(), a.GetData()); 
@@ -109,7 +109,7 @@ void Vector::operator/=(const Vector& a) {
 }
 
 void Vector::operator*=(const Vector& a) {
-	CH_TIMERS("vector vector *="); 
+	CH_TIMERS_FINE("vector vector *="); 
 	CHECK(a.GetSize() == GetSize()); 
 #ifdef RV_VECMUL
 	VectorMul_RV(GetSize(), GetData(), a.GetData()); 
@@ -122,7 +122,7 @@ void Vector::operator*=(const Vector& a) {
 }
 
 void Vector::OuterProduct(const Vector& a, Matrix& b) const {
-	CH_TIMERS("outer product"); 
+	CH_TIMERS_FINE("outer product"); 
 	if (b.Height() != GetSize() || b.Width() != a.GetSize()) {
 		b.SetSize(GetSize(), a.GetSize()); 		
 	}
@@ -169,7 +169,7 @@ void Vector::SquareRoot() {
 }
 
 double Vector::Dot(const Vector& x) const {
-	CH_TIMERS("vector dot product"); 
+	CH_TIMERS_FINE("vector dot product"); 
 	CHECK(x.GetSize() == GetSize()); 
 #ifdef RV_VECDOT
 	double ret = 0; 
@@ -186,7 +186,7 @@ double Vector::Dot(const Vector& x) const {
 }
 
 double Vector::L2Norm() const {
-	CH_TIMERS("vector L2 norm"); 
+	CH_TIMERS_FINE("vector L2 norm"); 
 #ifdef RV_VECDOT 
 	double ret = 0; 
 	VectorDot_RV(GetSize(), GetData(), GetData(), &ret); 
@@ -226,7 +226,7 @@ void Vector::Print(std::ostream& out, std::string end) const {
 }
 
 void Add(const Vector& a, const Vector& b, Vector& c) {
-	CH_TIMERS("vvadd"); 
+	CH_TIMERS_FINE("vvadd"); 
 	CHECK(a.GetSize() == b.GetSize()); 
 	if (c.GetSize() != a.GetSize()) c.Resize(a.GetSize()); 
 #ifdef RV_VECADD
@@ -239,7 +239,7 @@ void Add(const Vector& a, const Vector& b, Vector& c) {
 }
 
 void Subtract(const Vector& a, const Vector& b, Vector& c) {
-	CH_TIMERS("vvsub"); 
+	CH_TIMERS_FINE("vvsub"); 
 	CHECK(a.GetSize() == b.GetSize()); 
 	if (c.GetSize() != a.GetSize()) c.Resize(a.GetSize()); 
 #ifdef RV_VECSUB
@@ -253,7 +253,7 @@ void Subtract(const Vector& a, const Vector& b, Vector& c) {
 }
 
 void Add(double alpha, const Vector& a, double beta, const Vector& b, Vector& c) {
-	CH_TIMERS("vvadd with coeffs"); 
+	CH_TIMERS_FINE("vvadd with coeffs"); 
 	CHECK(a.GetSize() == b.GetSize()); 
 	c.Resize(a.GetSize()); 
 
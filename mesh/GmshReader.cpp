@@ -0,0 +1,441 @@
+#include "Mesh.hpp"
+#include "MappedFile.hpp"
+#include <map>
+#include <string_view>
+#include <cstdlib>
+#include <limits>
+
+using namespace std; 
+
+namespace fem 
+{
+
+/// gmsh element type of points 
+#define GMSH_POINT 15
+
+/// cursor over the bytes of a gmsh file 
+/** numbers are scanned by hand instead of through an istream. Binary values
+	are copied out with memcpy since gmsh does not align them */ 
+class GmshScanner {
+public:
+	/// constructor 
+	GmshScanner(const char* data, size_t size) : _begin(data), _p(data), _end(data+size) { }
+	/// skip white space and return true if there is nothing left 
+	bool AtEnd() {
+		SkipSpace(); 
+		return _p == _end; 
+	}
+	/// skip white space 
+	void SkipSpace() {
+		while (_p < _end && IsSpace(*_p)) _p++; 
+	}
+	/// move past the next new line 
+	void SkipLine() {
+		while (_p < _end && *_p != '\n') _p++; 
+		if (_p < _end) _p++; 
+	}
+	/// move to the next occurrence of marker 
+	void SkipTo(const string& marker) {
+		size_t pos = string_view(_p, _end - _p).find(marker); 
+		if (pos == string_view::npos) Error("missing " + marker); 
+		_p += pos; 
+	}
+	/// return the next white space delimited word 
+	string Word() {
+		SkipSpace(); 
+		const char* start = _p; 
+		while (_p < _end && !IsSpace(*_p)) _p++; 
+		return string(start, _p); 
+	}
+	/// read the next word and check that it is expect 
+	void Expect(const string& expect) {
+		string word = Word(); 
+		if (word != expect) Error("expected " + expect + " but found " + word); 
+	}
+	/// scan an ascii integer 
+	long long Int() {
+		SkipSpace(); 
+		bool neg = false; 
+		if (_p < _end && (*_p == '-' || *_p == '+')) neg = (*_p++ == '-'); 
+		if (_p == _end || !IsDigit(*_p)) Error("expected an integer"); 
+		long long val = 0; 
+		while (_p < _end && IsDigit(*_p)) {
+			val = 10*val + (*_p++ - '0'); 
+		}
+		return (neg) ? -val : val; 
+	}
+	/// scan an ascii floating point number 
+	/** mantissas below 2^53 with exponents of at most 22 are converted exactly
+		with one multiply or divide by a power of ten. Anything else is passed to
+		strtod */ 
+	double Double() {
+		static const double pow10[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7,
+			1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18,
+			1e19, 1e20, 1e21, 1e22}; 
+		SkipSpace(); 
+		const char* start = _p; 
+		bool neg = false; 
+		if (_p < _end && (*_p == '-' || *_p == '+')) neg = (*_p++ == '-'); 
+		unsigned long long mant = 0; 
+		int ndigits = 0, exp = 0; 
+		bool any = false, dropped = false; 
+		while (_p < _end && IsDigit(*_p)) {
+			any = true; 
+			if (ndigits < 19) mant = 10*mant + (*_p - '0'); 
+			else {
+				exp++; 
+				dropped = true; 
+			}
+			if (mant > 0) ndigits++; 
+			_p++; 
+		}
+		if (_p < _end && *_p == '.') {
+			_p++; 
+			while (_p < _end && IsDigit(*_p)) {
+				any = true; 
+				if (ndigits < 19) {
+					mant = 10*mant + (*_p - '0'); 
+					exp--; 
+				} else dropped = true; 
+				if (mant > 0) ndigits++; 
+				_p++; 
+			}
+		}
+		if (!any) Error("expected a number"); 
+		if (_p < _end && (*_p == 'e' || *_p == 'E')) {
+			_p++; 
+			exp += Int(); 
+		}
+
+		if (!dropped && mant <= (1ull << 53) && exp >= -22 && exp <= 22) {
+			double val = (double)mant; 
+			val = (exp < 0) ? val/pow10[-exp] : val*pow10[exp]; 
+			return (neg) ? -val : val; 
+		}
+
+		// slow path for long mantissas and large exponents 
+		char buf[64]; 
+		size_t len = min((size_t)(_p - start), sizeof(buf)-1); 
+		memcpy(buf, start, len); 
+		buf[len] = '\0'; 
+		return strtod(buf, NULL); 
+	}
+	/// copy a binary value 
+	template<typename T>
+	T Read() {
+		if (_end - _p < (long)sizeof(T)) Error("unexpected end of file"); 
+		T val; 
+		memcpy(&val, _p, sizeof(T)); 
+		_p += sizeof(T); 
+		return val; 
+	}
+	/// report a parse error 
+	void Error(const string& msg) const {
+		ERROR("gmsh: " << msg << " at byte " << _p - _begin); 
+	}
+private:
+	/// return true for white space 
+	static bool IsSpace(char c) {return c == ' ' || c == '\n' || c == '\r' || c == '\t'; }
+	/// return true for 0-9 
+	static bool IsDigit(char c) {return c >= '0' && c <= '9'; }
+
+	/// start of the data 
+	const char* _begin; 
+	/// current position 
+	const char* _p; 
+	/// end of the data 
+	const char* _end; 
+}; 
+
+/// elements in the order they appear in the file 
+struct GmshElements {
+	/// GmshElType of each element 
+	Array<int> type; 
+	/// start of each element's tags 
+	Array<int> tag_offsets; 
+	/// physical and elementary tags 
+	Array<int> tags; 
+	/// start of each element's nodes 
+	Array<int> node_offsets; 
+	/// 0 based node ids 
+	Array<int> nodes; 
+}; 
+
+/// read one integer of a binary or ascii section 
+template<typename T>
+long long GmshInt(GmshScanner& scan, bool binary) {
+	return (binary) ? (long long)scan.Read<T>() : scan.Int(); 
+}
+
+/// read one double of a binary or ascii section 
+double GmshDouble(GmshScanner& scan, bool binary) {
+	return (binary) ? scan.Read<double>() : scan.Double(); 
+}
+
+/// map a gmsh element type to a GmshElType (-1 for points) 
+int GmshType(GmshScanner& scan, int type) {
+	if (type == GMSH_POINT) return -1; 
+	if (type < 1 || type > NGmshTypes) scan.Error("element type " + to_string(type) + " not supported"); 
+	return type - 1; 
+}
+
+void Mesh::ReadGmsh(const string& name) {
+	CH_TIMERS_COARSE("read gmsh"); 
+	MappedFile file(name); 
+	if (!file.Good()) ERROR("meshfile " << name << " not read"); 
+	GmshScanner scan(file.GetData(), file.GetSize()); 
+
+	GmshElements els; 
+	// first physical tag of each (dimension, entity) pair (msh 4 only) 
+	map<pair<int,int>, int> physical; 
+	_mesh_version = 0; 
+	_ascii = 0; 
+	_data_size = sizeof(double); 
+	while (!scan.AtEnd()) {
+		string section = scan.Word(); 
+		if (section.empty() || section[0] != '$') scan.Error("expected a section but found " + section); 
+		section = section.substr(1); 
+		bool binary = _ascii == 1; 
+
+		if (section == "MeshFormat") {
+			_mesh_version = scan.Double(); 
+			_ascii = scan.Int(); 
+			_data_size = scan.Int(); 
+			if (_data_size != sizeof(double)) scan.Error("data size " + to_string(_data_size) + " not supported"); 
+			if (_mesh_version >= 3 && _mesh_version != 4.1) scan.Error("msh version "
+				+ to_string(_mesh_version) + " not supported (use 2.2 or 4.1)"); 
+			if (_ascii == 1) {
+				scan.SkipLine(); 
+				if (scan.Read<int>() != 1) scan.Error("binary mesh has the wrong byte order"); 
+			}
+		}
+
+		else if (section == "Entities" && _mesh_version >= 4) {
+			scan.SkipLine(); 
+			long long count[4]; 
+			for (int d=0; d<4; d++) {
+				count[d] = GmshInt<size_t>(scan, binary); 
+			}
+			for (int d=0; d<4; d++) {
+				for (long long i=0; i<count[d]; i++) {
+					int tag = GmshInt<int>(scan, binary); 
+					// points have one location, the rest a bounding box 
+					for (int j=0; j<((d==0) ? 3 : 6); j++) {
+						GmshDouble(scan, binary); 
+					}
+					long long nphys = GmshInt<size_t>(scan, binary); 
+					for (long long j=0; j<nphys; j++) {
+						int phys = GmshInt<int>(scan, binary); 
+						if (j == 0) physical[{d, tag}] = phys; 
+					}
+					if (d == 0) continue; 
+					long long nbound = GmshInt<size_t>(scan, binary); 
+					for (long long j=0; j<nbound; j++) {
+						GmshInt<int>(scan, binary); 
+					}
+				}
+			}
+		}
+
+		else if (section == "Nodes" && _mesh_version < 4) {
+			int nNodes = scan.Int(); 
+			if (binary) scan.SkipLine(); 
+			_nodes.Resize(nNodes); 
+			for (int i=0; i<nNodes; i++) {
+				int id = GmshInt<int>(scan, binary) - 1; // decrement for 0 based indexing
+				if (id < 0 || id >= nNodes) scan.Error("node tags must be 1 to the number of nodes"); 
+				MeshNode& node = _nodes[id]; 
+				node.id = id; 
+				for (int d=0; d<3; d++) {
+					node.x[d] = GmshDouble(scan, binary); 
+				}
+			}
+		}
+
+		else if (section == "Nodes") {
+			scan.SkipLine(); 
+			long long nblocks = GmshInt<size_t>(scan, binary); 
+			long long nNodes = GmshInt<size_t>(scan, binary); 
+			GmshInt<size_t>(scan, binary); 
+			GmshInt<size_t>(scan, binary); 
+			_nodes.Resize(nNodes); 
+			Array<int> ids; 
+			for (long long b=0; b<nblocks; b++) {
+				int dim = GmshInt<int>(scan, binary); 
+				GmshInt<int>(scan, binary); 
+				int parametric = GmshInt<int>(scan, binary); 
+				long long n = GmshInt<size_t>(scan, binary); 
+				// all tags of the block come before the coordinates 
+				ids.Resize(n); 
+				for (long long i=0; i<n; i++) {
+					ids[i] = GmshInt<size_t>(scan, binary) - 1; 
+					if (ids[i] < 0 || ids[i] >= nNodes) scan.Error("node tags must be 1 to the number of nodes"); 
+				}
+				for (long long i=0; i<n; i++) {
+					MeshNode& node = _nodes[ids[i]]; 
+					node.id = ids[i]; 
+					for (int d=0; d<3; d++) {
+						node.x[d] = GmshDouble(scan, binary); 
+					}
+					for (int d=0; parametric && d<dim; d++) {
+						GmshDouble(scan, binary); 
+					}
+				}
+			}
+		}
+
+		else if (section == "Elements" && _mesh_version < 4) {
+			int nEl = scan.Int(); 
+			if (binary) scan.SkipLine(); 
+			els.type.Reserve(nEl); 
+			els.tag_offsets.Reserve(nEl+1); 
+			els.node_offsets.Reserve(nEl+1); 
+			els.tags.Reserve(2*nEl); 
+			els.nodes.Reserve(4*nEl); 
+			int read = 0; 
+			while (read < nEl) {
+				// binary elements come in blocks of one type with a shared header 
+				int gtype, nblock = 1, ntags = 0; 
+				if (binary) {
+					gtype = scan.Read<int>(); 
+					nblock = scan.Read<int>(); 
+					ntags = scan.Read<int>(); 
+				}
+				for (int i=0; i<nblock; i++) {
+					GmshInt<int>(scan, binary); 
+					if (!binary) {
+						gtype = scan.Int(); 
+						ntags = scan.Int(); 
+					}
+					int type = GmshType(scan, gtype); 
+					els.type.Append(type); 
+					els.tag_offsets.Append(els.tags.GetSize()); 
+					els.node_offsets.Append(els.nodes.GetSize()); 
+					for (int j=0; j<ntags; j++) {
+						els.tags.Append(GmshInt<int>(scan, binary)); 
+					}
+					int nnodes = (type < 0) ? 1 : _NodesPerEl[type]; 
+					for (int j=0; j<nnodes; j++) {
+						els.nodes.Append(GmshInt<int>(scan, binary) - 1); 
+					}
+				}
+				read += nblock; 
+			}
+		}
+
+		else if (section == "Elements") {
+			scan.SkipLine(); 
+			long long nblocks = GmshInt<size_t>(scan, binary); 
+			long long nEl = GmshInt<size_t>(scan, binary); 
+			GmshInt<size_t>(scan, binary); 
+			GmshInt<size_t>(scan, binary); 
+			els.type.Reserve(nEl); 
+			els.tag_offsets.Reserve(nEl+1); 
+			els.node_offsets.Reserve(nEl+1); 
+			els.tags.Reserve(2*nEl); 
+			els.nodes.Reserve(4*nEl); 
+			for (long long b=0; b<nblocks; b++) {
+				int dim = GmshInt<int>(scan, binary); 
+				int entity = GmshInt<int>(scan, binary); 
+				int type = GmshType(scan, GmshInt<int>(scan, binary)); 
+				long long n = GmshInt<size_t>(scan, binary); 
+				// same tag layout as msh 2: physical then elementary 
+				auto phys = physical.find({dim, entity}); 
+				int ptag = (phys == physical.end()) ? 0 : phys->second; 
+				int nnodes = (type < 0) ? 1 : _NodesPerEl[type]; 
+				for (long long i=0; i<n; i++) {
+					GmshInt<size_t>(scan, binary); 
+					els.type.Append(type); 
+					els.tag_offsets.Append(els.tags.GetSize()); 
+					els.node_offsets.Append(els.nodes.GetSize()); 
+					els.tags.Append(ptag); 
+					els.tags.Append(entity); 
+					for (int j=0; j<nnodes; j++) {
+						els.nodes.Append(GmshInt<size_t>(scan, binary) - 1); 
+					}
+				}
+			}
+		}
+
+		// skip sections that are not needed 
+		else {
+			scan.SkipTo("$End" + section); 
+		}
+
+		scan.Expect("$End" + section); 
+	}
+	if (_mesh_version == 0) ERROR(name << " is not a gmsh file"); 
+	els.tag_offsets.Append(els.tags.GetSize()); 
+	els.node_offsets.Append(els.nodes.GetSize()); 
+
+	BuildElements(els); 
+}
+
+void Mesh::BuildElements(const GmshElements& els) {
+	int Ne = els.type.GetSize(); 
+
+	// elements of the highest dimension make up the mesh, 
+	// elements one dimension lower are the boundary 
+	_dim = 0; 
+	int count[4] = {0, 0, 0, 0}; 
+	for (int i=0; i<Ne; i++) {
+		if (els.type[i] < 0) continue; 
+		int dim = GetGeoDim(els.type[i]); 
+		_dim = max(_dim, dim); 
+		count[dim]++; 
+	}
+	_el.Clear(); 
+	_bel.Clear(); 
+	_el.Reserve(count[_dim]); 
+	if (_dim > 0) _bel.Reserve(count[_dim-1]); 
+
+	for (int i=0; i<_nodes.GetSize(); i++) {
+		_nodes[i].bc = INTERIOR; 
+		_nodes[i].elements.Clear(); 
+	}
+
+	for (int i=0; i<Ne; i++) {
+		int type = els.type[i]; 
+		if (type < 0) continue; 
+		int dim = GetGeoDim(type); 
+		if (dim < _dim-1) continue; 
+
+		MeshEl el; 
+		el.SetType(type); 
+		for (int j=els.tag_offsets[i]; j<els.tag_offsets[i+1]; j++) {
+			el.AddTag(els.tags[j]); 
+		}
+		for (int j=els.node_offsets[i]; j<els.node_offsets[i+1]; j++) {
+			int node = els.nodes[j]; 
+			if (node < 0 || node >= _nodes.GetSize()) ERROR("element " << i << " references node "
+				<< node+1 << " which does not exist"); 
+			el.AddNode(node); 
+		}
+
+		// set boundary nodes 
+		if (dim < _dim) {
+			int tag = (el.GetNumTags()) ? el.GetTag(0) : 0; 
+			int bc; 
+			if (tag == 1) bc = DIRICHLET; 
+			else if (tag == 2) bc = NEUMANN; 
+			else ERROR("boundary value " << tag << " not defined"); 
+			for (int j=0; j<el.GetNumNodes(); j++) {
+				_nodes[el[j]].bc = bc; 
+			}
+			// build boundary element 
+			el.SetID(_bel.GetSize()); 
+			_bel.Append(el); 
+		}
+
+		// add to _el and set the element id for each node 
+		else {
+			el.SetID(_el.GetSize()); 
+			for (int j=0; j<el.GetNumNodes(); j++) {
+				_nodes[el[j]].elements.Append(el.GetID()); 
+			}
+			_el.Append(el); 
+		}
+	}
+}
+
+} // end namespace fem 
\ No newline at end of file
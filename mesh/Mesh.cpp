@@ -1,6 +1,10 @@
 #include "Mesh.hpp"
+#include "Snapshot.hpp"
 #include <fstream> 
 #include <limits> 
+#include <unordered_map>
+#include <unordered_set>
+#include <algorithm>
 // #include "Quadrature.hpp"
 // #include "ElTrans.hpp"
 
@@ -12,257 +16,384 @@
 #include <mpi.h>
 #endif
 
-#define GEO_TOL 1e-5
-
 using namespace std; 
 
-bool in(string str1, string str2) {
-	return str1.find(str2) != string::npos; 
-}
-
 namespace fem
 {
 
-bool matchingNode(const MeshNode& n1, const MeshNode& n2) {
-	for (int i=0; i<DIM; i++) {
-		if (abs(n1.x[i] - n2.x[i]) > GEO_TOL) return false; 
-	}
-	return true; 
-}
-
-Mesh::Mesh(string name, int nref) {
-	ifstream meshstream(MESH_DIR + name); 
-	if (!meshstream.good()) ERROR("meshfile " << name << " not read"); 
+/// sorted vertex ids of a face padded with -1 
+typedef array<int,4> FaceKey; 
 
-	_NodesPerEl = {2, 3, 4, 4, 8, 6, 5}; 
-
-	string line; 
-	while (getline(meshstream, line)) {
-		if (in(line, "$MeshFormat")) {
-			meshstream >> _mesh_version >> _ascii >> _data_size; 
-		} 
-
-		else if (in(line, "$Nodes")) {
-			int nNodes; 
-			meshstream >> nNodes; 
-			_nodes.Resize(nNodes); 
-			for (int i=0; i<nNodes; i++) {
-				MeshNode node; 
-				meshstream >> node.id >> node.x[0] >> node.x[1] >> node.x[2];
-				node.id--; // decrement for 0 based indexing 
-				_nodes[i] = node; 
-			}
+/// hash of a FaceKey 
+struct FaceKeyHash {
+	size_t operator()(const FaceKey& k) const {
+		size_t h = 14695981039346656037ull; 
+		for (int i=0; i<4; i++) {
+			h = (h ^ (size_t)(unsigned int)k[i]) * 1099511628211ull; 
 		}
-
-		else if (in(line, "$Elements")) {
-			int nEl; 
-			meshstream >> nEl; 
-			for (int i=0; i<nEl; i++) {
-				int id, type, ntags; 
-				meshstream >> id >> type >> ntags; 
-				type--; // decrement for 0 based indexing 
-
-				MeshEl el; 
-				el.SetType(type); 
-
-				// set dim 
-				_dim = 2; 
-				if (type == TET || type == HEX || type == PRISM || type == PYR) {
-					_dim = 3; 
-				}
-
-				// read in tags 
-				for (int j=0; j<ntags; j++) {
-					int tag; 
-					meshstream >> tag;
-					el.AddTag(tag);  
-				}
-
-				// read in nodes 
-				int nnodes = _NodesPerEl[el.GetType()]; 
-				for (int j=0; j<nnodes; j++) {
-					int node; 
-					meshstream >> node; 
-					node--;
-					el.AddNode(node); 
-				}
-
-				// set boundary nodes 
-				if (el.GetType() == LINE) {
-					for (int j=0; j<nnodes; j++) {
-						if (el.GetTag(0)==1) {
-							_nodes[el[j]].bc = DIRICHLET; 
-						}
-						else if (el.GetTag(0)==2) {
-							_nodes[el[j]].bc = NEUMANN; 
-						}
-						else ERROR("boundary value " 
-							<< el.GetTag(0) << " not defined"); 
-					}
-					// build boundary element 
-					el.SetID(_bel.GetSize()); 
-					_bel.Append(el); 
-				} 
-
-				// add to _el and set the element id for each node 
-				else {
-					el.SetID(_el.GetSize()); 
-					for (int j=0; j<nnodes; j++) {
-						_nodes[el[j]].elements.Append(el.GetID()); 
-					}
-					_el.Append(el); 
-				}
-			}
+		return h; 
+	}
+}; 
+
+/// sort the first n ids into a FaceKey 
+FaceKey MakeFaceKey(const int* ids, int n) {
+	if (n > 4) ERROR("a face key holds at most 4 vertices, got " << n); 
+	FaceKey key = {-1, -1, -1, -1}; 
+	// insertion sort of at most 4 ids 
+	for (int i=0; i<n; i++) {
+		int j = i; 
+		for (; j>0 && key[j-1] > ids[i]; j--) {
+			key[j] = key[j-1]; 
 		}
+		key[j] = ids[i]; 
 	}
+	return key; 
+}
+
+/// lattice coordinates of corner c of a quad or hex (each 0 or 1) 
+void CornerBits(int c, int* bits) {
+	bits[0] = (c&1) ^ ((c>>1)&1); 
+	bits[1] = (c>>1)&1; 
+	bits[2] = (c>>2)&1; 
+}
 
-	meshstream.close();
+/// corner of a quad or hex at lattice coordinates bits 
+int BitsCorner(const int* bits, int dim) {
+	int c = (bits[1]) ? 3 - bits[0] : bits[0]; 
+	if (dim == 3) c += 4*bits[2]; 
+	return c; 
+}
+
+Mesh::Mesh(string name, int nref) {
+	_NodesPerEl = {2, 3, 4, 4, 8, 6, 5}; 
+	ReadGmsh(MESH_DIR + name); 
 
+	FindNeighbors(); 
 	for (int i=0; i<nref; i++) {
 		GlobalRefine(); 
 	}
-
-	FindNeighbors(); 
 }
 
 void Mesh::GlobalRefine() {
+	CH_TIMERS_COARSE("global refine"); 
+	if (_el_face_offsets.GetSize() != GetNumElements()+1) FindNeighbors(); 
+	int Ne = GetNumElements(); 
+	int Nv = GetNumNodes(); 
+
+	// keys of the boundary faces and their edges: slot 5*i holds face i and 
+	// slots 5*i+1.. its edges (unused slots stay empty). Filled in parallel 
+	int Nf = _faces.GetSize(); 
+	Array<FaceKey> bkeys(5*Nf); 
+	bkeys = FaceKey({-1, -1, -1, -1}); 
+	#pragma omp parallel for 
+	for (int i=0; i<Nf; i++) {
+		const MeshFace& face = _faces[i]; 
+		if (face.neighbor >= 0) continue; 
+		const MeshEl& el = _el[face.owner]; 
+		int verts[4], ids[4]; 
+		int nv = FaceVertices(el.GetType(), face.owner_face, verts); 
+		for (int v=0; v<nv; v++) {
+			ids[v] = el[verts[v]]; 
+		}
+		bkeys[5*i] = MakeFaceKey(ids, nv); 
+		for (int v=0; nv>2 && v<nv; v++) {
+			int edge[2] = {ids[v], ids[(v+1)%nv]}; 
+			bkeys[5*i+1+v] = MakeFaceKey(edge, 2); 
+		}
+	}
+	unordered_set<FaceKey, FaceKeyHash> boundary; 
+	for (int i=0; i<bkeys.GetSize(); i++) {
+		if (bkeys[i][0] >= 0) boundary.insert(bkeys[i]); 
+	}
 
-	Array<MeshEl> old_els = _el; 
-	vector<vector<int>> node_map(_el.GetSize()); 
-	int start_nodes = _nodes.GetSize(); 
-	for (int n=0; n<old_els.GetSize(); n++) {
-		// access element n
-		const MeshEl& old = _el[n]; 
+	MeshRefinement ref; 
+	ref.child_offsets.Resize(Ne+1); 
+	ref.stencil_offsets.Resize(Nv+1); 
+	ref.stencil_offsets[0] = 0; 
+	ref.stencil_nodes.Resize(Nv); 
+	ref.stencil_weights.Resize(Nv); 
+	for (int i=0; i<Nv; i++) {
+		ref.stencil_offsets[i+1] = i+1; 
+		ref.stencil_nodes[i] = i; 
+		ref.stencil_weights[i] = 1.; 
+	}
 
-		if (old.GetType() != QUAD) {
-			WARNING("only quads supported"); 
-			return; 
+	// new node of each refined edge and face 
+	unordered_map<FaceKey, int, FaceKeyHash> created; 
+	created.reserve(3*Ne); 
+	// return the node at the center of the entity with vertices ids, creating it if needed 
+	auto center = [&](const int* ids, int n, bool cell) {
+		// cell centers are never shared, so only edges and faces (at most 4 vertices) get keys 
+		FaceKey key; 
+		if (!cell) {
+			key = MakeFaceKey(ids, n); 
+			auto it = created.find(key); 
+			if (it != created.end()) return it->second; 
 		}
-
-		// construct new nodes 
-		Array<MeshNode> new_nodes(5); 
-		for (int i=0; i<4; i++) {
-			int next = (i+1)%old.GetNumNodes(); 
-			Point x; 
-			for (int j=0; j<DIM; j++) {
-				x[j] = .5*(_nodes[old[i]].x[j] + _nodes[old[next]].x[j]); 
-			}
-			new_nodes[i].x = x; 
-			if (_nodes[old[i]].bc == _nodes[old[next]].bc) {
-				new_nodes[i].bc = _nodes[old[i]].bc; 
-			} else {
-				new_nodes[i].bc = INTERIOR; 
+		MeshNode node; 
+		node.id = _nodes.GetSize(); 
+		node.bc = INTERIOR; 
+		if (!cell && boundary.count(key)) {
+			// shared boundary condition of the parents, neumann where they differ 
+			node.bc = _nodes[ids[0]].bc; 
+			for (int i=1; i<n; i++) {
+				if (_nodes[ids[i]].bc != node.bc) node.bc = NEUMANN; 
 			}
 		}
-
-		// average node positions 
-		Point x; 
-		for (int i=0; i<DIM; i++) {
-			x[i] = .5*(_nodes[old[0]].x[i] + _nodes[old[2]].x[i]); 
+		for (int i=0; i<n; i++) {
+			node.x += _nodes[ids[i]].x; 
+			ref.stencil_nodes.Append(ids[i]); 
+			ref.stencil_weights.Append(1./n); 
 		}
-		new_nodes[4].x = x; 
-		new_nodes[4].bc = INTERIOR; 
-
-		// set to node id's to -1 
-		for (int i=0; i<new_nodes.GetSize(); i++) {
-			new_nodes[i].id = -1; 
+		node.x /= n; 
+		ref.stencil_offsets.Append(ref.stencil_nodes.GetSize()); 
+		if (!cell) created.insert({key, node.id}); 
+		_nodes.Append(node); 
+		return node.id; 
+	}; 
+
+	// split el into children appended to out 
+	auto split = [&](const MeshEl& el, bool boundary_el, Array<MeshEl>& out) {
+		int type = el.GetType(); 
+		vector<vector<int>> children; 
+		if (type == LINE) {
+			int edge[2] = {el[0], el[1]}; 
+			int mid = center(edge, 2, false); 
+			children = {{el[0], mid}, {mid, el[1]}}; 
 		}
 
-		// loop over faces 
-		for (int i=0; i<old.GetNumNodes(); i++) {
-			const MeshNode& node = _nodes[old[i]]; 
-			// check if neighbor on face i 
-			for (int j=0; j<node.elements.GetSize(); j++) {
-
-				// if a neighbor and neighbor has already been refined 
-				int el_num = node.elements[j]; 
-				if (old.IsFaceNeighbor(i, old_els[el_num])) {
-
-					// find match for new_node[i] 
-					for (int k=0; k<node_map[el_num].size(); k++) {
-						// if match set node id to already existing node's id 
-						int node_num = node_map[el_num][k]; 
-						if (matchingNode(new_nodes[i], _nodes[node_num])) {
-							new_nodes[i].id = node_num; 
-						}
+		else if (type == TRI) {
+			int m[3]; 
+			for (int i=0; i<3; i++) {
+				int edge[2] = {el[i], el[(i+1)%3]}; 
+				m[i] = center(edge, 2, false); 
+			}
+			children = {{el[0], m[0], m[2]}, {m[0], el[1], m[1]}, 
+				{m[2], m[1], el[2]}, {m[0], m[1], m[2]}}; 
+		} 
+
+		else if (type == QUAD || type == HEX) {
+			// nodes of the refined element on a lattice with coordinates 0, 1, 2 
+			int dim = (type == QUAD) ? 2 : 3; 
+			int lattice[27]; 
+			int nlat = (dim == 2) ? 9 : 27; 
+			for (int l=0; l<nlat; l++) {
+				int x[3] = {l%3, (l/3)%3, l/9}; 
+				int free[3], nfree = 0; 
+				for (int d=0; d<dim; d++) {
+					if (x[d] == 1) free[nfree++] = d; 
+				}
+				// corners of the entity the lattice point is the center of 
+				int corners[8]; 
+				for (int c=0; c<(1<<nfree); c++) {
+					int bits[3] = {x[0]/2, x[1]/2, x[2]/2}; 
+					for (int f=0; f<nfree; f++) {
+						bits[free[f]] = (c>>f)&1; 
 					}
-				}				
+					corners[c] = el[BitsCorner(bits, dim)]; 
+				}
+				if (nfree == 0) lattice[l] = corners[0]; 
+				else lattice[l] = center(corners, 1<<nfree, nfree == dim && !boundary_el); 
 			}
-		}
 
-		// add new nodes to _nodes 
-		for (int i=0; i<new_nodes.GetSize(); i++) {
+			// child c contains corner c 
+			int nc = 1<<dim; 
+			children.resize(nc); 
+			for (int c=0; c<nc; c++) {
+				int base[3]; 
+				CornerBits(c, base); 
+				for (int j=0; j<nc; j++) {
+					int off[3]; 
+					CornerBits(j, off); 
+					int l = base[0] + off[0] + 3*(base[1] + off[1]); 
+					if (dim == 3) l += 9*(base[2] + off[2]); 
+					children[c].push_back(lattice[l]); 
+				}
+			}
+		} 
 
-			// if a redundant node leave node id as is and 
-			// don't append to end of _nodes 
-			if (new_nodes[i].id > 0) {
+		else ERROR("refinement of geo = " << type << " not supported"); 
 
-			} else {
-				new_nodes[i].id = _nodes.GetSize(); 
-				_nodes.Append(new_nodes[i]); 				
+		for (int c=0; c<children.size(); c++) {
+			MeshEl child; 
+			child.SetType(type); 
+			for (int j=0; j<el.GetNumTags(); j++) {
+				child.AddTag(el.GetTag(j)); 
+			}
+			for (int j=0; j<children[c].size(); j++) {
+				child.AddNode(children[c][j]); 
 			}
+			child.SetID(out.GetSize()); 
+			out.Append(child); 
 		}
-
-		// construct new elements 
-		vector<MeshEl> new_els(4); 
-		// add first two for all elements 
-		for (int i=0; i<new_els.size(); i++) {
-			new_els[i].AddNode(old[i]); 
-			new_els[i].AddNode(new_nodes[i].id); 
+	}; 
+
+	Array<MeshEl> coarse; 
+	coarse.Swap(_el); 
+	_el.Clear(); 
+	for (int e=0; e<Ne; e++) {
+		ref.child_offsets[e] = _el.GetSize(); 
+		split(coarse[e], false, _el); 
+		for (int c=ref.child_offsets[e]; c<_el.GetSize(); c++) {
+			ref.parent.Append(e); 
 		}
+	}
+	ref.child_offsets[Ne] = _el.GetSize(); 
 
-		// el0 remaining 
-		new_els[0].AddNode(new_nodes[4].id); 
-		new_els[0].AddNode(new_nodes[3].id); 
-
-		// el1 remaining 
-		new_els[1].AddNode(new_nodes[4].id); 
-		new_els[1].AddNode(new_nodes[0].id); 
+	Array<MeshEl> bcoarse; 
+	bcoarse.Swap(_bel); 
+	_bel.Clear(); 
+	for (int e=0; e<bcoarse.GetSize(); e++) {
+		split(bcoarse[e], true, _bel); 
+	}
 
-		// el2 remaining 
-		new_els[2].AddNode(new_nodes[4].id); 
-		new_els[2].AddNode(new_nodes[1].id); 
+	// update elements nodes belong to 
+	for (int i=0; i<_nodes.GetSize(); i++) {
+		_nodes[i].elements.Clear(); 
+	}
+	for (int n=0; n<_el.GetSize(); n++) {
+		for (int j=0; j<_el[n].GetNumNodes(); j++) {
+			_nodes[_el[n][j]].elements.Append(n); 
+		}
+	}
 
-		// el3 remaining 
-		new_els[3].AddNode(new_nodes[4].id); 
-		new_els[3].AddNode(new_nodes[2].id);
+	_refinements.Append(ref); 
+	FindNeighbors(); 
+}
 
-		// copy meta info from old element 
-		for (int i=0; i<new_els.size(); i++) {
-			for (int j=0; j<old.GetNumTags(); j++) {
-				new_els[i].AddTag(old.GetTag(j)); 
-			}
-			new_els[i].SetType(old.GetType()); 
+/// store the types, tags, and nodes of els in flat arrays 
+void FlattenElements(const Array<MeshEl>& els, Array<int>& type, Array<int>& toff, 
+	Array<int>& tags, Array<int>& noff, Array<int>& nodes) {
+	type.Resize(els.GetSize()); 
+	toff.Resize(els.GetSize()+1); 
+	noff.Resize(els.GetSize()+1); 
+	tags.Clear(); 
+	nodes.Clear(); 
+	for (int e=0; e<els.GetSize(); e++) {
+		const MeshEl& el = els[e]; 
+		type[e] = el.GetType(); 
+		toff[e] = tags.GetSize(); 
+		for (int i=0; i<el.GetNumTags(); i++) {
+			tags.Append(el.GetTag(i)); 
 		}
+		noff[e] = nodes.GetSize(); 
+		for (int i=0; i<el.GetNumNodes(); i++) {
+			nodes.Append(el[i]); 
+		}
+	}
+	toff[els.GetSize()] = tags.GetSize(); 
+	noff[els.GetSize()] = nodes.GetSize(); 
+}
 
-		// put el0 into old's location 
-		new_els[0].SetID(n); 
-		_el[n] = new_els[0]; 
-
-		// append the rest to the end 
-		for (int i=1; i<new_els.size(); i++) {
-			new_els[i].SetID(_el.GetSize()); 
-			_el.Append(new_els[i]); 
+/// rebuild elements from the arrays written by FlattenElements 
+void UnflattenElements(const Array<int>& type, const Array<int>& toff, 
+	const Array<int>& tags, const Array<int>& noff, const Array<int>& nodes, Array<MeshEl>& els) {
+	els.Clear(); 
+	els.Reserve(type.GetSize()); 
+	for (int e=0; e<type.GetSize(); e++) {
+		MeshEl el(e, type[e]); 
+		for (int i=toff[e]; i<toff[e+1]; i++) {
+			el.AddTag(tags[i]); 
+		}
+		for (int i=noff[e]; i<noff[e+1]; i++) {
+			el.AddNode(nodes[i]); 
 		}
+		els.Append(el); 
+	}
+}
 
-		// update the node map 
-		for (int i=0; i<new_nodes.GetSize(); i++) {
-			node_map[n].push_back(new_nodes[i].id); 
+void Mesh::Save(SnapshotWriter& snap) const {
+	CH_TIMERS_COARSE("save mesh snapshot"); 
+	int Nn = GetNumNodes(); 
+	Array<double> x(DIM*Nn); 
+	Array<int> bc(Nn); 
+	for (int i=0; i<Nn; i++) {
+		for (int d=0; d<DIM; d++) {
+			x[DIM*i+d] = _nodes[i].x[d]; 
+		}
+		bc[i] = _nodes[i].bc; 
+	}
+	snap.Add("mesh_dim", _dim); 
+	snap.Add("mesh_x", x); 
+	snap.Add("mesh_bc", bc); 
+
+	Array<int> type, toff, tags, noff, nodes; 
+	FlattenElements(_el, type, toff, tags, noff, nodes); 
+	snap.Add("mesh_el_type", type); 
+	snap.Add("mesh_el_toff", toff); 
+	snap.Add("mesh_el_tags", tags); 
+	snap.Add("mesh_el_noff", noff); 
+	snap.Add("mesh_el_nodes", nodes); 
+	FlattenElements(_bel, type, toff, tags, noff, nodes); 
+	snap.Add("mesh_bel_type", type); 
+	snap.Add("mesh_bel_toff", toff); 
+	snap.Add("mesh_bel_tags", tags); 
+	snap.Add("mesh_bel_noff", noff); 
+	snap.Add("mesh_bel_nodes", nodes); 
+
+	// neighbors share the layout of _el_faces 
+	Array<int> neighbors(_el_faces.GetSize()); 
+	for (int e=0; e<GetNumElements(); e++) {
+		const Array<int>& nei = _el[e].GetNeighbors(); 
+		for (int f=0; f<nei.GetSize(); f++) {
+			neighbors[_el_face_offsets[e] + f] = nei[f]; 
 		}
 	}
+	snap.Add("mesh_nbr", neighbors); 
+	snap.Add("mesh_foff", _el_face_offsets); 
+	snap.Add("mesh_el_faces", _el_faces); 
+	snap.Add("mesh_faces", _faces); 
+}
 
-	// update elements nodes belong to 
-	for (int n=0; n<_el.GetSize(); n++) {
-		for (int j=0; j<_el[n].GetNumNodes(); j++) {
-			_nodes[_el[n][j]].elements.Clear(); 
+void Mesh::Load(const SnapshotReader& snap) {
+	CH_TIMERS_COARSE("load mesh snapshot"); 
+	_NodesPerEl = {2, 3, 4, 4, 8, 6, 5}; 
+	_dim = snap.GetInt("mesh_dim"); 
+	Array<double> x; 
+	Array<int> bc; 
+	snap.Get("mesh_x", x); 
+	snap.Get("mesh_bc", bc); 
+	_nodes.Resize(bc.GetSize()); 
+	for (int i=0; i<bc.GetSize(); i++) {
+		MeshNode& node = _nodes[i]; 
+		node.id = i; 
+		for (int d=0; d<DIM; d++) {
+			node.x[d] = x[DIM*i+d]; 
 		}
+		node.bc = bc[i]; 
+		node.elements.Clear(); 
 	}
 
-	for (int n=0; n<_el.GetSize(); n++) {
-		for (int j=0; j<_el[n].GetNumNodes(); j++) {
-			_nodes[_el[n][j]].elements.Append(_el[n].GetID()); 
+	Array<int> type, toff, tags, noff, nodes; 
+	snap.Get("mesh_el_type", type); 
+	snap.Get("mesh_el_toff", toff); 
+	snap.Get("mesh_el_tags", tags); 
+	snap.Get("mesh_el_noff", noff); 
+	snap.Get("mesh_el_nodes", nodes); 
+	UnflattenElements(type, toff, tags, noff, nodes, _el); 
+	snap.Get("mesh_bel_type", type); 
+	snap.Get("mesh_bel_toff", toff); 
+	snap.Get("mesh_bel_tags", tags); 
+	snap.Get("mesh_bel_noff", noff); 
+	snap.Get("mesh_bel_nodes", nodes); 
+	UnflattenElements(type, toff, tags, noff, nodes, _bel); 
+
+	snap.Get("mesh_foff", _el_face_offsets); 
+	snap.Get("mesh_el_faces", _el_faces); 
+	snap.Get("mesh_faces", _faces); 
+	Array<int> neighbors, nei; 
+	snap.Get("mesh_nbr", neighbors); 
+	for (int e=0; e<GetNumElements(); e++) {
+		nei.Resize(_el_face_offsets[e+1] - _el_face_offsets[e]); 
+		for (int f=0; f<nei.GetSize(); f++) {
+			nei[f] = neighbors[_el_face_offsets[e] + f]; 
+		}
+		_el[e].SetNeighbors(nei); 
+		for (int j=0; j<_el[e].GetNumNodes(); j++) {
+			_nodes[_el[e][j]].elements.Append(e); 
 		}
 	}
+	_refinements.Clear(); 
 }
 
 const MeshEl& Mesh::GetElement(int index) const {
@@ -286,8 +417,69 @@ void Mesh::GetNodes(int ind, Array<MeshNode>& nodes) const {
 }
 
 void Mesh::FindNeighbors() {
-	for (int i=0; i<GetNumElements(); i++) {
-		_el[i].SetNeighbors(_nodes); 
+	CH_TIMERS_COARSE("find neighbors"); 
+	int Ne = GetNumElements(); 
+	_el_face_offsets.Resize(Ne+1); 
+	int nlocal = 0; 
+	for (int e=0; e<Ne; e++) {
+		_el_face_offsets[e] = nlocal; 
+		nlocal += FacesPerEl(_el[e].GetType()); 
+	}
+	_el_face_offsets[Ne] = nlocal; 
+	_el_faces.Resize(nlocal); 
+	_faces.Clear(); 
+
+	// key of every local face. Each element fills its own slots so this runs in parallel 
+	Array<FaceKey> keys(nlocal); 
+	#pragma omp parallel for 
+	for (int e=0; e<Ne; e++) {
+		const MeshEl& el = _el[e]; 
+		int verts[4], ids[4]; 
+		for (int f=0; f<FacesPerEl(el.GetType()); f++) {
+			int nv = FaceVertices(el.GetType(), f, verts); 
+			for (int v=0; v<nv; v++) {
+				ids[v] = el[verts[v]]; 
+			}
+			keys[_el_face_offsets[e] + f] = MakeFaceKey(ids, nv); 
+		}
+	}
+
+	// match the keys serially so faces are numbered in element order 
+	// face list index of each face key seen so far 
+	unordered_map<FaceKey, int, FaceKeyHash> index; 
+	index.reserve(nlocal); 
+	// neighbor across each local face of each element 
+	Array<int> neighbors(nlocal); 
+	neighbors = -1; 
+	for (int e=0; e<Ne; e++) {
+		int nf = FacesPerEl(_el[e].GetType()); 
+		for (int f=0; f<nf; f++) {
+			const FaceKey& key = keys[_el_face_offsets[e] + f]; 
+			auto it = index.find(key); 
+			if (it == index.end()) {
+				index.insert({key, _faces.GetSize()}); 
+				_el_faces[_el_face_offsets[e] + f] = _faces.GetSize(); 
+				_faces.Append({e, -1, f, -1}); 
+			} else {
+				MeshFace& face = _faces[it->second]; 
+				if (face.neighbor >= 0) ERROR("face " << f << " of element " << e 
+					<< " is shared by more than two elements"); 
+				face.neighbor = e; 
+				face.neighbor_face = f; 
+				_el_faces[_el_face_offsets[e] + f] = it->second; 
+				neighbors[_el_face_offsets[e] + f] = face.owner; 
+				neighbors[_el_face_offsets[face.owner] + face.owner_face] = e; 
+			}
+		}
+	}
+
+	#pragma omp parallel for 
+	for (int e=0; e<Ne; e++) {
+		Array<int> neighb(_el_face_offsets[e+1] - _el_face_offsets[e]); 
+		for (int f=0; f<neighb.GetSize(); f++) {
+			neighb[f] = neighbors[_el_face_offsets[e] + f]; 
+		}
+		_el[e].SetNeighbors(neighb); 
 	}
 }
 
@@ -303,8 +495,44 @@ int FacesPerEl(int geo) {
 	else if (geo == TRI) return 3; 
 	else if (geo == LINE) return 2; 
 	else if (geo == HEX) return 6; 
+	else if (geo == TET) return 4; 
+	else if (geo == PRISM) return 5; 
+	else if (geo == PYR) return 5; 
 	else ERROR("number of faces for geo = " << geo << " not defined"); 
 	return -1; 
 }
 
+int FaceVertices(int geo, int f, int* verts) {
+	// hex faces match the neighbor ordering of CubeMesh: 
+	// -z, +z, -y, +y, -x, +x 
+	static const int hex[6][4] = {{0,1,2,3}, {4,5,6,7}, {0,1,5,4}, 
+		{3,2,6,7}, {0,3,7,4}, {1,2,6,5}}; 
+	static const int tet[4][3] = {{0,2,1}, {0,1,3}, {0,3,2}, {1,2,3}}; 
+	static const int prism[5][4] = {{0,2,1,-1}, {3,4,5,-1}, {0,1,4,3}, 
+		{0,3,5,2}, {1,2,5,4}}; 
+	static const int pyr[5][4] = {{0,3,2,1}, {0,1,4,-1}, {1,2,4,-1}, 
+		{2,3,4,-1}, {3,0,4,-1}}; 
+	CHECKMSG(f >= 0 && f < FacesPerEl(geo), "face " << f << " not defined for geo = " << geo); 
+	if (geo == LINE) {
+		verts[0] = f; 
+		return 1; 
+	} else if (geo == TRI || geo == QUAD) {
+		// edge f runs from vertex f to the next vertex 
+		int nv = (geo == TRI) ? 3 : 4; 
+		verts[0] = f; 
+		verts[1] = (f+1)%nv; 
+		return 2; 
+	} else if (geo == TET) {
+		for (int i=0; i<3; i++) verts[i] = tet[f][i]; 
+		return 3; 
+	} else if (geo == HEX) {
+		for (int i=0; i<4; i++) verts[i] = hex[f][i]; 
+		return 4; 
+	} 
+	const int* face = (geo == PRISM) ? prism[f] : pyr[f]; 
+	int nv = (face[3] < 0) ? 3 : 4; 
+	for (int i=0; i<nv; i++) verts[i] = face[i]; 
+	return nv; 
+}
+
 } // end namespace FEM 
\ No newline at end of file
@@ -9,6 +9,10 @@
 namespace fem 
 {
 
+struct GmshElements; 
+class SnapshotWriter; 
+class SnapshotReader; 
+
 /// define the possible GMSH mesh element types 
 enum GmshElType {
 	LINE, 
@@ -27,16 +31,57 @@ enum BoundaryCondition {
 	NEUMANN
 };  
 
+/// a face shared by at most two elements 
+struct MeshFace {
+	/// element the face was first found on 
+	int owner; 
+	/// element on the other side (-1 on the boundary) 
+	int neighbor; 
+	/// local face index in owner 
+	int owner_face; 
+	/// local face index in neighbor (-1 on the boundary) 
+	int neighbor_face; 
+}; 
+
+/// record of one uniform refinement of a Mesh 
+/** the children of coarse element e are the fine elements child_offsets[e] 
+	through child_offsets[e+1]-1 and child c contains corner c of its parent. 
+	Fine node i is interpolated from the coarse nodes 
+	stencil_nodes[stencil_offsets[i]:stencil_offsets[i+1]] with the matching 
+	stencil_weights. Coarse nodes keep their ids */ 
+struct MeshRefinement {
+	/// coarse element each fine element was split from 
+	Array<int> parent; 
+	/// first child of each coarse element 
+	Array<int> child_offsets; 
+	/// start of each fine node's stencil 
+	Array<int> stencil_offsets; 
+	/// coarse nodes of the stencils 
+	Array<int> stencil_nodes; 
+	/// weights of the stencils 
+	Array<double> stencil_weights; 
+}; 
+
 /// represent a FEM mesh 
 class Mesh { 
 public: 
 	/// default constructor 
 	Mesh() { } 
 	/// load the mesh file 
-	/** \param name name of mesh file (relative to the mesh directory) */ 
+	/** reads ascii and binary gmsh files in the 2.2 and 4.1 formats. 
+		\param name name of mesh file (relative to the mesh directory) 
+		\param nref number of times to refine the mesh after reading */ 
 	Mesh(std::string name, int nref=0); 
-	/// refine the mesh 
+	/// split every element into 2^dim children 
+	/** supports TRI, QUAD, and HEX meshes. New nodes are placed at the centers of 
+		edges, faces, and cells and shared entities are matched by their sorted 
+		vertex ids so the cost is linear in the number of elements. Appends a 
+		MeshRefinement to the refinement history */ 
 	void GlobalRefine(); 
+	/// return the number of times GlobalRefine has been called 
+	int GetNumRefinements() const {return _refinements.GetSize(); }
+	/// return the record of refinement level i (0 is the first refinement) 
+	const MeshRefinement& GetRefinement(int i) const {return _refinements[i]; }
 
 	/// const access to MeshEls 
 	const MeshEl& GetElement(int index) const; 
@@ -51,6 +96,11 @@ public:
 
 	/// write the mesh to gmsh format 
 	void Write() const {ERROR("not implemented"); }
+	/// add nodes, elements, neighbors, and faces to a snapshot 
+	void Save(SnapshotWriter& snap) const; 
+	/// replace this mesh with the one stored in a snapshot 
+	/** the refinement history is not stored */ 
+	void Load(const SnapshotReader& snap); 
 
 	/// return the number of nodes 
 	int GetNumNodes() const {return _nodes.GetSize(); }
@@ -60,8 +110,25 @@ public:
 	int GetNumBoundaryElements() const {return _bel.GetSize(); }
 	/// return the dimensionality of the mesh 
 	int GetDim() const {return _dim; }
+
+	/// return the number of unique faces 
+	int GetNumFaces() const {return _faces.GetSize(); }
+	/// const access to face i 
+	const MeshFace& GetFace(int i) const {return _faces[i]; }
+	/// return the index into the face list of local face f of element e 
+	int GetElementFace(int e, int f) const {return _el_faces[_el_face_offsets[e] + f]; }
 protected:
-	/// find neighbors of all elements 
+	/// read the nodes and elements of a gmsh file 
+	void ReadGmsh(const std::string& name); 
+	/// fill _el and _bel from the elements read from a gmsh file 
+	/** elements of the highest dimension form the mesh and elements one 
+		dimension lower are boundary elements whose first (physical) tag sets 
+		the boundary condition of their nodes: 1 dirichlet, 2 neumann */ 
+	void BuildElements(const GmshElements& els); 
+	/// find neighbors of all elements and build the unique face list 
+	/** faces are matched by their sorted vertex ids in a hash map so the cost is 
+		linear in the number of elements. Neighbors are stored per local face 
+		in the order given by FaceVertices */ 
 	void FindNeighbors(); 
 	/// number of nodes per element for each Gmsh element type 
 	std::array<int,NGmshTypes> _NodesPerEl; 
@@ -71,6 +138,14 @@ protected:
 	Array<MeshEl> _el; 
 	/// store the boundary elements (ie for quad these will be segments) 
 	Array<MeshEl> _bel; 
+	/// unique faces 
+	Array<MeshFace> _faces; 
+	/// start of each element's entries in _el_faces 
+	Array<int> _el_face_offsets; 
+	/// face list index of each local face of each element 
+	Array<int> _el_faces; 
+	/// refinement history 
+	Array<MeshRefinement> _refinements; 
 	/// mesh version 
 	double _mesh_version; 
 	/// ascii type 
@@ -85,5 +160,11 @@ protected:
 int GetGeoDim(int geo); 
 /// returns the number of faces for a given element shape 
 int FacesPerEl(int geo); 
+/// return the local vertex numbers of face f of an element of shape geo 
+/** \param[in] geo GmshElType of the element 
+	\param[in] f local face 
+	\param[out] verts up to 4 local vertex numbers 
+	\returns the number of vertices on the face */ 
+int FaceVertices(int geo, int f, int* verts); 
 
 } // end namespace FEM 
\ No newline at end of file
@@ -43,23 +43,4 @@ bool MeshEl::IsFaceNeighbor(int face, const MeshEl& el) const {
 	return false; 
 }
 
-void MeshEl::SetNeighbors(Array<MeshNode>& nodes) {
-	for (int j=0; j<GetNumNodes(); j++) {
-		int k = (j+1)%GetNumNodes(); 
-		MeshNode& nj = nodes[(*this)[j]]; 
-		MeshNode& nk = nodes[(*this)[k]]; 
-		Array<int> intersection; 
-		nj.elements.Intersection(nk.elements, intersection); 
-		if (intersection.GetSize() == 2) {
-			if (intersection[0]==GetID()) {
-				_neighbors.Append(intersection[1]); 
-			} else {
-				_neighbors.Append(intersection[0]); 
-			}
-		} else {
-			_neighbors.Append(-1); 
-		}
-	}
-}
-
 } // end namespace fem 
\ No newline at end of file
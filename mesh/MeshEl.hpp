@@ -46,8 +46,6 @@ public:
 	int GetTag(int i) const; 
 	/// get number of nodes 
 	int GetNumNodes() const {return _nodes.GetSize(); }
-	/// set neighbors based on node information 
-	void SetNeighbors(Array<MeshNode>& nodes);
 	/// set neighbors 
 	void SetNeighbors(Array<int>& nei) {_neighbors = nei; } 
 	/// return the neighbors array 
@@ -0,0 +1,62 @@
+#include "FEM.hpp"
+
+using namespace std; 
+using namespace fem; 
+
+double linear(const Point& x) {
+	return 1. + 2.*x[0] - x[1]; 
+}
+
+double bilinear(const Point& x) {
+	return x[0]*x[1]; 
+}
+
+int main(int argc, char* argv[]) {
+	int N = 8; 
+	int p = 2; 
+	if (argc>1) N = atoi(argv[1]); 
+	if (argc>2) p = atoi(argv[2]); 
+	SquareMesh mesh(N, N, {0,0}, {1,1}); 
+	LagrangeSpace h1(mesh, p); 
+
+	FEMatrix K(&h1); 
+	K.AddIntegrator(new WeakDiffusionIntegrator); 
+	ConstrainedOperator A(&K, &h1); 
+
+	// harmonic solutions are reproduced exactly for two sets of boundary data 
+	double (*exact[2])(const Point&) = {linear, bilinear}; 
+	for (int i=0; i<2; i++) {
+		GridFunction bvals(&h1), ex(&h1), x(&h1); 
+		bvals.Project(exact[i]); 
+		ex.Project(exact[i]); 
+		RHS rhs(&h1); 
+		A.EliminateRHS(bvals, rhs); 
+		CG cg(&A, 1e-12, 1000); 
+		cg.Solve(rhs, x); 
+		ex -= x; 
+		TEST(ex.LinfNorm() < 1e-8, "harmonic solution " << i); 
+	}
+
+	// matches eliminating the boundary in the element matrices 
+	FEMatrix K2(&h1); 
+	K2.AddIntegrator(new WeakDiffusionIntegrator); 
+	RHS r1(&h1), r2(&h1); 
+	for (int i=0; i<r1.GetSize(); i++) {
+		r1[i] = r2[i] = (double)rand()/RAND_MAX; 
+	}
+	K2.ApplyDirichletBoundary(r2, 3.); 
+	Vector bvals(h1.GetVSize()); 
+	bvals = 3.; 
+	A.EliminateRHS(bvals, r1); 
+	r1 -= r2; 
+	TEST(r1.L2Norm() < 1e-10, "lifted rhs"); 
+
+	Vector x(h1.GetVSize()), b1(h1.GetVSize()), b2(h1.GetVSize()); 
+	for (int i=0; i<x.GetSize(); i++) {
+		x[i] = (double)rand()/RAND_MAX; 
+	}
+	A.Mult(x, b1); 
+	K2.Mult(x, b2); 
+	b1 -= b2; 
+	TEST(b1.L2Norm() < 1e-10, "constrained mult"); 
+}
\ No newline at end of file
@@ -33,7 +33,6 @@ double ComputeError(int N, int p) {
 
 	K.ApplyDirichletBoundary(rhs); 
 
-	K.ConvertToBatch(); 
 	hwc.Reset(); 
 	CG cg(&K, 1e-5, 1000); 
 	cg.Solve(rhs, x); 
@@ -57,4 +56,54 @@ int main(int argc, char* argv[]) {
 
 	p = log(E1/E2)/log(2); 
 	TEST(abs(p - 2.) < 1e-1, "p = " << p); 
+
+	// shared edge and face nodes are numbered once 
+	CubeMesh mesh({N, N, N}); 
+	LagrangeSpace h2(mesh, 2), h3(mesh, 3); 
+	TEST(h2.GetNumNodes() == pow(2*N+1, 3) && h3.GetNumNodes() == pow(3*N+1, 3), 
+		"hex numbering"); 
+
+	// every interior face is shared by exactly two elements 
+	bool ok = mesh.GetNumFaces() == 3*N*N*(N+1); 
+	int nbdr = 0; 
+	for (int i=0; i<mesh.GetNumFaces(); i++) {
+		const MeshFace& face = mesh.GetFace(i); 
+		if (face.neighbor < 0) {
+			nbdr++; 
+			continue; 
+		}
+		const MeshEl& owner = mesh.GetElement(face.owner); 
+		const MeshEl& neighb = mesh.GetElement(face.neighbor); 
+		ok = ok && owner.GetNeighbors()[face.owner_face] == face.neighbor 
+			&& neighb.GetNeighbors()[face.neighbor_face] == face.owner 
+			&& mesh.GetElementFace(face.neighbor, face.neighbor_face) == i; 
+	}
+	TEST(ok && nbdr == 6*N*N, "mesh faces"); 
+
+	// refined mesh matches a mesh built at twice the resolution and the 
+	// stencils interpolate the coarse node locations 
+	CubeMesh fine({N, N, N}); 
+	fine.GlobalRefine(); 
+	const MeshRefinement& ref = fine.GetRefinement(0); 
+	ok = fine.GetNumElements() == 8*mesh.GetNumElements() 
+		&& fine.GetNumNodes() == pow(2*N+1, 3) 
+		&& fine.GetNumFaces() == 3*4*N*N*(2*N+1) 
+		&& ref.parent[ref.child_offsets[1]] == 1; 
+	for (int i=0; i<fine.GetNumNodes(); i++) {
+		Point x; 
+		for (int s=ref.stencil_offsets[i]; s<ref.stencil_offsets[i+1]; s++) {
+			for (int d=0; d<DIM; d++) {
+				x[d] += ref.stencil_weights[s]*mesh.GetNode(ref.stencil_nodes[s]).x[d]; 
+			}
+		}
+		for (int d=0; d<DIM; d++) {
+			ok = ok && abs(x[d] - fine.GetNode(i).x[d]) < 1e-12; 
+		}
+	}
+	TEST(ok, "refinement"); 
+
+	E1 = ComputeError(N, 2); 
+	E2 = ComputeError(2*N, 2); 
+	p = log(E1/E2)/log(2); 
+	TEST(abs(p - 3.) < 2e-1, "p2 = " << p); 
 }
\ No newline at end of file
@@ -0,0 +1,60 @@
+#include "FEM.hpp"
+
+using namespace std; 
+using namespace fem; 
+
+// reference source 
+double Source(const Point& x) {
+	return sin(M_PI*x[0])*sin(M_PI*x[1]) + exp(-x[0])*pow(1.+x[1], 1.5); 
+}
+
+// true if the expression evaluates to val at x 
+bool Near(const string& expr, double val, Point x = {0,0,0}) {
+	Expression e(expr); 
+	return fabs(e.Eval(x) - val) < 1e-12*max(1., fabs(val)); 
+}
+
+int main(int argc, char* argv[]) {
+	int N = 8; 
+	int p = 2; 
+	if (argc>1) N = atoi(argv[1]); 
+	if (argc>2) p = atoi(argv[2]); 
+
+	bool prec = Near("1 + 2*3", 7.) && Near("-2^2", -4.) && Near("2^3^2", 512.) 
+		&& Near("2**3", 8.) && Near("(1+2)*3", 9.) && Near("8/4/2", 1.) 
+		&& Near("-x*y", -6., {2,3,0}) && Near("2*-x", -4., {2,0,0}) 
+		&& Near("max(x, 1) + min(x, 1) + atan2(1, 1)", 3. + M_PI/4, {2,0,0}) 
+		&& Near("1.5e1 + e", 15. + M_E); 
+	TEST(prec, "parse"); 
+
+	Expression folded("2*pi*cos(0) + sqrt(4)"); 
+	Expression square("x^2 + y^0.5"); 
+	TEST(folded.IsConstant() && folded.NumInstructions() == 0 
+		&& fabs(folded.Eval(Point()) - 2*M_PI - 2) < 1e-14 
+		&& square.NumInstructions() == 3, "constant folding"); 
+
+	// batches longer than one chunk with a missing z coordinate and time 
+	ExpressionCoefficient ec("sin(pi*x)*sin(pi*y) + exp(-x)*pow(1+y, 1.5) + z + t"); 
+	ec.SetTime(.25); 
+	int n = 203; 
+	Array<double> x(2*n), vals(n); 
+	for (int i=0; i<2*n; i++) x[i] = (double)rand()/RAND_MAX; 
+	ec.Eval(n, 2, x.GetData(), vals.GetData()); 
+	double err = 0.; 
+	for (int i=0; i<n; i++) {
+		Point pt = {x[i], x[n+i], 0}; 
+		err = max(err, fabs(vals[i] - Source(pt) - .25)); 
+	}
+	TEST(err < 1e-12, "batch eval"); 
+
+	// same right hand side as the function pointer 
+	SquareMesh mesh(N, N, {0,0}, {1,1}); 
+	LagrangeSpace h1(mesh, p); 
+	FunctionCoefficient fc(Source); 
+	ExpressionCoefficient xc("sin(pi*x)*sin(pi*y) + exp(-x)*(1+y)^1.5"); 
+	RHS rf(&h1), rx(&h1); 
+	rf.AddIntegrator(new DomainIntegrator(&fc)); 
+	rx.AddIntegrator(new DomainIntegrator(&xc)); 
+	rx -= rf; 
+	TEST(rx.L2Norm() < 1e-12, "expression source"); 
+}
\ No newline at end of file
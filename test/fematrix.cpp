@@ -0,0 +1,314 @@
+#include "FEM.hpp"
+
+using namespace std; 
+using namespace fem; 
+
+// difference between FEMatrix and SparseMatrix products 
+double MultDiff(const FEMatrix& A, const SparseMatrix& S, const Vector& x) {
+	Vector b(x.GetSize()); 
+	Vector b2(x.GetSize()); 
+	A.Mult(x, b); 
+	S.Mult(x, b2); 
+	b2 -= b; 
+	return b2.L2Norm(); 
+}
+
+// spatially varying material 
+double Material(const Point& x) {
+	return 1. + x[0]*x[1]; 
+}
+
+// batched version of Material 
+void MaterialBatch(int n, int dim, const double* x, double* vals) {
+	for (int i=0; i<n; i++) {
+		vals[i] = 1. + x[i]*x[n+i]; 
+	}
+}
+
+// number of MaterialCounted calls 
+int material_calls = 0; 
+
+// MaterialBatch that counts its calls 
+void MaterialCounted(int n, int dim, const double* x, double* vals) {
+	material_calls++; 
+	MaterialBatch(n, dim, x, vals); 
+}
+
+int main(int argc, char* argv[]) {
+	int N = 8; 
+	int p = 2; 
+	if (argc>1) N = atoi(argv[1]); 
+	if (argc>2) p = atoi(argv[2]); 
+	SquareMesh mesh(N, N, {0,0}, {1,1}); 
+	LagrangeSpace h1(mesh, p); 
+
+	Vector x(h1.GetVSize()); 
+	for (int i=0; i<x.GetSize(); i++) {
+		x[i] = (double)rand()/RAND_MAX; 
+	}
+
+	FEMatrix A(&h1); 
+	A.AddIntegrator(new WeakDiffusionIntegrator); 
+	A.AddIntegrator(new MassIntegrator); 
+	TEST(A.IsPacked(), "symmetric integrators packed"); 
+
+	LHS S(&h1); 
+	S.AddIntegrator(new WeakDiffusionIntegrator); 
+	S.AddIntegrator(new MassIntegrator); 
+	// low orders use the unrolled kernels, higher ones the triangle loop 
+	bool orders = true; 
+	for (int o=1; o<=3; o++) {
+		LagrangeSpace ho(mesh, o); 
+		Vector xo(ho.GetVSize()); 
+		for (int i=0; i<xo.GetSize(); i++) {
+			xo[i] = (double)rand()/RAND_MAX; 
+		}
+		FEMatrix Ao(&ho); 
+		Ao.AddIntegrator(new WeakDiffusionIntegrator); 
+		LHS So(&ho); 
+		So.AddIntegrator(new WeakDiffusionIntegrator); 
+		orders = orders && Ao.IsPacked() && MultDiff(Ao, So, xo) < 1e-10; 
+	}
+	TEST(MultDiff(A, S, x) < 1e-10 && orders, "packed matvec"); 
+
+	Vector diag, sdiag(h1.GetVSize()); 
+	A.GetDiagonal(diag); 
+	for (int i=0; i<sdiag.GetSize(); i++) {
+		sdiag[i] = S.At(i,i); 
+	}
+	sdiag -= diag; 
+	TEST(sdiag.L2Norm() < 1e-10, "packed diagonal"); 
+
+	// writable element access switches to full storage so (0,1) and (1,0) stay apart 
+	FEMatrix B(&h1); 
+	B.AddIntegrator(new MassIntegrator); 
+	const FEMatrix& Bc = B; 
+	double b01 = Bc[0](0,1), b10 = Bc[0](1,0); 
+	Matrix upper(B.GetElSize(0)); 
+	upper = 0.; 
+	upper(0,1) = 1.; 
+	B[0] += upper; 
+	TEST(!B.IsPacked() && Bc[0](0,1) == b01 + 1. && Bc[0](1,0) == b10, "element update unpacks"); 
+
+	// symmetric element updates keep packed storage but are not fingerprinted 
+	FEMatrix C(&h1); 
+	C.AddIntegrator(new MassIntegrator); 
+	const FEMatrix& Cc = C; 
+	bool ckeyed = C.IsCacheable(); 
+	double c01 = Cc[0](0,1); 
+	Matrix ones(C.GetElSize(0)); 
+	ones = 1.; 
+	C[0] *= 2.; 
+	C[0] += ones; 
+	TEST(ckeyed && C.IsPacked() && !C.IsCacheable() && Cc[0](0,1) == 2*c01 + 1. 
+		&& Cc[0](1,0) == 2*c01 + 1., "symmetric element update stays packed"); 
+
+	// a non symmetric integrator switches to full storage 
+	Vector v(2); 
+	v[0] = 1.; 
+	v[1] = 2.; 
+	ConstantVectorCoefficient vc(v); 
+	A.AddIntegrator(new ConvectionIntegrator(&vc)); 
+	S.AddIntegrator(new ConvectionIntegrator(&vc)); 
+	TEST(!A.IsPacked(), "unpacked after convection"); 
+	TEST(MultDiff(A, S, x) < 1e-10, "dense matvec"); 
+
+	SparseMatrix converted; 
+	A.ConvertToSparseMatrix(converted); 
+	Vector b(x.GetSize()), b2(x.GetSize()); 
+	converted.Mult(x, b); 
+	S.Mult(x, b2); 
+	b2 -= b; 
+	TEST(b2.L2Norm() < 1e-10, "convert to sparse"); 
+
+	// cached geometric factors: affine on the square mesh, per point once distorted 
+	SquareMesh dmesh(N, N, {0,0}, {1,1}); 
+	for (int n=0; n<dmesh.GetNumNodes(); n++) {
+		MeshNode& node = dmesh.GetNode(n); 
+		if (node.bc == INTERIOR) node.x[0] += .2/N*sin(7.*node.x[1]); 
+	}
+	bool cached = true; 
+	for (int m=0; m<2; m++) {
+		LagrangeSpace ref(m ? dmesh : mesh, p); 
+		LagrangeSpace fast(m ? dmesh : mesh, p); 
+		fast.EnableGeometricCache(); 
+		FEMatrix Af(&fast); 
+		Af.AddIntegrator(new WeakDiffusionIntegrator); 
+		Af.AddIntegrator(new MassIntegrator); 
+		LHS Sr(&ref); 
+		Sr.AddIntegrator(new WeakDiffusionIntegrator); 
+		Sr.AddIntegrator(new MassIntegrator); 
+		// factors are built lazily during assembly 
+		bool built = fast.GetGeometricCache()->GetSize() > 0; 
+		const GeometricFactors& gf = fast.GetGeometricCache()->Get( 
+			QRules.Get(QUAD, p+1, INTEGRATION_TYPE)); 
+		bool affine = (m==0) == (gf.NumAffine() == fast.GetNumElements()); 
+		cached = cached && built && affine && MultDiff(Af, Sr, x) < 1e-10; 
+	}
+	TEST(cached, "geometric cache"); 
+
+	// cached coefficient values reproduce the per point coefficient 
+	FunctionCoefficient fc(Material); 
+	FunctionCoefficient fb(MaterialBatch); 
+	QuadratureFunction qf(h1, &fb); 
+	FEMatrix Aq(&h1); 
+	Aq.AddIntegrator(new WeakDiffusionIntegrator(&qf)); 
+	Aq.AddIntegrator(new MassIntegrator(&qf)); 
+	LHS Sc(&h1); 
+	Sc.AddIntegrator(new WeakDiffusionIntegrator(&fc)); 
+	Sc.AddIntegrator(new MassIntegrator(&fc)); 
+	RHS rc(&h1), rq(&h1); 
+	rc.AddIntegrator(new DomainIntegrator(&fc)); 
+	rq.AddIntegrator(new DomainIntegrator(&qf)); 
+	int rules = qf.GetSize(); 
+	rq.AddIntegrator(new DomainIntegrator(&qf)); 
+	rq *= .5; 
+	rq -= rc; 
+	TEST(rules > 0 && qf.GetSize() == rules && MultDiff(Aq, Sc, x) < 1e-10 
+		&& rq.L2Norm() < 1e-12, "quadrature function"); 
+
+	// compact storage builds element views on demand 
+	LagrangeSpace small(mesh, p); 
+	small.Compact(); 
+	small.EnableGeometricCache(); 
+	FEMatrix Ac(&small); 
+	Ac.AddIntegrator(new WeakDiffusionIntegrator(&fc)); 
+	Ac.AddIntegrator(new MassIntegrator(&fc)); 
+	RHS rcompact(&small); 
+	rcompact.AddIntegrator(new DomainIntegrator(&fc)); 
+	rcompact -= rc; 
+	Array<int> svdofs; 
+	small.GetVDofs(3, svdofs); 
+	bool same = small.IsCompact() && small.GetNumElements() == h1.GetNumElements() 
+		&& small.GetNBE() == h1.GetNBE() && svdofs == h1.GetVDofs(3); 
+	TEST(same && MultDiff(Ac, Sc, x) < 1e-10 && rcompact.L2Norm() < 1e-12, 
+		"compact space"); 
+
+	// building the compact storage directly numbers the space the same way 
+	LagrangeSpace direct(mesh, p, 1, true); 
+	FEMatrix Ad(&direct); 
+	Ad.AddIntegrator(new WeakDiffusionIntegrator(&fc)); 
+	Ad.AddIntegrator(new MassIntegrator(&fc)); 
+	TEST(direct.IsCompact() && direct.Hash() == small.Hash() && direct.GetNBE() == h1.GetNBE() 
+		&& MultDiff(Ad, Sc, x) < 1e-10, "direct compact space"); 
+
+	// owned elements come back by reference, compact ones through the caller's view 
+	ElementHandle view; 
+	bool owned = &h1.GetEl(3, view) == &h1.GetEl(3) && !view; 
+	TEST(owned && small.GetEl(3, view).GetID() == 3 && view && view->GetID() == 3,
+		"element access"); 
+
+	// a held view outlives its eviction from the view cache 
+	SquareMesh big(16, 16, {0,0}, {1,1}); 
+	LagrangeSpace hbig(big, p); 
+	hbig.Compact(); 
+	ElementHandle held = hbig.GetElView(3); 
+	Point c = held->Centroid(); 
+	for (int k=1; k<=FESPACE_VIEW_WAYS; k++) {
+		hbig.GetElView(3 + k*FESPACE_VIEW_SETS); 
+	}
+	Point c2 = held->Centroid(); 
+	TEST(held->GetID() == 3 && hbig.GetElView(3) != held && c[0] == c2[0] && c[1] == c2[1],
+		"held view"); 
+
+	// an evicted view nobody holds is moved onto the next element in place 
+	const Element* first = hbig.GetElView(5).get(); 
+	for (int k=1; k<=FESPACE_VIEW_WAYS; k++) {
+		hbig.GetElView(5 + k*FESPACE_VIEW_SETS); 
+	}
+	bool reused = hbig.GetElView(5 + FESPACE_VIEW_WAYS*FESPACE_VIEW_SETS).get() == first; 
+	LagrangeSpace hfull(big, p); 
+	hbig.EnableGeometricCache(); 
+	FEMatrix Abig(&hbig); 
+	Abig.AddIntegrator(new WeakDiffusionIntegrator(&fc)); 
+	Abig.AddIntegrator(new MassIntegrator(&fc)); 
+	LHS Sbig(&hfull); 
+	Sbig.AddIntegrator(new WeakDiffusionIntegrator(&fc)); 
+	Sbig.AddIntegrator(new MassIntegrator(&fc)); 
+	Vector xbig(hfull.GetVSize()); 
+	for (int i=0; i<xbig.GetSize(); i++) {
+		xbig[i] = sin(i); 
+	}
+	TEST(reused && MultDiff(Abig, Sbig, xbig) < 1e-10, "reused views"); 
+
+	// cached coefficient values are still found for a view evicted from the cache 
+	FunctionCoefficient fcount(MaterialCounted); 
+	QuadratureFunction qbig(hbig, &fcount); 
+	ElementHandle kept = hbig.GetElView(7); 
+	ShapeTable table(*kept, QRules.Get(QUAD, p+1, INTEGRATION_TYPE)); 
+	Array<double> v1(table.NumPoints()), v2(table.NumPoints()); 
+	qbig.Eval(kept->GetTrans(), table, v1.GetData()); 
+	int calls = material_calls; 
+	for (int k=1; k<=FESPACE_VIEW_WAYS; k++) {
+		hbig.GetElView(7 + k*FESPACE_VIEW_SETS); 
+	}
+	qbig.Eval(kept->GetTrans(), table, v2.GetData()); 
+	TEST(hbig.GetElView(7) != kept && material_calls == calls && v1 == v2, "evicted view cache hit"); 
+
+	// the second assembly of the same operator maps the batch saved by the first 
+	auto Integs = [](Coefficient* c) {
+		return Array<BilinearIntegrator*>({new WeakDiffusionIntegrator(c), new MassIntegrator(c)}); 
+	}; 
+	ConstantCoefficient one(1.); 
+	fc.SetKey("material"); 
+	FEMatrix Am1(&h1), Am2(&h1), Am3(&h1); 
+	LHS Sm1(&h1), Sm2(&h1); 
+	bool miss = !Am1.AddIntegrators(Integs(&fc), ".") && !Am1.IsMapped(); 
+	bool hit = Am2.AddIntegrators(Integs(&fc), ".") && Am2.IsMapped(); 
+	bool other = !Am3.AddIntegrators(Integs(&one), "."); 
+	bool lhs = !Sm1.AddIntegrators(Integs(&fc), ".") && Sm2.AddIntegrators(Integs(&fc), "."); 
+	double diff = MultDiff(Am2, Sc, x) + MultDiff(Am2, Sm2, x); 
+	remove(Am1.GetCacheName(".").c_str()); 
+	remove(Am3.GetCacheName(".").c_str()); 
+	remove(Sm1.GetCacheName(".").c_str()); 
+	// modifying a mapped batch copies it first 
+	Am2 -= Am1; 
+	Vector zero(x.GetSize()); 
+	Am2.Mult(x, zero); 
+	TEST(miss && hit && other && lhs && diff < 1e-10 && !Am2.IsMapped() 
+		&& zero.L2Norm() < 1e-12 && MultDiff(Am1, Sc, x) < 1e-10, "operator cache"); 
+
+	// a function without a key cannot be fingerprinted, so nothing is cached 
+	FEMatrix Au1(&h1), Au2(&h1); 
+	LHS Su(&h1); 
+	bool uncached = !Au1.AddIntegrators(Integs(&fb), ".") && !Au2.AddIntegrators(Integs(&fb), ".") 
+		&& !Su.AddIntegrators(Integs(&fb), ".") && !Au2.IsMapped() && !Au1.IsCacheable() 
+		&& !Su.IsCacheable() && !ifstream(Au1.GetCacheName(".")).good() 
+		&& MultDiff(Au2, Sc, x) < 1e-10; 
+	// neither is a matrix written through operator[] 
+	FEMatrix Aw(&h1); 
+	Aw.AddIntegrator(new MassIntegrator(&one)); 
+	bool keyed = Aw.IsCacheable(); 
+	Aw[0] += Matrix(Aw.GetElSize(0)); 
+	TEST(uncached && keyed && !Aw.IsCacheable(), "uncacheable operators"); 
+
+	// a file read in many small chunks reproduces the in memory matvec 
+	StreamingFEMatrix Ast(&h1, "fematrix_stream.bin", 4096); 
+	Ast.AddIntegrator(new WeakDiffusionIntegrator(&fc)); 
+	Ast.AddIntegrator(new MassIntegrator(&fc)); 
+	Vector stdiag, cdiag; 
+	Ast.GetDiagonal(stdiag); 
+	Am1.GetDiagonal(cdiag); 
+	stdiag -= cdiag; 
+	// the products accumulate into sb 
+	Vector sb(x.GetSize()), cb(x.GetSize()); 
+	Ast.Mult(x, sb); 
+	Ast.Mult(x, sb); 
+	sb *= .5; 
+	Am1.Mult(x, cb); 
+	sb -= cb; 
+	const StreamStats& stats = Ast.GetStats(); 
+	TEST(Ast.GetNumChunks() > 2 && Ast.IsPacked() && sb.L2Norm() < 1e-10 
+		&& stats.mults == 2 && stats.bytes == 2.*Ast.GetFileSize() && stdiag.L2Norm() < 1e-12, 
+		"streaming matvec"); 
+
+	// a non symmetric integrator rewrites the packed file with full matrices 
+	Ast.AddIntegrator(new ConvectionIntegrator(&vc)); 
+	Am1.AddIntegrator(new ConvectionIntegrator(&vc)); 
+	sb = 0.; 
+	cb = 0.; 
+	Ast.Mult(x, sb); 
+	Am1.Mult(x, cb); 
+	sb -= cb; 
+	TEST(!Ast.IsPacked() && Ast.GetNumChunks() > 2 && sb.L2Norm() < 1e-10, "streaming unpack"); 
+}
\ No newline at end of file
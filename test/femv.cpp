@@ -24,7 +24,6 @@ int main(int argc, char* argv[]) {
 	lhs.ApplyDirichletBoundary(b, 0.); 
 	RHS b2(b); 
 
-	lhs.ConvertToBatch(); 
 	HWCounter hwc; 
 	lhs.Mult(x, b);
 	hwc.Read(); 
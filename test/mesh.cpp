@@ -0,0 +1,208 @@
+#include "FEM.hpp"
+
+using namespace std; 
+using namespace fem; 
+
+// writes ascii or native binary values to a gmsh file 
+struct MshStream {
+	ofstream out; 
+	bool binary; 
+	MshStream(const string& name, bool b) : out(name, ios::binary), binary(b) { }
+	template<typename T>
+	void Put(T val) {
+		if (binary) out.write((const char*)&val, sizeof(T)); 
+		else out << setprecision(16) << val << " "; 
+	}
+	void Line(const string& s) {
+		if (binary) out << "\n"; 
+		out << s << "\n"; 
+	}
+	void End() {
+		if (!binary) out << "\n"; 
+	}
+}; 
+
+// write an N x N quad mesh of the unit square numbered like SquareMesh 
+// with dirichlet boundary lines and one point element 
+void WriteMsh(const string& name, int N, bool v4, bool binary) {
+	MshStream s(name, binary); 
+	auto flat = [N](int i, int j) {return j + (N+1)*i + 1; }; 
+	s.out << "$MeshFormat\n" << (v4 ? "4.1" : "2.2") << " " << binary << " 8\n"; 
+	if (binary) s.Put<int>(1); 
+	s.Line("$EndMeshFormat"); 
+	s.out << "$PhysicalNames\n1\n1 1 \"boundary\"\n$EndPhysicalNames\n"; 
+
+	// boundary edges counterclockwise 
+	vector<array<int,2>> lines; 
+	for (int j=0; j<N; j++) lines.push_back({flat(0,j), flat(0,j+1)}); 
+	for (int i=0; i<N; i++) lines.push_back({flat(i,N), flat(i+1,N)}); 
+	for (int j=N; j>0; j--) lines.push_back({flat(N,j), flat(N,j-1)}); 
+	for (int i=N; i>0; i--) lines.push_back({flat(i,0), flat(i-1,0)}); 
+	int Nn = (N+1)*(N+1); 
+	int Nl = lines.size(); 
+
+	if (v4) {
+		s.out << "$Entities\n"; 
+		for (int d=0; d<4; d++) s.Put<size_t>(d == 1 || d == 2); 
+		s.End(); 
+		// curve 1 is physical group 1 
+		s.Put<int>(1); 
+		for (int i=0; i<6; i++) s.Put<double>(0); 
+		s.Put<size_t>(1); s.Put<int>(1); s.Put<size_t>(0); 
+		s.End(); 
+		s.Put<int>(1); 
+		for (int i=0; i<6; i++) s.Put<double>(0); 
+		s.Put<size_t>(0); s.Put<size_t>(0); 
+		s.End(); 
+		s.Line("$EndEntities"); 
+
+		s.out << "$Nodes\n"; 
+		s.Put<size_t>(1); s.Put<size_t>(Nn); s.Put<size_t>(1); s.Put<size_t>(Nn); 
+		s.End(); 
+		s.Put<int>(2); s.Put<int>(1); s.Put<int>(0); s.Put<size_t>(Nn); 
+		s.End(); 
+		for (int n=0; n<Nn; n++) s.Put<size_t>(n+1); 
+		s.End(); 
+		for (int n=0; n<Nn; n++) {
+			s.Put<double>((double)(n%(N+1))/N); s.Put<double>((double)(n/(N+1))/N); s.Put<double>(0); 
+			s.End(); 
+		}
+		s.Line("$EndNodes"); 
+
+		s.out << "$Elements\n"; 
+		s.Put<size_t>(3); s.Put<size_t>(Nl + N*N + 1); s.Put<size_t>(1); s.Put<size_t>(Nl + N*N + 1); 
+		s.End(); 
+		s.Put<int>(0); s.Put<int>(1); s.Put<int>(15); s.Put<size_t>(1); 
+		s.Put<size_t>(1); s.Put<size_t>(1); 
+		s.End(); 
+		s.Put<int>(1); s.Put<int>(1); s.Put<int>(1); s.Put<size_t>(Nl); 
+		for (int l=0; l<Nl; l++) {
+			s.Put<size_t>(l+2); s.Put<size_t>(lines[l][0]); s.Put<size_t>(lines[l][1]); 
+		}
+		s.End(); 
+		s.Put<int>(2); s.Put<int>(1); s.Put<int>(3); s.Put<size_t>(N*N); 
+		for (int i=0; i<N; i++) {
+			for (int j=0; j<N; j++) {
+				s.Put<size_t>(Nl + 2 + j + N*i); 
+				s.Put<size_t>(flat(i,j)); s.Put<size_t>(flat(i,j+1)); 
+				s.Put<size_t>(flat(i+1,j+1)); s.Put<size_t>(flat(i+1,j)); 
+			}
+		}
+		s.Line("$EndElements"); 
+		return; 
+	}
+
+	s.out << "$Nodes\n" << Nn << "\n"; 
+	for (int n=0; n<Nn; n++) {
+		s.Put<int>(n+1); 
+		s.Put<double>((double)(n%(N+1))/N); s.Put<double>((double)(n/(N+1))/N); s.Put<double>(0); 
+		s.End(); 
+	}
+	s.Line("$EndNodes"); 
+
+	// binary elements are written in blocks of one type 
+	s.out << "$Elements\n" << Nl + N*N + 1 << "\n"; 
+	auto header = [&](int type, int n, int ntags) {
+		if (binary) {s.Put<int>(type); s.Put<int>(n); s.Put<int>(ntags); }
+	}; 
+	auto start = [&](int id, int type, int ntags) {
+		s.Put<int>(id); 
+		if (!binary) {s.Put<int>(type); s.Put<int>(ntags); }
+	}; 
+	header(15, 1, 2); 
+	start(1, 15, 2); s.Put<int>(0); s.Put<int>(1); s.Put<int>(1); s.End(); 
+	header(1, Nl, 2); 
+	for (int l=0; l<Nl; l++) {
+		start(l+2, 1, 2); s.Put<int>(1); s.Put<int>(1); 
+		s.Put<int>(lines[l][0]); s.Put<int>(lines[l][1]); s.End(); 
+	}
+	header(3, N*N, 2); 
+	for (int i=0; i<N; i++) {
+		for (int j=0; j<N; j++) {
+			start(Nl + 2 + j + N*i, 3, 2); s.Put<int>(0); s.Put<int>(1); 
+			s.Put<int>(flat(i,j)); s.Put<int>(flat(i,j+1)); 
+			s.Put<int>(flat(i+1,j+1)); s.Put<int>(flat(i+1,j)); s.End(); 
+		}
+	}
+	s.Line("$EndElements"); 
+}
+
+// true if mesh matches the square mesh sq 
+bool Same(const Mesh& mesh, const SquareMesh& sq) {
+	if (mesh.GetNumNodes() != sq.GetNumNodes() || mesh.GetNumElements() != sq.GetNumElements()
+		|| mesh.GetNumFaces() != sq.GetNumFaces() || mesh.GetDim() != 2) return false; 
+	for (int n=0; n<mesh.GetNumNodes(); n++) {
+		for (int d=0; d<DIM; d++) {
+			if (fabs(mesh.GetNode(n).x[d] - sq.GetNode(n).x[d]) > 1e-14) return false; 
+		}
+		if (mesh.GetNode(n).bc != sq.GetNode(n).bc) return false; 
+	}
+	for (int e=0; e<mesh.GetNumElements(); e++) {
+		const MeshEl& el = mesh.GetElement(e); 
+		const MeshEl& sel = sq.GetElement(e); 
+		if (el.GetType() != QUAD) return false; 
+		for (int i=0; i<el.GetNumNodes(); i++) {
+			if (el[i] != sel[i] || el.GetNeighbors()[i] != sel.GetNeighbors()[i]) return false; 
+		}
+	}
+	return true; 
+}
+
+int main(int argc, char* argv[]) {
+	int N = 5; 
+	if (argc > 1) N = atoi(argv[1]); 
+
+	SquareMesh sq(N, N, {0,0}, {1,1}); 
+	const char* names[2][2] = {{"ascii 2.2", "binary 2.2"}, {"ascii 4.1", "binary 4.1"}}; 
+	for (int v4=0; v4<2; v4++) {
+		for (int binary=0; binary<2; binary++) {
+			string name = "mesh_test.msh"; 
+			WriteMsh(name, N, v4, binary); 
+			Mesh mesh(name); 
+			remove(name.c_str()); 
+			TEST(Same(mesh, sq) && mesh.GetNumBoundaryElements() == 4*N, names[v4][binary]); 
+		}
+	}
+
+	// the second open reuses the snapshot written by the first 
+	string name = "mesh_test.msh"; 
+	WriteMsh(name, N, true, true); 
+	bool same = true; 
+	{
+		SpaceCache built(name, 2, 2, 1, "."); 
+		SpaceCache cached(name, 2, 2, 1, "."); 
+		LagrangeSpace& h1 = built.GetSpace(); 
+		LagrangeSpace& h2 = cached.GetSpace(); 
+		same = !built.FromSnapshot() && cached.FromSnapshot() 
+			&& h1.GetNumNodes() == h2.GetNumNodes() && h1.GetNBN() == h2.GetNBN() 
+			&& h1.GetNumElements() == h2.GetNumElements() && h1.GetNBE() == h2.GetNBE() 
+			&& cached.GetMesh().GetNumFaces() == built.GetMesh().GetNumFaces(); 
+		for (int e=0; same && e<h1.GetNumElements(); e++) {
+			Array<int> v1, v2; 
+			h1.GetVDofs(e, v1); 
+			h2.GetVDofs(e, v2); 
+			for (int i=0; i<v1.GetSize(); i++) {
+				same = same && v1[i] == v2[i]; 
+			}
+		}
+
+		FEMatrix A1(&h1), A2(&h2); 
+		A1.AddIntegrator(new VectorMassIntegrator); 
+		A2.AddIntegrator(new VectorMassIntegrator); 
+		Vector x(h1.GetVSize()), b1(h1.GetVSize()), b2(h1.GetVSize()); 
+		for (int i=0; i<x.GetSize(); i++) {
+			x[i] = sin(i); 
+		}
+		A1.Mult(x, b1); 
+		A2.Mult(x, b2); 
+		b2 -= b1; 
+		same = same && b2.L2Norm() < 1e-12; 
+		remove(cached.GetSnapshotName().c_str()); 
+	}
+	remove(name.c_str()); 
+	TEST(same, "space snapshot"); 
+
+	// files that cannot be opened are reported instead of mapped 
+	MappedFile missing("mesh_test_missing.msh"); 
+	TEST(!missing.Good(), "missing file"); 
+}
\ No newline at end of file
@@ -39,7 +39,6 @@ void solve(int nref, int order, double& LinfE) {
 	// apply the boundary conditions
 	lhs.ApplyDirichletBoundary(rhs, 0.);
 
-	lhs.ConvertToBatch(); 
 
 	// test symmetry 
 	// TEST(lhs.IsSymmetric(), "diffusion matrix symmetric"); 
@@ -34,6 +34,60 @@ bool GradShape(Element& el) {
 	return true; 
 }
 
+bool Table(Element& el) {
+	Quadrature* quad = QRules.Get(el.GetType(), el.GetOrder()+1); 
+	const ShapeTable& table = STables.Get(el, quad); 
+	if (&table != &STables.Get(el, quad)) return false; 
+	Vector shape, tshape; 
+	Matrix gshape, tgshape; 
+	for (int n=0; n<quad->NumPoints(); n++) {
+		el.CalcShape(quad->X(n), shape); 
+		el.CalcGradShape(quad->X(n), gshape); 
+		table.GetShape(n, tshape); 
+		table.GetGradShape(n, tgshape); 
+		for (int i=0; i<shape.GetSize(); i++) {
+			if (fabs(shape[i] - tshape[i]) > 1e-12) return false; 
+		}
+		for (int i=0; i<gshape.GetSize(); i++) {
+			if (fabs(gshape[i] - tgshape[i]) > 1e-12) return false; 
+		}
+	}
+	return true; 
+}
+
+bool HighOrder(Element& el) {
+	const LagrangeKernels* k = el.GetKernels(); 
+	if (!k || k->nn != el.GetNumNodes()) return false; 
+	Vector shape; 
+	Matrix gshape; 
+	for (int n=0; n<k->nn; n++) {
+		// kronecker property at the reference lattice 
+		Point xi; 
+		for (int d=0; d<k->dim; d++) xi[d] = -1. + 2.*k->lattice[n*k->dim+d]/k->order; 
+		el.CalcShape(xi, shape); 
+		for (int i=0; i<shape.GetSize(); i++) {
+			if (fabs(shape[i] - (i==n)) > 1e-9) return false; 
+		}
+		// nodes of an affine element are the image of the lattice 
+		for (int d=0; d<k->dim; d++) {
+			if (fabs(el.GetNode(n).GetX()[d] - .5*(xi[d]+1.)) > 1e-12) return false; 
+		}
+	}
+	// partition of unity and zero gradient sum 
+	Point xr = {.3, -.7, .1}; 
+	el.CalcShape(xr, shape); 
+	el.CalcGradShape(xr, gshape); 
+	double sum = 0.; 
+	for (int i=0; i<shape.GetSize(); i++) sum += shape[i]; 
+	if (fabs(sum - 1.) > 1e-9) return false; 
+	for (int d=0; d<k->dim; d++) {
+		double gsum = 0.; 
+		for (int i=0; i<shape.GetSize(); i++) gsum += gshape(d,i); 
+		if (fabs(gsum) > 1e-8) return false; 
+	}
+	return true; 
+}
+
 int main() {
 	MeshNode n0 = {0, {0,0}, fem::INTERIOR}; 
 	MeshNode n1 = {1, {2,0}, fem::INTERIOR}; 
@@ -43,4 +97,27 @@ int main() {
 
 	TEST(Shape(el), "calc shape"); 
 	TEST(GradShape(el), "grad shape"); 
+	TEST(Table(el), "shape table"); 
+
+	MeshNode h[8] = {{0, {0,0,0}, fem::INTERIOR}, {1, {1,0,0}, fem::INTERIOR}, 
+		{2, {1,1,0}, fem::INTERIOR}, {3, {0,1,0}, fem::INTERIOR}, 
+		{4, {0,0,1}, fem::INTERIOR}, {5, {1,0,1}, fem::INTERIOR}, 
+		{6, {1,1,1}, fem::INTERIOR}, {7, {0,1,1}, fem::INTERIOR}}; 
+	bool ho = true; 
+	for (int p=1; p<=LAGRANGE_MAX_ORDER; p++) {
+		LagrangeQuad q({h[0], h[1], h[2], h[3]}, p); 
+		LagrangeHex hex({h[0], h[1], h[2], h[3], h[4], h[5], h[6], h[7]}, p); 
+		ho = ho && HighOrder(q) && HighOrder(hex); 
+	}
+	TEST(ho, "high order basis"); 
+
+	// elements of the same type and order share one reference element 
+	LagrangeQuad other({n1, n2, n3, n0}, 2); 
+	int nref = RefElements.GetSize(); 
+	L2Quad d0({n0, n1, n2, n3}, 1); 
+	L2Quad d1({n1, n2, n3, n0}, 1); 
+	TEST(el.GetReference() == other.GetReference() && el.GetKernels() 
+		&& d0.GetReference() == d1.GetReference() 
+		&& &d0.GetFaceRefTransFromFace(2) == &d1.GetFaceRefTransFromFace(2) 
+		&& RefElements.GetSize() == nref + 2, "reference elements"); 
 }
\ No newline at end of file
@@ -0,0 +1,78 @@
+#include "FEM.hpp"
+
+using namespace std; 
+using namespace fem; 
+
+int main(int argc, char* argv[]) {
+	int N = 10; 
+	int p = 2; 
+	if (argc>1) N = atoi(argv[1]); 
+	if (argc>2) p = atoi(argv[2]); 
+	SquareMesh mesh(N, N, {0,0}, {1,1}); 
+	LagrangeSpace h1(mesh, p); 
+
+	LHS S(&h1); 
+	S.AddIntegrator(new WeakDiffusionIntegrator); 
+	S.AddIntegrator(new MassIntegrator); 
+	int nnz = S.GetNNZ(); 
+
+	FEMatrix A(&h1); 
+	A.AddIntegrator(new WeakDiffusionIntegrator); 
+	A.AddIntegrator(new MassIntegrator); 
+
+	RHS rs(&h1), ra(&h1); 
+	for (int i=0; i<rs.GetSize(); i++) {
+		rs[i] = ra[i] = (double)rand()/RAND_MAX; 
+	}
+	S.ApplyDirichletBoundary(rs, 2.); 
+	A.ApplyDirichletBoundary(ra, 2.); 
+
+	Vector diff(rs); 
+	diff -= ra; 
+	TEST(diff.L2Norm() < 1e-10, "eliminated rhs"); 
+
+	Vector x(h1.GetVSize()), bs(h1.GetVSize()), ba(h1.GetVSize()); 
+	for (int i=0; i<x.GetSize(); i++) {
+		x[i] = (double)rand()/RAND_MAX; 
+	}
+	S.Mult(x, bs); 
+	A.Mult(x, ba); 
+	bs -= ba; 
+	TEST(bs.L2Norm() < 1e-10, "eliminated matrix"); 
+
+	// entries are removed, never inserted 
+	int dirichlet = 0; 
+	for (int i=0; i<h1.GetNBN(); i++) {
+		if (h1.GetBoundaryNode(i).GetBC() == DIRICHLET) dirichlet++; 
+	}
+	TEST(S.GetNNZ() < nnz && S.GetNNZ() >= dirichlet, "non-zeros removed"); 
+	bool unit = true; 
+	for (int i=0; i<h1.GetNBN(); i++) {
+		int rc = h1.GetBoundaryNode(i).GetGlobalID(); 
+		if (S.At(rc,rc) != 1.) unit = false; 
+	}
+	TEST(unit, "unit diagonal"); 
+
+	// compact spaces keep the same boundary nodes in flat arrays 
+	LagrangeSpace direct(mesh, p, 1, true); 
+	bool nodes = direct.GetNumNodes() == h1.GetNumNodes() && direct.GetNBN() == h1.GetNBN(); 
+	for (int i=0; nodes && i<h1.GetNBN(); i++) {
+		int id = h1.GetBoundaryNode(i).GetGlobalID(); 
+		Point x = direct.GetNodeX(id); 
+		nodes = direct.GetBoundaryNodeID(i) == id && direct.GetNodeBC(id) == h1.GetNode(id).GetBC() 
+			&& x[0] == h1.GetNode(id).GetX()[0] && x[1] == h1.GetNode(id).GetX()[1]; 
+	}
+	LHS Sd(&direct); 
+	Sd.AddIntegrator(new WeakDiffusionIntegrator); 
+	Sd.AddIntegrator(new MassIntegrator); 
+	RHS rd(&direct); 
+	rd = 1.; 
+	rs = 1.; 
+	Sd.ApplyDirichletBoundary(rd, 2.); 
+	LHS Sh(&h1); 
+	Sh.AddIntegrator(new WeakDiffusionIntegrator); 
+	Sh.AddIntegrator(new MassIntegrator); 
+	Sh.ApplyDirichletBoundary(rs, 2.); 
+	rd -= rs; 
+	TEST(nodes && Sd.GetNNZ() == Sh.GetNNZ() && rd.L2Norm() < 1e-10, "compact boundary nodes"); 
+}
\ No newline at end of file
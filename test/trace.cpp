@@ -0,0 +1,83 @@
+#define CH_TRACE CH_TRACE_MEDIUM
+#include "FEM.hpp"
+#ifndef USE_RISCV
+#include <thread>
+#endif
+
+using namespace std; 
+using namespace fem; 
+
+// medium timer nested in a coarse one, with a fine one compiled out 
+double Work(int n) {
+	CH_TIMERS("work"); 
+	double s = 0; 
+	for (int i=0; i<n; i++) {
+		CH_TIMERS_FINE("fine"); 
+		s += sqrt(i + 1.); 
+	}
+	return s; 
+}
+
+double Outer(int calls) {
+	CH_TIMERS_COARSE("outer"); 
+	double s = 0; 
+	for (int i=0; i<calls; i++) {
+		s += Work(1000); 
+	}
+	return s; 
+}
+
+// profile entry for name (calls = -1 if missing) 
+TraceStat Find(const vector<TraceStat>& flat, const string& name) {
+	for (int i=0; i<flat.size(); i++) {
+		if (flat[i].name == name) return flat[i]; 
+	}
+	TraceStat none; 
+	none.calls = -1; 
+	return none; 
+}
+
+int main() {
+	// each thread records into its own buffer 
+	int nthreads = 0; 
+#ifndef USE_RISCV
+	nthreads = 4; 
+	vector<thread> threads; 
+	vector<double> sums(nthreads); 
+	for (int t=0; t<nthreads; t++) {
+		threads.push_back(thread([t, &sums]() {sums[t] = Outer(10); })); 
+	}
+	for (int t=0; t<nthreads; t++) {
+		threads[t].join(); 
+	}
+#endif
+	Outer(5); 
+
+	vector<TraceStat> flat = TraceFlatProfile(); 
+	TraceStat outer = Find(flat, "outer"); 
+	TraceStat work = Find(flat, "work"); 
+	TEST(outer.calls == nthreads + 1 && work.calls == 10*nthreads + 5 
+		&& Find(flat, "fine").calls == -1 && TraceLost() == 0, "trace counts"); 
+	TEST(work.self > 0 && work.total >= work.self && outer.total >= work.total 
+		&& fabs(outer.self + work.total - outer.total) < 1e-9*outer.total, "trace self time"); 
+
+	// one complete event per scope plus a name per thread 
+	TraceWriteChrome("trace_test.json"); 
+	ifstream in("trace_test.json"); 
+	stringstream ss; 
+	ss << in.rdbuf(); 
+	string json = ss.str(); 
+	remove("trace_test.json"); 
+	long complete = 0, names = 0; 
+	for (size_t p=json.find("\"ph\":\"X\""); p!=string::npos; p=json.find("\"ph\":\"X\"", p+1)) complete++; 
+	for (size_t p=json.find("thread_name"); p!=string::npos; p=json.find("thread_name", p+1)) names++; 
+	TEST(json.find("{\"traceEvents\":[") == 0 && complete == outer.calls + work.calls 
+		&& names == nthreads + 1, "chrome trace"); 
+
+	// the ring keeps the newest events and drops stops whose start was overwritten 
+	TraceReset(); 
+	Outer(CH_TRACE_EVENTS/2 + 10); 
+	flat = TraceFlatProfile(); 
+	TEST(TraceLost() == 22 && Find(flat, "work").calls == CH_TRACE_EVENTS/2 - 1 
+		&& Find(flat, "outer").calls == -1, "trace ring wrap"); 
+}
\ No newline at end of file
@@ -0,0 +1,188 @@
+#include "FEM.hpp"
+
+using namespace std; 
+using namespace fem; 
+
+// linear field that is easy to check from the written points 
+double Linear(const Point& x) {
+	return x[0] + 2.*x[1]; 
+}
+
+// read a whole file 
+string Slurp(const string& name) {
+	ifstream in(name, ios::binary); 
+	stringstream ss; 
+	ss << in.rdbuf(); 
+	return ss.str(); 
+}
+
+// integer attribute attr of the first tag containing key 
+long Attribute(const string& xml, const string& key, const string& attr) {
+	size_t pos = xml.find(key); 
+	if (pos == string::npos) return -1; 
+	pos = xml.find(attr + "=\"", pos); 
+	return atol(xml.c_str() + pos + attr.size() + 2); 
+}
+
+// decode the appended array at offset 
+vector<char> Decode(const string& file, long offset, bool compressed) {
+	const char* p = file.data() + file.find("encoding=\"raw\">") + 17 + offset; 
+	vector<char> out; 
+	if (!compressed) {
+		uint64_t n; 
+		memcpy(&n, p, 8); 
+		out.assign(p + 8, p + 8 + n); 
+		return out; 
+	}
+	uint64_t nblocks, block, last; 
+	memcpy(&nblocks, p, 8); 
+	memcpy(&block, p + 8, 8); 
+	memcpy(&last, p + 16, 8); 
+	const char* data = p + 8*(3 + nblocks); 
+	for (uint64_t b=0; b<nblocks; b++) {
+		uint64_t csize; 
+		memcpy(&csize, p + 8*(3 + b), 8); 
+		size_t n = (b+1 == nblocks && last) ? last : block; 
+		size_t pos = out.size(); 
+		out.resize(pos + n); 
+		if (LZ4Decompress(data, csize, &out[pos], n) != n) out.clear(); 
+		data += csize; 
+	}
+	return out; 
+}
+
+// true if the field written to piece matches Linear + shift at the written points 
+// and the piece has ncells cells 
+bool CheckPiece(const string& name, bool compressed, long& ncells, double shift=0) {
+	string file = Slurp(name); 
+	remove(name.c_str()); 
+	long np = Attribute(file, "<Piece", "NumberOfPoints"); 
+	ncells = Attribute(file, "<Piece", "NumberOfCells"); 
+	bool ok = (file.find("vtkLZ4DataCompressor") != string::npos) == compressed; 
+	vector<char> u = Decode(file, Attribute(file, "Name=\"u\"", "offset"), compressed); 
+	vector<char> x = Decode(file, Attribute(file, "<Points>", "offset"), compressed); 
+	vector<char> types = Decode(file, Attribute(file, "Name=\"types\"", "offset"), compressed); 
+	ok = ok && np > 0 && u.size() == 8*np && x.size() == 24*np && types.size() == ncells; 
+	for (long i=0; ok && i<np; i++) {
+		double ui, xi[3]; 
+		memcpy(&ui, &u[8*i], 8); 
+		memcpy(xi, &x[24*i], 24); 
+		ok = fabs(ui - xi[0] - 2.*xi[1] - shift) < 1e-12; 
+	}
+	return ok; 
+}
+
+int main(int argc, char* argv[]) {
+	int N = 8; 
+	int p = 2; 
+	if (argc>1) N = atoi(argv[1]); 
+	if (argc>2) p = atoi(argv[2]); 
+
+	// smooth, repetitive, and short inputs survive compression 
+	vector<double> smooth(5000); 
+	for (int i=0; i<smooth.size(); i++) {
+		smooth[i] = (i%100)*.25; 
+	}
+	bool round = true; 
+	vector<char> packed(LZ4Bound(8*smooth.size())); 
+	size_t n = LZ4Compress((const char*)smooth.data(), 8*smooth.size(), packed.data()); 
+	vector<double> back(smooth.size()); 
+	round = n < 8*smooth.size()/4
+		&& LZ4Decompress(packed.data(), n, (char*)back.data(), 8*back.size()) == 8*back.size()
+		&& back == smooth; 
+	for (int len=0; len<40; len++) {
+		string s; 
+		for (int i=0; i<len; i++) s += "abcab"[(i*i)%5]; 
+		vector<char> c(LZ4Bound(len)), d(len + 1); 
+		size_t m = LZ4Compress(s.data(), len, c.data()); 
+		round = round && LZ4Decompress(c.data(), m, d.data(), len) == len
+			&& string(d.data(), len) == s; 
+	}
+	TEST(round, "lz4 round trip"); 
+
+	SquareMesh mesh(N, N, {0,0}, {1,1}); 
+	LagrangeSpace h1(mesh, p); 
+	GridFunction u(&h1); 
+	u.Project(Linear); 
+	Writer writer("writer_test"); 
+	writer.Add(u, "u"); 
+
+	// one file, raw then compressed 
+	long cells, ccells; 
+	writer.WriteVTU(); 
+	bool raw = CheckPiece("writer_test0.vtu", false, cells); 
+	writer.SetCompression(true); 
+	writer.WriteVTU(); 
+	bool compressed = CheckPiece("writer_test1.vtu", true, ccells); 
+	TEST(raw && cells == N*N*p*p, "vtu appended"); 
+	TEST(compressed && ccells == cells, "vtu compressed"); 
+
+	// pieces split the cells and are listed in the index 
+	writer.SetPieces(3); 
+	writer.WriteVTU(); 
+	string index = Slurp("writer_test2.pvtu"); 
+	remove("writer_test2.pvtu"); 
+	bool pieces = index.find("writer_test2_2.vtu") != string::npos; 
+	long total = 0; 
+	for (int i=0; i<3; i++) {
+		long pc; 
+		pieces = CheckPiece("writer_test2_" + to_string(i) + ".vtu", true, pc) && pieces; 
+		total += pc; 
+	}
+	TEST(pieces && total == cells, "pvtu pieces"); 
+
+	// each file holds the values at the time of its write even though the 
+	// variable changes before the background thread gets to it 
+	writer.SetPieces(1); 
+	writer.SetCompression(false); 
+	writer.SetAsync(2); 
+	for (int k=0; k<6; k++) {
+		writer.WriteVTU(); 
+		for (int i=0; i<u.GetSize(); i++) {
+			u[i] += 1.; 
+		}
+	}
+	writer.Flush(); 
+	writer.SetAsync(0); 
+	bool async = true; 
+	for (int k=0; k<6; k++) {
+		long ac; 
+		async = CheckPiece("writer_test" + to_string(3+k) + ".vtu", false, ac, k) 
+			&& ac == cells && async; 
+	}
+	TEST(async, "async output"); 
+
+	// checkpoint the variable and some solver state, scramble them, and restart 
+	Vector krylov(50); 
+	for (int i=0; i<krylov.GetSize(); i++) krylov[i] = 1./(i+1); 
+	Checkpoint ckp("writer_test.ckp"); 
+	ckp.Add(u, "u"); 
+	ckp.Add(krylov, "krylov"); 
+	ckp.Write({7, 3, 1.25, .125}); 
+	GridFunction u0(u); 
+	Vector k0(krylov); 
+	u = 0.; 
+	krylov = -1.; 
+	CheckpointState state; 
+	bool restart = ckp.Read(state) && state.step == 7 && state.iter == 3 
+		&& state.time == 1.25 && state.dt == .125 && ckp.GetBytes() % CHECKPOINT_ALIGN == 0; 
+	for (int i=0; i<u.GetSize(); i++) restart = restart && u[i] == u0[i]; 
+	for (int i=0; i<krylov.GetSize(); i++) restart = restart && krylov[i] == k0[i]; 
+	TEST(restart, "checkpoint restart"); 
+
+	// a flipped bit, a different space, or no file leave the variables alone 
+	string file = Slurp("writer_test.ckp"); 
+	file[file.size()/2] ^= 4; 
+	ofstream("writer_test.ckp", ios::binary).write(file.data(), file.size()); 
+	u = 0.; 
+	bool reject = !ckp.Read(state) && u[0] == 0.; 
+	LagrangeSpace h1b(mesh, 1); 
+	GridFunction v(&h1b); 
+	Checkpoint other("writer_test.ckp"); 
+	other.Add(v, "u"); 
+	other.Add(krylov, "krylov"); 
+	reject = reject && !other.Read(state); 
+	remove("writer_test.ckp"); 
+	reject = reject && !ckp.Read(state) && u[0] == 0.; 
+	TEST(reject, "checkpoint validation"); 
+}
\ No newline at end of file
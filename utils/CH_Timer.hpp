@@ -21,6 +21,7 @@
 #endif
 
 #include "HWCounter.hpp"
+#include "CH_Trace.hpp"
 
 
   /** TraceTimer class is a self-tracing code instrumentation system
@@ -331,12 +332,39 @@ inline void TraceTimer::leafStop()
   m_hwc.Reset(); 
 }
 
-#ifdef CH_NTIMER
+// timer levels: CH_TIMERS_COARSE for setup, solves, and I/O, CH_TIMERS (and CH_TIME) 
+// for operator and batch kernels, CH_TIMERS_FINE for per element and small vector 
+// work. With the timer tree every level is timed. Defining CH_TRACE as one of 
+// CH_TRACE_COARSE, CH_TRACE_MEDIUM, or CH_TRACE_FINE replaces the tree (even with 
+// CH_NTIMER) by per-thread event buffers (see CH_Trace.hpp) and compiles out the 
+// timers finer than the level. CH_TIMER_REPORT then writes trace.json and profile.table 
+
+#ifdef CH_TRACE
+
+#define CH_TRACE_SCOPE(level, name) \
+  fem::TraceScope<(level) <= (CH_TRACE)> CH_TraceScope(name)
+
+#define CH_TIMER(name, tpointer)   (void)0
+#define CH_TIME(name)    CH_TRACE_SCOPE(CH_TRACE_MEDIUM, name)
+#define CH_TIMELEAF(name)  CH_TRACE_SCOPE(CH_TRACE_FINE, name)
+#define CH_TIMERS(name)    CH_TRACE_SCOPE(CH_TRACE_MEDIUM, name)
+#define CH_TIMERS_COARSE(name)    CH_TRACE_SCOPE(CH_TRACE_COARSE, name)
+#define CH_TIMERS_FINE(name)    CH_TRACE_SCOPE(CH_TRACE_FINE, name)
+#define CH_START(tpointer)  (void)0
+#define CH_STOP(tpointer)  (void)0
+#define CH_STOPV(tpointer, val) (void)0
+#define CH_TIMER_REPORT()  fem::TraceReport()
+#define CH_TIMER_RESET()   fem::TraceReset()
+#define CH_TIMER_PRUNE(threshold)  (void)0
+
+#elif defined(CH_NTIMER)
 
 #define CH_TIMER(name, tpointer)   (void)0
 #define CH_TIME(name)    (void)0
 #define CH_TIMELEAF(name)  (void)0
 #define CH_TIMERS(name)    (void)0
+#define CH_TIMERS_COARSE(name)    (void)0
+#define CH_TIMERS_FINE(name)    (void)0
 #define CH_START(tpointer)  (void)0
 #define CH_STOP(tpointer)  (void)0
 #define CH_STOPV(tpointer, val) (void)0
@@ -369,6 +397,9 @@ inline void TraceTimer::leafStop()
   TraceTimer* ch_tpointer = TraceTimer::getTimer(TimerTagA); \
   AutoStart autostart(ch_tpointer, &CH_TimermutexA, &CH_Timermutex)
 
+#define CH_TIMERS_COARSE(name) CH_TIMERS(name)
+#define CH_TIMERS_FINE(name) CH_TIMERS(name)
+
 
 #define CH_START(tpointer) tpointer->start(&CH_Timermutex)
 
@@ -381,7 +412,7 @@ inline void TraceTimer::leafStop()
 
 #define CH_TIMER_PRUNE(threshold) TraceTimer::PruneTimersParentChildPercent(threshold)
 
-#endif  // CH_NTIMER
+#endif  // CH_TRACE, CH_NTIMER
 
 
 
@@ -0,0 +1,175 @@
+#include "CH_Trace.hpp"
+#include "General.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <algorithm>
+#include <fstream>
+#ifndef USE_RISCV
+#include <mutex>
+#endif
+
+using namespace std; 
+
+namespace fem 
+{
+
+/// every thread's buffer 
+static vector<TraceBuffer*> trace_buffers; 
+#ifndef USE_RISCV
+/// guards trace_buffers 
+static mutex trace_lock; 
+#endif
+/// time stamp and clock time of the first event, to convert ticks to seconds 
+static uint64_t trace_ticks0; 
+/// clock time of the first event 
+static chrono::steady_clock::time_point trace_time0; 
+
+TraceBuffer* TraceBuffer::Create() {
+#ifndef USE_RISCV
+	lock_guard<mutex> lock(trace_lock); 
+#endif
+	if (trace_buffers.empty()) {
+		trace_ticks0 = TraceTicks(); 
+		trace_time0 = chrono::steady_clock::now(); 
+		// report at exit when asked to, as the timer tree does 
+		if (getenv("CH_TIMER")) atexit(TraceReport); 
+	}
+	trace_buffer = new TraceBuffer(trace_buffers.size()); 
+	trace_buffers.push_back(trace_buffer); 
+	return trace_buffer; 
+}
+
+/// return the number of ticks per second measured since the first event 
+static double TicksPerSecond() {
+	double sec = chrono::duration<double>(chrono::steady_clock::now() - trace_time0).count(); 
+	uint64_t ticks = TraceTicks() - trace_ticks0; 
+	return (sec > 0 && ticks > 0) ? ticks/sec : 1e9; 
+}
+
+/// call f(name, thread, start, stop, nested) for every completed scope 
+/** nested is the ticks spent in scopes directly inside this one. Stops whose start was 
+	overwritten and starts that have not stopped are skipped */ 
+template<typename F> 
+static void ForEachScope(F f) {
+	struct Open {
+		const char* name; 
+		uint64_t start; 
+		uint64_t nested; 
+	}; 
+	for (int b=0; b<trace_buffers.size(); b++) {
+		const TraceBuffer& buf = *trace_buffers[b]; 
+		uint64_t n = buf.count.load(memory_order_acquire); 
+		uint64_t first = (n > CH_TRACE_EVENTS) ? n - CH_TRACE_EVENTS : 0; 
+		vector<Open> stack; 
+		for (uint64_t i=first; i<n; i++) {
+			const TraceEvent& e = buf.events[i & (CH_TRACE_EVENTS - 1)]; 
+			if (e.begin) {
+				stack.push_back({e.name, e.ticks, 0}); 
+				continue; 
+			}
+			if (stack.empty() || stack.back().name != e.name) continue; 
+			Open o = stack.back(); 
+			stack.pop_back(); 
+			uint64_t dur = e.ticks - o.start; 
+			if (!stack.empty()) stack.back().nested += dur; 
+			f(o.name, buf.tid, o.start, e.ticks, o.nested); 
+		}
+	}
+}
+
+/// write s as a JSON string 
+static void WriteJSONString(FILE* out, const char* s) {
+	fputc('"', out); 
+	for (; *s; s++) {
+		if (*s == '"' || *s == '\\') fputc('\\', out); 
+		if ((unsigned char)*s < 0x20) fprintf(out, "\\u%04x", *s); 
+		else fputc(*s, out); 
+	}
+	fputc('"', out); 
+}
+
+void TraceWriteChrome(const string& name) {
+	FILE* out = fopen(name.c_str(), "w"); 
+	if (!out) ERROR("could not open " << name); 
+	double us = TicksPerSecond()/1e6; 
+	fprintf(out, "{\"traceEvents\":[\n"); 
+	bool first = true; 
+	for (int b=0; b<trace_buffers.size(); b++) {
+		fprintf(out, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d," 
+			"\"args\":{\"name\":\"thread %d\"}}", (first) ? "" : ",\n", b, b); 
+		first = false; 
+	}
+	ForEachScope([&](const char* label, int tid, uint64_t start, uint64_t stop, uint64_t) {
+		fprintf(out, "%s{\"name\":", (first) ? "" : ",\n"); 
+		WriteJSONString(out, label); 
+		fprintf(out, ",\"cat\":\"fem\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%d}", 
+			(start - trace_ticks0)/us, (stop - start)/us, tid); 
+		first = false; 
+	}); 
+	fprintf(out, "\n],\"displayTimeUnit\":\"ns\"}\n"); 
+	bool ok = ferror(out) == 0; 
+	if (fclose(out) != 0 || !ok) ERROR("could not write " << name); 
+}
+
+vector<TraceStat> TraceFlatProfile() {
+	double tps = TicksPerSecond(); 
+	map<string, TraceStat> stats; 
+	ForEachScope([&](const char* label, int, uint64_t start, uint64_t stop, uint64_t nested) {
+		TraceStat& s = stats[label]; 
+		s.name = label; 
+		s.calls++; 
+		s.total += (stop - start)/tps; 
+		s.self += (stop - start - nested)/tps; 
+	}); 
+	vector<TraceStat> flat; 
+	for (auto& s : stats) {
+		flat.push_back(s.second); 
+	}
+	sort(flat.begin(), flat.end(), [](const TraceStat& a, const TraceStat& b) {
+		return a.self > b.self; 
+	}); 
+	return flat; 
+}
+
+void TraceProfile(ostream& out) {
+	vector<TraceStat> flat = TraceFlatProfile(); 
+	double sum = 0; 
+	for (int i=0; i<flat.size(); i++) {
+		sum += flat[i].self; 
+	}
+	char line[256]; 
+	out << "flat profile: " << trace_buffers.size() << " threads, " 
+		<< TraceLost() << " events overwritten" << endl; 
+	snprintf(line, sizeof(line), "%8s %12s %12s %12s  %s", "self %", "self (s)", "total (s)", 
+		"calls", "name"); 
+	out << line << endl; 
+	for (int i=0; i<flat.size(); i++) {
+		snprintf(line, sizeof(line), "%8.2f %12.6f %12.6f %12ld  ", 
+			(sum > 0) ? 100*flat[i].self/sum : 0., flat[i].self, flat[i].total, flat[i].calls); 
+		out << line << flat[i].name << endl; 
+	}
+}
+
+uint64_t TraceLost() {
+	uint64_t lost = 0; 
+	for (int b=0; b<trace_buffers.size(); b++) {
+		uint64_t n = trace_buffers[b]->count.load(memory_order_acquire); 
+		if (n > CH_TRACE_EVENTS) lost += n - CH_TRACE_EVENTS; 
+	}
+	return lost; 
+}
+
+void TraceReport() {
+	TraceWriteChrome("trace.json"); 
+	ofstream out("profile.table"); 
+	TraceProfile(out); 
+}
+
+void TraceReset() {
+	for (int b=0; b<trace_buffers.size(); b++) {
+		trace_buffers[b]->count.store(0, memory_order_release); 
+	}
+}
+
+} // end namespace fem 
\ No newline at end of file
@@ -0,0 +1,128 @@
+#pragma once 
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <iostream>
+#include "ClockTicks.hpp"
+
+/// CH_TRACE level that keeps only CH_TIMERS_COARSE timers 
+#define CH_TRACE_COARSE 1
+/// CH_TRACE level that adds CH_TIMERS and CH_TIME timers 
+#define CH_TRACE_MEDIUM 2
+/// CH_TRACE level that adds CH_TIMERS_FINE timers 
+#define CH_TRACE_FINE 3
+/// events in each thread's ring buffer (a power of 2). Older events are overwritten 
+#define CH_TRACE_EVENTS (1 << 16)
+
+namespace fem 
+{
+
+/// the start or stop of a traced scope 
+struct TraceEvent {
+	/// timer label (a string literal) 
+	const char* name; 
+	/// time stamp 
+	uint64_t ticks; 
+	/// true for a start, false for a stop 
+	bool begin; 
+}; 
+
+/// ring buffer of one thread's events 
+/** only the owning thread writes. Each event is published by storing the count with
+	release order so an exporter that loads the count with acquire sees whole events.
+	Buffers are never freed so events outlive their threads */ 
+struct TraceBuffer {
+	/// constructor 
+	TraceBuffer(int t) : count(0), tid(t) { }
+	/// number of events ever recorded 
+	std::atomic<uint64_t> count; 
+	/// thread number in order of first event 
+	int tid; 
+	/// the last CH_TRACE_EVENTS events 
+	TraceEvent events[CH_TRACE_EVENTS]; 
+	/// create and register the calling thread's buffer 
+	static TraceBuffer* Create(); 
+}; 
+
+/// the calling thread's buffer (NULL before its first event) 
+#ifdef USE_RISCV
+inline TraceBuffer* trace_buffer = NULL; 
+#else
+inline thread_local TraceBuffer* trace_buffer = NULL; 
+#endif
+
+/// return the current time stamp 
+inline uint64_t TraceTicks() {
+#if defined(CH_TICKS) || defined(__riscv)
+	return ch_ticks(); 
+#else
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count(); 
+#endif
+}
+
+/// append an event to the calling thread's buffer 
+inline void TraceRecord(const char* name, bool begin) {
+	TraceBuffer* b = trace_buffer; 
+	if (!b) b = TraceBuffer::Create(); 
+	uint64_t n = b->count.load(std::memory_order_relaxed); 
+	TraceEvent& e = b->events[n & (CH_TRACE_EVENTS - 1)]; 
+	e.name = name; 
+	e.ticks = TraceTicks(); 
+	e.begin = begin; 
+	b->count.store(n + 1, std::memory_order_release); 
+}
+
+/// records a start on construction and a stop on destruction 
+template<bool enabled>
+class TraceScope {
+public:
+	/// start 
+	TraceScope(const char* name) : _name(name) {TraceRecord(name, true); }
+	/// stop 
+	~TraceScope() {TraceRecord(_name, false); }
+private:
+	/// timer label 
+	const char* _name; 
+}; 
+
+/// a timer above the compiled trace level: compiles to nothing 
+template<>
+class TraceScope<false> {
+public:
+	/// do nothing 
+	TraceScope(const char*) { }
+}; 
+
+/// time spent in one timer summed over all threads 
+struct TraceStat {
+	/// timer label 
+	std::string name; 
+	/// number of completed scopes 
+	long calls = 0; 
+	/// seconds inside the timer excluding nested timers 
+	double self = 0; 
+	/// seconds inside the timer including nested timers 
+	double total = 0; 
+}; 
+
+// the functions below read every thread's events. Call them while no other 
+// thread is recording (e.g. after joining workers) 
+
+/// write the completed scopes as Chrome trace JSON (chrome://tracing or Perfetto) 
+void TraceWriteChrome(const std::string& name="trace.json"); 
+/// return the flat profile sorted by decreasing self time 
+std::vector<TraceStat> TraceFlatProfile(); 
+/// print the flat profile 
+void TraceProfile(std::ostream& out=std::cout); 
+/// return the number of events overwritten before they were read 
+uint64_t TraceLost(); 
+/// write trace.json and the flat profile to profile.table 
+void TraceReport(); 
+/// drop all recorded events 
+void TraceReset(); 
+
+} // end namespace fem 
\ No newline at end of file
@@ -0,0 +1,116 @@
+#include "Compression.hpp"
+#include <cstring>
+#include <cstdint>
+
+using namespace std; 
+
+namespace fem 
+{
+
+/// bits in the match finder's hash table 
+#define LZ4_HASH_BITS 12
+/// shortest match the format allows 
+#define LZ4_MIN_MATCH 4
+/// the last match must start this many bytes before the end 
+#define LZ4_MF_LIMIT 12
+/// the block always ends with at least this many literals 
+#define LZ4_LAST_LITERALS 5
+/// farthest back a match can point 
+#define LZ4_MAX_OFFSET 65535
+
+/// load 4 unaligned bytes 
+static inline uint32_t Read32(const char* p) {
+	uint32_t v; 
+	memcpy(&v, p, 4); 
+	return v; 
+}
+
+/// write a length that did not fit in its 4 bit token field 
+static inline char* WriteLength(char* op, size_t len) {
+	for (; len >= 255; len -= 255) *op++ = (char)255; 
+	*op++ = (char)len; 
+	return op; 
+}
+
+/// emit one sequence: literals [lit, lit+nlit) followed by a match (none if mlen = 0) 
+static inline char* WriteSequence(char* op, const char* lit, size_t nlit,
+	size_t offset, size_t mlen) {
+	char* token = op++; 
+	*token = (char)((nlit >= 15 ? 15 : nlit) << 4); 
+	if (nlit >= 15) op = WriteLength(op, nlit - 15); 
+	memcpy(op, lit, nlit); 
+	op += nlit; 
+	if (mlen == 0) return op; 
+	*op++ = (char)(offset & 0xff); 
+	*op++ = (char)(offset >> 8); 
+	size_t ml = mlen - LZ4_MIN_MATCH; 
+	*token |= (char)(ml >= 15 ? 15 : ml); 
+	if (ml >= 15) op = WriteLength(op, ml - 15); 
+	return op; 
+}
+
+size_t LZ4Compress(const char* src, size_t n, char* dst) {
+	char* op = dst; 
+	size_t anchor = 0; 
+	if (n > LZ4_MF_LIMIT) {
+		// positions are stored +1 so zero means empty 
+		uint32_t table[1 << LZ4_HASH_BITS]; 
+		memset(table, 0, sizeof(table)); 
+		size_t limit = n - LZ4_MF_LIMIT; 
+		size_t match_limit = n - LZ4_LAST_LITERALS; 
+		size_t i = 0; 
+		while (i < limit) {
+			uint32_t seq = Read32(src + i); 
+			uint32_t h = (seq * 2654435761u) >> (32 - LZ4_HASH_BITS); 
+			size_t ref = table[h]; 
+			table[h] = i + 1; 
+			if (ref == 0 || i + 1 - ref > LZ4_MAX_OFFSET || Read32(src + ref - 1) != seq) {
+				i++; 
+				continue; 
+			}
+			ref--; 
+			size_t len = LZ4_MIN_MATCH; 
+			while (i + len < match_limit && src[ref + len] == src[i + len]) len++; 
+			op = WriteSequence(op, src + anchor, i - anchor, i - ref, len); 
+			i += len; 
+			anchor = i; 
+		}
+	}
+	op = WriteSequence(op, src + anchor, n - anchor, 0, 0); 
+	return op - dst; 
+}
+
+size_t LZ4Decompress(const char* src, size_t n, char* dst, size_t capacity) {
+	const unsigned char* ip = (const unsigned char*)src; 
+	const unsigned char* end = ip + n; 
+	size_t out = 0; 
+	auto Length = [&](size_t len) {
+		if (len != 15) return len; 
+		unsigned char b; 
+		do {
+			if (ip >= end) ERROR("truncated lz4 block"); 
+			b = *ip++; 
+			len += b; 
+		} while (b == 255); 
+		return len; 
+	}; 
+	while (ip < end) {
+		unsigned char token = *ip++; 
+		size_t nlit = Length(token >> 4); 
+		if ((size_t)(end - ip) < nlit || capacity - out < nlit) ERROR("corrupt lz4 block"); 
+		memcpy(dst + out, ip, nlit); 
+		ip += nlit; 
+		out += nlit; 
+		if (ip == end) break; 
+		if (end - ip < 2) ERROR("truncated lz4 block"); 
+		size_t offset = ip[0] | (ip[1] << 8); 
+		ip += 2; 
+		size_t mlen = Length(token & 15) + LZ4_MIN_MATCH; 
+		if (offset == 0 || offset > out || capacity - out < mlen) ERROR("corrupt lz4 block"); 
+		// byte by byte since the match may overlap the bytes it produces 
+		for (size_t k=0; k<mlen; k++, out++) dst[out] = dst[out - offset]; 
+	}
+	return out; 
+}
+
+} // end namespace fem 
\ No newline at end of file
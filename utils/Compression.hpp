@@ -0,0 +1,29 @@
+#pragma once 
+
+#include <cstddef>
+#include "General.hpp"
+
+namespace fem 
+{
+
+/// largest compressed size of n bytes 
+inline size_t LZ4Bound(size_t n) {return n + n/255 + 16; }
+
+/// compress n bytes of src into dst in the LZ4 block format 
+/** a greedy single pass encoder with a small hash table: fast rather than tight.
+	The output is a plain LZ4 block (no frame) as used by vtkLZ4DataCompressor
+	\param[in] src data
+	\param[in] n number of bytes in src
+	\param[out] dst at least LZ4Bound(n) bytes
+	\returns the number of bytes written to dst */ 
+size_t LZ4Compress(const char* src, size_t n, char* dst); 
+
+/// decompress an LZ4 block 
+/** \param[in] src compressed block
+	\param[in] n number of bytes in src
+	\param[out] dst decompressed data
+	\param[in] capacity size of dst
+	\returns the number of bytes written to dst (errors on corrupt input) */ 
+size_t LZ4Decompress(const char* src, size_t n, char* dst, size_t capacity); 
+
+} // end namespace fem 
\ No newline at end of file
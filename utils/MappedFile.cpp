@@ -0,0 +1,60 @@
+#include "MappedFile.hpp"
+#include <cstdio>
+#include <cstdlib>
+#ifndef USE_RISCV 
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace std; 
+
+namespace fem 
+{
+
+MappedFile::MappedFile(const string& name) 
+	: _data(NULL), _size(0), _mapped(false), _good(false) {
+#ifndef USE_RISCV 
+	int fd = open(name.c_str(), O_RDONLY); 
+	if (fd < 0) return; 
+	struct stat st; 
+	if (fstat(fd, &st) == 0) {
+		_size = st.st_size; 
+		_good = true; 
+		if (_size > 0) {
+			void* map = mmap(NULL, _size, PROT_READ, MAP_PRIVATE, fd, 0); 
+			if (map != MAP_FAILED) {
+				madvise(map, _size, MADV_SEQUENTIAL); 
+				_data = (char*)map; 
+				_mapped = true; 
+			}
+		}
+	}
+	close(fd); 
+	if (_mapped || !_good || _size == 0) return; 
+	_good = false; 
+#endif
+
+	// read the whole file 
+	FILE* f = fopen(name.c_str(), "rb"); 
+	if (!f) return; 
+	fseek(f, 0, SEEK_END); 
+	_size = ftell(f); 
+	fseek(f, 0, SEEK_SET); 
+	_data = (char*)malloc(_size + 1); 
+	_good = _data && fread(_data, 1, _size, f) == _size; 
+	fclose(f); 
+}
+
+MappedFile::~MappedFile() {
+#ifndef USE_RISCV 
+	if (_mapped) {
+		munmap(_data, _size); 
+		return; 
+	}
+#endif
+	free(_data); 
+}
+
+} // end namespace fem 
\ No newline at end of file
@@ -0,0 +1,42 @@
+#pragma once 
+
+#include "General.hpp"
+
+namespace fem 
+{
+
+/// read only view of the bytes of a file 
+/** the file is memory mapped when the platform supports it. Under USE_RISCV 
+	(proxy kernel) or if mapping fails the whole file is read into memory 
+	with fread instead */ 
+class MappedFile {
+public:
+	/// open and map name 
+	MappedFile(const std::string& name); 
+	/// unmap or free the data 
+	~MappedFile(); 
+	/// return false if the file could not be read 
+	bool Good() const {return _good; }
+	/// return true if the data is memory mapped (false if it was copied) 
+	bool IsMapped() const {return _mapped; }
+	/// return the file contents 
+	const char* GetData() const {return _data; }
+	/// return the size of the file in bytes 
+	size_t GetSize() const {return _size; }
+private:
+	/// no copies 
+	MappedFile(const MappedFile&) = delete; 
+	/// no copies 
+	MappedFile& operator=(const MappedFile&) = delete; 
+
+	/// file contents 
+	char* _data; 
+	/// size in bytes 
+	size_t _size; 
+	/// true if _data is a mapping 
+	bool _mapped; 
+	/// true if the file was read 
+	bool _good; 
+}; 
+
+} // end namespace fem 
\ No newline at end of file
@@ -0,0 +1,140 @@
+#include "Snapshot.hpp"
+#include <cstdio>
+#include <sstream>
+
+using namespace std; 
+
+namespace fem 
+{
+
+/// identifies snapshot files 
+static const char SNAPSHOT_MAGIC[8] = {'R','V','F','E','M','S','N','P'}; 
+
+/// first bytes of every snapshot 
+struct SnapshotHeader {
+	/// SNAPSHOT_MAGIC 
+	char magic[8]; 
+	/// SNAPSHOT_VERSION 
+	uint64_t version; 
+	/// what the snapshot holds 
+	uint64_t key; 
+}; 
+
+/// header of one array 
+struct SnapshotRecord {
+	/// array name (NUL padded) 
+	char name[16]; 
+	/// entry size in bytes 
+	int64_t size; 
+	/// number of entries 
+	int64_t count; 
+}; 
+
+uint64_t HashBytes(const void* data, size_t size, uint64_t h) {
+	const unsigned char* p = (const unsigned char*)data; 
+	size_t nwords = size/8; 
+	for (size_t i=0; i<nwords; i++) {
+		uint64_t w; 
+		memcpy(&w, p + 8*i, 8); 
+		h = (h ^ w) * 1099511628211ull; 
+	}
+	for (size_t i=8*nwords; i<size; i++) {
+		h = (h ^ p[i]) * 1099511628211ull; 
+	}
+	return h; 
+}
+
+string SnapshotName(const string& dir, const string& prefix, uint64_t key) {
+	stringstream name; 
+	name << dir << ((dir.empty() || dir.back() == '/') ? "" : "/") 
+		<< prefix << "_" << hex << key << ".snap"; 
+	return name.str(); 
+}
+
+SnapshotWriter::SnapshotWriter(const string& name, uint64_t key) : _name(name) {
+	_file = fopen((name + ".tmp").c_str(), "wb"); 
+	if (!_file) ERROR("could not open snapshot " << name << ".tmp"); 
+	SnapshotHeader header; 
+	memcpy(header.magic, SNAPSHOT_MAGIC, 8); 
+	header.version = SNAPSHOT_VERSION; 
+	header.key = key; 
+	fwrite(&header, sizeof(header), 1, _file); 
+}
+
+SnapshotWriter::~SnapshotWriter() {
+	if (_file) Close(); 
+}
+
+void SnapshotWriter::Add(const string& name, int size, int64_t count, const void* data) {
+	CHECKMSG(_file, "snapshot " << _name << " already closed"); 
+	CHECKMSG(name.size() < 16, "snapshot array name " << name << " is too long"); 
+	SnapshotRecord rec; 
+	memset(rec.name, 0, sizeof(rec.name)); 
+	memcpy(rec.name, name.c_str(), name.size()); 
+	rec.size = size; 
+	rec.count = count; 
+	fwrite(&rec, sizeof(rec), 1, _file); 
+	size_t bytes = size*count; 
+	if (bytes) fwrite(data, 1, bytes, _file); 
+	// keep the next record 8 byte aligned 
+	static const char pad[8] = {0}; 
+	if (bytes%8) fwrite(pad, 1, 8 - bytes%8, _file); 
+}
+
+void SnapshotWriter::Close() {
+	bool ok = ferror(_file) == 0; 
+	ok = (fclose(_file) == 0) && ok; 
+	_file = NULL; 
+	if (!ok || rename((_name + ".tmp").c_str(), _name.c_str()) != 0) {
+		remove((_name + ".tmp").c_str()); 
+		ERROR("could not write snapshot " << _name); 
+	}
+}
+
+SnapshotReader::SnapshotReader(const string& name, uint64_t key) : _file(name), _good(false) {
+	if (!_file.Good() || _file.GetSize() < sizeof(SnapshotHeader)) return; 
+	const char* p = _file.GetData(); 
+	const char* end = p + _file.GetSize(); 
+	SnapshotHeader header; 
+	memcpy(&header, p, sizeof(header)); 
+	if (memcmp(header.magic, SNAPSHOT_MAGIC, 8) != 0 || header.version != SNAPSHOT_VERSION 
+		|| header.key != key) return; 
+	p += sizeof(header); 
+
+	while (p < end) {
+		SnapshotRecord rec; 
+		if (end - p < (long)sizeof(rec)) return; 
+		memcpy(&rec, p, sizeof(rec)); 
+		p += sizeof(rec); 
+		int64_t bytes = rec.size*rec.count; 
+		if (rec.size <= 0 || rec.count < 0 || end - p < bytes) return; 
+		rec.name[15] = '\0'; 
+		_arrays[rec.name] = {(int)rec.size, rec.count, p}; 
+		p += bytes + ((bytes%8) ? 8 - bytes%8 : 0); 
+	}
+	_good = true; 
+}
+
+const SnapshotReader::Record& SnapshotReader::Find(const string& name, int size) const {
+	auto it = _arrays.find(name); 
+	if (it == _arrays.end()) ERROR("snapshot has no array " << name); 
+	if (it->second.size != size) ERROR("snapshot array " << name << " has entries of " 
+		<< it->second.size << " bytes, expected " << size); 
+	return it->second; 
+}
+
+int SnapshotReader::GetInt(const string& name) const {
+	const Record& r = Find(name, sizeof(int)); 
+	CHECKMSG(r.count == 1, "snapshot array " << name << " is not a scalar"); 
+	int val; 
+	memcpy(&val, r.data, sizeof(int)); 
+	return val; 
+}
+
+const void* SnapshotReader::GetData(const string& name, int size, int64_t& count) const {
+	const Record& r = Find(name, size); 
+	count = r.count; 
+	return r.data; 
+}
+
+} // end namespace fem 
\ No newline at end of file
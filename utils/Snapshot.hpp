@@ -0,0 +1,99 @@
+#pragma once 
+
+#include <map>
+#include <cstdint>
+#include "General.hpp"
+#include "Array.hpp"
+#include "MappedFile.hpp"
+
+namespace fem 
+{
+
+/// bump when the layout of any snapshot changes 
+#define SNAPSHOT_VERSION 2 
+
+/// 64 bit FNV-1a hash of size bytes (whole 8 byte words are hashed at a time) 
+uint64_t HashBytes(const void* data, size_t size, uint64_t h=14695981039346656037ull); 
+
+/// return the file name of the snapshot prefix_<hex key>.snap in directory dir 
+std::string SnapshotName(const std::string& dir, const std::string& prefix, uint64_t key); 
+
+/// write named arrays to a versioned binary file 
+/** the file is a header followed by one record per array: a 16 character 
+	name, the entry size, the entry count, and the raw entries padded to 8 bytes. 
+	It is written to name.tmp and renamed on Close so readers never see a partial file */ 
+class SnapshotWriter {
+public:
+	/// open name for writing 
+	/** \param name file name 
+		\param key identifies what the snapshot holds (checked by SnapshotReader) */ 
+	SnapshotWriter(const std::string& name, uint64_t key); 
+	/// close if still open 
+	~SnapshotWriter(); 
+	/// add an array 
+	template<typename T> 
+	void Add(const std::string& name, const Array<T>& a) {
+		Add(name, sizeof(T), a.GetSize(), (a.GetSize()) ? &a[0] : NULL); 
+	}
+	/// add a single integer 
+	void Add(const std::string& name, int val) {Add(name, sizeof(int), 1, &val); }
+	/// add raw entries 
+	void Add(const std::string& name, int size, int64_t count, const void* data); 
+	/// finish the file and move it into place 
+	void Close(); 
+private:
+	/// final file name 
+	std::string _name; 
+	/// temporary file 
+	FILE* _file; 
+}; 
+
+/// memory mapped view of a file written by SnapshotWriter 
+/** arrays are located once when the file is opened and copied out with one 
+	memcpy each. Nothing is parsed */ 
+class SnapshotReader {
+public:
+	/// open name and check its version and key 
+	SnapshotReader(const std::string& name, uint64_t key); 
+	/// return true if the file exists and matches the version and key 
+	bool Good() const {return _good; }
+	/// return true if the snapshot has an array called name 
+	bool Has(const std::string& name) const {return _arrays.count(name); }
+	/// copy array name into a 
+	template<typename T> 
+	void Get(const std::string& name, Array<T>& a) const {
+		const Record& r = Find(name, sizeof(T)); 
+		a.Resize(r.count); 
+		if (r.count) memcpy(&a[0], r.data, r.count*sizeof(T)); 
+	}
+	/// return the single integer name 
+	int GetInt(const std::string& name) const; 
+	/// return a pointer to array name inside the mapping without copying 
+	/** the pointer is 8 byte aligned and stays valid while the reader exists. 
+		Pages are only read from disk when they are first touched 
+		\param[in] name array name 
+		\param[in] size expected entry size in bytes 
+		\param[out] count number of entries */ 
+	const void* GetData(const std::string& name, int size, int64_t& count) const; 
+private:
+	/// location of one array in the file 
+	struct Record {
+		/// entry size in bytes 
+		int size; 
+		/// number of entries 
+		int64_t count; 
+		/// first entry 
+		const char* data; 
+	}; 
+	/// return the record name, checking its entry size 
+	const Record& Find(const std::string& name, int size) const; 
+
+	/// mapped file 
+	MappedFile _file; 
+	/// arrays by name 
+	std::map<std::string, Record> _arrays; 
+	/// true if the file matched 
+	bool _good; 
+}; 
+
+} // end namespace fem 
\ No newline at end of file
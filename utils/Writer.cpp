@@ -1,268 +1,714 @@
 #include "Writer.hpp"
 #include "VisitWriter.H"
+#include "LagrangeBasis.hpp"
+#include "Compression.hpp"
+#include <cstdint>
+#include <sstream>
+#ifndef USE_RISCV
+#include <future>
+#include <chrono>
+#endif
 
 using namespace std; 
 
 namespace fem 
 {
+/// the mesh as the writers need it, read once from the first variable's space 
+struct WriterMesh {
+	/// number of nodes 
+	int N; 
+	/// coordinates, 3 per global id 
+	vector<double> pts; 
+	/// global id of each node 
+	vector<int> gids; 
+	/// vertices of every linear cell 
+	vector<int> conns; 
+	/// end of each cell's vertices in conns 
+	vector<int> ends; 
+	/// VTK type of each cell 
+	vector<int> types; 
+	/// first cell of each element 
+	vector<int> el_cells; 
+	/// gmsh type of each element 
+	vector<int> el_types; 
+	/// start of each element's nodes in el_nodes 
+	vector<int> el_offsets; 
+	/// global ids of every element's nodes 
+	vector<int> el_nodes; 
+	/// field names 
+	vector<string> names; 
+	/// vector dimension of each field 
+	vector<int> vdim; 
+	/// number of components of each field as written (vectors are padded to 3) 
+	vector<int> ncomp; 
+	/// true if every field has a value on each node of the first 
+	bool shared; 
+}; 
+
+/// one output: the variables at the time of the write and where to put them 
+struct WriterFrame {
+	/// Writer::Format to write in 
+	int format; 
+	/// file name without extension 
+	string name; 
+	/// number of the output 
+	int index; 
+	/// number of VTU pieces 
+	int pieces; 
+	/// true if VTU arrays are compressed 
+	bool compress; 
+	/// copies of the variables (asynchronous writes) 
+	vector<vector<double>> staged; 
+	/// values of each variable, either the live GridFunction or its copy 
+	vector<const double*> fields; 
+}; 
+
+#ifndef USE_RISCV
+/// VisitWriter keeps its state in globals 
+static mutex visit_lock; 
+#endif
+
+/// return the byte order of this machine as VTK names it 
+static const char* ByteOrder() {
+	uint16_t one = 1; 
+	return (*(const char*)&one) ? "LittleEndian" : "BigEndian"; 
+}
+
+/// return the number of vertices of a linear VTK cell 
+static int VTUVertices(int type) {
+	if (type == VISIT_TRIANGLE) return 3; 
+	if (type == VISIT_QUAD) return 4; 
+	if (type == VISIT_HEXAHEDRON) return 8; 
+	ERROR("cell type " << type << " not defined"); 
+}
+
+/// append an array to the appended data of a VTU file and return its offset there 
+/** raw arrays are a UInt64 byte count followed by the bytes. Compressed arrays are 
+	a header (block count, block size, size of the last partial block, and the 
+	compressed size of each block) followed by the LZ4 blocks */ 
+static size_t AppendVTUArray(vector<char>& data, const void* p, size_t bytes, bool compress) {
+	size_t offset = data.size(); 
+	const char* src = (const char*)p; 
+	if (!compress) {
+		uint64_t n = bytes; 
+		data.insert(data.end(), (const char*)&n, (const char*)&n + sizeof(n)); 
+		data.insert(data.end(), src, src + bytes); 
+		return offset; 
+	}
+	uint64_t nblocks = (bytes + VTU_BLOCK_BYTES - 1)/VTU_BLOCK_BYTES; 
+	vector<uint64_t> header(3 + nblocks); 
+	header[0] = nblocks; 
+	header[1] = VTU_BLOCK_BYTES; 
+	header[2] = bytes % VTU_BLOCK_BYTES; 
+	data.resize(offset + sizeof(uint64_t)*header.size()); 
+	for (uint64_t b=0; b<nblocks; b++) {
+		size_t n = std::min((size_t)VTU_BLOCK_BYTES, bytes - b*VTU_BLOCK_BYTES); 
+		size_t pos = data.size(); 
+		data.resize(pos + LZ4Bound(n)); 
+		header[3+b] = LZ4Compress(src + b*VTU_BLOCK_BYTES, n, &data[pos]); 
+		data.resize(pos + header[3+b]); 
+	}
+	memcpy(&data[offset], header.data(), sizeof(uint64_t)*header.size()); 
+	return offset; 
+}
+
+/// write the cells of elements [e0, e1) and the nodes they use to a VTU file 
+static void WriteVTUPiece(const string& fname, const WriterMesh& d, 
+	const vector<vector<double>>& fields, int e0, int e1, bool compress) {
+	int c0 = d.el_cells[e0]; 
+	int c1 = d.el_cells[e1]; 
+	int v0 = (c0) ? d.ends[c0-1] : 0; 
+	int v1 = (c1) ? d.ends[c1-1] : 0; 
+
+	// number the piece's nodes in order of first use 
+	vector<int> local(d.N, -1); 
+	vector<int> nodes; 
+	vector<int32_t> conns(v1-v0); 
+	for (int v=v0; v<v1; v++) {
+		int g = d.conns[v]; 
+		if (local[g] < 0) {
+			local[g] = nodes.size(); 
+			nodes.push_back(g); 
+		}
+		conns[v-v0] = local[g]; 
+	}
+	int np = nodes.size(); 
+
+	vector<char> data; 
+	vector<size_t> offsets; 
+	vector<double> vals; 
+	for (int f=0; f<fields.size(); f++) {
+		int nc = d.ncomp[f]; 
+		vals.resize(nc*np); 
+		for (int i=0; i<np; i++) {
+			for (int c=0; c<nc; c++) {
+				vals[nc*i+c] = fields[f][nc*nodes[i]+c]; 
+			}
+		}
+		offsets.push_back(AppendVTUArray(data, vals.data(), sizeof(double)*vals.size(), compress)); 
+	}
+	vals.resize(3*np); 
+	for (int i=0; i<np; i++) {
+		for (int c=0; c<3; c++) {
+			vals[3*i+c] = d.pts[3*nodes[i]+c]; 
+		}
+	}
+	offsets.push_back(AppendVTUArray(data, vals.data(), sizeof(double)*vals.size(), compress)); 
+	offsets.push_back(AppendVTUArray(data, conns.data(), sizeof(int32_t)*conns.size(), compress)); 
+	vector<int32_t> ends(c1-c0); 
+	vector<uint8_t> types(c1-c0); 
+	for (int c=c0; c<c1; c++) {
+		ends[c-c0] = d.ends[c] - v0; 
+		types[c-c0] = d.types[c]; 
+	}
+	offsets.push_back(AppendVTUArray(data, ends.data(), sizeof(int32_t)*ends.size(), compress)); 
+	offsets.push_back(AppendVTUArray(data, types.data(), types.size(), compress)); 
+
+	stringstream xml; 
+	auto DataArray = [&](const char* type, const string& name, int nc, size_t offset) {
+		xml << "<DataArray type=\"" << type << "\""; 
+		if (!name.empty()) xml << " Name=\"" << name << "\""; 
+		if (nc) xml << " NumberOfComponents=\"" << nc << "\""; 
+		xml << " format=\"appended\" offset=\"" << offset << "\"/>\n"; 
+	}; 
+	xml << "<?xml version=\"1.0\"?>\n<VTKFile type=\"UnstructuredGrid\" version=\"1.0\" " 
+		<< "byte_order=\"" << ByteOrder() << "\" header_type=\"UInt64\""; 
+	if (compress) xml << " compressor=\"vtkLZ4DataCompressor\""; 
+	xml << ">\n<UnstructuredGrid>\n<Piece NumberOfPoints=\"" << np 
+		<< "\" NumberOfCells=\"" << c1-c0 << "\">\n<PointData>\n"; 
+	for (int f=0; f<fields.size(); f++) {
+		DataArray("Float64", d.names[f], d.ncomp[f], offsets[f]); 
+	}
+	int k = fields.size(); 
+	xml << "</PointData>\n<Points>\n"; 
+	DataArray("Float64", "", 3, offsets[k]); 
+	xml << "</Points>\n<Cells>\n"; 
+	DataArray("Int32", "connectivity", 0, offsets[k+1]); 
+	DataArray("Int32", "offsets", 0, offsets[k+2]); 
+	DataArray("UInt8", "types", 0, offsets[k+3]); 
+	xml << "</Cells>\n</Piece>\n</UnstructuredGrid>\n<AppendedData encoding=\"raw\">\n_"; 
+	string head = xml.str(); 
+	const char tail[] = "\n</AppendedData>\n</VTKFile>\n"; 
+
+	FILE* out = fopen(fname.c_str(), "wb"); 
+	if (!out) ERROR("could not open " << fname); 
+	setvbuf(out, NULL, _IOFBF, WRITER_BUFFER_BYTES); 
+	fwrite(head.data(), 1, head.size(), out); 
+	if (data.size()) fwrite(data.data(), 1, data.size(), out); 
+	fwrite(tail, 1, sizeof(tail)-1, out); 
+	bool ok = ferror(out) == 0; 
+	if (fclose(out) != 0 || !ok) ERROR("could not write " << fname); 
+}
 
 Writer::Writer(string name) {
 	_base_name = name; 
 	_count = 0; 
 	_writes = 0; 
 	_f = 1; 
+	_pieces = 1; 
+	_compress = false; 
+	_mesh = NULL; 
+	_frames.Append(new WriterFrame); 
+	_async = false; 
+	_stall = 0; 
+#ifndef USE_RISCV
+	_busy = 0; 
+	_stop = false; 
+#endif
+}
+
+Writer::~Writer() {
+	SetAsync(0); 
+	for (int i=0; i<_frames.GetSize(); i++) {
+		delete _frames[i]; 
+	}
+	delete _mesh; 
 }
 
 void Writer::Add(GridFunction& gf, string name) {
+	// the mesh and field layout are read again on the next write 
+	Flush(); 
+	delete _mesh; 
+	_mesh = NULL; 
 	_gf.Append(&gf); 
 	_names.Append(name); 
 }
 
+void Writer::SetAsync(int depth) {
+	CHECK(depth >= 0); 
+#ifndef USE_RISCV
+	if (_thread.joinable()) {
+		Flush(); 
+		{
+			lock_guard<mutex> lock(_lock); 
+			_stop = true; 
+		}
+		_cv.notify_all(); 
+		_thread.join(); 
+		_stop = false; 
+	}
+	for (int i=_frames.GetSize(); i<depth; i++) {
+		_frames.Append(new WriterFrame); 
+	}
+	_free.Clear(); 
+	for (int i=0; i<depth; i++) {
+		_free.Append(_frames[i]); 
+	}
+	_async = depth > 0; 
+	if (_async) {
+		_thread = thread(&Writer::Run, this); 
+	}
+#endif
+}
+
+void Writer::Flush() {
+#ifndef USE_RISCV
+	unique_lock<mutex> lock(_lock); 
+	_cv.wait(lock, [this]{return _queue.empty() && _busy == 0; }); 
+#endif
+}
+
+#ifndef USE_RISCV
+void Writer::Run() {
+	unique_lock<mutex> lock(_lock); 
+	while (true) {
+		_cv.wait(lock, [this]{return _stop || !_queue.empty(); }); 
+		if (_queue.empty()) {
+			return; 
+		}
+		WriterFrame* frame = _queue.front(); 
+		_queue.pop_front(); 
+		_busy++; 
+		lock.unlock(); 
+		WriteFrame(*frame); 
+		lock.lock(); 
+		_busy--; 
+		_free.Append(frame); 
+		_cv.notify_all(); 
+	}
+}
+#endif
+
 void Writer::WriteGMSH(bool force) {
+	if (_count++%_f != 0 && !force) {
+		return; 
+	}
+	Output(GMSH); 
+}
 
+void Writer::Write(bool force) {
+#ifndef USE_RISCV
 	if (_count++%_f != 0 && !force) {
 		return; 
 	}
+	Output(VISIT); 
+#endif
+}
+
+void Writer::WriteVTU(bool force) {
+	if (_count++%_f != 0 && !force) {
+		return; 
+	}
+	Output(VTU); 
+}
 
+void Writer::BuildMesh() {
 	const FESpace* space = _gf[0]->GetSpace(); 
-	string name = _names[0]; 
+	WriterMesh* m = new WriterMesh; 
+	m->N = space->GetNumNodes(); 
+	m->pts.assign(3*m->N, 0.); 
+	m->gids.resize(m->N); 
+	// space nodes are numbered by index 
+	for (int i=0; i<m->N; i++) {
+		Point x = space->GetNodeX(i); 
+		m->gids[i] = i; 
+		for (int j=0; j<DIM; j++) {
+			m->pts[3*i+j] = x[j]; 
+		}
+	}
+
+	// element views are not thread safe so everything is read here 
+	int Ne = space->GetNumElements(); 
+	m->el_cells.resize(Ne+1); 
+	m->el_cells[0] = 0; 
+	m->el_offsets.resize(Ne+1); 
+	m->el_offsets[0] = 0; 
+	for (int e=0; e<Ne; e++) {
+		ElementHandle view; 
+		const Element& el = space->GetEl(e, view); 
+		LinearCells(el, space->GetOrder(), m->conns, m->types); 
+		m->el_cells[e+1] = m->types.size(); 
+		m->el_types.push_back(el.GetType()+1); 
+		for (int j=0; j<el.GetNumNodes(); j++) {
+			m->el_nodes.push_back(el[j].GetGlobalID()); 
+		}
+		m->el_offsets[e+1] = m->el_nodes.size(); 
+	}
+	m->ends.resize(m->types.size()); 
+	for (int c=0; c<m->types.size(); c++) {
+		m->ends[c] = ((c) ? m->ends[c-1] : 0) + VTUVertices(m->types[c]); 
+	}
 
-	ofstream out(_base_name + to_string(_writes++) + ".msh"); 
+	m->shared = true; 
+	for (int f=0; f<_gf.GetSize(); f++) {
+		const FESpace* fes = _gf[f]->GetSpace(); 
+		m->names.push_back(_names[f]); 
+		m->vdim.push_back(fes->GetVDim()); 
+		m->ncomp.push_back((fes->GetVDim() > 1) ? 3 : 1); 
+		m->shared = m->shared && fes->GetNumNodes() == m->N; 
+	}
+	_mesh = m; 
+}
+
+void Writer::Output(Format format) {
+	CH_TIMERS_COARSE("writer output"); 
+	CHECKMSG(_gf.GetSize() > 0, "no variables to write"); 
+	if (!_mesh) {
+		BuildMesh(); 
+	}
+	if (format != GMSH) {
+		CHECKMSG(_mesh->shared, "fields must share the nodes of the first field"); 
+	}
+
+	WriterFrame* frame = _frames[0]; 
+#ifndef USE_RISCV
+	if (_async) {
+		unique_lock<mutex> lock(_lock); 
+		if (_free.GetSize() == 0) {
+			// every buffer is queued: wait for the oldest to be written 
+			auto start = chrono::steady_clock::now(); 
+			_cv.wait(lock, [this]{return _free.GetSize() > 0; }); 
+			_stall += chrono::duration<double>(chrono::steady_clock::now() - start).count(); 
+		}
+		frame = _free[_free.GetSize()-1]; 
+		_free.Resize(_free.GetSize()-1); 
+	}
+#endif
+	frame->format = format; 
+	frame->index = _writes++; 
+	frame->name = _base_name + to_string(frame->index); 
+	frame->pieces = _pieces; 
+	frame->compress = _compress; 
+	frame->staged.resize(_gf.GetSize()); 
+	frame->fields.resize(_gf.GetSize()); 
+	for (int f=0; f<_gf.GetSize(); f++) {
+		const double* vals = _gf[f]->GetData(); 
+		if (_async) {
+			frame->staged[f].assign(vals, vals + _gf[f]->GetSize()); 
+			vals = frame->staged[f].data(); 
+		}
+		frame->fields[f] = vals; 
+	}
+
+	if (!_async) {
+		WriteFrame(*frame); 
+		return; 
+	}
+#ifndef USE_RISCV
+	{
+		lock_guard<mutex> lock(_lock); 
+		_queue.push_back(frame); 
+	}
+	_cv.notify_all(); 
+#endif
+}
+
+void Writer::WriteFrame(const WriterFrame& frame) const {
+	if (frame.format == GMSH) {
+		WriteGMSH(frame); 
+	} else if (frame.format == VISIT) {
+		WriteVisIt(frame); 
+	} else {
+		WriteVTU(frame); 
+	}
+}
+
+void Writer::WriteGMSH(const WriterFrame& frame) const {
+	const WriterMesh& m = *_mesh; 
+
+	// write through a large buffer instead of flushing every line 
+	vector<char> buf(WRITER_BUFFER_BYTES); 
+	ofstream out; 
+	out.rdbuf()->pubsetbuf(buf.data(), buf.size()); 
+	out.open(frame.name + ".msh"); 
 
 	// header 
-	out << "$MeshFormat" << endl; 
-	out << 2.2 << " " << 0 << " " << 8 << endl; 
-	out << "$EndMeshFormat" << endl; 
+	out << "$MeshFormat\n"; 
+	out << 2.2 << " " << 0 << " " << 8 << "\n"; 
+	out << "$EndMeshFormat\n"; 
 
 	// nodes 
-	out << "$Nodes" << endl; 
-	out << space->GetNumNodes() << endl; 
-	for (int i=0; i<space->GetNumNodes(); i++) {
-		out << space->GetNode(i).GetGlobalID()+1 << " "; 
+	out << "$Nodes\n"; 
+	out << m.N << "\n"; 
+	for (int i=0; i<m.N; i++) {
+		out << m.gids[i]+1 << " "; 
 		for (int j=0; j<DIM; j++) {
-			out << space->GetNode(i).GetX()[j] << " "; 
+			out << m.pts[3*m.gids[i]+j] << " "; 
 		}
 		if (DIM==2) {
 			out << 0; 
 		}
-		out << endl; 
+		out << "\n"; 
 	}
-	out << "$EndNodes" << endl; 
+	out << "$EndNodes\n"; 
 
 	// elements 
-	out << "$Elements" << endl; 
-	out << space->GetNumElements() << endl; 
-	for (int i=0; i<space->GetNumElements(); i++) {
-		const Element& el = space->GetEl(i); 
-		out << i+1 << " " << el.GetType()+1 << " " 
+	int Ne = m.el_types.size(); 
+	out << "$Elements\n"; 
+	out << Ne << "\n"; 
+	for (int i=0; i<Ne; i++) {
+		out << i+1 << " " << m.el_types[i] << " " 
 			<< 0 << " "; 
 
-		for (int j=0; j<el.GetNumNodes(); j++) {
-			out << el[j].GetGlobalID()+1 << " "; 
+		for (int j=m.el_offsets[i]; j<m.el_offsets[i+1]; j++) {
+			out << m.el_nodes[j]+1 << " "; 
 		}
-		out << endl; 
+		out << "\n"; 
 	}
-	out << "$EndElements" << endl; 
+	out << "$EndElements\n"; 
 
 	// node data 
-	out << "$NodeData" << endl; 
+	out << "$NodeData\n"; 
 	out << 
-		"1" << endl << "\"" << name << "\"" << endl << // string tag 
-		"1" << endl << "0.0" << endl << // real tag 
-		"3" << endl << // number of integer tags 
-		_writes-1 << endl << // time step number 
-		"1" << endl << // number of components 
-		space->GetNumNodes() << endl; // number of node values to write 
-	for (int i=0; i<space->GetNumNodes(); i++) {
-		out << space->GetNode(i).GetGlobalID()+1 << " " << (*_gf[0])[i] << endl; 
+		"1\n" << "\"" << m.names[0] << "\"\n" << // string tag 
+		"1\n" << "0.0\n" << // real tag 
+		"3\n" << // number of integer tags 
+		frame.index << "\n" << // time step number 
+		"1\n" << // number of components 
+		m.N << "\n"; // number of node values to write 
+	for (int i=0; i<m.N; i++) {
+		out << m.gids[i]+1 << " " << frame.fields[0][i] << "\n"; 
 	}
-	out << "$EndNodeData" << endl; 
+	out << "$EndNodeData\n"; 
 
 	out.close(); 
 }
 
-void Writer::Write(bool force) {
-#ifndef USE_RISCV
-	if (_count++%_f != 0 && !force) {
-		return; 
-	}
-
-	const FESpace* space = _gf[0]->GetSpace(); 
-	int N = space->GetNumNodes(); 
-
-	int nvars = _gf.GetSize(); 
-
-	// deep copy to float** 
-	float** vars = new float*[nvars]; 
-	int vardim[nvars]; 
-	for (int i=0; i<nvars; i++) {
-		const FESpace* fes = _gf[i]->GetSpace(); 
-		int dim = fes->GetVDim(); 
-		int vdim = (dim > 1) ? 3 : 1; 
-		vardim[i] = vdim; 
-		vars[i] = new float[vdim*fes->GetNumNodes()]; 
-		if (vdim == 1) {
-			for (int j=0; j<_gf[i]->GetSize(); j++) {
-				vars[i][j] = _gf[i]->operator[](j); 
-			} 			
+void Writer::LinearCells(const Element& el, int order, vector<int>& conns, 
+	vector<int>& cellType) const {
+	if (el.GetType() == QUAD) {
+		if (order == 0) {
+			ERROR("not supported"); 
+		}
+		
+		else if (order == 1) {
+			for (int j=0; j<4; j++) {
+				conns.push_back(el[j].GetGlobalID()); 
+			}
+			cellType.push_back(VISIT_QUAD); 
+		} 
+
+		else if (order == 2) {
+			conns.push_back(el.GetNodeGlobalID(0)); 
+			conns.push_back(el.GetNodeGlobalID(4)); 
+			conns.push_back(el.GetNodeGlobalID(8)); 
+			conns.push_back(el.GetNodeGlobalID(7)); 
+			cellType.push_back(VISIT_QUAD); 
+
+			conns.push_back(el.GetNodeGlobalID(4)); 
+			conns.push_back(el.GetNodeGlobalID(1)); 
+			conns.push_back(el.GetNodeGlobalID(5)); 
+			conns.push_back(el.GetNodeGlobalID(8)); 
+			cellType.push_back(VISIT_QUAD); 
+
+			conns.push_back(el.GetNodeGlobalID(8)); 
+			conns.push_back(el.GetNodeGlobalID(5)); 
+			conns.push_back(el.GetNodeGlobalID(2)); 
+			conns.push_back(el.GetNodeGlobalID(6)); 
+			cellType.push_back(VISIT_QUAD); 
+
+			conns.push_back(el.GetNodeGlobalID(7)); 
+			conns.push_back(el.GetNodeGlobalID(8)); 
+			conns.push_back(el.GetNodeGlobalID(6)); 
+			conns.push_back(el.GetNodeGlobalID(3)); 
+			cellType.push_back(VISIT_QUAD); 
+		} else if (order == 3) {
+			conns.push_back(el.GetNodeGlobalID(0)); 
+			conns.push_back(el.GetNodeGlobalID(4)); 
+			conns.push_back(el.GetNodeGlobalID(12)); 
+			conns.push_back(el.GetNodeGlobalID(11)); 
+			cellType.push_back(VISIT_QUAD); 
+
+			conns.push_back(el.GetNodeGlobalID(4)); 
+			conns.push_back(el.GetNodeGlobalID(5)); 
+			conns.push_back(el.GetNodeGlobalID(13)); 
+			conns.push_back(el.GetNodeGlobalID(12)); 
+			cellType.push_back(VISIT_QUAD); 
+
+			conns.push_back(el.GetNodeGlobalID(5)); 
+			conns.push_back(el.GetNodeGlobalID(1)); 
+			conns.push_back(el.GetNodeGlobalID(6)); 
+			conns.push_back(el.GetNodeGlobalID(13)); 
+			cellType.push_back(VISIT_QUAD); 
+
+			conns.push_back(el.GetNodeGlobalID(11)); 
+			conns.push_back(el.GetNodeGlobalID(12)); 
+			conns.push_back(el.GetNodeGlobalID(14)); 
+			conns.push_back(el.GetNodeGlobalID(10)); 
+			cellType.push_back(VISIT_QUAD); 
+
+			conns.push_back(el.GetNodeGlobalID(12)); 
+			conns.push_back(el.GetNodeGlobalID(13)); 
+			conns.push_back(el.GetNodeGlobalID(15)); 
+			conns.push_back(el.GetNodeGlobalID(14)); 
+			cellType.push_back(VISIT_QUAD); 
+
+			conns.push_back(el.GetNodeGlobalID(13)); 
+			conns.push_back(el.GetNodeGlobalID(6)); 
+			conns.push_back(el.GetNodeGlobalID(7)); 
+			conns.push_back(el.GetNodeGlobalID(15)); 
+			cellType.push_back(VISIT_QUAD); 
+
+			conns.push_back(el.GetNodeGlobalID(10)); 
+			conns.push_back(el.GetNodeGlobalID(14)); 
+			conns.push_back(el.GetNodeGlobalID(9)); 
+			conns.push_back(el.GetNodeGlobalID(3)); 
+			cellType.push_back(VISIT_QUAD); 
+
+			conns.push_back(el.GetNodeGlobalID(14)); 
+			conns.push_back(el.GetNodeGlobalID(15)); 
+			conns.push_back(el.GetNodeGlobalID(8)); 
+			conns.push_back(el.GetNodeGlobalID(9)); 
+			cellType.push_back(VISIT_QUAD); 
+
+			conns.push_back(el.GetNodeGlobalID(15)); 
+			conns.push_back(el.GetNodeGlobalID(7)); 
+			conns.push_back(el.GetNodeGlobalID(2)); 
+			conns.push_back(el.GetNodeGlobalID(8)); 
+			cellType.push_back(VISIT_QUAD); 
 		} else {
-			if (dim==2) {
-				for (int j=0; j<fes->GetNumNodes(); j++) {
-					vars[i][vdim*j] = _gf[i]->operator[](dim*j); 
-					vars[i][vdim*j+1] = _gf[i]->operator[](dim*j+1); 
-					vars[i][vdim*j+2] = 0; 
-				}
-			} else {
-				for (int j=0; j<fes->GetNumNodes(); j++) {
-					for (int d=0; d<3; d++) {
-						vars[i][vdim*j+d] = _gf[i]->operator[](dim*j+d); 
-					}
+			// split into order^2 linear quads using the node lattice 
+			const LagrangeKernels* k = el.GetKernels(); 
+			if (!k) ERROR("order " << order << " not supported"); 
+			int P = k->order; 
+			vector<int> lat((P+1)*(P+1)); 
+			for (int n=0; n<k->nn; n++) {
+				lat[k->lattice[2*n+1]*(P+1) + k->lattice[2*n]] = n; 
+			}
+			for (int j=0; j<P; j++) {
+				for (int i=0; i<P; i++) {
+					conns.push_back(el.GetNodeGlobalID(lat[j*(P+1)+i])); 
+					conns.push_back(el.GetNodeGlobalID(lat[j*(P+1)+i+1])); 
+					conns.push_back(el.GetNodeGlobalID(lat[(j+1)*(P+1)+i+1])); 
+					conns.push_back(el.GetNodeGlobalID(lat[(j+1)*(P+1)+i])); 
+					cellType.push_back(VISIT_QUAD); 
 				}
 			}
 		}
 	}
 
-	int centering[nvars]; 
-	for (int i=0; i<nvars; i++) {
-		centering[i] = 1; 
-	}
-
-	const char* varnames[nvars]; 
-	for (int i=0; i<nvars; i++) {
-		varnames[i] = _names[i].c_str(); 
+	else if (el.GetType() == TRI) {
+		for (int i=0; i<3; i++) {
+			conns.push_back(el.GetNodeGlobalID(i)); 
+		}
+		cellType.push_back(VISIT_TRIANGLE); 
 	}
 
-	vector<float> pts(3*N);
-	for (int i=0; i<N; i++) {
-		Point x = space->GetNode(i).GetX(); 
-		int p = 3*space->GetNode(i).GetGlobalID();  
-		for (int j=0; j<DIM; j++) {
-			pts[p+j] = x[j]; 
+	else if (el.GetType() == HEX) {
+		for (int i=0; i<8; i++) {
+			conns.push_back(el.GetNodeGlobalID(i)); 
 		}
-	} 
-
-	vector<int> conns; 
-	vector<int> cellType; 
-	for (int i=0; i<space->GetNumElements(); i++) {
-		const Element& el = space->GetEl(i); 
+		cellType.push_back(VISIT_HEXAHEDRON); 
+	}
 
-		if (el.GetType() == QUAD) {
-			if (space->GetOrder() == 0) {
-				ERROR("not supported"); 
-			}
-			
-			else if (space->GetOrder() == 1) {
-				for (int j=0; j<4; j++) {
-					conns.push_back(el[j].GetGlobalID()); 
-				}
-				cellType.push_back(VISIT_QUAD); 
-			} 
-
-			else if (space->GetOrder() == 2) {
-				conns.push_back(el.GetNodeGlobalID(0)); 
-				conns.push_back(el.GetNodeGlobalID(4)); 
-				conns.push_back(el.GetNodeGlobalID(8)); 
-				conns.push_back(el.GetNodeGlobalID(7)); 
-				cellType.push_back(VISIT_QUAD); 
-
-				conns.push_back(el.GetNodeGlobalID(4)); 
-				conns.push_back(el.GetNodeGlobalID(1)); 
-				conns.push_back(el.GetNodeGlobalID(5)); 
-				conns.push_back(el.GetNodeGlobalID(8)); 
-				cellType.push_back(VISIT_QUAD);
-
-				conns.push_back(el.GetNodeGlobalID(8)); 
-				conns.push_back(el.GetNodeGlobalID(5)); 
-				conns.push_back(el.GetNodeGlobalID(2)); 
-				conns.push_back(el.GetNodeGlobalID(6)); 
-				cellType.push_back(VISIT_QUAD);
-
-				conns.push_back(el.GetNodeGlobalID(7)); 
-				conns.push_back(el.GetNodeGlobalID(8)); 
-				conns.push_back(el.GetNodeGlobalID(6)); 
-				conns.push_back(el.GetNodeGlobalID(3)); 
-				cellType.push_back(VISIT_QUAD); 
-			} else if (space->GetOrder() == 3) {
-				conns.push_back(el.GetNodeGlobalID(0)); 
-				conns.push_back(el.GetNodeGlobalID(4)); 
-				conns.push_back(el.GetNodeGlobalID(12)); 
-				conns.push_back(el.GetNodeGlobalID(11)); 
-				cellType.push_back(VISIT_QUAD); 
-
-				conns.push_back(el.GetNodeGlobalID(4)); 
-				conns.push_back(el.GetNodeGlobalID(5)); 
-				conns.push_back(el.GetNodeGlobalID(13)); 
-				conns.push_back(el.GetNodeGlobalID(12)); 
-				cellType.push_back(VISIT_QUAD); 
-
-				conns.push_back(el.GetNodeGlobalID(5)); 
-				conns.push_back(el.GetNodeGlobalID(1)); 
-				conns.push_back(el.GetNodeGlobalID(6)); 
-				conns.push_back(el.GetNodeGlobalID(13)); 
-				cellType.push_back(VISIT_QUAD); 
-
-				conns.push_back(el.GetNodeGlobalID(11)); 
-				conns.push_back(el.GetNodeGlobalID(12)); 
-				conns.push_back(el.GetNodeGlobalID(14)); 
-				conns.push_back(el.GetNodeGlobalID(10)); 
-				cellType.push_back(VISIT_QUAD); 
-
-				conns.push_back(el.GetNodeGlobalID(12)); 
-				conns.push_back(el.GetNodeGlobalID(13)); 
-				conns.push_back(el.GetNodeGlobalID(15)); 
-				conns.push_back(el.GetNodeGlobalID(14)); 
-				cellType.push_back(VISIT_QUAD); 
-
-				conns.push_back(el.GetNodeGlobalID(13)); 
-				conns.push_back(el.GetNodeGlobalID(6)); 
-				conns.push_back(el.GetNodeGlobalID(7)); 
-				conns.push_back(el.GetNodeGlobalID(15)); 
-				cellType.push_back(VISIT_QUAD); 
-
-				conns.push_back(el.GetNodeGlobalID(10)); 
-				conns.push_back(el.GetNodeGlobalID(14)); 
-				conns.push_back(el.GetNodeGlobalID(9)); 
-				conns.push_back(el.GetNodeGlobalID(3)); 
-				cellType.push_back(VISIT_QUAD); 
-
-				conns.push_back(el.GetNodeGlobalID(14)); 
-				conns.push_back(el.GetNodeGlobalID(15)); 
-				conns.push_back(el.GetNodeGlobalID(8)); 
-				conns.push_back(el.GetNodeGlobalID(9)); 
-				cellType.push_back(VISIT_QUAD); 
-
-				conns.push_back(el.GetNodeGlobalID(15)); 
-				conns.push_back(el.GetNodeGlobalID(7)); 
-				conns.push_back(el.GetNodeGlobalID(2)); 
-				conns.push_back(el.GetNodeGlobalID(8)); 
-				cellType.push_back(VISIT_QUAD); 
-			}
-		}
+	else {
+		ERROR("element type " << el.GetType() << " not defined"); 
+	}
+}
 
-		else if (el.GetType() == TRI) {
-			for (int i=0; i<3; i++) {
-				conns.push_back(el.GetNodeGlobalID(i)); 
+void Writer::WriteVisIt(const WriterFrame& frame) const {
+#ifndef USE_RISCV
+	const WriterMesh& m = *_mesh; 
+	int N = m.N; 
+	int nvars = frame.fields.size(); 
+
+	// convert to float, vectors padded to 3 components 
+	vector<vector<float>> vals(nvars); 
+	vector<float*> vars(nvars); 
+	vector<int> centering(nvars, 1); 
+	vector<const char*> varnames(nvars); 
+	for (int i=0; i<nvars; i++) {
+		int dim = m.vdim[i]; 
+		int vdim = m.ncomp[i]; 
+		vals[i].assign(vdim*N, 0.f); 
+		for (int j=0; j<N; j++) {
+			for (int d=0; d<std::min(dim, vdim); d++) {
+				vals[i][vdim*j+d] = frame.fields[i][dim*j+d]; 
 			}
-			cellType.push_back(VISIT_TRIANGLE); 
 		}
+		vars[i] = vals[i].data(); 
+		varnames[i] = m.names[i].c_str(); 
+	}
+	vector<int> vardim = m.ncomp; 
+	vector<float> pts(m.pts.begin(), m.pts.end()); 
+	vector<int> cellType = m.types; 
+	vector<int> conns = m.conns; 
+
+	lock_guard<mutex> lock(visit_lock); 
+	write_unstructured_mesh(frame.name.c_str(), 1, N, &(pts[0]), 
+		cellType.size(), &(cellType[0]), &(conns[0]), nvars, &(vardim[0]), &(centering[0]), 
+		&(varnames[0]), &(vars[0])); 
+#endif
+}
 
-		else if (el.GetType() == HEX) {
-			for (int i=0; i<8; i++) {
-				conns.push_back(el.GetNodeGlobalID(i)); 
+void Writer::WriteVTU(const WriterFrame& frame) const {
+	const WriterMesh& d = *_mesh; 
+
+	// vector fields are padded to 3 components 
+	vector<vector<double>> fields(frame.fields.size()); 
+	for (int f=0; f<fields.size(); f++) {
+		int vdim = d.vdim[f]; 
+		int nc = d.ncomp[f]; 
+		fields[f].assign(nc*d.N, 0.); 
+		for (int i=0; i<d.N; i++) {
+			for (int c=0; c<std::min(vdim, nc); c++) {
+				fields[f][nc*i+c] = frame.fields[f][vdim*i+c]; 
 			}
-			cellType.push_back(VISIT_HEXAHEDRON); 
-		}
-
-		else {
-			ERROR("element type " << el.GetType() << " not defined"); 
 		}
 	}
 
-	string fname = _base_name + to_string(_writes++); 
-	write_unstructured_mesh(fname.c_str(), 1, N, &(pts[0]), 
-		cellType.size(), &(cellType[0]), &(conns[0]), nvars, vardim, centering, 
-		varnames, vars); 
+	const string& fname = frame.name; 
+	int Ne = d.el_types.size(); 
+	int np = std::max(1, std::min(frame.pieces, Ne)); 
+	if (np == 1) {
+		WriteVTUPiece(fname + ".vtu", d, fields, 0, Ne, frame.compress); 
+		return; 
+	}
+	vector<string> pieces(np); 
+	for (int p=0; p<np; p++) {
+		pieces[p] = fname + "_" + to_string(p) + ".vtu"; 
+	}
+#ifdef USE_RISCV
+	for (int p=0; p<np; p++) {
+		WriteVTUPiece(pieces[p], d, fields, p*Ne/np, (p+1)*Ne/np, frame.compress); 
+	}
+#else
+	vector<future<void>> jobs; 
+	for (int p=0; p<np; p++) {
+		jobs.push_back(async(launch::async, WriteVTUPiece, cref(pieces[p]), cref(d), 
+			cref(fields), p*Ne/np, (p+1)*Ne/np, frame.compress)); 
+	}
+	for (int p=0; p<np; p++) {
+		jobs[p].get(); 
+	}
 #endif
+
+	// pieces are named relative to the index 
+	ofstream out(fname + ".pvtu"); 
+	out << "<?xml version=\"1.0\"?>\n<VTKFile type=\"PUnstructuredGrid\" version=\"1.0\" " 
+		<< "byte_order=\"" << ByteOrder() << "\" header_type=\"UInt64\">\n" 
+		<< "<PUnstructuredGrid GhostLevel=\"0\">\n<PPointData>\n"; 
+	for (int f=0; f<fields.size(); f++) {
+		out << "<PDataArray type=\"Float64\" Name=\"" << d.names[f] 
+			<< "\" NumberOfComponents=\"" << d.ncomp[f] << "\"/>\n"; 
+	}
+	out << "</PPointData>\n<PPoints>\n" 
+		<< "<PDataArray type=\"Float64\" NumberOfComponents=\"3\"/>\n</PPoints>\n"; 
+	for (int p=0; p<np; p++) {
+		out << "<Piece Source=\"" << pieces[p].substr(pieces[p].rfind('/') + 1) << "\"/>\n"; 
+	}
+	out << "</PUnstructuredGrid>\n</VTKFile>\n"; 
+	if (!out) ERROR("could not write " << fname << ".pvtu"); 
 }
 
-} // end namespace fem 
\ No newline at end of file
+} // end namespace fem 
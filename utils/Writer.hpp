@@ -3,22 +3,40 @@
 #include "General.hpp"
 #include "GridFunction.hpp"
 #include "Array.hpp"
-#ifdef USE_MPI 
+#ifdef USE_MPI
 #include <mpi.h>
 #endif
+#ifndef USE_RISCV
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#endif
 
 namespace fem 
 {
 
+/// size of the buffers output files are written through 
+#define WRITER_BUFFER_BYTES (1 << 20)
+/// uncompressed size of the blocks compressed VTU arrays are split into 
+#define VTU_BLOCK_BYTES (1 << 16)
+
+struct WriterMesh; 
+struct WriterFrame; 
+
 /// write to vtk 
+/** the mesh is read from the first variable's space on the first write and reused
+	after that. Only the variables are read on later writes */ 
 class Writer {
 public:
 	/// constructor. provide base name for output files 
 	Writer(std::string name="solution"); 
+	/// finish queued writes 
+	~Writer(); 
 	/// add a solution variable to the output list
-	/** \param gf GridFunction memory location 
-		\param name name to write out 
-	*/  
+	/** \param gf GridFunction memory location
+		\param name name to write out
+	*/ 
 	void Add(GridFunction& gf, std::string name); 
 	/// set the write frequency 
 	/** write every f calls to Write */ 
@@ -30,7 +48,54 @@ public:
 
 	/// write all variables to VTK 
 	void Write(bool force=false); 
+
+	/// write all variables to binary VTU 
+	/** arrays are raw binary in the appended section, optionally LZ4 compressed. With
+		more than one piece the elements are split into contiguous ranges that are written
+		to separate .vtu files concurrently along with a .pvtu index naming them
+		\param force force output regardless of write frequency settings */ 
+	void WriteVTU(bool force=false); 
+	/// set the number of pieces WriteVTU splits the output into 
+	void SetPieces(int n) {CHECK(n > 0); _pieces = n; }
+	/// compress WriteVTU arrays (read by VTK as vtkLZ4DataCompressor) 
+	void SetCompression(bool c) {_compress = c; }
+
+	/// write files from a background thread 
+	/** each write copies the variables into one of depth pooled staging buffers, queues
+		it, and returns. When every buffer is queued the next write waits for the oldest
+		one to finish. Under USE_RISCV there are no threads and writes stay synchronous */ 
+	void SetAsync(int depth=2); 
+	/// wait until every queued write is finished 
+	void Flush(); 
+	/// return the seconds writes have waited for a free staging buffer 
+	double GetStallTime() const {return _stall; }
 protected:
+	/// output formats 
+	enum Format {
+		GMSH,
+		VISIT,
+		VTU
+	}; 
+	/// append element el split into linear VTK cells 
+	/** \param[in] el element
+		\param[in] order order of the space
+		\param[out] conns global ids of the cells' vertices
+		\param[out] cellType VTK type of each cell */ 
+	void LinearCells(const Element& el, int order, std::vector<int>& conns,
+		std::vector<int>& cellType) const; 
+	/// read the mesh from the first variable's space 
+	void BuildMesh(); 
+	/// stage the variables and write them in format now or in the background 
+	void Output(Format format); 
+	/// write a staged frame (safe to call from the background thread) 
+	void WriteFrame(const WriterFrame& frame) const; 
+	/// write frame to gmsh 
+	void WriteGMSH(const WriterFrame& frame) const; 
+	/// write frame to VTK through VisitWriter 
+	void WriteVisIt(const WriterFrame& frame) const; 
+	/// write frame to VTU 
+	void WriteVTU(const WriterFrame& frame) const; 
+
 	/// output frequency. write every _f times 
 	int _f; 
 	/// store pointers to GridFunction's 
@@ -43,6 +108,36 @@ protected:
 	int _count; 
 	/// number of files written 
 	int _writes; 
+	/// number of VTU pieces 
+	int _pieces; 
+	/// true if VTU arrays are compressed 
+	bool _compress; 
+	/// mesh read on the first write 
+	WriterMesh* _mesh; 
+	/// staging buffers (one for synchronous writes) 
+	Array<WriterFrame*> _frames; 
+	/// true if writes are queued for the background thread 
+	bool _async; 
+	/// seconds spent waiting for a free staging buffer 
+	double _stall; 
+#ifndef USE_RISCV
+	/// take queued frames and write them until stopped 
+	void Run(); 
+	/// background thread 
+	std::thread _thread; 
+	/// guards the queue and the free list 
+	std::mutex _lock; 
+	/// signals queue and free list changes 
+	std::condition_variable _cv; 
+	/// frames waiting to be written 
+	std::deque<WriterFrame*> _queue; 
+	/// frames that can be staged into 
+	Array<WriterFrame*> _free; 
+	/// number of frames being written 
+	int _busy; 
+	/// tells the thread to finish 
+	bool _stop; 
+#endif
 }; 
 
 } // end namespace fem 
\ No newline at end of file